@@ -0,0 +1,162 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// AdvancedMatchEngine在每个合约有大量挂单时的报撤单及行情撮合耗时
+// 参数为每个合约的挂单数，挂单平均分布在买卖双方各kLevelNum个价位上
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "trader/gateway/backtest/match_engine/advanced_match_engine.h"
+
+static constexpr uint32_t kContractNum = 4;
+static constexpr int kLevelNum = 100;
+static constexpr double kBid = 5000;
+static constexpr double kAsk = 5001;
+
+static bool InitContractTable() {
+  std::vector<ft::Contract> contracts(kContractNum);
+  for (uint32_t i = 0; i < kContractNum; ++i) {
+    contracts[i].ticker = "ticker" + std::to_string(i);
+    contracts[i].size = 1;
+    contracts[i].price_tick = 1;
+  }
+  return ft::ContractTable::Init(std::move(contracts));
+}
+
+class CountingListener : public ft::OrderEventListener {
+ public:
+  void OnTraded(const ft::OrderRequest& order, int volume, double price,
+                uint64_t timestamp_us) override {
+    ++traded;
+  }
+
+  void OnCanceled(const ft::OrderRequest& order, int canceled_volume) override { ++canceled; }
+
+  uint64_t traded = 0;
+  uint64_t canceled = 0;
+};
+
+class Book {
+ public:
+  explicit Book(int orders_per_contract) {
+    LOG_SET_LEVEL("error");
+    InitContractTable();
+    engine_.RegisterListener(&listener_);
+    engine_.Init();
+
+    for (uint32_t ticker_id = 1; ticker_id <= kContractNum; ++ticker_id) {
+      auto tick = MakeTick(ticker_id, kBid, kAsk);
+      tick.lower_limit_price = kBid * 0.9;
+      tick.upper_limit_price = kAsk * 1.1;
+      engine_.OnNewTick(tick);
+      for (int i = 0; i < orders_per_contract; ++i) {
+        bool buy = i % 2 == 0;
+        double price = buy ? kBid - (i / 2) % kLevelNum : kAsk + (i / 2) % kLevelNum;
+        Insert(ticker_id, buy, price);
+      }
+    }
+  }
+
+  static ft::TickData MakeTick(uint32_t ticker_id, double bid, double ask) {
+    ft::TickData tick{};
+    tick.ticker_id = ticker_id;
+    for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+      tick.bid[level] = bid - level;
+      tick.ask[level] = ask + level;
+      // 盘口挂单量足够大，使挂单的队列位置不会被消耗完
+      tick.bid_volume[level] = 1000000000;
+      tick.ask_volume[level] = 1000000000;
+    }
+    return tick;
+  }
+
+  uint64_t Insert(uint32_t ticker_id, bool buy, double price) {
+    ft::OrderRequest order{};
+    order.contract = ft::ContractTable::get_by_index(ticker_id);
+    order.order_id = ++next_order_id_;
+    order.type = ft::OrderType::kLimit;
+    order.direction = buy ? ft::Direction::kBuy : ft::Direction::kSell;
+    order.offset = ft::Offset::kOpen;
+    order.volume = 1;
+    order.price = price;
+    uint64_t handle;
+    engine_.InsertOrder(order, &handle);
+    return handle;
+  }
+
+  ft::AdvancedMatchEngine& engine() { return engine_; }
+  CountingListener& listener() { return listener_; }
+  uint64_t next_order_id() const { return next_order_id_; }
+
+ private:
+  ft::AdvancedMatchEngine engine_;
+  CountingListener listener_;
+  uint64_t next_order_id_ = 0;
+};
+
+// 在已有挂单的价位上报单后立即撤单
+static void BM_advanced_match_engine_insert_cancel(benchmark::State& state) {
+  Book book(state.range(0));
+  uint64_t i = 0;
+  for (auto _ : state) {
+    uint32_t ticker_id = i % kContractNum + 1;
+    double price = kBid - static_cast<double>(i % kLevelNum);
+    auto handle = book.Insert(ticker_id, true, price);
+    book.engine().CancelOrder(book.next_order_id(), handle);
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// 有成交量但不产生成交的行情，需要遍历盘口价位上的挂单更新队列位置
+static void BM_advanced_match_engine_tick(benchmark::State& state) {
+  Book book(state.range(0));
+  std::vector<ft::TickData> ticks;
+  for (uint32_t ticker_id = 1; ticker_id <= kContractNum; ++ticker_id) {
+    ticks.emplace_back(Book::MakeTick(ticker_id, kBid, kAsk));
+  }
+
+  uint64_t i = 0;
+  for (auto _ : state) {
+    auto& tick = ticks[i % kContractNum];
+    tick.volume += 2;
+    tick.turnover += kBid + kAsk;
+    book.engine().OnNewTick(tick);
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// 卖一价跌到买一价，买一价位上的挂单全部成交，之后恢复行情并补回挂单
+static void BM_advanced_match_engine_fill(benchmark::State& state) {
+  Book book(state.range(0));
+  int orders_per_level = static_cast<int>(state.range(0) / 2 / kLevelNum);
+  auto normal_tick = Book::MakeTick(1, kBid, kAsk);
+  auto cross_tick = Book::MakeTick(1, kBid - 1, kBid);
+
+  for (auto _ : state) {
+    cross_tick.volume = normal_tick.volume + 1;
+    cross_tick.turnover = normal_tick.turnover + kBid;
+    book.engine().OnNewTick(cross_tick);
+
+    state.PauseTiming();
+    normal_tick.volume = cross_tick.volume;
+    normal_tick.turnover = cross_tick.turnover;
+    book.engine().OnNewTick(normal_tick);
+    for (int n = 0; n < orders_per_level; ++n) {
+      book.Insert(1, true, kBid);
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(book.listener().traded);
+}
+
+BENCHMARK(BM_advanced_match_engine_insert_cancel)->Arg(1000)->Arg(4000)->Arg(16000);
+BENCHMARK(BM_advanced_match_engine_tick)->Arg(1000)->Arg(4000)->Arg(16000);
+BENCHMARK(BM_advanced_match_engine_fill)->Arg(1000)->Arg(4000)->Arg(16000);
+
+BENCHMARK_MAIN();
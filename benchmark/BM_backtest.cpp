@@ -0,0 +1,216 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 比较进程内回测(BacktestRunner)与ft_trader + strategy_engine --backtest的回测速度
+// 先生成列式tick文件，两种模式分别在单独的子进程中回放所有tick，策略每隔一定tick数挂单并撤单
+// journal模式下OMS与策略分别运行在两个线程中，通过journal及notifier交互
+// OMS初始化时需要连接TraderDB(redis)
+//
+// Usage: BM_backtest [--contracts=<file>] [--trader_db=<address>] [--ticks=<n>]
+//                    [--order_interval=<n>] [--dir=<dir>]
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "backtest/backtest_runner.h"
+#include "ft/base/config.h"
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "ft/strategy/strategy.h"
+#include "ft/utils/getopt.hpp"
+#include "trader/gateway/backtest/data_feed/tick_file.h"
+#include "trader/oms.h"
+
+static constexpr int kTickerNum = 4;
+
+static uint64_t total_ticks = 0;
+static uint32_t order_interval = 0;
+
+static double ElapsedSec(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+class BenchStrategy : public ft::Strategy {
+ public:
+  void OnTick(const ft::TickData& tick) override {
+    ++tick_count_;
+    if (order_interval > 0 && tick_count_ % order_interval == 0) {
+      auto* contract = ft::ContractTable::get_by_index(tick.ticker_id);
+      BuyOpen(contract->ticker, 1, tick.bid[0], ft::OrderType::kLimit);
+    }
+    if (tick_count_ == total_ticks && done_) {
+      done_->store(true, std::memory_order_release);
+    }
+  }
+
+  void OnOrder(const ft::OrderResponse& order) override {
+    ++rsp_count_;
+    if (!order.completed) {
+      CancelOrder(order.order_id);
+    }
+  }
+
+  void set_done_flag(std::atomic<bool>* done) { done_ = done; }
+  uint64_t tick_count() const { return tick_count_; }
+  uint64_t rsp_count() const { return rsp_count_; }
+
+ private:
+  uint64_t tick_count_ = 0;
+  uint64_t rsp_count_ = 0;
+  std::atomic<bool>* done_ = nullptr;
+};
+
+static bool GenerateTickFile(const std::string& contract_file, const std::string& file,
+                             std::vector<std::string>* tickers) {
+  if (!ft::ContractTable::Init(contract_file) || ft::ContractTable::size() < kTickerNum) {
+    printf("invalid contract file %s\n", contract_file.c_str());
+    return false;
+  }
+
+  ft::TickFileWriter writer;
+  if (!writer.Open(file)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < kTickerNum; ++i) {
+    tickers->emplace_back(ft::ContractTable::get_by_index(i + 1)->ticker);
+  }
+
+  uint64_t ts = 1619571600000000;
+  for (uint64_t i = 0; i < total_ticks; ++i) {
+    ft::TickData tick{};
+    double price = 4000.0 + static_cast<double>(i % 200);
+    tick.ticker_id = static_cast<uint32_t>(i % kTickerNum + 1);
+    tick.local_timestamp_us = ts + i * 125;
+    tick.exchange_timestamp_us = tick.local_timestamp_us - 50;
+    tick.last_price = price;
+    tick.volume = i;
+    for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+      tick.ask[level] = price + level + 1;
+      tick.bid[level] = price - level - 1;
+      tick.ask_volume[level] = 100;
+      tick.bid_volume[level] = 100;
+    }
+    if (!writer.Write(tick)) {
+      return false;
+    }
+  }
+  return writer.Close();
+}
+
+static void RunInProcess(const ft::FlareTraderConfig& config) {
+  auto start = std::chrono::steady_clock::now();
+  ft::BacktestRunner runner;
+  BenchStrategy strategy;
+  if (!runner.Init(config) || !runner.AddStrategy("BM_backtest", &strategy)) {
+    printf("failed to init backtest runner\n");
+    _exit(EXIT_FAILURE);
+  }
+  double init_sec = ElapsedSec(start);
+
+  start = std::chrono::steady_clock::now();
+  runner.Run();
+  double sec = ElapsedSec(start);
+  printf("%-10s ticks:%lu rsps:%lu init:%.3fs run:%.3fs %.0f ticks/s\n", "in_process",
+         strategy.tick_count(), strategy.rsp_count(), init_sec, sec, strategy.tick_count() / sec);
+}
+
+static void RunJournal(const ft::FlareTraderConfig& config) {
+  auto start = std::chrono::steady_clock::now();
+  // 读端在journal不存在时会直接失效，先初始化策略创建trade_mq再初始化OMS
+  BenchStrategy strategy;
+  std::atomic<bool> done = false;
+  strategy.set_done_flag(&done);
+  if (!strategy.Init(config.strategy_config_list[0], config)) {
+    printf("failed to init strategy\n");
+    _exit(EXIT_FAILURE);
+  }
+  auto oms = std::make_unique<ft::OrderManagementSystem>();
+  if (!oms->Init(config)) {
+    printf("failed to init oms\n");
+    _exit(EXIT_FAILURE);
+  }
+  double init_sec = ElapsedSec(start);
+
+  // 两个线程都不会退出，回放完所有tick后直接结束进程
+  start = std::chrono::steady_clock::now();
+  std::thread([&] { oms->Run(); }).detach();
+  std::thread([&] { strategy.RunBacktest(); }).detach();
+  while (!done.load(std::memory_order_acquire)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  double sec = ElapsedSec(start);
+  printf("%-10s ticks:%lu rsps:%lu init:%.3fs run:%.3fs %.0f ticks/s\n", "journal",
+         strategy.tick_count(), strategy.rsp_count(), init_sec, sec, strategy.tick_count() / sec);
+}
+
+static void RunMode(void (*func)(const ft::FlareTraderConfig&),
+                    const ft::FlareTraderConfig& config) {
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) {
+    printf("fork failed\n");
+    exit(EXIT_FAILURE);
+  }
+  if (pid == 0) {
+    func(config);
+    fflush(stdout);
+    _exit(EXIT_SUCCESS);
+  }
+
+  int status;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+    printf("backtest failed\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+int main() {
+  std::string contract_file = getarg("../config/contracts.csv", "--contracts");
+  std::string trader_db_address = getarg("127.0.0.1:6379", "--trader_db");
+  std::string dir = getarg(".", "--dir");
+  total_ticks = getarg(1000000UL, "--ticks");
+  order_interval = getarg(100U, "--order_interval");
+
+  LOG_SET_LEVEL("error");
+
+  std::string tick_file = dir + "/BM_backtest.ftick";
+  std::vector<std::string> tickers;
+  if (!GenerateTickFile(contract_file, tick_file, &tickers)) {
+    printf("failed to generate tick file\n");
+    exit(EXIT_FAILURE);
+  }
+
+  ft::FlareTraderConfig config{};
+  config.global_config.contract_file = contract_file;
+  config.global_config.trader_db_address = trader_db_address;
+  config.gateway_config.api = "backtest";
+  config.gateway_config.extended_args["match_engine"] = "ft.match_engine.simple";
+  config.gateway_config.extended_args["data_feed"] = "ft.data_feed.tick_file";
+  config.gateway_config.extended_args["data_file"] = tick_file;
+  config.rms_config.risk_conf_list.emplace_back(ft::RiskConfig{"ft.risk.position", {}});
+  config.rms_config.risk_conf_list.emplace_back(ft::RiskConfig{"ft.risk.self_trade", {}});
+
+  ft::StrategyConfig strategy_conf{};
+  strategy_conf.strategy_name = "BM_backtest";
+  strategy_conf.trade_mq_name = "BM_backtest_trade_mq";
+  strategy_conf.rsp_mq_name = "BM_backtest_rsp_mq";
+  strategy_conf.md_mq_name = "BM_backtest_md_mq";
+  strategy_conf.subscription_list = tickers;
+  config.strategy_config_list.emplace_back(strategy_conf);
+
+  printf("ticks:%lu order_interval:%u\n", total_ticks, order_interval);
+  RunMode(RunInProcess, config);
+  RunMode(RunJournal, config);
+
+  remove(tick_file.c_str());
+  int res = system("rm -f yjj.BM_backtest_* ft_notifier.oms. ft_notifier.strategy.BM_backtest");
+  (void)res;
+  exit(EXIT_SUCCESS);
+}
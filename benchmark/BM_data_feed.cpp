@@ -0,0 +1,183 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 比较CsvDataFeed与TickFileDataFeed回放同样行情时的耗时及内存占用
+// 先生成csv行情文件并转换为列式tick文件，每种data feed在单独的子进程中
+// 完成Init并回放所有tick，统计耗时及子进程的峰值RSS
+//
+// Usage: BM_data_feed [--ticks=<n>] [--dir=<dir>]
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "ft/utils/getopt.hpp"
+#include "trader/gateway/backtest/data_feed/csv_data_feed.h"
+#include "trader/gateway/backtest/data_feed/tick_file.h"
+
+static const char* kTickers[] = {"rb2105", "rb2110", "ag2106", "IF2106"};
+
+static bool InitContractTable() {
+  std::vector<ft::Contract> contracts;
+  for (auto* ticker : kTickers) {
+    contracts.emplace_back();
+    contracts.back().ticker = ticker;
+  }
+  return ft::ContractTable::Init(std::move(contracts));
+}
+
+static double ElapsedSec(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void GenerateCsv(const std::string& file, uint64_t tick_num) {
+  FILE* fp = fopen(file.c_str(), "w");
+  if (!fp) {
+    printf("failed to open %s\n", file.c_str());
+    exit(EXIT_FAILURE);
+  }
+  fprintf(fp, "InstrumentID,LocalTimeStamp,ExchangeTimeStamp,LastPrice,Volume,Turnover");
+  for (auto* side : {"AskPrice", "AskVolume", "BidPrice", "BidVolume"}) {
+    for (int level = 1; level <= ft::kMaxMarketLevel; ++level) {
+      fprintf(fp, ",%s%d", side, level);
+    }
+  }
+  fprintf(fp, "\n");
+
+  uint64_t ts = 1619571600000000;
+  for (uint64_t i = 0; i < tick_num; ++i) {
+    double price = 4000.0 + static_cast<double>(i % 200);
+    fprintf(fp, "%s,%lu,%lu,%.1f,%lu,%lu", kTickers[i % 4], ts + i * 125, ts + i * 125 - 50, price,
+            i, i * 40000);
+    for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+      fprintf(fp, ",%.1f", price + level + 1);
+    }
+    for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+      fprintf(fp, ",%lu", (i + level) % 500);
+    }
+    for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+      fprintf(fp, ",%.1f", price - level - 1);
+    }
+    for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+      fprintf(fp, ",%lu", (i * 3 + level) % 500);
+    }
+    fprintf(fp, "\n");
+  }
+  fclose(fp);
+}
+
+class Counter : public ft::MarketDataListener {
+ public:
+  explicit Counter(ft::TickFileWriter* writer = nullptr) : writer_(writer) {}
+
+  void OnDataFeed(const ft::TickData* tick) override {
+    ++count;
+    sum += tick->last_price;
+    if (writer_ && !writer_->Write(*tick)) {
+      printf("failed to write tick\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  uint64_t count = 0;
+  double sum = 0;
+
+ private:
+  ft::TickFileWriter* writer_;
+};
+
+// 在子进程中回放，使得峰值RSS互不影响
+static void RunFeed(const std::string& name, const std::string& data_feed_name,
+                    const std::string& data_file) {
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) {
+    printf("fork failed\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (pid == 0) {
+    auto start = std::chrono::steady_clock::now();
+    auto data_feed = ft::CreateDataFeed(data_feed_name);
+    Counter counter;
+    data_feed->RegisterListener(&counter);
+    if (!data_feed->Init({{"data_file", data_file}})) {
+      printf("failed to init %s\n", data_feed_name.c_str());
+      _exit(EXIT_FAILURE);
+    }
+    double load_sec = ElapsedSec(start);
+    while (data_feed->Feed()) {
+    }
+    double total_sec = ElapsedSec(start);
+    printf("%-10s ticks:%lu init:%.3fs init+feed:%.3fs %.0f ticks/s checksum:%.1f\n", name.c_str(),
+           counter.count, load_sec, total_sec, counter.count / total_sec, counter.sum);
+    fflush(stdout);
+    _exit(EXIT_SUCCESS);
+  }
+
+  int status;
+  struct rusage usage;
+  wait4(pid, &status, 0, &usage);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+    printf("%s failed\n", name.c_str());
+    exit(EXIT_FAILURE);
+  }
+  printf("%-10s peak rss:%.1fMB\n", name.c_str(), usage.ru_maxrss / 1024.0);
+}
+
+int main() {
+  uint64_t tick_num = getarg(10000000UL, "--ticks");
+  std::string dir = getarg(".", "--dir");
+
+  LOG_SET_LEVEL("error");
+  if (!InitContractTable()) {
+    printf("failed to init contract table\n");
+    exit(EXIT_FAILURE);
+  }
+
+  std::string csv_file = dir + "/BM_data_feed.csv";
+  std::string tick_file = dir + "/BM_data_feed.ftick";
+
+  auto start = std::chrono::steady_clock::now();
+  GenerateCsv(csv_file, tick_num);
+  printf("generate csv: %.3fs\n", ElapsedSec(start));
+
+  // 与tick_converter相同，通过CsvDataFeed转换
+  start = std::chrono::steady_clock::now();
+  {
+    ft::TickFileWriter writer;
+    Counter counter(&writer);
+    ft::CsvDataFeed csv_feed;
+    csv_feed.RegisterListener(&counter);
+    if (!writer.Open(tick_file) || !csv_feed.Init({{"data_file", csv_file}})) {
+      printf("failed to convert csv\n");
+      exit(EXIT_FAILURE);
+    }
+    while (csv_feed.Feed()) {
+    }
+    if (!writer.Close()) {
+      printf("failed to convert csv\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+  printf("convert: %.3fs\n", ElapsedSec(start));
+
+  struct stat csv_stat, tick_stat;
+  stat(csv_file.c_str(), &csv_stat);
+  stat(tick_file.c_str(), &tick_stat);
+  printf("ticks:%lu csv:%.1fMB tick_file:%.1fMB\n", tick_num, csv_stat.st_size / 1048576.0,
+         tick_stat.st_size / 1048576.0);
+  RunFeed("csv", "ft.data_feed.csv", csv_file);
+  RunFeed("tick_file", "ft.data_feed.tick_file", tick_file);
+
+  remove(csv_file.c_str());
+  remove(tick_file.c_str());
+  exit(EXIT_SUCCESS);
+}
@@ -48,5 +48,103 @@ static void BM_yijinjing_ipc(benchmark::State& state) {
   int res = system("rm -f yjj.BM_yijinjing_ipc*");
   (void)res;
 }
+// 与BM_yijinjing_ipc相同，但使用不申请内存的getNextFrame(Frame*)
+static void BM_yijinjing_ipc_frame_view(benchmark::State& state) {
+  auto md_writer = yijinjing::JournalWriter::create(".", "BM_yijinjing_ipc_fv_md", "md_writer");
+  auto md_reader = yijinjing::JournalReader::create(".", "BM_yijinjing_ipc_fv_md",
+                                                    yijinjing::TIME_TO_LAST, "md_reader");
+
+  auto td_writer = yijinjing::JournalWriter::create(".", "BM_yijinjing_ipc_fv_td", "td_writer");
+  auto td_reader = yijinjing::JournalReader::create(".", "BM_yijinjing_ipc_fv_td",
+                                                    yijinjing::TIME_TO_LAST, "td_reader");
+
+  std::atomic<bool> running = true;
+
+  std::thread st_thread([&] {
+    ft::TraderCommand cmd;
+    yijinjing::Frame frame(nullptr);
+
+    while (running) {
+      if (!md_reader->getNextFrame(&frame)) {
+        continue;
+      }
+      td_writer->write_data(cmd, 0, 0);
+    }
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  ft::TickData tick;
+  yijinjing::Frame frame(nullptr);
+  for (auto _ : state) {
+    md_writer->write_data(tick, 0, 0);
+    while (!td_reader->getNextFrame(&frame)) {
+      continue;
+    }
+  }
+
+  running = false;
+  st_thread.join();
+
+  int res = system("rm -f yjj.BM_yijinjing_ipc_fv*");
+  (void)res;
+}
+
+// 只统计读的耗时，每批先写入kReadBatch条消息再读出
+// 两者的差值即为每条消息上FramePtr的开销(malloc/free及引用计数)
+constexpr int kReadBatch = 1024;
+
+static void BM_yijinjing_read_frame_ptr(benchmark::State& state) {
+  auto writer = yijinjing::JournalWriter::create(".", "BM_yijinjing_read_fp", "writer");
+  auto reader = yijinjing::JournalReader::create(".", "BM_yijinjing_read_fp",
+                                                 yijinjing::TIME_TO_LAST, "reader");
+
+  ft::TickData tick{};
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (int i = 0; i < kReadBatch; ++i) {
+      writer->write_data(tick, 0, 0);
+    }
+    state.ResumeTiming();
+
+    for (int i = 0; i < kReadBatch; ++i) {
+      auto frame = reader->getNextFrame();
+      benchmark::DoNotOptimize(frame->getData());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kReadBatch);
+
+  int res = system("rm -f yjj.BM_yijinjing_read_fp*");
+  (void)res;
+}
+
+static void BM_yijinjing_read_frame_view(benchmark::State& state) {
+  auto writer = yijinjing::JournalWriter::create(".", "BM_yijinjing_read_fv", "writer");
+  auto reader = yijinjing::JournalReader::create(".", "BM_yijinjing_read_fv",
+                                                 yijinjing::TIME_TO_LAST, "reader");
+
+  ft::TickData tick{};
+  yijinjing::Frame frame(nullptr);
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (int i = 0; i < kReadBatch; ++i) {
+      writer->write_data(tick, 0, 0);
+    }
+    state.ResumeTiming();
+
+    for (int i = 0; i < kReadBatch; ++i) {
+      reader->getNextFrame(&frame);
+      benchmark::DoNotOptimize(frame.getData());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kReadBatch);
+
+  int res = system("rm -f yjj.BM_yijinjing_read_fv*");
+  (void)res;
+}
+
 BENCHMARK(BM_yijinjing_ipc);
+BENCHMARK(BM_yijinjing_ipc_frame_view);
+BENCHMARK(BM_yijinjing_read_frame_ptr);
+BENCHMARK(BM_yijinjing_read_frame_view);
 BENCHMARK_MAIN();
@@ -0,0 +1,67 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 同一条行情分发到多个策略journal的耗时
+// BM_fanout_single: 逐个journal调用write_data，每次写入都取一次时间戳
+// BM_fanout_multi: write_data_multi，整批共用一个时间戳，先填充再统一发布
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "ft/base/market_data.h"
+#include "ft/component/yijinjing/journal/JournalWriter.h"
+#include "ft/component/yijinjing/journal/PageUtil.h"
+
+static std::vector<yijinjing::JournalWriterPtr> CreateWriters(int num) {
+  yijinjing::PageConfig page_config;
+  page_config.pageSize = 64 * yijinjing::MB;
+
+  std::vector<yijinjing::JournalWriterPtr> writers;
+  for (int i = 0; i < num; ++i) {
+    auto jname = "BM_journal_fanout_" + std::to_string(i);
+    yijinjing::PageUtil::RemoveJournal(".", jname);
+    writers.emplace_back(yijinjing::JournalWriter::create(".", jname, "writer", page_config));
+  }
+  return writers;
+}
+
+static void RemoveJournals(int num) {
+  for (int i = 0; i < num; ++i) {
+    yijinjing::PageUtil::RemoveJournal(".", "BM_journal_fanout_" + std::to_string(i));
+  }
+}
+
+static void BM_fanout_single(benchmark::State& state) {
+  int num = static_cast<int>(state.range(0));
+  auto writers = CreateWriters(num);
+  ft::TickData tick{};
+  for (auto _ : state) {
+    for (auto& writer : writers) {
+      writer->write_data(tick, 1, 0);
+    }
+  }
+  writers.clear();
+  RemoveJournals(num);
+}
+
+static void BM_fanout_multi(benchmark::State& state) {
+  int num = static_cast<int>(state.range(0));
+  auto writers = CreateWriters(num);
+  std::vector<yijinjing::JournalWriter*> raw_writers;
+  for (auto& writer : writers) {
+    raw_writers.emplace_back(writer.get());
+  }
+  ft::TickData tick{};
+  for (auto _ : state) {
+    yijinjing::JournalWriter::write_data_multi(raw_writers.data(), raw_writers.size(), tick, 1, 0);
+  }
+  writers.clear();
+  RemoveJournals(num);
+}
+
+// 限制迭代次数，避免写入过多的页
+BENCHMARK(BM_fanout_single)->Arg(1)->Arg(8)->Arg(24)->Arg(64)->Iterations(100000);
+BENCHMARK(BM_fanout_multi)->Arg(1)->Arg(8)->Arg(24)->Arg(64)->Iterations(100000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,92 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 对比JournalReader合并多个journal时线性扫描与最小堆的读取耗时
+// dense: 所有journal交替写入，每个journal上都有待读的帧
+// sparse: 只有一个journal持续写入，其余journal一直没有新帧，
+//         堆合并时空闲的journal每隔idle_poll_interval次才检查一次
+//
+// Usage: BM_journal_merge [--frames=<n>] [--idle_poll_interval=<n>]
+
+#include <algorithm>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "ft/base/market_data.h"
+#include "ft/component/yijinjing/journal/JournalReader.h"
+#include "ft/component/yijinjing/journal/JournalWriter.h"
+#include "ft/component/yijinjing/journal/PageUtil.h"
+#include "ft/component/yijinjing/journal/Timer.h"
+#include "ft/utils/getopt.hpp"
+
+static uint64_t NowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_nsec + ts.tv_sec * 1000000000UL;
+}
+
+static std::string GetJournalName(int idx) { return "BM_journal_merge_" + std::to_string(idx); }
+
+// 返回平均每帧的读取耗时
+static double RunOnce(int journal_num, int frames, bool sparse, bool heap_merge,
+                      int idle_poll_interval) {
+  yijinjing::PageConfig page_config;
+  page_config.pageSize = yijinjing::JOURNAL_MIN_PAGE_SIZE;
+
+  std::vector<std::string> dirs;
+  std::vector<std::string> jnames;
+  std::vector<yijinjing::JournalWriterPtr> writers;
+  for (int i = 0; i < journal_num; ++i) {
+    dirs.emplace_back(".");
+    jnames.emplace_back(GetJournalName(i));
+    yijinjing::PageUtil::RemoveJournal(".", jnames.back());
+    writers.emplace_back(
+        yijinjing::JournalWriter::create(".", jnames.back(), "writer", page_config));
+  }
+
+  auto start_time = yijinjing::getNanoTime();
+  ft::TickData tick{};
+  for (int i = 0; i < frames; ++i) {
+    writers[sparse ? 0 : i % journal_num]->write_data(tick, 0, 0);
+  }
+
+  auto reader = yijinjing::JournalReader::create(dirs, jnames, start_time, "reader");
+  if (heap_merge) {
+    reader->enableHeapMerge(idle_poll_interval);
+  }
+  yijinjing::Frame frame(nullptr);
+  int count = 0;
+  auto start = NowNs();
+  while (reader->getNextFrame(&frame)) {
+    ++count;
+  }
+  auto cost = NowNs() - start;
+  if (count != frames) {
+    printf("frames lost: %d/%d\n", count, frames);
+    exit(EXIT_FAILURE);
+  }
+
+  reader.reset();
+  writers.clear();
+  for (auto& jname : jnames) {
+    yijinjing::PageUtil::RemoveJournal(".", jname);
+  }
+  return static_cast<double>(cost) / frames;
+}
+
+int main() {
+  int frames = getarg(200000, "--frames");
+  int idle_poll_interval = getarg(64, "--idle_poll_interval");
+
+  printf("ns/frame      journals    linear      heap(1)     heap(%d)\n", idle_poll_interval);
+  for (bool sparse : {false, true}) {
+    for (int journal_num : {1, 8, 64, 512}) {
+      double linear = RunOnce(journal_num, frames, sparse, false, 1);
+      double heap = RunOnce(journal_num, frames, sparse, true, 1);
+      double heap_idle = RunOnce(journal_num, frames, sparse, true, idle_poll_interval);
+      printf("%-13s %-11d %-11.1f %-11.1f %-11.1f\n", sparse ? "sparse" : "dense", journal_num,
+             linear, heap, heap_idle);
+    }
+  }
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,80 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 对比journal换页时的写入延迟
+// default: 换页时在写入路径上创建文件并mmap，新页的第一次写入会产生缺页中断
+// preallocate: 后台线程提前创建、预热并锁定下一页，换页时只需rename
+// 写入之间有间隔，给后台线程留出准备下一页的时间，模拟真实的消息速率
+//
+// Usage: BM_journal_page [--page_size_mb=<n>] [--pages=<n>] [--interval_ns=<n>]
+
+#include <algorithm>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "ft/base/market_data.h"
+#include "ft/component/yijinjing/journal/JournalWriter.h"
+#include "ft/component/yijinjing/journal/PageUtil.h"
+#include "ft/utils/getopt.hpp"
+
+static uint64_t NowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_nsec + ts.tv_sec * 1000000000UL;
+}
+
+static void SpinFor(uint64_t ns) {
+  auto start = NowNs();
+  while (NowNs() - start < ns) {
+  }
+}
+
+static void RunOnce(const std::string& name, int page_size_mb, int pages, uint64_t interval_ns,
+                    bool preallocate) {
+  std::string jname = "BM_journal_page_" + name;
+  yijinjing::PageUtil::RemoveJournal(".", jname);
+
+  yijinjing::PageConfig page_config;
+  page_config.pageSize = page_size_mb * yijinjing::MB;
+  page_config.preallocate = preallocate;
+  auto writer = yijinjing::JournalWriter::create(".", jname, "writer", page_config);
+
+  std::vector<uint64_t> latency;
+  std::vector<uint64_t> rollover_latency;
+  ft::TickData tick{};
+  short page_num = writer->getPageNum();
+  while (writer->getPageNum() < page_num + pages) {
+    short cur_page_num = writer->getPageNum();
+    auto start = NowNs();
+    writer->write_data(tick, 0, 0);
+    auto cost = NowNs() - start;
+    latency.emplace_back(cost);
+    if (writer->getPageNum() != cur_page_num) {
+      rollover_latency.emplace_back(cost);
+    }
+    SpinFor(interval_ns);
+  }
+  writer.reset();
+  yijinjing::PageUtil::RemoveJournal(".", jname);
+
+  std::sort(latency.begin(), latency.end());
+  auto pct = [&](double p) { return latency[static_cast<std::size_t>(p * (latency.size() - 1))]; };
+  uint64_t rollover_max = *std::max_element(rollover_latency.begin(), rollover_latency.end());
+  uint64_t rollover_sum = 0;
+  for (auto v : rollover_latency) {
+    rollover_sum += v;
+  }
+  printf("[%s] writes:%lu 50th:%lu 99th:%lu 99.99th:%lu max:%lu (ns)\n", name.c_str(),
+         latency.size(), pct(0.5), pct(0.99), pct(0.9999), latency.back());
+  printf("[%s] page rollovers:%lu mean:%lu max:%lu (ns)\n", name.c_str(), rollover_latency.size(),
+         rollover_sum / rollover_latency.size(), rollover_max);
+}
+
+int main() {
+  int page_size_mb = getarg(4, "--page_size_mb");
+  int pages = getarg(16, "--pages");
+  uint64_t interval_ns = getarg(1000UL, "--interval_ns");
+
+  RunOnce("default", page_size_mb, pages, interval_ns, false);
+  RunOnce("preallocate", page_size_mb, pages, interval_ns, true);
+}
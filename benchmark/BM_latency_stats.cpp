@@ -0,0 +1,59 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 热路径打点的耗时，每次迭代为一个阶段: 读一次tsc并记入直方图
+// BM_latency_stage_unregistered: 线程未注册recorder时只有读tsc的开销
+// BM_latency_flush: 导出一次全部直方图到共享内存的耗时，只在线程空闲时发生
+
+#include <benchmark/benchmark.h>
+
+#include "ft/component/latency_stats.h"
+
+static void BM_latency_rdtsc(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ft::RdTsc());
+  }
+}
+BENCHMARK(BM_latency_rdtsc);
+
+// 需要在注册recorder之前运行
+static void BM_latency_stage_unregistered(benchmark::State& state) {
+  uint64_t start_tsc = ft::RdTsc();
+  for (auto _ : state) {
+    uint64_t now = ft::RdTsc();
+    ft::RecordLatency(ft::kLatencyTickRing, start_tsc, now);
+    start_tsc = now;
+  }
+}
+BENCHMARK(BM_latency_stage_unregistered);
+
+static void BM_latency_stage(benchmark::State& state) {
+  ft::LatencyStats stats;
+  stats.Create("BM_latency_stats");
+  ft::RegisterLatencyRecorder(&stats, "bm");
+  uint64_t start_tsc = ft::RdTsc();
+  uint32_t stage = 0;
+  for (auto _ : state) {
+    uint64_t now = ft::RdTsc();
+    ft::RecordLatency(static_cast<ft::LatencyStage>(stage), start_tsc, now);
+    start_tsc = now;
+    stage = (stage + 1) % ft::kLatencyStageNum;
+  }
+  int res = system("rm -f ft_latency_stats.BM_latency_stats");
+  (void)res;
+}
+BENCHMARK(BM_latency_stage);
+
+static void BM_latency_flush(benchmark::State& state) {
+  ft::LatencyStats stats;
+  stats.Create("BM_latency_stats");
+  ft::RegisterLatencyRecorder(&stats, "bm", 0);
+  for (auto _ : state) {
+    ft::RecordLatency(ft::kLatencyTickRing, 1, 2);
+    ft::FlushLatencyStats();
+  }
+  int res = system("rm -f ft_latency_stats.BM_latency_stats");
+  (void)res;
+}
+BENCHMARK(BM_latency_flush);
+
+BENCHMARK_MAIN();
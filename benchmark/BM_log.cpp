@@ -0,0 +1,61 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 调用线程上一条LOG_INFO的耗时，日志写入/dev/null
+// BM_log_sync: 调用线程上格式化并写入sink
+// BM_log_async: 调用线程只编码参数写入队列，格式化及写入在后台线程，
+//               写入速度超过后台线程时队列满的日志被丢弃，只反映调用线程的开销
+// BM_log_filtered: 低于日志级别时的开销
+
+#include <benchmark/benchmark.h>
+
+#include "ft/base/log.h"
+#include "spdlog/sinks/basic_file_sink.h"
+
+static void SetupSink() {
+  static bool once = [] {
+    auto logger = ft::Logger::Instance().GetLogger();
+    logger->sinks() = {std::make_shared<spdlog::sinks::basic_file_sink_mt>("/dev/null")};
+    return true;
+  }();
+  (void)once;
+}
+
+static void LogOrder(int64_t order_id) {
+  char ticker[16] = "rb2105";
+  LOG_INFO("order sent. ticker:{}.{} direction:{} price:{:.2f} volume:{} order_id:{}", ticker,
+           "SHFE", "buy", 4123.5 + static_cast<double>(order_id % 10), 10, order_id);
+}
+
+static void BM_log_sync(benchmark::State& state) {
+  SetupSink();
+  LOG_SET_LEVEL("info");
+  int64_t order_id = 0;
+  for (auto _ : state) {
+    LogOrder(order_id++);
+  }
+}
+BENCHMARK(BM_log_sync);
+
+static void BM_log_async(benchmark::State& state) {
+  SetupSink();
+  LOG_SET_LEVEL("info");
+  ft::Logger::Instance().StartAsync();
+  int64_t order_id = 0;
+  for (auto _ : state) {
+    LogOrder(order_id++);
+  }
+  ft::Logger::Instance().StopAsync();
+}
+BENCHMARK(BM_log_async);
+
+static void BM_log_filtered(benchmark::State& state) {
+  SetupSink();
+  LOG_SET_LEVEL("warn");
+  int64_t order_id = 0;
+  for (auto _ : state) {
+    LogOrder(order_id++);
+  }
+}
+BENCHMARK(BM_log_filtered);
+
+BENCHMARK_MAIN();
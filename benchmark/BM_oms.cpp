@@ -0,0 +1,112 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 通过stub gateway驱动OMS，每个循环包含一次完整的订单生命周期：
+// 下单 -> 接受 -> 部分成交 -> 撤单 -> 撤单回报
+// 统计的是策略视角下单个循环的耗时。OMS初始化时需要连接TraderDB(redis)
+//
+// Usage: BM_oms [--contracts=<file>] [--trader_db=<address>] [--loop=<n>]
+
+#include <algorithm>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ft/base/config.h"
+#include "ft/base/log.h"
+#include "ft/base/trade_msg.h"
+#include "ft/component/yijinjing/journal/JournalReader.h"
+#include "ft/component/yijinjing/journal/Timer.h"
+#include "ft/strategy/order_sender.h"
+#include "ft/utils/getopt.hpp"
+#include "trader/oms.h"
+
+static uint64_t NowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_nsec + ts.tv_sec * 1000000000UL;
+}
+
+static const ft::OrderResponse* WaitRsp(const yijinjing::JournalReaderPtr& reader) {
+  yijinjing::Frame frame(nullptr);
+  while (!reader->getNextFrame(&frame)) {
+  }
+  static ft::OrderResponse rsp;
+  rsp = *reinterpret_cast<ft::OrderResponse*>(frame.getData());
+  return &rsp;
+}
+
+int main() {
+  std::string contract_file = getarg("../config/contracts.csv", "--contracts");
+  std::string trader_db_address = getarg("127.0.0.1:6379", "--trader_db");
+  uint64_t loop_times = getarg(1000000UL, "--loop");
+
+  LOG_SET_LEVEL("error");
+
+  ft::FlareTraderConfig config{};
+  config.global_config.contract_file = contract_file;
+  config.global_config.trader_db_address = trader_db_address;
+  config.gateway_config.api = "stub";
+  config.gateway_config.extended_args["fill_mode"] = "partial";
+  config.rms_config.risk_conf_list.emplace_back(ft::RiskConfig{"ft.risk.position", {}});
+  config.rms_config.risk_conf_list.emplace_back(ft::RiskConfig{"ft.risk.self_trade", {}});
+
+  ft::StrategyConfig strategy_conf{};
+  strategy_conf.strategy_name = "BM_oms";
+  strategy_conf.trade_mq_name = "BM_oms_trade_mq";
+  strategy_conf.rsp_mq_name = "BM_oms_rsp_mq";
+  strategy_conf.md_mq_name = "BM_oms_md_mq";
+  config.strategy_config_list.emplace_back(strategy_conf);
+
+  auto oms = std::make_unique<ft::OrderManagementSystem>();
+  if (!oms->Init(config)) {
+    printf("failed to init oms\n");
+    exit(EXIT_FAILURE);
+  }
+  std::thread oms_thread([&] { oms->Run(); });
+  oms_thread.detach();
+
+  auto rsp_reader = yijinjing::JournalReader::create(".", strategy_conf.rsp_mq_name,
+                                                     yijinjing::getNanoTime(), "BM_oms_reader");
+  ft::OrderSender sender;
+  sender.Init(strategy_conf.trade_mq_name);
+  sender.SetStrategyId(strategy_conf.strategy_name);
+
+  std::vector<uint64_t> time_cost;
+  time_cost.reserve(loop_times);
+  const ft::OrderResponse* rsp;
+  for (uint64_t i = 0; i < loop_times; ++i) {
+    auto start = NowNs();
+    sender.BuyOpen(1, 2, 100.0, ft::OrderType::kLimit, static_cast<uint32_t>(i));
+
+    rsp = WaitRsp(rsp_reader);  // accepted
+    if (rsp->error_code != ft::ErrorCode::kNoError) {
+      printf("order rejected: %s\n", ft::ErrorCodeStr(rsp->error_code));
+      exit(EXIT_FAILURE);
+    }
+    WaitRsp(rsp_reader);  // traded
+    sender.CancelOrder(rsp->order_id);
+    rsp = WaitRsp(rsp_reader);  // canceled
+    if (!rsp->completed) {
+      printf("unexpected order status\n");
+      exit(EXIT_FAILURE);
+    }
+    time_cost.emplace_back(NowNs() - start);
+  }
+
+  std::sort(time_cost.begin(), time_cost.end());
+
+  uint64_t sum = 0;
+  for (auto v : time_cost) {
+    sum += v;
+  }
+  printf("send/fill/cancel cycles:%lu\n", loop_times);
+  printf("mean:%lu, min:%lu, 25th:%lu, 50th:%lu 75th:%lu 99th:%lu max:%lu\n", sum / loop_times,
+         time_cost[0], time_cost[time_cost.size() / 4], time_cost[time_cost.size() / 2],
+         time_cost[time_cost.size() * 3 / 4], time_cost[time_cost.size() * 99 / 100],
+         *time_cost.rbegin());
+
+  int res = system("rm -f yjj.BM_oms_* ft_notifier.oms. ft_notifier.strategy.BM_oms");
+  (void)res;
+  exit(EXIT_SUCCESS);
+}
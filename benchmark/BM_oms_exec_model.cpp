@@ -0,0 +1,289 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 对比OMS新旧两种执行模型在回报突发时的延迟分布
+// 策略每轮连续发出burst个订单，stub gateway在SendOrder中同步产生接受及部分成交回报，
+// 收齐后再连续撤掉这些订单，每个订单共产生3条回报(接受、部分成交、撤单)，
+// 回报在短时间内集中进入OMS。统计每条回报从策略发出对应指令到策略收到该回报的时间
+//
+// OMS以进程内模式运行，不需要TraderDB(redis)及journal，策略线程与核心线程之间
+// 通过SPSC队列传递指令及回报。两种模型调用的是同一套OMS指令及回报处理逻辑，
+// 区别只在核心线程的调度方式：
+//   legacy: 旧模型。每个循环先处理完所有待处理的指令，再处理至多3条回报，
+//           指令及回报的处理都在SpinLock保护下进行(此处锁无竞争，只计入加解锁的开销)
+//   batch:  当前模型。每个循环至多处理oms_batch_size条指令及oms_batch_size条回报，无锁
+//
+// Usage: BM_oms_exec_model [--contracts=<file>] [--model=<all|legacy|batch>] [--burst=<n>]
+//                          [--rounds=<n>] [--batch=<n>] [--yield]
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ft/base/config.h"
+#include "ft/base/log.h"
+#include "ft/base/trade_msg.h"
+#include "ft/utils/getopt.hpp"
+#include "ft/utils/ring_buffer.h"
+#include "ft/utils/spinlock.h"
+#include "trader/gateway/stub/stub_gateway.h"
+#include "trader/oms.h"
+
+static uint64_t NowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_nsec + ts.tv_sec * 1000000000UL;
+}
+
+// 核数少于2时需设置--yield，否则自旋等待会与另一线程争抢CPU
+static bool yield_on_wait = false;
+
+static void Pause() {
+  if (yield_on_wait) {
+    std::this_thread::yield();
+  }
+}
+
+using CmdRB = ft::RingBuffer<ft::TraderCommand, 4096>;
+using RspRB = ft::RingBuffer<ft::OrderResponse, 4096>;
+
+class RspCollector : public ft::OmsInProcessListener {
+ public:
+  explicit RspCollector(RspRB* rsp_rb) : rsp_rb_(rsp_rb) {}
+
+  void OnTick(uint32_t, const ft::TickData&) override {}
+
+  void OnOrderResponse(uint32_t, const ft::OrderResponse& rsp) override {
+    rsp_rb_->PutWithBlocking(rsp);
+  }
+
+ private:
+  RspRB* rsp_rb_;
+};
+
+// 旧模型：先处理完所有指令，每个循环至多处理3条回报，处理时持有锁
+static void RunLegacy(ft::OrderManagementSystem* oms, ft::Gateway* gateway, CmdRB* cmd_rb,
+                      const std::atomic<bool>* running) {
+  ft::SpinLock spinlock;
+  auto* rsp_rb = gateway->GetOrderRspRB();
+  ft::TraderCommand cmd;
+  ft::GatewayOrderResponse rsp;
+  while (running->load(std::memory_order_relaxed)) {
+    bool busy = false;
+    while (cmd_rb->Get(&cmd)) {
+      busy = true;
+      std::unique_lock<ft::SpinLock> lock(spinlock);
+      oms->ExecuteCmd(cmd, 0);
+    }
+    for (int count = 0; count < 3 && rsp_rb->Get(&rsp); ++count) {
+      busy = true;
+      std::unique_lock<ft::SpinLock> lock(spinlock);
+      std::visit(*oms, rsp.data);
+    }
+    if (!busy) {
+      Pause();
+    }
+  }
+}
+
+// 当前模型：指令及回报各自批量处理，单线程独占状态，无锁
+static void RunBatch(ft::OrderManagementSystem* oms, ft::Gateway* gateway, CmdRB* cmd_rb,
+                     const std::atomic<bool>* running, int batch_size) {
+  auto* rsp_rb = gateway->GetOrderRspRB();
+  ft::TraderCommand cmd;
+  ft::GatewayOrderResponse rsp;
+  while (running->load(std::memory_order_relaxed)) {
+    bool busy = false;
+    for (int count = 0; count < batch_size && cmd_rb->Get(&cmd); ++count) {
+      busy = true;
+      oms->ExecuteCmd(cmd, 0);
+    }
+    for (int count = 0; count < batch_size && rsp_rb->Get(&rsp); ++count) {
+      busy = true;
+      std::visit(*oms, rsp.data);
+    }
+    if (!busy) {
+      Pause();
+    }
+  }
+}
+
+static void PrintHistogram(const char* name, std::vector<uint64_t>* latency) {
+  if (latency->empty()) {
+    return;
+  }
+  auto& v = *latency;
+  std::sort(v.begin(), v.end());
+  auto pct = [&](double p) { return v[static_cast<std::size_t>(p * (v.size() - 1))]; };
+  printf("%s: count:%lu 50th:%lu 90th:%lu 99th:%lu 99.9th:%lu max:%lu (ns)\n", name, v.size(),
+         pct(0.5), pct(0.9), pct(0.99), pct(0.999), v.back());
+
+  // 以2的幂划分区间
+  uint64_t upper = 1024;
+  std::size_t i = 0;
+  while (i < v.size()) {
+    std::size_t cnt = 0;
+    while (i < v.size() && v[i] < upper) {
+      ++cnt;
+      ++i;
+    }
+    if (cnt > 0) {
+      printf("  < %10lu ns: %8lu %6.2f%%\n", upper, cnt, 100.0 * cnt / v.size());
+    }
+    upper <<= 1;
+  }
+}
+
+static ft::OrderResponse WaitRsp(RspRB* rsp_rb) {
+  ft::OrderResponse rsp;
+  while (!rsp_rb->Get(&rsp)) {
+    Pause();
+  }
+  return rsp;
+}
+
+static void RunModel(const std::string& model, const ft::FlareTraderConfig& config,
+                     uint32_t burst, uint32_t rounds) {
+  CmdRB cmd_rb;
+  RspRB rsp_rb;
+  RspCollector collector(&rsp_rb);
+
+  auto gateway = std::make_shared<ft::StubGateway>();
+  auto oms = std::make_unique<ft::OrderManagementSystem>();
+  oms->SetGateway(gateway);
+  if (!oms->Init(config, &collector)) {
+    printf("failed to init oms\n");
+    exit(EXIT_FAILURE);
+  }
+
+  std::atomic<bool> running = true;
+  std::thread core_thread([&] {
+    if (model == "legacy") {
+      RunLegacy(oms.get(), gateway.get(), &cmd_rb, &running);
+    } else {
+      RunBatch(oms.get(), gateway.get(), &cmd_rb, &running, config.global_config.oms_batch_size);
+    }
+  });
+
+  ft::TraderCommand order_cmd{};
+  order_cmd.magic = ft::kTradingCmdMagic;
+  order_cmd.type = ft::TraderCmdType::kNewOrder;
+  strncpy(order_cmd.strategy_id, config.strategy_config_list[0].strategy_name.c_str(),
+          sizeof(order_cmd.strategy_id) - 1);
+  order_cmd.order_req.ticker_id = 1;
+  order_cmd.order_req.volume = 2;
+  order_cmd.order_req.direction = ft::Direction::kBuy;
+  order_cmd.order_req.offset = ft::Offset::kOpen;
+  order_cmd.order_req.type = ft::OrderType::kLimit;
+  order_cmd.order_req.price = 100.0;
+
+  ft::TraderCommand cancel_cmd{};
+  cancel_cmd.magic = ft::kTradingCmdMagic;
+  cancel_cmd.type = ft::TraderCmdType::kCancelOrder;
+
+  // 以client_order_id为下标记录对应指令的发出时间
+  std::vector<uint64_t> send_ts(burst);
+  std::vector<uint64_t> order_ids(burst);
+  std::vector<uint64_t> accepted_latency;
+  std::vector<uint64_t> traded_latency;
+  std::vector<uint64_t> canceled_latency;
+  accepted_latency.reserve(static_cast<std::size_t>(burst) * rounds);
+  traded_latency.reserve(static_cast<std::size_t>(burst) * rounds);
+  canceled_latency.reserve(static_cast<std::size_t>(burst) * rounds);
+
+  auto start_ns = NowNs();
+  for (uint32_t round = 0; round < rounds; ++round) {
+    for (uint32_t i = 0; i < burst; ++i) {
+      send_ts[i] = NowNs();
+      order_cmd.order_req.client_order_id = i;
+      cmd_rb.PutWithBlocking(order_cmd);
+    }
+    for (uint32_t n = 0; n < burst * 2; ++n) {
+      auto rsp = WaitRsp(&rsp_rb);
+      auto now = NowNs();
+      if (rsp.error_code != ft::ErrorCode::kNoError) {
+        printf("order rejected: %s\n", ft::ErrorCodeStr(rsp.error_code));
+        exit(EXIT_FAILURE);
+      }
+      if (rsp.this_traded > 0) {
+        traded_latency.emplace_back(now - send_ts[rsp.client_order_id]);
+      } else {
+        accepted_latency.emplace_back(now - send_ts[rsp.client_order_id]);
+        order_ids[rsp.client_order_id] = rsp.order_id;
+      }
+    }
+
+    for (uint32_t i = 0; i < burst; ++i) {
+      send_ts[i] = NowNs();
+      cancel_cmd.cancel_req.order_id = order_ids[i];
+      cmd_rb.PutWithBlocking(cancel_cmd);
+    }
+    for (uint32_t n = 0; n < burst; ++n) {
+      auto rsp = WaitRsp(&rsp_rb);
+      auto now = NowNs();
+      if (!rsp.completed) {
+        printf("unexpected order status\n");
+        exit(EXIT_FAILURE);
+      }
+      canceled_latency.emplace_back(now - send_ts[rsp.client_order_id]);
+    }
+  }
+  auto elapsed_ns = NowNs() - start_ns;
+
+  running = false;
+  core_thread.join();
+  gateway->Logout();
+
+  printf("model:%s burst:%u rounds:%u elapsed:%lums\n", model.c_str(), burst, rounds,
+         elapsed_ns / 1000000);
+  PrintHistogram("accepted", &accepted_latency);
+  PrintHistogram("traded", &traded_latency);
+  PrintHistogram("canceled", &canceled_latency);
+}
+
+int main() {
+  std::string contract_file = getarg("../config/contracts.csv", "--contracts");
+  std::string model = getarg("all", "--model");
+  uint32_t burst = getarg(64U, "--burst");
+  uint32_t rounds = getarg(2000U, "--rounds");
+  int batch_size = getarg(64, "--batch");
+  yield_on_wait = getarg(false, "--yield");
+
+  if (model != "all" && model != "legacy" && model != "batch") {
+    printf("unknown model: %s\n", model.c_str());
+    exit(EXIT_FAILURE);
+  }
+  // stub gateway在核心线程中同步产生回报，回报队列容量为1024，
+  // 旧模型先处理完所有指令，burst过大时核心线程会阻塞在回报队列上
+  if (burst == 0 || burst > 512) {
+    printf("burst should be in [1, 512]\n");
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_SET_LEVEL("error");
+
+  ft::FlareTraderConfig config{};
+  config.global_config.contract_file = contract_file;
+  config.global_config.oms_batch_size = batch_size;
+  config.gateway_config.api = "stub";
+  config.gateway_config.extended_args["fill_mode"] = "partial";
+  config.rms_config.risk_conf_list.emplace_back(ft::RiskConfig{"ft.risk.position", {}});
+  config.rms_config.risk_conf_list.emplace_back(ft::RiskConfig{"ft.risk.self_trade", {}});
+
+  ft::StrategyConfig strategy_conf{};
+  strategy_conf.strategy_name = "BM_oms_exec";
+  config.strategy_config_list.emplace_back(strategy_conf);
+
+  if (model == "all" || model == "legacy") {
+    RunModel("legacy", config, burst, rounds);
+  }
+  if (model == "all" || model == "batch") {
+    RunModel("batch", config, burst, rounds);
+  }
+  exit(EXIT_SUCCESS);
+}
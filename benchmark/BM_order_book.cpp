@@ -0,0 +1,125 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 用合成的逐笔委托流回放orderbook::OrderBook，统计每秒处理的消息数
+// 委托价格围绕随机游走的中间价按几何分布生成，撤单及成交随机选择存活的委托，
+// 存活委托数超过--live时只撤单不报单。每条消息处理后调用一次to_tick
+//
+// Usage: BM_order_book [--msgs=<n>] [--live=<n>] [--rounds=<n>]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "ft/component/order_book/order_book.h"
+#include "ft/utils/getopt.hpp"
+
+using ft::orderbook::LimitOrder;
+using ft::orderbook::OrderBook;
+
+enum class MsgType : uint8_t { kAdd, kCancel, kExecute };
+
+struct Msg {
+  MsgType type;
+  bool is_buy;
+  int volume;
+  double price;
+  uint64_t order_id;
+};
+
+static constexpr double kPriceTick = 0.01;
+
+static std::vector<Msg> GenerateFlow(uint64_t msg_num, std::size_t max_live) {
+  struct Live {
+    uint64_t order_id;
+    int volume;
+  };
+
+  std::mt19937_64 rng(20210501);
+  std::geometric_distribution<int> distance(0.2);
+  std::vector<Msg> msgs;
+  std::vector<Live> live;
+  msgs.reserve(msg_num);
+  uint64_t next_id = 0;
+  int64_t mid = 1000;  // 以price_tick为单位
+
+  for (uint64_t i = 0; i < msg_num; ++i) {
+    if (rng() % 128 == 0) {
+      mid += rng() % 2 ? 1 : -1;
+    }
+
+    auto r = rng() % 100;
+    if (live.empty() || (r < 50 && live.size() < max_live)) {
+      bool is_buy = rng() % 2;
+      int64_t tick_price = is_buy ? mid - 1 - distance(rng) : mid + 1 + distance(rng);
+      int volume = static_cast<int>(rng() % 10 + 1) * 100;
+      msgs.emplace_back(Msg{MsgType::kAdd, is_buy, volume, tick_price * kPriceTick, ++next_id});
+      live.emplace_back(Live{next_id, volume});
+      continue;
+    }
+
+    auto idx = rng() % live.size();
+    auto& order = live[idx];
+    if (r < 85) {
+      msgs.emplace_back(Msg{MsgType::kCancel, false, 0, 0.0, order.order_id});
+      order.volume = 0;
+    } else {
+      int volume = std::min(order.volume, static_cast<int>(rng() % 10 + 1) * 100);
+      msgs.emplace_back(Msg{MsgType::kExecute, false, volume, 0.0, order.order_id});
+      order.volume -= volume;
+    }
+    if (order.volume == 0) {
+      order = live.back();
+      live.pop_back();
+    }
+  }
+  return msgs;
+}
+
+int main() {
+  uint64_t msg_num = getarg(2000000UL, "--msgs");
+  std::size_t max_live = getarg(20000UL, "--live");
+  int rounds = getarg(5, "--rounds");
+
+  auto msgs = GenerateFlow(msg_num, max_live);
+  uint64_t add_num = std::count_if(msgs.begin(), msgs.end(),
+                                   [](auto& msg) { return msg.type == MsgType::kAdd; });
+  printf("msgs:%lu add:%lu cancel/execute:%lu\n", msg_num, add_num, msg_num - add_num);
+
+  for (int round = 0; round < rounds; ++round) {
+    OrderBook order_book(1, kPriceTick);
+    ft::TickData tick{};
+    double checksum = 0;
+    LimitOrder order;
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto& msg : msgs) {
+      switch (msg.type) {
+        case MsgType::kAdd: {
+          order.set_id(msg.order_id);
+          order.set_direction(msg.is_buy);
+          order.set_volume(msg.volume);
+          order.set_price(msg.price);
+          order_book.AddOrder(&order);
+          break;
+        }
+        case MsgType::kCancel: {
+          order_book.CancelOrder(msg.order_id);
+          break;
+        }
+        case MsgType::kExecute: {
+          order_book.ExecuteOrder(msg.order_id, msg.volume);
+          break;
+        }
+      }
+      order_book.to_tick(&tick);
+      checksum += tick.bid_volume[0];
+    }
+    double sec =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("round:%d %.3fs %.0f msgs/s %.1f ns/msg live:%lu checksum:%.0f\n", round, sec,
+           msg_num / sec, sec * 1e9 / msg_num, order_book.size(), checksum);
+  }
+  return 0;
+}
@@ -0,0 +1,73 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 从共享内存持仓缓存读取持仓的耗时，对比TraderDB::GetPosition的redis往返
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "ft/base/contract_table.h"
+#include "ft/component/position_cache.h"
+
+static bool InitContractTable() {
+  std::vector<ft::Contract> contracts(1024);
+  for (std::size_t i = 0; i < contracts.size(); ++i) {
+    contracts[i].ticker = "ticker" + std::to_string(i);
+  }
+  return ft::ContractTable::Init(std::move(contracts));
+}
+
+static void BM_position_cache_get_by_ticker(benchmark::State& state) {
+  InitContractTable();
+  ft::PositionCache writer;
+  writer.Create("BM_position_cache", {"common", "s1", "s2", "s3"}, 1024);
+  ft::Position pos{};
+  pos.ticker_id = 1;
+  writer.SetPosition("s3", pos);
+
+  ft::PositionCache reader;
+  reader.Open("BM_position_cache");
+  std::string ticker = "ticker0";
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(reader.GetPosition("s3", ticker, &pos));
+  }
+  int res = system("rm -f ft_position_cache.BM_position_cache");
+  (void)res;
+}
+
+static void BM_position_cache_get_by_id(benchmark::State& state) {
+  ft::PositionCache writer;
+  writer.Create("BM_position_cache", {"common", "s1", "s2", "s3"}, 1024);
+  ft::Position pos{};
+  pos.ticker_id = 1;
+  writer.SetPosition("s3", pos);
+
+  ft::PositionCache reader;
+  reader.Open("BM_position_cache");
+  uint32_t strategy_idx = 0;
+  reader.FindStrategy("s3", &strategy_idx);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(reader.GetPosition(strategy_idx, 1, &pos));
+  }
+  int res = system("rm -f ft_position_cache.BM_position_cache");
+  (void)res;
+}
+
+static void BM_position_cache_set(benchmark::State& state) {
+  ft::PositionCache writer;
+  writer.Create("BM_position_cache", {"common", "s1", "s2", "s3"}, 1024);
+  ft::Position pos{};
+  pos.ticker_id = 1;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(writer.SetPosition("s3", pos));
+  }
+  int res = system("rm -f ft_position_cache.BM_position_cache");
+  (void)res;
+}
+
+BENCHMARK(BM_position_cache_get_by_ticker);
+BENCHMARK(BM_position_cache_get_by_id);
+BENCHMARK(BM_position_cache_set);
+
+BENCHMARK_MAIN();
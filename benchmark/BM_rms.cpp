@@ -0,0 +1,157 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// RMS每个订单的风控耗时，参数为规则数量(4个内置规则重复若干次)
+// BM_rms_check: 下单前的检查
+// BM_rms_order: 一个完整的订单生命周期: 检查 -> 发出 -> 接受 -> 撤单 -> 完成
+// BM_rms_*_list: 作为对比，按原先的方式遍历std::list，每个回调都通过虚函数调用
+
+#include <benchmark/benchmark.h>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "trader/risk/rms.h"
+
+static const char* kRuleNames[] = {"ft.risk.fund", "ft.risk.position", "ft.risk.self_trade",
+                                   "ft.risk.throttle_rate"};
+
+struct RmsFixture {
+  ft::FlareTraderConfig config{};
+  ft::Account account{};
+  ft::PositionManager pos_manager;
+  ft::OrderMap order_map;
+  ft::StrategyTable strategy_table;
+  ft::RiskRuleParams params{};
+  ft::Order order{};
+
+  explicit RmsFixture(int64_t rule_num) {
+    LOG_SET_LEVEL("error");
+    if (!ft::ContractTable::is_inited()) {
+      ft::Contract contract{};
+      contract.ticker = "rb2105";
+      contract.exchange = "SHFE";
+      contract.size = 10;
+      contract.long_margin_rate = 0.1;
+      contract.short_margin_rate = 0.1;
+      std::vector<ft::Contract> contracts{contract};
+      ft::ContractTable::Init(std::move(contracts));
+    }
+
+    for (int64_t i = 0; i < rule_num; ++i) {
+      ft::RiskConfig risk_conf{kRuleNames[i % 4], {}};
+      if (risk_conf.name == "ft.risk.throttle_rate") {
+        risk_conf.options["order_limit"] = "100000";
+        risk_conf.options["period_ms"] = "1";
+      }
+      config.rms_config.risk_conf_list.emplace_back(risk_conf);
+    }
+    pos_manager.Init(config, nullptr);
+    strategy_table.Intern("BM_rms");
+
+    account.cash = 1e15;
+    params.config = &config.rms_config;
+    params.account = &account;
+    params.pos_manager = &pos_manager;
+    params.order_map = &order_map;
+    params.strategy_table = &strategy_table;
+
+    order.req.order_id = 1;
+    order.req.contract = ft::ContractTable::get_by_index(1);
+    order.req.type = ft::OrderType::kLimit;
+    order.req.direction = ft::Direction::kBuy;
+    order.req.offset = ft::Offset::kOpen;
+    order.req.price = 4000.0;
+    order.req.volume = 1;
+    order.strategy_id = 0;
+  }
+};
+
+static void InitRms(RmsFixture* fixture, ft::RiskManagementSystem* rms) {
+  for (auto& risk_conf : fixture->config.rms_config.risk_conf_list) {
+    rms->AddRule(risk_conf.name);
+  }
+  rms->Init(&fixture->params);
+}
+
+static void InitList(RmsFixture* fixture, std::list<std::shared_ptr<ft::RiskRule>>* rules) {
+  uint32_t id = 0;
+  for (auto& risk_conf : fixture->config.rms_config.risk_conf_list) {
+    auto rule = ft::CreateRiskRule(risk_conf.name);
+    rule->SetId(id++);
+    rule->Init(&fixture->params);
+    rules->emplace_back(rule);
+  }
+}
+
+static void BM_rms_check(benchmark::State& state) {
+  RmsFixture fixture(state.range(0));
+  ft::RiskManagementSystem rms;
+  InitRms(&fixture, &rms);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rms.CheckOrderRequest(fixture.order));
+  }
+}
+BENCHMARK(BM_rms_check)->Arg(4)->Arg(12);
+
+static void BM_rms_check_list(benchmark::State& state) {
+  RmsFixture fixture(state.range(0));
+  std::list<std::shared_ptr<ft::RiskRule>> rules;
+  InitList(&fixture, &rules);
+  for (auto _ : state) {
+    ft::ErrorCode error_code = ft::ErrorCode::kNoError;
+    for (auto& rule : rules) {
+      error_code = rule->CheckOrderRequest(fixture.order);
+      if (error_code != ft::ErrorCode::kNoError) {
+        break;
+      }
+    }
+    benchmark::DoNotOptimize(error_code);
+  }
+}
+BENCHMARK(BM_rms_check_list)->Arg(4)->Arg(12);
+
+static void BM_rms_order(benchmark::State& state) {
+  RmsFixture fixture(state.range(0));
+  ft::RiskManagementSystem rms;
+  InitRms(&fixture, &rms);
+  auto& order = fixture.order;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rms.CheckOrderRequest(order));
+    rms.OnOrderSent(order);
+    rms.OnOrderAccepted(order);
+    rms.OnOrderCanceled(order, order.req.volume);
+    rms.OnOrderCompleted(order);
+  }
+}
+BENCHMARK(BM_rms_order)->Arg(4)->Arg(12);
+
+static void BM_rms_order_list(benchmark::State& state) {
+  RmsFixture fixture(state.range(0));
+  std::list<std::shared_ptr<ft::RiskRule>> rules;
+  InitList(&fixture, &rules);
+  auto& order = fixture.order;
+  for (auto _ : state) {
+    for (auto& rule : rules) {
+      benchmark::DoNotOptimize(rule->CheckOrderRequest(order));
+    }
+    for (auto& rule : rules) {
+      rule->OnOrderSent(order);
+    }
+    for (auto& rule : rules) {
+      rule->OnOrderAccepted(order);
+    }
+    for (auto& rule : rules) {
+      rule->OnOrderCanceled(order, order.req.volume);
+    }
+    for (auto& rule : rules) {
+      rule->OnOrderCompleted(order);
+    }
+  }
+}
+BENCHMARK(BM_rms_order_list)->Arg(4)->Arg(12);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,96 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 自成交检查的耗时与挂单数量的关系
+// BM_self_trade_risk为基于OrderMap挂单索引的实现，BM_self_trade_scan为遍历所有挂单的实现
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "trader/order_map.h"
+#include "trader/risk/common/self_trade_risk.h"
+
+constexpr uint32_t kTickerNum = 100;
+
+static std::vector<ft::Contract> contracts(kTickerNum + 1);
+
+// 挂单均匀分布在kTickerNum个合约上，买单价格低于卖单价格，不会触发自成交
+static void FillOrders(ft::OrderMap* order_map, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) {
+    uint32_t ticker_id = static_cast<uint32_t>(i % kTickerNum) + 1;
+    contracts[ticker_id].ticker_id = ticker_id;
+
+    ft::Order order{};
+    order.req.order_id = static_cast<uint64_t>(i) + 1;
+    order.req.contract = &contracts[ticker_id];
+    order.req.type = ft::OrderType::kLimit;
+    order.req.volume = 1;
+    if (i % 2 == 0) {
+      order.req.direction = ft::Direction::kBuy;
+      order.req.price = 100.0 - static_cast<double>(i % 10);
+    } else {
+      order.req.direction = ft::Direction::kSell;
+      order.req.price = 101.0 + static_cast<double>(i % 10);
+    }
+    order_map->emplace(order);
+  }
+}
+
+static ft::Order GenCheckOrder() {
+  ft::Order order{};
+  order.req.order_id = 0;
+  order.req.contract = &contracts[1];
+  order.req.type = ft::OrderType::kLimit;
+  order.req.direction = ft::Direction::kBuy;
+  order.req.price = 100.5;
+  order.req.volume = 1;
+  return order;
+}
+
+static void BM_self_trade_risk(benchmark::State& state) {
+  ft::OrderMap order_map;
+  FillOrders(&order_map, state.range(0));
+
+  ft::RiskRuleParams params{};
+  params.order_map = &order_map;
+  ft::SelfTradeRisk rule;
+  rule.Init(&params);
+
+  auto order = GenCheckOrder();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rule.CheckOrderRequest(order));
+  }
+}
+
+static ft::ErrorCode ScanCheck(const ft::OrderMap& order_map, const ft::Order& order) {
+  auto& req = order.req;
+  auto oppsite_direction = ft::OppositeDirection(req.direction);
+  for (auto& o : order_map) {
+    auto& pending = o.req;
+    if (pending.contract->ticker_id != req.contract->ticker_id ||
+        pending.direction != oppsite_direction) {
+      continue;
+    }
+    if (pending.price < 1e-5 || pending.type == ft::OrderType::kMarket ||
+        (req.direction == ft::Direction::kBuy && req.price > pending.price - 1e-5) ||
+        (req.direction == ft::Direction::kSell && req.price < pending.price + 1e-5)) {
+      return ft::ErrorCode::kSelfTrade;
+    }
+  }
+  return ft::ErrorCode::kNoError;
+}
+
+static void BM_self_trade_scan(benchmark::State& state) {
+  ft::OrderMap order_map;
+  FillOrders(&order_map, state.range(0));
+
+  auto order = GenCheckOrder();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ScanCheck(order_map, order));
+  }
+}
+
+BENCHMARK(BM_self_trade_risk)->RangeMultiplier(8)->Range(8, 32768);
+BENCHMARK(BM_self_trade_scan)->RangeMultiplier(8)->Range(8, 32768);
+
+BENCHMARK_MAIN();
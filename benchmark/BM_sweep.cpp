@@ -0,0 +1,147 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 统计SweepRunner在不同线程数下的耗时，检查参数扫描是否随核数近似线性扩展
+// 先生成列式tick文件并加载，之后以1, 2, 4...直到CPU核数个线程分别运行同样的参数组合
+//
+// Usage: BM_sweep [--ticks=<n>] [--param_sets=<n>] [--dir=<dir>]
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "backtest/sweep_runner.h"
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "ft/utils/getopt.hpp"
+#include "trader/gateway/backtest/data_feed/tick_file.h"
+
+static const char* kTickers[] = {"rb2105", "rb2110", "ag2106", "IF2106"};
+
+// 价格突破period个tick的均价时开仓，回落时平仓
+class BenchStrategy : public ft::Strategy {
+ public:
+  void OnInit() override {
+    period_ = std::stoi(GetParam("period", "20"));
+    prices_.resize(period_);
+  }
+
+  void OnTick(const ft::TickData& tick) override {
+    if (tick.ticker_id != 1) {
+      return;
+    }
+    sum_ += tick.last_price - prices_[count_ % period_];
+    prices_[count_ % period_] = tick.last_price;
+    if (++count_ < static_cast<uint64_t>(period_)) {
+      return;
+    }
+
+    double avg = sum_ / period_;
+    if (pos_ == 0 && tick.last_price > avg) {
+      BuyOpen(kTickers[0], 1, tick.ask[0]);
+      pos_ = 1;
+    } else if (pos_ == 1 && tick.last_price < avg) {
+      SellClose(kTickers[0], 1, tick.bid[0]);
+      pos_ = 0;
+    }
+  }
+
+ private:
+  int period_ = 0;
+  std::vector<double> prices_;
+  double sum_ = 0.0;
+  uint64_t count_ = 0;
+  int pos_ = 0;
+};
+
+static ft::StrategyRunner* CreateBenchStrategy() { return new BenchStrategy; }
+
+static bool GenerateTickFile(const std::string& file, uint64_t tick_num) {
+  ft::TickFileWriter writer;
+  if (!writer.Open(file)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < tick_num; ++i) {
+    ft::TickData tick{};
+    double price = 4000.0 + static_cast<double>((i * 7919) % 200);
+    tick.ticker_id = static_cast<uint32_t>(i % 4 + 1);
+    tick.local_timestamp_us = 1619571600000000 + i * 125;
+    tick.exchange_timestamp_us = tick.local_timestamp_us;
+    tick.last_price = price;
+    for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+      tick.ask[level] = price + level + 1;
+      tick.bid[level] = price - level - 1;
+      tick.ask_volume[level] = 100;
+      tick.bid_volume[level] = 100;
+    }
+    if (!writer.Write(tick)) {
+      return false;
+    }
+  }
+  return writer.Close();
+}
+
+int main() {
+  uint64_t tick_num = getarg(1000000UL, "--ticks");
+  uint32_t param_sets = getarg(32U, "--param_sets");
+  std::string dir = getarg(".", "--dir");
+
+  LOG_SET_LEVEL("error");
+
+  std::vector<ft::Contract> contracts;
+  for (auto* ticker : kTickers) {
+    contracts.emplace_back();
+    contracts.back().ticker = ticker;
+    contracts.back().size = 10;
+  }
+  ft::ContractTable::Init(std::move(contracts));
+
+  std::string tick_file = dir + "/BM_sweep.ftick";
+  if (!GenerateTickFile(tick_file, tick_num)) {
+    printf("failed to generate tick file\n");
+    exit(EXIT_FAILURE);
+  }
+
+  ft::FlareTraderConfig config{};
+  config.gateway_config.api = "backtest";
+  config.gateway_config.extended_args["data_feed"] = "ft.data_feed.tick_file";
+  config.gateway_config.extended_args["data_file"] = tick_file;
+  ft::StrategyConfig strategy_conf{};
+  strategy_conf.strategy_name = "BM_sweep";
+  strategy_conf.subscription_list = {kTickers[0]};
+  config.strategy_config_list.emplace_back(strategy_conf);
+  config.rms_config.risk_conf_list.push_back({"ft.risk.fund", {}});
+  config.rms_config.risk_conf_list.push_back({"ft.risk.position", {}});
+
+  ft::SweepRunner runner;
+  if (!runner.Init(config, "BM_sweep", CreateBenchStrategy)) {
+    printf("failed to init sweep runner\n");
+    exit(EXIT_FAILURE);
+  }
+  remove(tick_file.c_str());
+
+  ft::ParamGrid grid{{"period", {}}};
+  for (uint32_t i = 0; i < param_sets; ++i) {
+    grid[0].second.emplace_back(std::to_string(10 + i * 5));
+  }
+  runner.SetParamGrid(grid);
+
+  int max_threads = static_cast<int>(std::thread::hardware_concurrency());
+  double base_sec = 0.0;
+  printf("ticks:%lu param_sets:%u cores:%d\n", tick_num, param_sets, max_threads);
+  for (int threads = 1;; threads = std::min(threads * 2, max_threads)) {
+    auto start = std::chrono::steady_clock::now();
+    runner.Run(threads);
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (threads == 1) {
+      base_sec = sec;
+    }
+    printf("threads:%3d elapsed:%.3fs %.0f ticks/s speedup:%.2f\n", threads, sec,
+           static_cast<double>(tick_num) * param_sets / sec, base_sec / sec);
+    if (threads >= max_threads) {
+      break;
+    }
+  }
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,75 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 共享内存行情快照表的读写耗时
+// BM_tick_snapshot_get_contended: 另一个线程持续写入同一合约时的读取耗时
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <thread>
+
+#include "ft/component/tick_snapshot.h"
+
+static void BM_tick_snapshot_update(benchmark::State& state) {
+  ft::TickSnapshotTable table;
+  table.Create("BM_tick_snapshot", 1024);
+  ft::TickData tick{};
+  uint32_t ticker_id = 0;
+  for (auto _ : state) {
+    tick.ticker_id = ticker_id % 1024 + 1;
+    benchmark::DoNotOptimize(table.Update(tick));
+    ++ticker_id;
+  }
+  int res = system("rm -f ft_tick_snapshot.BM_tick_snapshot");
+  (void)res;
+}
+
+static void BM_tick_snapshot_get(benchmark::State& state) {
+  ft::TickSnapshotTable writer;
+  writer.Create("BM_tick_snapshot", 1024);
+  ft::TickData tick{};
+  for (uint32_t i = 1; i <= 1024; ++i) {
+    tick.ticker_id = i;
+    writer.Update(tick);
+  }
+
+  ft::TickSnapshotTable reader;
+  reader.Open("BM_tick_snapshot");
+  uint32_t ticker_id = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(reader.Get(ticker_id % 1024 + 1, &tick));
+    ++ticker_id;
+  }
+  int res = system("rm -f ft_tick_snapshot.BM_tick_snapshot");
+  (void)res;
+}
+
+static void BM_tick_snapshot_get_contended(benchmark::State& state) {
+  ft::TickSnapshotTable writer;
+  writer.Create("BM_tick_snapshot", 1);
+  std::atomic<bool> running = true;
+  std::thread writer_thread([&] {
+    ft::TickData tick{};
+    tick.ticker_id = 1;
+    while (running) {
+      writer.Update(tick);
+    }
+  });
+
+  ft::TickSnapshotTable reader;
+  reader.Open("BM_tick_snapshot");
+  ft::TickData tick{};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(reader.Get(1, &tick));
+  }
+  running = false;
+  writer_thread.join();
+  int res = system("rm -f ft_tick_snapshot.BM_tick_snapshot");
+  (void)res;
+}
+
+BENCHMARK(BM_tick_snapshot_update);
+BENCHMARK(BM_tick_snapshot_get);
+BENCHMARK(BM_tick_snapshot_get_contended);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,86 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 对比各种等待策略的唤醒延迟及消费者线程的CPU占用
+// 生产者每隔固定时间写入一条消息并通过notifier唤醒消费者，消息间隔远大于
+// spin_count次自旋的耗时，用于模拟不活跃的策略，此时除busy_spin外消费者
+// 大部分时间都处于等待状态
+//
+// Usage: BM_wait_strategy [--msg=<n>] [--interval_us=<n>] [--spin=<n>]
+
+#include <algorithm>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ft/utils/getopt.hpp"
+#include "ft/utils/ring_buffer.h"
+#include "ft/utils/wait_strategy.h"
+
+using MsgRB = ft::RingBuffer<uint64_t, 1024>;
+
+static uint64_t NowNs(clockid_t clock_id = CLOCK_MONOTONIC) {
+  timespec ts;
+  clock_gettime(clock_id, &ts);
+  return ts.tv_nsec + ts.tv_sec * 1000000000UL;
+}
+
+static void RunOnce(const std::string& name, uint64_t msg_num, uint64_t interval_us,
+                    uint32_t spin_count) {
+  ft::WaitStrategy strategy{};
+  if (!ft::ParseWaitStrategyType(name, &strategy.type)) {
+    printf("invalid wait strategy %s\n", name.c_str());
+    exit(EXIT_FAILURE);
+  }
+  strategy.spin_count = spin_count;
+
+  MsgRB rb;
+  ft::Notifier notifier;
+  if (strategy.type == ft::WaitStrategyType::kSpinEventFd) {
+    notifier.EnableEventFd();
+  }
+
+  std::vector<uint64_t> latency;
+  latency.reserve(msg_num);
+  uint64_t cpu_ns = 0;
+  uint64_t wall_ns = 0;
+
+  std::thread consumer([&] {
+    ft::Waiter waiter(strategy, &notifier);
+    auto cpu_start = NowNs(CLOCK_THREAD_CPUTIME_ID);
+    auto wall_start = NowNs();
+    uint64_t ts;
+    while (latency.size() < msg_num) {
+      if (rb.Get(&ts)) {
+        latency.emplace_back(NowNs() - ts);
+        waiter.Reset();
+      } else {
+        waiter.Wait();
+      }
+    }
+    cpu_ns = NowNs(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    wall_ns = NowNs() - wall_start;
+  });
+
+  for (uint64_t i = 0; i < msg_num; ++i) {
+    std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+    rb.PutWithBlocking(NowNs());
+    notifier.Notify();
+  }
+  consumer.join();
+
+  std::sort(latency.begin(), latency.end());
+  auto pct = [&](double p) { return latency[static_cast<std::size_t>(p * (latency.size() - 1))]; };
+  printf("%-10s latency(ns) 50th:%-8lu 90th:%-8lu 99th:%-8lu max:%-8lu cpu:%.1f%%\n", name.c_str(),
+         pct(0.5), pct(0.9), pct(0.99), latency.back(), 100.0 * cpu_ns / wall_ns);
+}
+
+int main() {
+  uint64_t msg_num = getarg(10000UL, "--msg");
+  uint64_t interval_us = getarg(100UL, "--interval_us");
+  uint32_t spin_count = getarg(1000U, "--spin");
+
+  for (auto* name : {"busy_spin", "spin_yield", "futex", "eventfd"}) {
+    RunOnce(name, msg_num, interval_us, spin_count);
+  }
+}
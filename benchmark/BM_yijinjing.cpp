@@ -24,14 +24,22 @@ void WriteThread() {
   }
 }
 
+template <bool kFrameView>
 void ReadThread() {
   std::vector<uint64_t> time_cost;
-  yijinjing::FramePtr frame;
+  yijinjing::FramePtr frame_ptr;
+  yijinjing::Frame frame(nullptr);
   for (uint64_t i = 0; i < kLoopTimes; ++i) {
-    do {
-      frame = reader->getNextFrame();
-    } while (!frame);
-    auto* tick = reinterpret_cast<ft::TickData*>(frame->getData());
+    if constexpr (kFrameView) {
+      while (!reader->getNextFrame(&frame)) {
+      }
+    } else {
+      do {
+        frame_ptr = reader->getNextFrame();
+      } while (!frame_ptr);
+      frame = *frame_ptr;
+    }
+    auto* tick = reinterpret_cast<ft::TickData*>(frame.getData());
     timespec ts;
     clock_gettime(CLOCK_MONOTONIC, &ts);
     time_cost.emplace_back(ts.tv_nsec + ts.tv_sec * 1000000000UL - tick->local_timestamp_us);
@@ -43,17 +51,19 @@ void ReadThread() {
   for (auto v : time_cost) {
     sum += v;
   }
-  printf("mean:%lu, min:%lu, 25th:%lu, 50th:%lu 75th:%lu max:%lu\n", sum / kLoopTimes, time_cost[0],
+  printf("%s mean:%lu, min:%lu, 25th:%lu, 50th:%lu 75th:%lu max:%lu\n",
+         kFrameView ? "[frame view]" : "[frame ptr] ", sum / kLoopTimes, time_cost[0],
          time_cost[time_cost.size() / 4], time_cost[time_cost.size() / 2],
          time_cost[time_cost.size() * 3 / 4], *time_cost.rbegin());
 }
 
-int main() {
+template <bool kFrameView>
+void RunOnce() {
   writer = yijinjing::JournalWriter::create(".", "BM_yijinjing", "writer");
   reader =
       yijinjing::JournalReader::create(".", "BM_yijinjing", yijinjing::getNanoTime(), "reader");
 
-  std::thread rd_thread(ReadThread);
+  std::thread rd_thread(ReadThread<kFrameView>);
   std::this_thread::sleep_for(std::chrono::milliseconds(100));
   std::thread wr_thread(WriteThread);
 
@@ -63,3 +73,8 @@ int main() {
   int res = system("rm -f yjj.BM_yijinjing.*");
   (void)res;
 }
+
+int main() {
+  RunOnce<false>();
+  RunOnce<true>();
+}
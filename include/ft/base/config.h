@@ -12,10 +12,41 @@ namespace ft {
 struct GlobalConfig {
   std::string contract_file;
   std::string trader_db_address;
+
+  // OMS核心线程及行情分发线程绑定的CPU核，小于0表示不绑定
+  int oms_cpu_affinity = -1;
+  int md_cpu_affinity = -1;
+  // OMS核心线程每轮从每个消息源最多处理的消息数量
+  int oms_batch_size = 64;
+  // OMS核心线程、行情分发线程及策略在没有新消息时的等待方式
+  // busy_spin/spin_yield/futex/eventfd，默认busy_spin
+  std::string wait_strategy = "busy_spin";
+  int wait_spin_count = 1000;  // 进入阻塞等待前的自旋次数
+  int wait_timeout_us = 1000;  // 阻塞等待的超时时间
+
+  // 订单类journal(trade_mq/rsp_mq)及行情journal(md_mq)新建页的大小，单位MB，1~1024
+  int order_mq_page_size_mb = 128;
+  int md_mq_page_size_mb = 128;
+  // 在后台预先创建、预热并锁定下一页，避免换页时在写入路径上产生缺页中断
+  bool journal_preallocate = false;
+  // 行情journal使用大页，页大小需为2MB的倍数，journal目录需位于支持大页的tmpfs或hugetlbfs
+  // 不依赖journal_preallocate
+  bool md_mq_huge_page = false;
+
+  // OMS行情线程把每个合约的最新行情写入共享内存快照表，策略可以通过GetLatestTick读取
+  bool tick_snapshot = false;
+  // OMS把各策略的持仓及账户资金写入共享内存，策略查询持仓时直接读取本地内存，不再访问redis
+  bool position_cache = false;
+  // 统计热路径各阶段的延迟，OMS及策略各线程定期导出到共享内存
+  bool latency_stats = true;
+  // 日志模式: sync(同步输出)、async(后台线程格式化输出)、binary(后台线程写入二进制文件)
+  std::string log_mode = "sync";
 };
 
 struct GatewayConfig {
   std::string api;
+  // OMS单独接入行情所用的gateway，如market，为空时行情与交易使用同一个gateway
+  std::string md_api;
   std::string trade_server_address;
   std::string quote_server_address;
   std::string broker_id;
@@ -44,6 +75,30 @@ struct StrategyConfig {
   std::string rsp_mq_name;
   std::string md_mq_name;
   std::vector<std::string> subscription_list;
+  std::string wait_strategy;  // 为空时使用global中的wait_strategy
+  // 合并行情，每个合约只保留最新的tick，策略处理不过来时不会处理过期的行情
+  // 开启后行情不再写入md_mq，而是写入./ft_conflated_md.<strategy_name>
+  bool conflate_md = false;
+  // 选填。策略参数，参数扫描(ft_sweep)时按参数网格覆盖
+  std::map<std::string, std::string> params;
+};
+
+// 行情服务ft_market的配置
+struct MarketConfig {
+  // 每个交易所的行情写入./yjj.<md_journal_prefix>.<exchange>
+  std::string md_journal_prefix;
+
+  // 行情来源为空时通过gateway接入行情，为udp/tcp时接收其他ft_market转发的行情
+  std::string upstream;
+  std::string upstream_address;
+  int upstream_port;
+
+  // 转发方式，为空时不转发，udp时发往组播或单播地址，tcp时在publish_address上监听
+  std::string publish;
+  std::string publish_address;
+  int publish_port;
+  // 收发组播所用的本机网卡地址，为空时由系统选择
+  std::string multicast_interface;
 };
 
 struct FlareTraderConfig {
@@ -53,6 +108,7 @@ struct FlareTraderConfig {
   GatewayConfig gateway_config;
   RmsConfig rms_config;
   std::vector<StrategyConfig> strategy_config_list;
+  MarketConfig market_config;
 };
 
 }  // namespace ft
@@ -19,6 +19,8 @@ enum class ErrorCode : int {
   kPositionNotEnough,
   kFundNotEnough,
   kExceedThrottleRateRisk,
+  kExceedCancelLimit,
+  kExceedOrderTradeRatio,
 
   kSendFailed,
 
@@ -42,6 +44,12 @@ inline const char* ErrorCodeStr(ErrorCode error_code) {
     case ErrorCode::kExceedThrottleRateRisk: {
       return "ExceedThrottleRateRisk";
     }
+    case ErrorCode::kExceedCancelLimit: {
+      return "ExceedCancelLimit";
+    }
+    case ErrorCode::kExceedOrderTradeRatio: {
+      return "ExceedOrderTradeRatio";
+    }
     case ErrorCode::kSendFailed: {
       return "SendFailed";
     }
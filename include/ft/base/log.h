@@ -3,12 +3,204 @@
 #ifndef FT_INCLUDE_FT_BASE_LOG_H_
 #define FT_INCLUDE_FT_BASE_LOG_H_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 
 #include "spdlog/spdlog.h"
 
 namespace ft {
 
+struct GlobalConfig;
+
+// LOG_*宏为每个调用点生成一个静态的LogSite，异步模式下记录中只保存调用点的id及参数
+struct LogSite {
+  const char* file;
+  int line;
+  std::atomic<uint32_t> id{0};
+};
+
+namespace log_detail {
+
+// 异步日志记录的参数编码: 1字节类型 + 值，字符串为4字节长度 + 内容
+enum LogArgType : uint8_t {
+  kLogInt = 1,
+  kLogUInt,
+  kLogFloat,
+  kLogDouble,
+  kLogBool,
+  kLogChar,
+  kLogString,
+  kLogPointer,
+};
+
+// 超过的部分被截断
+constexpr uint32_t kMaxLogStringLen = 4096;
+
+// size为记录头及参数的实际长度，记录在队列中按8字节对齐，site_id为0表示队列末尾的填充
+struct LogRecordHeader {
+  uint32_t size;
+  uint32_t site_id;
+  int64_t timestamp_ns;
+};
+
+// 调用点id为[1, 8)的记录只有一个已格式化的字符串参数，id - 1为日志级别，
+// 用于格式串不是字面量的调用点，其他调用点的id从8开始分配
+constexpr uint32_t kPreformattedSiteId = 1;
+constexpr uint32_t kFirstSiteId = 8;
+
+// 在调用线程上把参数归一化为少数几种类型，标量原样保留，字符串只保留视图，
+// 其他类型(自定义formatter)立即格式化为字符串，此时格式串中的格式说明对其无效
+template <class T>
+inline auto Normalize(const T& arg) {
+  using U = std::decay_t<T>;
+  if constexpr (std::is_same_v<U, bool> || std::is_same_v<U, char> || std::is_same_v<U, float> ||
+                std::is_same_v<U, double>) {
+    return arg;
+  } else if constexpr (std::is_same_v<U, long double>) {
+    return static_cast<double>(arg);
+  } else if constexpr (std::is_enum_v<U>) {
+    return Normalize(static_cast<std::underlying_type_t<U>>(arg));
+  } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+    return static_cast<int64_t>(arg);
+  } else if constexpr (std::is_integral_v<U>) {
+    return static_cast<uint64_t>(arg);
+  } else if constexpr (std::is_array_v<T> &&
+                       std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>) {
+    return std::string_view(arg, strnlen(arg, std::extent_v<T>));
+  } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+    return arg ? std::string_view(arg) : std::string_view();
+  } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+    return std::string_view(arg);
+  } else if constexpr (std::is_pointer_v<U>) {
+    return static_cast<const void*>(arg);
+  } else {
+    return fmt::format("{}", arg);
+  }
+}
+
+inline std::size_t EncodedSize(int64_t) { return 1 + sizeof(int64_t); }
+inline std::size_t EncodedSize(uint64_t) { return 1 + sizeof(uint64_t); }
+inline std::size_t EncodedSize(float) { return 1 + sizeof(float); }
+inline std::size_t EncodedSize(double) { return 1 + sizeof(double); }
+inline std::size_t EncodedSize(bool) { return 2; }
+inline std::size_t EncodedSize(char) { return 2; }
+inline std::size_t EncodedSize(const void*) { return 1 + sizeof(uint64_t); }
+inline std::size_t EncodedSize(std::string_view s) {
+  return 1 + sizeof(uint32_t) + std::min<std::size_t>(s.size(), kMaxLogStringLen);
+}
+
+template <class T>
+inline char* EncodeScalar(char* p, LogArgType type, T value) {
+  *p = type;
+  memcpy(p + 1, &value, sizeof(T));
+  return p + 1 + sizeof(T);
+}
+
+inline char* Encode(char* p, int64_t v) { return EncodeScalar(p, kLogInt, v); }
+inline char* Encode(char* p, uint64_t v) { return EncodeScalar(p, kLogUInt, v); }
+inline char* Encode(char* p, float v) { return EncodeScalar(p, kLogFloat, v); }
+inline char* Encode(char* p, double v) { return EncodeScalar(p, kLogDouble, v); }
+inline char* Encode(char* p, bool v) { return EncodeScalar(p, kLogBool, v); }
+inline char* Encode(char* p, char v) { return EncodeScalar(p, kLogChar, v); }
+inline char* Encode(char* p, const void* v) {
+  return EncodeScalar(p, kLogPointer, reinterpret_cast<uint64_t>(v));
+}
+inline char* Encode(char* p, std::string_view s) {
+  auto len = static_cast<uint32_t>(std::min<std::size_t>(s.size(), kMaxLogStringLen));
+  p = EncodeScalar(p, kLogString, len);
+  memcpy(p, s.data(), len);
+  return p + len;
+}
+
+// 按格式串及编码后的参数生成日志内容，没有参数时原样输出格式串
+// 格式串或参数不合法时返回false
+bool FormatLogArgs(std::string_view fmt, const char* args, std::size_t size, std::string* out);
+
+// 单生产者单消费者的变长记录环形队列，生产者为写日志的线程，消费者为后台线程
+// 记录不跨越队列末尾，末尾剩余空间不足时写入填充记录
+class LogRing {
+ public:
+  static constexpr std::size_t kCapacity = 1UL << 20;
+
+  LogRing() : buf_(new char[kCapacity]) {}
+
+  // size需按8字节对齐，空间不足时返回nullptr
+  char* Reserve(std::size_t size) {
+    std::size_t offset = head_ & (kCapacity - 1);
+    std::size_t contiguous = kCapacity - offset;
+    std::size_t need = contiguous < size ? contiguous + size : size;
+    if (head_ + need - cached_tail_ > kCapacity) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head_ + need - cached_tail_ > kCapacity) {
+        return nullptr;
+      }
+    }
+    if (contiguous < size) {
+      auto* padding = reinterpret_cast<uint32_t*>(buf_.get() + offset);
+      padding[0] = static_cast<uint32_t>(contiguous);
+      padding[1] = 0;
+      head_ += contiguous;
+    }
+    return buf_.get() + (head_ & (kCapacity - 1));
+  }
+
+  void Commit(std::size_t size) {
+    head_ += size;
+    published_head_.store(head_, std::memory_order_release);
+  }
+
+  // 以下由消费者调用，队列为空时返回nullptr
+  const LogRecordHeader* Front() {
+    for (;;) {
+      uint64_t tail = tail_.load(std::memory_order_relaxed);
+      if (tail == published_head_.load(std::memory_order_acquire)) {
+        return nullptr;
+      }
+      auto* header =
+          reinterpret_cast<const LogRecordHeader*>(buf_.get() + (tail & (kCapacity - 1)));
+      if (header->site_id != 0) {
+        return header;
+      }
+      tail_.store(tail + header->size, std::memory_order_release);
+    }
+  }
+
+  bool Empty() const {
+    return tail_.load(std::memory_order_acquire) ==
+           published_head_.load(std::memory_order_acquire);
+  }
+
+  void Pop(std::size_t size) {
+    tail_.store(tail_.load(std::memory_order_relaxed) + size, std::memory_order_release);
+  }
+
+  void OnDropped() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  std::unique_ptr<char[]> buf_;
+  alignas(64) uint64_t head_ = 0;  // 只由生产者访问
+  uint64_t cached_tail_ = 0;
+  alignas(64) std::atomic<uint64_t> published_head_{0};
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace log_detail
+
+// 日志默认同步输出到spdlog的default logger
+// 开启异步模式后，调用线程只检查日志级别，把调用点id及参数编码写入线程私有的环形队列，
+// 后台线程格式化后交给spdlog输出，或者直接把记录写入二进制文件，由tools/log_decoder离线解码。
+// 队列满时丢弃日志并计数，不会阻塞调用线程。不同线程的日志之间不保证输出顺序
+// LOG_FATAL写入队列后会等待后台线程输出并flush，保证崩溃前的最后一条日志不会丢失
 class Logger {
  public:
   static Logger& Instance() {
@@ -16,24 +208,151 @@ class Logger {
     return logger;
   }
 
+  ~Logger();
+
   std::shared_ptr<spdlog::logger> GetLogger() { return logger_; }
 
+  // binary_file为空时后台线程格式化后输出到spdlog，否则写入binary_file
+  bool StartAsync(const std::string& binary_file = "");
+
+  // 输出队列中剩余的日志后停止后台线程，恢复同步模式，只应在退出前调用
+  void StopAsync();
+
+  bool async() const { return async_.load(std::memory_order_relaxed); }
+
+  // 异步模式下等待后台线程输出此前写入队列的日志并flush，最多等待1s
+  void Flush();
+
+  // 在信号处理函数中调用，只使用原子操作及nanosleep
+  void FlushInSignalHandler();
+
+  // kLiteralFmt由LOG_*宏在编译期判断，格式串为字面量时，异步模式下只记录调用点id及参数，
+  // 其他情况(如std::string或char数组缓冲区)在调用线程上格式化，避免把第一次的内容当作格式串
+  template <bool kLiteralFmt, class T, class... Args>
+  void Log(LogSite* site, spdlog::level::level_enum level, const T& msg, const Args&... args) {
+    if (!logger_->should_log(level)) {
+      return;
+    }
+    if (!async()) {
+      LogSync(level, msg, args...);
+      return;
+    }
+
+    if constexpr (kLiteralFmt && std::is_array_v<T>) {
+      uint32_t site_id = site->id.load(std::memory_order_acquire);
+      if (site_id == 0) {
+        site_id = RegisterSite(site, level, fmt::string_view(msg, std::extent_v<T> - 1));
+      }
+      auto normalized = std::make_tuple(log_detail::Normalize(args)...);
+      Push(site_id, normalized, std::index_sequence_for<Args...>{});
+    } else {
+      std::string formatted;
+      if constexpr (sizeof...(Args) == 0) {
+        formatted = fmt::format("{}", msg);
+      } else {
+        formatted = FormatOrRaw(msg, args...);
+      }
+      auto normalized = std::make_tuple(std::string_view(formatted));
+      Push(log_detail::kPreformattedSiteId + static_cast<uint32_t>(level), normalized,
+           std::index_sequence<0>{});
+    }
+
+    if (level >= spdlog::level::critical) {
+      Flush();
+    }
+  }
+
  private:
   Logger() : logger_(spdlog::default_logger()) {}
 
+  // 异步模式下在调用线程上格式化非字面量的格式串，格式串不合法时输出格式串本身
+  template <class T, class... Args>
+  static std::string FormatOrRaw(const T& fmt, const Args&... args) {
+    fmt::string_view view(fmt);
+    try {
+      return fmt::vformat(view, fmt::make_format_args(args...));
+    } catch (const std::exception& e) {
+      return std::string(view.data(), view.size());
+    }
+  }
+
+  // 格式串及参数直接交给spdlog，格式化写入spdlog内部的缓冲区，不产生临时字符串，
+  // 格式串不合法时由spdlog的错误处理函数报告。没有参数时原样输出，与spdlog一致
+  template <class T, class... Args>
+  void LogSync(spdlog::level::level_enum level, const T& msg, const Args&... args) {
+    if constexpr (sizeof...(Args) == 0) {
+      logger_->log(level, msg);
+    } else {
+      logger_->log(level, msg, args...);
+    }
+  }
+
+  template <class Tuple, std::size_t... I>
+  void Push(uint32_t site_id, const Tuple& args, std::index_sequence<I...>) {
+    std::size_t size = sizeof(log_detail::LogRecordHeader);
+    ((size += log_detail::EncodedSize(std::get<I>(args))), ...);
+    std::size_t aligned_size = (size + 7) & ~static_cast<std::size_t>(7);
+
+    auto* ring = LocalRing();
+    char* p = ring->Reserve(aligned_size);
+    if (!p) {
+      ring->OnDropped();
+      return;
+    }
+    auto* header = reinterpret_cast<log_detail::LogRecordHeader*>(p);
+    header->size = static_cast<uint32_t>(size);
+    header->site_id = site_id;
+    header->timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::system_clock::now().time_since_epoch())
+                               .count();
+    p += sizeof(log_detail::LogRecordHeader);
+    ((p = log_detail::Encode(p, std::get<I>(args))), ...);
+    ring->Commit(aligned_size);
+  }
+
+  uint32_t RegisterSite(LogSite* site, spdlog::level::level_enum level, fmt::string_view fmt);
+
+  log_detail::LogRing* LocalRing() {
+    static thread_local log_detail::LogRing* ring = nullptr;
+    if (!ring) {
+      ring = CreateLocalRing();
+    }
+    return ring;
+  }
+
+  log_detail::LogRing* CreateLocalRing();
+
+  void BackgroundLoop();
+
  private:
   std::shared_ptr<spdlog::logger> logger_;
+  std::atomic<bool> async_{false};
+  struct AsyncContext;
+  AsyncContext* ctx_ = nullptr;
 };
 
+// 按配置开启异步或二进制日志，name用于区分二进制日志文件:
+// ./ft_log.<name>.<pid>.bin
+// 异步模式下为SIGINT/SIGTERM/SIGABRT安装处理函数(已有处理函数的除外)，
+// 等待后台线程输出队列中的日志后再按默认方式退出
+bool InitLogMode(const GlobalConfig& config, const std::string& name);
+
+// 第一个参数字符串化后以双引号开头时为字面量格式串
+#define FT_LOG_IMPL(level, ...)                                                                 \
+  do {                                                                                          \
+    static ::ft::LogSite ft_log_site_{__FILE__, __LINE__};                                      \
+    ::ft::Logger::Instance().Log<(#__VA_ARGS__)[0] == '"'>(&ft_log_site_, level, __VA_ARGS__); \
+  } while (0)
+
 #define LOG_SET_LEVEL(log_level) \
   ::ft::Logger::Instance().GetLogger()->set_level(spdlog::level::from_str(log_level))
 
-#define LOG_TRACE(...) ::ft::Logger::Instance().GetLogger()->trace(__VA_ARGS__)
-#define LOG_DEBUG(...) ::ft::Logger::Instance().GetLogger()->debug(__VA_ARGS__)
-#define LOG_INFO(...) ::ft::Logger::Instance().GetLogger()->info(__VA_ARGS__)
-#define LOG_WARN(...) ::ft::Logger::Instance().GetLogger()->warn(__VA_ARGS__)
-#define LOG_ERROR(...) ::ft::Logger::Instance().GetLogger()->error(__VA_ARGS__)
-#define LOG_FATAL(...) ::ft::Logger::Instance().GetLogger()->critical(__VA_ARGS__)
+#define LOG_TRACE(...) FT_LOG_IMPL(::spdlog::level::trace, __VA_ARGS__)
+#define LOG_DEBUG(...) FT_LOG_IMPL(::spdlog::level::debug, __VA_ARGS__)
+#define LOG_INFO(...) FT_LOG_IMPL(::spdlog::level::info, __VA_ARGS__)
+#define LOG_WARN(...) FT_LOG_IMPL(::spdlog::level::warn, __VA_ARGS__)
+#define LOG_ERROR(...) FT_LOG_IMPL(::spdlog::level::err, __VA_ARGS__)
+#define LOG_FATAL(...) FT_LOG_IMPL(::spdlog::level::critical, __VA_ARGS__)
 
 }  // namespace ft
 
@@ -0,0 +1,48 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_BASE_LOG_FILE_H_
+#define FT_INCLUDE_FT_BASE_LOG_FILE_H_
+
+#include <cstdint>
+
+namespace ft {
+
+// 二进制日志文件格式，由异步日志的后台线程写入，tools/log_decoder解码
+// 文件头之后为若干个块，每个块以type及size(包括块头在内的长度)开头
+//   site块: 调用点第一次出现时写入，块头后依次为文件名及格式串
+//   record块: 一条日志，块头后为编码后的参数，site_id为[1, 8)时参数为已格式化的内容
+
+constexpr uint32_t kLogFileMagic = 0x676f6c66;  // "flog"
+constexpr uint32_t kLogFileVersion = 1;
+
+enum LogFileBlockType : uint32_t {
+  kLogFileSiteBlock = 1,
+  kLogFileRecordBlock,
+};
+
+struct LogFileHeader {
+  uint32_t magic;
+  uint32_t version;
+};
+
+struct LogFileSite {
+  uint32_t type;
+  uint32_t size;
+  uint32_t site_id;
+  uint32_t level;
+  uint32_t line;
+  uint32_t file_len;
+};
+
+struct LogFileRecord {
+  uint32_t type;
+  uint32_t size;
+  uint32_t site_id;
+  uint32_t reserved;
+  int64_t timestamp_ns;
+  uint64_t thread_id;
+};
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_BASE_LOG_FILE_H_
@@ -18,6 +18,9 @@ struct TickData {
   MarketDataSource source;
   uint64_t local_timestamp_us;
   uint64_t exchange_timestamp_us;
+  // 热路径打点(RdTsc)，只在本机内有意义，0表示未打点
+  uint64_t recv_tsc;      // gateway收到行情
+  uint64_t dispatch_tsc;  // OMS开始分发
 
   uint32_t ticker_id;
   double last_price;
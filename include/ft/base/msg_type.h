@@ -0,0 +1,43 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_BASE_MSG_TYPE_H_
+#define FT_INCLUDE_FT_BASE_MSG_TYPE_H_
+
+#include <cstdint>
+
+#include "ft/base/market_data.h"
+#include "ft/base/trade_msg.h"
+
+namespace ft {
+
+// yijinjing FrameHeader中msg_type字段的取值
+// 同一个journal可以混合传输多种消息，读端根据msg_type分发到对应的处理函数
+// 0保留给未标注类型的数据
+enum class MsgType : int16_t {
+  kUnknown = 0,
+  kTickData = 1,
+  kOrderResponse = 2,
+  kTraderCommand = 3,
+};
+
+// 消息结构体到msg_type的编译期映射，未注册的结构体无法通过typed接口写入或分发
+template <class T>
+struct MsgTypeOf;
+
+// 需在namespace ft中使用
+#define FT_REGISTER_MSG_TYPE(msg_struct, msg_type) \
+  template <>                                      \
+  struct MsgTypeOf<msg_struct> {                   \
+    static constexpr MsgType value = msg_type;     \
+  }
+
+FT_REGISTER_MSG_TYPE(TickData, MsgType::kTickData);
+FT_REGISTER_MSG_TYPE(OrderResponse, MsgType::kOrderResponse);
+FT_REGISTER_MSG_TYPE(TraderCommand, MsgType::kTraderCommand);
+
+template <class T>
+inline constexpr int16_t kMsgTypeOf = static_cast<int16_t>(MsgTypeOf<T>::value);
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_BASE_MSG_TYPE_H_
@@ -233,6 +233,9 @@ struct TraderCommand {
   uint32_t magic;
   TraderCmdType type;
   uint64_t timestamp_us;
+  // 热路径打点(RdTsc)，0表示未打点
+  uint64_t tick_recv_tsc;  // 触发下单的行情被gateway收到的时间
+  uint64_t write_tsc;      // 策略写入指令的时间
   bool without_check;
   StrategyIdType strategy_id;
   union {
@@ -0,0 +1,137 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_COMPONENT_CONFLATED_MD_CHANNEL_H_
+#define FT_INCLUDE_FT_COMPONENT_CONFLATED_MD_CHANNEL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ft/base/market_data.h"
+#include "ft/utils/seqlock.h"
+
+namespace ft {
+
+// 合并行情通道，用于处理速度跟不上行情的策略
+// 每个合约只保留最新的一个tick，读端每次取到的都是该合约当前最新的行情，
+// 读端暂停期间同一合约的多个tick会被合并为一个，不会再逐个处理过期的行情
+// 有新行情的合约按第一次更新的顺序排队，每个合约在队列中最多出现一次
+// 单写者(OMS行情线程)单读者(策略)，映射文件为./ft_conflated_md.<name>
+class ConflatedMdChannel {
+ public:
+  ConflatedMdChannel() {}
+  ~ConflatedMdChannel();
+
+  ConflatedMdChannel(const ConflatedMdChannel&) = delete;
+  ConflatedMdChannel& operator=(const ConflatedMdChannel&) = delete;
+
+  // 写端创建通道，已存在的通道会被清空
+  bool Create(const std::string& name, uint32_t ticker_num);
+
+  // 读端映射已存在的通道
+  bool Open(const std::string& name);
+
+  // 写端写入最新行情，ticker_id超出范围时返回false
+  bool Publish(const TickData& tick) {
+    if (tick.ticker_id == 0 || tick.ticker_id > ticker_num_) {
+      return false;
+    }
+    auto& slot = slots_[tick.ticker_id - 1];
+    slot.tick.Store(tick);
+    counters_->published.store(counters_->published.load(std::memory_order_relaxed) + 1,
+                               std::memory_order_relaxed);
+    if (slot.pending.exchange(1, std::memory_order_acq_rel) != 0) {
+      // 读端还没有取走上一个tick，被合并
+      counters_->conflated.store(counters_->conflated.load(std::memory_order_relaxed) + 1,
+                                 std::memory_order_relaxed);
+      return true;
+    }
+    uint64_t head = ring_head_->value.load(std::memory_order_relaxed);
+    ring_[head & ring_mask_] = tick.ticker_id;
+    ring_head_->value.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 读端取出一个有更新的合约的最新行情，没有更新时返回false
+  bool Poll(TickData* tick) {
+    for (;;) {
+      uint64_t tail = ring_tail_->value.load(std::memory_order_relaxed);
+      if (tail == ring_head_->value.load(std::memory_order_acquire)) {
+        return false;
+      }
+      uint32_t ticker_id = ring_[tail & ring_mask_];
+      ring_tail_->value.store(tail + 1, std::memory_order_release);
+
+      // 先清除标记再读取，读取之后的更新会重新排队
+      auto& slot = slots_[ticker_id - 1];
+      slot.pending.store(0, std::memory_order_seq_cst);
+      uint32_t version;
+      // 写入与排队之间被读走的tick会再次排队，跳过已经读过的版本
+      if (!slot.tick.Load(tick, &version) || version == delivered_versions_[ticker_id]) {
+        continue;
+      }
+      delivered_versions_[ticker_id] = version;
+      return true;
+    }
+  }
+
+  // 写端写入的tick数量，以及在被读端取走之前就被新tick覆盖的数量
+  uint64_t published() const { return counters_->published.load(std::memory_order_relaxed); }
+  uint64_t conflated() const { return counters_->conflated.load(std::memory_order_relaxed); }
+
+  uint32_t ticker_num() const { return ticker_num_; }
+
+ private:
+  struct Header {
+    uint32_t magic;
+    uint32_t slot_size;
+    uint32_t ticker_num;
+    uint32_t ring_size;
+  };
+
+  struct alignas(64) Counters {
+    std::atomic<uint64_t> published;
+    std::atomic<uint64_t> conflated;
+  };
+
+  struct alignas(64) RingIndex {
+    std::atomic<uint64_t> value;
+  };
+
+  struct alignas(64) Slot {
+    SeqLock<TickData> tick;
+    std::atomic<uint32_t> pending;
+  };
+
+  static constexpr uint32_t kMagic = 0x636d6463;  // "cmdc"
+
+  static uint32_t RingSize(uint32_t ticker_num);
+  // 布局: Header | Counters | 写端索引 | 读端索引 | ring | Slot * ticker_num，各部分按cache line对齐
+  static std::size_t RingOffset() { return 64 + sizeof(Counters) + 2 * sizeof(RingIndex); }
+  static std::size_t SlotOffset(uint32_t ring_size) {
+    return RingOffset() + ((ring_size * sizeof(uint32_t) + 63) & ~63UL);
+  }
+  static std::size_t MappingSize(uint32_t ticker_num, uint32_t ring_size) {
+    return SlotOffset(ring_size) + static_cast<std::size_t>(ticker_num) * sizeof(Slot);
+  }
+
+  bool Map(const std::string& name, bool create, uint32_t ticker_num);
+  void Close();
+
+  void* addr_ = nullptr;
+  std::size_t size_ = 0;
+  Counters* counters_ = nullptr;
+  RingIndex* ring_head_ = nullptr;
+  RingIndex* ring_tail_ = nullptr;
+  uint32_t* ring_ = nullptr;
+  uint64_t ring_mask_ = 0;
+  Slot* slots_ = nullptr;
+  uint32_t ticker_num_ = 0;
+  // 读端本地记录每个合约已经取走的版本，以ticker_id为下标
+  std::vector<uint32_t> delivered_versions_;
+};
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_COMPONENT_CONFLATED_MD_CHANNEL_H_
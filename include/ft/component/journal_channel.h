@@ -0,0 +1,91 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_COMPONENT_JOURNAL_CHANNEL_H_
+#define FT_INCLUDE_FT_COMPONENT_JOURNAL_CHANNEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "ft/base/msg_type.h"
+#include "ft/component/yijinjing/journal/JournalReader.h"
+#include "ft/component/yijinjing/journal/JournalWriter.h"
+
+namespace ft {
+
+// 以消息结构体对应的msg_type写入journal
+template <class T>
+inline int64_t WriteMsg(yijinjing::JournalWriter* writer, const T& msg) {
+  return writer->write_data(msg, kMsgTypeOf<T>, 0);
+}
+
+// 将同一条消息写入多个journal，所有journal共用一个时间戳，先写入数据再统一发布
+// writers中不能有重复的writer
+template <class T>
+inline int64_t WriteMsgToAll(yijinjing::JournalWriter* const* writers, size_t num, const T& msg) {
+  return yijinjing::JournalWriter::write_data_multi(writers, num, msg, kMsgTypeOf<T>, 0);
+}
+
+// 按msg_type分发消息，分发逻辑在编译期展开，没有虚函数调用
+// Msgs为channel上可能出现的消息类型，handler需为每种类型提供operator()(const T&)
+template <class... Msgs>
+struct MsgDispatcher {
+  // msg_type未注册或数据长度与结构体不一致时返回false
+  template <class Handler>
+  static bool Dispatch(const yijinjing::Frame& frame, Handler&& handler) {
+    return (TryDispatch<Msgs>(frame, handler) || ...);
+  }
+
+ private:
+  template <class T, class Handler>
+  static bool TryDispatch(const yijinjing::Frame& frame, Handler& handler) {
+    if (frame.getMsgType() != kMsgTypeOf<T> || frame.getDataLength() != sizeof(T)) {
+      return false;
+    }
+    handler(*reinterpret_cast<const T*>(frame.getData()));
+    return true;
+  }
+};
+
+// 带类型分发的journal reader，一个cursor可以读取同一journal(或多个journal合并)中
+// 的不同类型消息。无法识别的消息会被计数并交给on_unknown，由使用者决定如何处理
+template <class... Msgs>
+class TypedJournalReader {
+ public:
+  TypedJournalReader() {}
+
+  explicit TypedJournalReader(yijinjing::JournalReaderPtr reader) : reader_(std::move(reader)) {}
+
+  // 读取并分发一条消息，没有新消息时返回false
+  // on_unknown的参数为无法识别的frame，可据此记录msg_type及数据长度
+  template <class Handler, class UnknownHandler>
+  bool Poll(Handler&& handler, UnknownHandler&& on_unknown) {
+    if (!reader_->getNextFrame(&frame_)) {
+      return false;
+    }
+    if (!MsgDispatcher<Msgs...>::Dispatch(frame_, handler)) {
+      ++unknown_count_;
+      on_unknown(static_cast<const yijinjing::Frame&>(frame_));
+    }
+    return true;
+  }
+
+  // 无法识别的消息只计数
+  template <class Handler>
+  bool Poll(Handler&& handler) {
+    return Poll(handler, [](const yijinjing::Frame&) {});
+  }
+
+  uint64_t unknown_count() const { return unknown_count_; }
+
+  const yijinjing::JournalReaderPtr& reader() const { return reader_; }
+
+ private:
+  yijinjing::JournalReaderPtr reader_;
+  yijinjing::Frame frame_{nullptr};
+  uint64_t unknown_count_ = 0;
+};
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_COMPONENT_JOURNAL_CHANNEL_H_
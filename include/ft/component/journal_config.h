@@ -0,0 +1,26 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_COMPONENT_JOURNAL_CONFIG_H_
+#define FT_INCLUDE_FT_COMPONENT_JOURNAL_CONFIG_H_
+
+#include <string>
+
+#include "ft/base/config.h"
+#include "ft/component/yijinjing/journal/PageProvider.h"
+#include "ft/utils/wait_strategy.h"
+
+namespace ft {
+
+// OMS与策略之间的journal及其读端等待方式的配置解析
+
+// 订单类journal(trade_mq/rsp_mq)及行情journal(md_mq)的页配置，页大小需在1MB到1024MB之间
+// 配置不合法时返回false
+bool GetOrderMqPageConfig(const GlobalConfig& config, yijinjing::PageConfig* page_config);
+bool GetMdMqPageConfig(const GlobalConfig& config, yijinjing::PageConfig* page_config);
+
+// 根据配置生成等待策略，name为空时使用global中的wait_strategy
+bool GetWaitStrategy(const GlobalConfig& config, const std::string& name, WaitStrategy* strategy);
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_COMPONENT_JOURNAL_CONFIG_H_
@@ -0,0 +1,205 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_COMPONENT_LATENCY_STATS_H_
+#define FT_INCLUDE_FT_COMPONENT_LATENCY_STATS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "ft/utils/seqlock.h"
+#include "ft/utils/tsc.h"
+
+namespace ft {
+
+// 热路径上的各阶段，时间戳均为RdTsc的计数
+//   gateway收到行情 -> OMS行情线程从tick ring取出 -> OMS分发完毕 -> 策略收到行情 ->
+//   策略写入指令 -> OMS读到指令 -> 风控检查完毕 -> gateway发出订单
+enum LatencyStage : uint32_t {
+  kLatencyTickRing = 0,   // gateway收到行情到OMS行情线程取出
+  kLatencyOmsDispatch,    // OMS写入md journal、合并行情通道及快照
+  kLatencyStrategyRecv,   // OMS开始分发到策略收到行情
+  kLatencyCmdWrite,       // 策略收到行情到写入下单指令，包括策略自身的计算
+  kLatencyCmdRead,        // 策略写入指令到OMS读到指令
+  kLatencyRmsCheck,       // OMS读到指令到风控检查完毕
+  kLatencyGatewaySend,    // 调用gateway发单
+  kLatencyTickToTrade,    // gateway收到行情到gateway发出订单
+  kLatencyStageNum,
+};
+
+const char* LatencyStageStr(LatencyStage stage);
+
+// HDR直方图，值按2的幂分段，每段再等分为32个子桶，相对误差不超过1/32
+// 小于64的值精确记录，超过2^32的值计入最后一个桶
+struct LatencyHistogram {
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int kMaxValueBits = 32;
+  static constexpr uint64_t kSubBucketNum = 1UL << kSubBucketBits;
+  static constexpr std::size_t kBucketNum = (kMaxValueBits - kSubBucketBits + 1) * kSubBucketNum;
+
+  uint64_t count;
+  uint64_t max;
+  uint64_t buckets[kBucketNum];
+
+  static std::size_t BucketIndex(uint64_t value) {
+    if (value < 2 * kSubBucketNum) {
+      return value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    if (msb >= kMaxValueBits) {
+      return kBucketNum - 1;
+    }
+    int shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBucketNum + (value >> shift) - kSubBucketNum;
+  }
+
+  // 桶内的最大值
+  static uint64_t BucketValue(std::size_t idx) {
+    if (idx < 2 * kSubBucketNum) {
+      return idx;
+    }
+    int shift = static_cast<int>(idx / kSubBucketNum) - 1;
+    uint64_t sub = idx % kSubBucketNum + kSubBucketNum;
+    return ((sub + 1) << shift) - 1;
+  }
+
+  void Record(uint64_t value) {
+    ++buckets[BucketIndex(value)];
+    ++count;
+    if (value > max) {
+      max = value;
+    }
+  }
+
+  // p在(0, 1]之间，返回不小于p比例样本的最小桶上界，没有样本时返回0
+  uint64_t Percentile(double p) const;
+};
+
+struct LatencyHistograms {
+  LatencyHistogram stages[kLatencyStageNum];
+};
+
+// 共享内存中的延迟统计页，每个线程占一个slot，线程把本地的直方图定期写入slot，
+// 读端(tools/latency_stats)通过顺序锁读取，不影响写端
+// OMS创建并清空统计页，策略进程以读写方式打开后为自己的线程分配slot
+// 映射文件为./ft_latency_stats.<name>
+class LatencyStats {
+ public:
+  static constexpr uint32_t kMaxThreadNum = 64;
+  static constexpr std::size_t kMaxThreadNameLen = 31;
+
+  LatencyStats() {}
+  ~LatencyStats();
+
+  LatencyStats(const LatencyStats&) = delete;
+  LatencyStats& operator=(const LatencyStats&) = delete;
+
+  // 创建新的统计页替换已存在的，已映射旧统计页的进程不受影响。创建时测量tsc频率，阻塞约50ms
+  bool Create(const std::string& name);
+
+  // 映射已存在的统计页，只有writable时才能分配slot
+  bool Open(const std::string& name, bool writable);
+
+  // 按线程名分配slot，同名的slot已存在时复用，避免策略反复重启耗尽slot，复用后重新统计
+  // 没有空闲slot时返回false
+  bool AcquireSlot(const std::string& thread_name, uint32_t* slot_idx);
+
+  // 写端定期调用，只能由slot的持有线程调用
+  void Store(uint32_t slot_idx, const LatencyHistograms& histograms) {
+    slots_[slot_idx].histograms.Store(histograms);
+  }
+
+  // slot未被分配或还没有写入过时返回false
+  bool Load(uint32_t slot_idx, std::string* thread_name, LatencyHistograms* histograms) const;
+
+  uint32_t slot_num() const { return kMaxThreadNum; }
+  double tsc_per_ns() const { return tsc_per_ns_; }
+  bool is_open() const { return addr_ != nullptr; }
+
+ private:
+  struct Header {
+    uint32_t magic;
+    uint32_t slot_size;
+    uint32_t slot_num;
+    uint32_t reserved;
+    double tsc_per_ns;
+  };
+
+  enum SlotState : uint32_t { kSlotFree = 0, kSlotClaiming, kSlotUsed };
+
+  struct alignas(64) Slot {
+    std::atomic<uint32_t> state;
+    char thread_name[kMaxThreadNameLen + 1];
+    SeqLock<LatencyHistograms> histograms;
+  };
+
+  static constexpr uint32_t kMagic = 0x6c617473;  // "lats"
+
+  // 布局: Header | Slot * kMaxThreadNum，Header独占一个cache line
+  static constexpr std::size_t kMappingSize = 64 + kMaxThreadNum * sizeof(Slot);
+
+  void Close();
+
+  void* addr_ = nullptr;
+  Slot* slots_ = nullptr;
+  double tsc_per_ns_ = 1.0;
+  bool writable_ = false;
+};
+
+// 线程本地的统计，记录只修改本线程的直方图，不需要原子操作
+// 线程空闲时调用Flush，距离上次导出超过interval时写入共享内存
+class LatencyRecorder {
+ public:
+  LatencyRecorder(LatencyStats* stats, uint32_t slot_idx, uint64_t flush_interval_tsc)
+      : stats_(stats), slot_idx_(slot_idx), flush_interval_tsc_(flush_interval_tsc) {}
+
+  void Record(LatencyStage stage, uint64_t start_tsc, uint64_t end_tsc) {
+    // 不同核心的tsc可能有少量偏差，end早于start时记为0
+    histograms_.stages[stage].Record(end_tsc > start_tsc ? end_tsc - start_tsc : 0);
+    dirty_ = true;
+  }
+
+  void Flush(uint64_t now_tsc) {
+    if (dirty_ && now_tsc >= next_flush_tsc_) {
+      stats_->Store(slot_idx_, histograms_);
+      next_flush_tsc_ = now_tsc + flush_interval_tsc_;
+      dirty_ = false;
+    }
+  }
+
+ private:
+  LatencyStats* stats_;
+  uint32_t slot_idx_;
+  uint64_t flush_interval_tsc_;
+  uint64_t next_flush_tsc_ = 0;
+  bool dirty_ = false;
+  LatencyHistograms histograms_{};
+};
+
+// 当前线程的recorder，未注册时为nullptr，此时打点只有一次RdTsc的开销
+inline thread_local LatencyRecorder* tls_latency_recorder = nullptr;
+
+// 为当前线程在stats中分配slot并注册recorder，默认每100ms导出一次
+// stats未打开或没有空闲slot时返回false，当前线程不做统计
+bool RegisterLatencyRecorder(LatencyStats* stats, const std::string& thread_name,
+                             uint64_t flush_interval_ms = 100);
+
+// 记录[start_tsc, end_tsc]的耗时，start_tsc为0表示上游没有打点，忽略
+inline void RecordLatency(LatencyStage stage, uint64_t start_tsc, uint64_t end_tsc) {
+  auto* recorder = tls_latency_recorder;
+  if (recorder && start_tsc != 0) {
+    recorder->Record(stage, start_tsc, end_tsc);
+  }
+}
+
+// 在线程的事件循环空闲时调用
+inline void FlushLatencyStats() {
+  auto* recorder = tls_latency_recorder;
+  if (recorder) {
+    recorder->Flush(RdTsc());
+  }
+}
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_COMPONENT_LATENCY_STATS_H_
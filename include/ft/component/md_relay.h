@@ -0,0 +1,208 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_COMPONENT_MD_RELAY_H_
+#define FT_INCLUDE_FT_COMPONENT_MD_RELAY_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ft/base/log.h"
+#include "ft/base/market_data.h"
+#include "ft/component/networking.h"
+#include "ft/utils/ring_buffer.h"
+#include "ft/utils/tsc.h"
+
+namespace ft {
+
+// 行情转发的二进制格式，用于一台行情接入机向其他主机转发行情
+// 每个包由MdRelayHeader及tick_num个TickData组成。UDP一个包对应一个datagram，
+// TCP一个包对应一条NetworkNode二进制消息(msg_type为kMdRelayMsgType)
+// seq为包中第一个tick的序号，同一个session内从1开始连续递增，接收端据此检测丢包及重复包，
+// session为发布端的启动时间，发布端重启后接收端重新开始计数
+// ticker_id为合约表下标，发布端与接收端需使用同一份合约文件，contract_hash不一致的包会被丢弃
+struct MdRelayHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t tick_num;
+  uint32_t contract_hash;
+  uint32_t reserved;
+  uint64_t session;
+  uint64_t seq;
+};
+
+constexpr uint32_t kMdRelayMagic = 0x6d647279;  // "mdry"
+constexpr uint16_t kMdRelayVersion = 1;
+constexpr uint32_t kMdRelayMsgType = 1;
+// UDP包不超过以太网MTU，避免IP分片
+constexpr std::size_t kMaxMdRelayPacketSize = 1472;
+constexpr std::size_t kMaxTicksPerMdRelayPacket =
+    (kMaxMdRelayPacketSize - sizeof(MdRelayHeader)) / sizeof(TickData);
+
+// 合约表中所有ticker的hash，用于校验发布端与接收端的合约表是否一致
+uint32_t GetContractTableHash();
+
+// 发布端，把tick打包后发送，UDP及TCP共用
+class MdRelayPublisher {
+ public:
+  MdRelayPublisher();
+  virtual ~MdRelayPublisher() {}
+
+  // 把tick加入当前包，包满时立即发送
+  void Publish(const TickData& tick) {
+    ticks()[tick_num_++] = tick;
+    if (tick_num_ == kMaxTicksPerMdRelayPacket) {
+      Flush();
+    }
+  }
+
+  // 发送当前未满的包，一般在取完一批tick后调用
+  void Flush();
+
+  uint64_t next_seq() const { return next_seq_; }
+
+ protected:
+  virtual bool SendPacket(const char* data, std::size_t size) = 0;
+
+ private:
+  MdRelayHeader* header() { return reinterpret_cast<MdRelayHeader*>(buf_); }
+  TickData* ticks() { return reinterpret_cast<TickData*>(buf_ + sizeof(MdRelayHeader)); }
+
+  alignas(8) char buf_[kMaxMdRelayPacketSize];
+  uint32_t tick_num_ = 0;
+  uint64_t next_seq_ = 1;
+};
+
+// 接收端解码，检测丢包及重复包
+class MdRelayDecoder {
+ public:
+  MdRelayDecoder();
+
+  // 解码一个包，对其中新的tick调用handler，重复的tick会被跳过，非法包返回false
+  template <class Handler>
+  bool Decode(const char* data, std::size_t size, Handler&& handler) {
+    uint32_t begin;
+    if (!CheckPacket(data, size, &begin)) {
+      return false;
+    }
+    auto* header = reinterpret_cast<const MdRelayHeader*>(data);
+    auto* ticks = reinterpret_cast<const TickData*>(data + sizeof(MdRelayHeader));
+    // 其他主机的tsc没有意义，以收包时间作为收到行情的时间
+    uint64_t recv_tsc = RdTsc();
+    TickData tick;
+    for (uint32_t i = begin; i < header->tick_num; ++i) {
+      tick = ticks[i];
+      tick.recv_tsc = recv_tsc;
+      tick.dispatch_tsc = 0;
+      handler(tick);
+    }
+    return true;
+  }
+
+  // 出现序号跳跃的次数及丢失的tick数
+  uint64_t gap_count() const { return gap_count_; }
+  uint64_t lost_ticks() const { return lost_ticks_; }
+  // 重复或乱序到达而被丢弃的tick数
+  uint64_t dup_ticks() const { return dup_ticks_; }
+  uint64_t next_seq() const { return next_seq_; }
+
+ private:
+  bool CheckPacket(const char* data, std::size_t size, uint32_t* begin);
+
+  uint32_t contract_hash_;
+  uint64_t session_ = 0;
+  uint64_t next_seq_ = 1;
+  uint64_t gap_count_ = 0;
+  uint64_t lost_ticks_ = 0;
+  uint64_t dup_ticks_ = 0;
+};
+
+// 接收端，Poll在调用线程中执行
+class MdRelayReceiver {
+ public:
+  virtual ~MdRelayReceiver() {}
+
+  // 读取一个tick，没有新数据时返回false
+  virtual bool Poll(TickData* tick) = 0;
+};
+
+// UDP发布端，address为组播地址时以组播发送，否则以单播发送
+// interface为发送组播的本机网卡地址，为空时由系统选择
+class UdpMdPublisher : public MdRelayPublisher {
+ public:
+  ~UdpMdPublisher();
+
+  bool Init(const std::string& address, int port, const std::string& interface = "");
+
+ protected:
+  bool SendPacket(const char* data, std::size_t size) override;
+
+ private:
+  int fd_ = -1;
+  char dst_addr_[16];  // sockaddr_in
+};
+
+// UDP接收端，address为组播地址时加入该组播组，否则只绑定端口
+class UdpMdReceiver : public MdRelayReceiver {
+ public:
+  ~UdpMdReceiver();
+
+  bool Init(const std::string& address, int port, const std::string& interface = "");
+
+  bool Poll(TickData* tick) override;
+
+  const MdRelayDecoder& decoder() const { return decoder_; }
+
+ private:
+  int fd_ = -1;
+  MdRelayDecoder decoder_;
+  TickData ticks_[kMaxTicksPerMdRelayPacket];
+  uint32_t tick_num_ = 0;
+  uint32_t tick_idx_ = 0;
+  alignas(8) char buf_[kMaxMdRelayPacketSize];
+};
+
+// TCP发布端，把每个包发送给所有已连接的接收端
+class TcpMdPublisher : public MdRelayPublisher, private NetworkNode {
+ public:
+  // ip为0.0.0.0时接受其他主机的连接
+  bool Init(const std::string& ip, int port) { return StartServer(ip, port); }
+
+ protected:
+  bool SendPacket(const char* data, std::size_t size) override;
+
+ private:
+  void OnConnected(int conn_id) override;
+  void OnDisconnected(int conn_id) override;
+
+  std::mutex mutex_;
+  std::set<int> conn_ids_;
+  std::vector<int> snapshot_;
+};
+
+// TCP接收端，在NetworkNode线程中解码后放入队列，由Poll的调用线程读取
+class TcpMdReceiver : public MdRelayReceiver, private NetworkNode {
+ public:
+  // 连接断开后每秒重连一次，重连期间丢失的行情会被计为丢包
+  bool Init(const std::string& ip, int port);
+
+  bool Poll(TickData* tick) override { return rb_->Get(tick); }
+
+ private:
+  void OnRecvMsg(int conn_id, uint32_t msg_type, const char* data, std::size_t size) override;
+  void OnDisconnected(int conn_id) override;
+
+  std::string ip_;
+  int port_ = 0;
+  MdRelayDecoder decoder_;
+  // 队列较大，放在堆上
+  std::unique_ptr<RingBuffer<TickData, 4096 * 16>> rb_ =
+      std::make_unique<RingBuffer<TickData, 4096 * 16>>();
+};
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_COMPONENT_MD_RELAY_H_
@@ -3,17 +3,33 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <string>
 #include <thread>
+#include <type_traits>
+#include <vector>
 
 #include "nlohmann/json.hpp"
 #include "uv.h"
 
 namespace ft {
 
+// 每条消息由8字节的帧头及消息体组成，消息体按8字节对齐填充
+// msg_type为0的消息体为json字符串，用于管理类消息；其余为二进制消息，msg_type由使用者定义，
+// 消息体可以是POD结构体或cereal序列化后的数据
+struct NetworkMsgHeader {
+  uint32_t body_size;
+  uint32_t msg_type;
+};
+
 class NetworkNode {
+ public:
+  static constexpr uint32_t kJsonMsgType = 0;
+  static constexpr std::size_t kMaxBodySize = 64UL << 20;
+
  private:
   enum TaskType {
     kConnect,
@@ -32,39 +48,82 @@ class NetworkNode {
     NetworkNode* node;
     uv_tcp_t client;
     int conn_id;
+    // 接收缓冲区，libuv直接读入rcv_buf的空闲部分，完整的消息在缓冲区内原地分发，不额外拷贝
     std::vector<char> rcv_buf;
+    std::size_t rcv_size = 0;
     std::vector<char> snd_buf;
   };
 
+  // 延迟连接的定时器，到期后在事件循环中发起连接
+  struct DelayedConnect {
+    NetworkNode* node;
+    uv_timer_t timer;
+    int conn_id;
+    uint32_t ip;
+    int port;
+  };
+
  public:
   NetworkNode();
   ~NetworkNode();
 
   int GenConnId();
+  // 未指定ip时连接本机
+  bool Connect(const std::string& ip, int port, int conn_id);
   bool Connect(int port, int conn_id);
   bool Connect(int port);
+  // delay_ms后再连接，由事件循环中的定时器发起，可在回调中用于断线重连而不阻塞事件循环
+  bool ConnectLater(const std::string& ip, int port, int conn_id, uint64_t delay_ms);
   bool Disconnect(int conn_id);
 
+  // 未指定ip时只监听本机，ip为0.0.0.0时接受其他主机的连接
+  bool StartServer(const std::string& ip, int port);
   bool StartServer(int port);
   bool StartClient();
 
   bool SendMsg(int conn_id, const nlohmann::json& msg);
 
+  // 发送二进制消息，msg_type不能为kJsonMsgType
+  bool SendMsg(int conn_id, uint32_t msg_type, const void* data, std::size_t size);
+
+  template <class T>
+  bool SendPodMsg(int conn_id, uint32_t msg_type, const T& msg) {
+    static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+    return SendMsg(conn_id, msg_type, &msg, sizeof(T));
+  }
+
+  // T需继承pubsub::Serializable，接收端通过T::ParseFromString解析
+  template <class T>
+  bool SendSerializedMsg(int conn_id, uint32_t msg_type, const T& msg) {
+    std::string data;
+    msg.SerializeToString(&data);
+    return SendMsg(conn_id, msg_type, data.data(), data.size());
+  }
+
   void OnUvConnect(int conn_id, int status);
   void OnUvConnection(int status);
-  void OnUvRead(int conn_id, const char* data, ssize_t len);
+  void OnUvAlloc(Connection* conn, uv_buf_t* buf);
+  void OnUvRead(int conn_id, ssize_t len);
   void OnUvAsyncTask();
   void OnUvAsyncExit();
+  void OnUvConnectTimer(DelayedConnect* delayed);
 
  protected:
   virtual void OnConnected(int conn_id) {}
   virtual void OnDisconnected(int conn_id) {}
   virtual void OnRecvMsg(int conn_id, const nlohmann::json& msg) {}
+  // data指向接收缓冲区，8字节对齐，只在回调期间有效
+  virtual void OnRecvMsg(int conn_id, uint32_t msg_type, const char* data, std::size_t size) {}
 
  private:
-  void DoConnect(int conn_id, int port);
+  void DoConnect(int conn_id, uint32_t ip, int port);
+  void DoConnectLater(int conn_id, uint32_t ip, int port, uint64_t delay_ms);
   void DoDisconnect(int conn_id);
-  void DoSendMsg(int conn_id, char* data, std::size_t size);
+  void DoSendMsg(int conn_id, const char* data, std::size_t size);
+
+  bool PutSendTask(int conn_id, uint32_t msg_type, const void* data, std::size_t size);
+  // 分发缓冲区中所有完整的消息，收到非法消息时返回false
+  bool DispatchMsgs(Connection* conn);
 
   void OnHeartBeat(int conn_id);
 
@@ -73,7 +132,6 @@ class NetworkNode {
   int next_conn_id() { return next_conn_id_++; }
 
   void PutTask(const Task& task);
-  bool GetTask(Task* task);
   void Notify();
 
  private:
@@ -83,7 +141,12 @@ class NetworkNode {
   std::map<int, std::shared_ptr<Connection>> connections_;
 
   std::mutex mtx_;
-  std::queue<Task> task_queue_;
+  std::vector<Task> task_queue_;
+  // 发送任务的帧在mtx_保护下追加到snd_buf_，任务中只记录偏移及长度。事件循环取任务时
+  // 将task_queue_及snd_buf_整体交换出来，两组缓冲区交替使用，容量稳定后发送路径上没有内存分配
+  std::vector<char> snd_buf_;
+  std::vector<Task> executing_tasks_;  // 以下只在事件循环中使用
+  std::vector<char> sending_buf_;
   uv_async_t async_task_req_;
 
   std::atomic<bool> running_{false};
@@ -3,8 +3,7 @@
 #ifndef FT_INCLUDE_FT_COMPONENT_ORDER_BOOK_LIMIT_ORDER_H_
 #define FT_INCLUDE_FT_COMPONENT_ORDER_BOOK_LIMIT_ORDER_H_
 
-#include <map>
-#include <string>
+#include <cstdint>
 
 namespace ft::orderbook {
 
@@ -14,10 +13,13 @@ inline uint64_t price_double_to_decimal(double p) {
 
 inline double price_decimal_to_double(uint64_t p) { return static_cast<double>(p) / 10000; }
 
-class PriceLevel;
+class OrderBook;
 
+// 逐笔委托，同时作为OrderBook中价位队列的侵入式链表节点
 class LimitOrder {
  public:
+  LimitOrder() = default;
+
   LimitOrder(uint64_t _id, bool _is_buy, int _volume, double _price)
       : id_(_id),
         is_buy_(_is_buy),
@@ -41,16 +43,19 @@ class LimitOrder {
   double price() const { return price_; }
   uint64_t decimal_price() const { return decimal_price_; }
 
-  void set_level(PriceLevel* l) { level_ = l; }
-  const PriceLevel* level() { return level_; }
-
  private:
-  uint64_t id_;
-  bool is_buy_;
-  int volume_;
-  double price_;
-  uint64_t decimal_price_;
-  PriceLevel* level_;
+  friend class OrderBook;
+
+  uint64_t id_ = 0;
+  bool is_buy_ = false;
+  int volume_ = 0;
+  double price_ = 0.0;
+  uint64_t decimal_price_ = 0;
+
+  // 以下字段由OrderBook维护
+  int64_t tick_price_ = 0;  // 以price_tick为单位的价格
+  uint32_t prev_ = 0;
+  uint32_t next_ = 0;
 };
 
 }  // namespace ft::orderbook
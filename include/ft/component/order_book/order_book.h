@@ -3,11 +3,8 @@
 #ifndef FT_INCLUDE_FT_COMPONENT_ORDER_BOOK_ORDER_BOOK_H_
 #define FT_INCLUDE_FT_COMPONENT_ORDER_BOOK_ORDER_BOOK_H_
 
-#include <cassert>
-#include <functional>
-#include <map>
-#include <string>
-#include <unordered_map>
+#include <cstdint>
+#include <vector>
 
 #include "ft/base/market_data.h"
 #include "ft/component/order_book/limit_order.h"
@@ -15,63 +12,119 @@
 
 namespace ft::orderbook {
 
+// 逐笔委托重建的L3订单簿
+// 1. 委托存放在预分配的节点池中，空闲节点由free list管理，节点池满时才会扩容
+// 2. order_id -> 节点的索引为开放寻址表，按order_id增删改均为O(1)
+// 3. 价位按price_tick映射到环形数组，数组覆盖所有非空价位，超出时扩容
+// 4. 前kMaxMarketLevel档在价位增删时增量维护，to_tick不需要遍历订单簿
+// 非线程安全
 class OrderBook {
  public:
-  explicit OrderBook(uint32_t ticker_id) : tid_(ticker_id) {}
+  static constexpr std::size_t kDefaultCapacity = 1UL << 16;
 
-  const PriceLevel* best_bid() const {
-    if (!buy_levels_.empty()) return &buy_levels_.begin()->second;
-    return nullptr;
+  // price_tick为最小变动价位，capacity为预分配的委托数
+  explicit OrderBook(uint32_t ticker_id, double price_tick = 0.01,
+                     std::size_t capacity = kDefaultCapacity);
+
+  // 返回的指针在下一次修改订单簿之前有效
+  const PriceLevel* best_bid() const { return top_level(bid_, 0); }
+  const PriceLevel* best_ask() const { return top_level(ask_, 0); }
+
+  void to_tick(TickData* tick) const;
+
+  // order_id必须非0，order_id已存在或价格、数量非正时返回false
+  bool AddOrder(const LimitOrder* order);
+  // 改价或改方向后排到新价位的队尾，只改数量时保持队列位置
+  bool ModifyOrder(const LimitOrder* order);
+  bool RemoveOrder(const LimitOrder* order) { return CancelOrder(order->id()); }
+
+  bool CancelOrder(uint64_t order_id);
+  // 委托成交volume，剩余数量为0时从订单簿中移除
+  bool ExecuteOrder(uint64_t order_id, int volume);
+
+  const LimitOrder* FindOrder(uint64_t order_id) const {
+    auto pos = find_index(order_id);
+    return pos == kNotFound ? nullptr : &nodes_[index_[pos].slot];
   }
-  const PriceLevel* best_ask() const {
-    if (!sell_levels_.empty()) return &sell_levels_.begin()->second;
-    return nullptr;
+
+  // 按时间顺序遍历价位上的委托，遍历过程中不能修改订单簿
+  template <class F>
+  void ForEachOrder(const PriceLevel& level, F&& f) const {
+    for (uint32_t i = level.head_; i != PriceLevel::kNil; i = nodes_[i].next_) {
+      f(nodes_[i]);
+    }
   }
-  void to_tick(TickData* tick);
 
-  void AddOrder(LimitOrder* order);
-  void ModifyOrder(LimitOrder* order);
-  void RemoveOrder(LimitOrder* order);
+  std::size_t size() const { return order_num_; }
+  uint32_t ticker_id() const { return tid_; }
 
  private:
-  PriceLevel* FndLevel(uint64_t decimal_price, bool is_buy) {
-    if (is_buy) {
-      auto it = buy_levels_.find(decimal_price);
-      if (it == buy_levels_.end()) return nullptr;
-      return &it->second;
-    } else {
-      auto it = sell_levels_.find(decimal_price);
-      if (it == sell_levels_.end()) return nullptr;
-      return &it->second;
+  static constexpr std::size_t kNotFound = static_cast<std::size_t>(-1);
+
+  struct IndexEntry {
+    uint64_t order_id = 0;
+    uint32_t slot = 0;
+  };
+
+  // 单边的价位，价格p对应的价位为levels[p & (levels.size() - 1)]
+  struct BookSide {
+    bool is_buy;
+    std::vector<PriceLevel> levels;
+    int64_t low = 0;  // 非空价位的范围，high - low < levels.size()
+    int64_t high = 0;
+    uint32_t level_num = 0;  // 非空价位数
+    int depth_num = 0;
+    int64_t depth[kMaxMarketLevel];  // 由优到劣的前kMaxMarketLevel个非空价位
+  };
+
+  BookSide& side_of(bool is_buy) { return is_buy ? bid_ : ask_; }
+
+  const PriceLevel* top_level(const BookSide& side, int i) const {
+    if (i >= side.depth_num) {
+      return nullptr;
     }
+    return &side.levels[side.depth[i] & (side.levels.size() - 1)];
   }
 
-  PriceLevel* FindOrCreateLevel(double price, uint64_t decimal_price, bool is_buy) {
-    if (is_buy)
-      return FindOrCreateLevel(&buy_levels_, price, decimal_price);
-    else
-      return FindOrCreateLevel(&sell_levels_, price, decimal_price);
-  }
+  int64_t to_tick_price(double price) const;
+
+  void Link(uint32_t idx);
+  void Unlink(uint32_t idx);
+  void ReserveLevel(BookSide* side, int64_t p);
+  void OnLevelCreated(BookSide* side, int64_t p);
+  void OnLevelRemoved(BookSide* side, int64_t p);
+
+  uint32_t AllocNode();
+  void FreeNode(uint32_t idx);
 
-  template <class LevelMap>
-  static PriceLevel* FindOrCreateLevel(LevelMap* level_map, double price, uint64_t decimal_price) {
-    PriceLevel* level;
-    auto it = level_map->find(decimal_price);
-    if (it == level_map->end()) {
-      auto res = level_map->emplace(decimal_price, price);
-      assert(res.second);
-      level = &res.first->second;
-    } else {
-      level = &it->second;
+  std::size_t find_index(uint64_t order_id) const {
+    if (order_id == 0) {
+      return kNotFound;
+    }
+    std::size_t pos = order_id & index_mask_;
+    for (;;) {
+      auto id = index_[pos].order_id;
+      if (id == order_id) return pos;
+      if (id == 0) return kNotFound;
+      pos = (pos + 1) & index_mask_;
     }
-    return level;
   }
+  void insert_index(uint64_t order_id, uint32_t slot);
+  void erase_index(std::size_t pos);
 
  private:
   uint32_t tid_;
-  std::unordered_map<uint64_t, LimitOrder> order_map_;
-  std::map<uint64_t, PriceLevel, std::greater<uint64_t>> buy_levels_;
-  std::map<uint64_t, PriceLevel, std::less<uint64_t>> sell_levels_;
+  double price_tick_;
+
+  std::vector<LimitOrder> nodes_;
+  uint32_t free_head_ = PriceLevel::kNil;
+  std::size_t order_num_ = 0;
+
+  std::vector<IndexEntry> index_;
+  std::size_t index_mask_;
+
+  BookSide bid_;
+  BookSide ask_;
 };
 
 }  // namespace ft::orderbook
@@ -3,30 +3,35 @@
 #ifndef FT_INCLUDE_FT_COMPONENT_ORDER_BOOK_PRICE_LEVEL_H_
 #define FT_INCLUDE_FT_COMPONENT_ORDER_BOOK_PRICE_LEVEL_H_
 
-#include <list>
+#include <cstdint>
 
 #include "ft/component/order_book/limit_order.h"
 
 namespace ft::orderbook {
 
+// 价位上的委托按时间顺序组成侵入式双向链表，链表节点为OrderBook节点池的下标
 class PriceLevel {
  public:
-  explicit PriceLevel(double price)
-      : price_(price), decimal_price_(price_double_to_decimal(price)) {}
-
-  void AddOrder(LimitOrder* order);
-  void ModifyOrder(LimitOrder* order);
-  void RemoveOrder(LimitOrder* order);
+  static constexpr uint32_t kNil = static_cast<uint32_t>(-1);
 
   double price() const { return price_; }
   uint64_t decimal_price() const { return decimal_price_; }
   int total_volume() const { return total_volume_; }
+  uint32_t order_num() const { return order_num_; }
+  bool empty() const { return order_num_ == 0; }
+
+  // 队首委托在节点池中的下标，价位为空时为kNil
+  uint32_t head() const { return head_; }
 
  private:
+  friend class OrderBook;
+
   double price_ = 0.0;
-  uint64_t decimal_price_;
+  uint64_t decimal_price_ = 0;
   int total_volume_ = 0;
-  std::list<LimitOrder> order_list_;
+  uint32_t order_num_ = 0;
+  uint32_t head_ = kNil;
+  uint32_t tail_ = kNil;
 };
 
 }  // namespace ft::orderbook
@@ -44,6 +44,12 @@ class PositionManager {
 
   const Position* GetPosition(const std::string& strategy, uint32_t ticker_id) const;
 
+  // 策略的仓位计算器，策略不存在时返回nullptr
+  const PositionCalculator* GetCalculator(const std::string& strategy) const {
+    auto it = st_pos_calculators_.find(strategy);
+    return it == st_pos_calculators_.end() ? nullptr : &it->second;
+  }
+
  private:
   PositionCalculator* FindCalculator(const std::string& strategy) {
     auto it = st_pos_calculators_.find(strategy);
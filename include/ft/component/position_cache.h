@@ -0,0 +1,132 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_COMPONENT_POSITION_CACHE_H_
+#define FT_INCLUDE_FT_COMPONENT_POSITION_CACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ft/base/trade_msg.h"
+#include "ft/utils/seqlock.h"
+
+namespace ft {
+
+// 共享内存中的持仓及资金缓存，每个(策略, 合约)的Position及账户的Account各由一个顺序锁保护
+// OMS在持仓或资金变化时写入，策略进程直接读取本地内存，不需要访问redis
+// 读接口与TraderDB一致，redis只用于持久化及重启后的恢复
+// 映射文件为./ft_position_cache.<name>
+class PositionCache {
+ public:
+  PositionCache() {}
+  ~PositionCache();
+
+  PositionCache(const PositionCache&) = delete;
+  PositionCache& operator=(const PositionCache&) = delete;
+
+  // 写端创建缓存，strategies为所有持仓池(包括公共池)，ticker_num为合约数量
+  // 已存在的缓存会被清空
+  bool Create(const std::string& name, const std::vector<std::string>& strategies,
+              uint32_t ticker_num);
+
+  // 读端以只读方式映射已存在的缓存
+  bool Open(const std::string& name);
+
+  // 以下写接口只能由一个写端调用
+  bool SetPosition(const std::string& strategy, const Position& pos);
+  bool SetPosition(uint32_t strategy_idx, const Position& pos) {
+    auto* slot = GetSlot(strategy_idx, pos.ticker_id);
+    if (!slot || !writable_) {
+      return false;
+    }
+    slot->pos.Store(pos);
+    return true;
+  }
+
+  bool SetAccount(const Account& account) {
+    if (!writable_) {
+      return false;
+    }
+    account_->account.Store(account);
+    return true;
+  }
+
+  // 与TraderDB::GetPosition一致，策略存在但还没有该合约的持仓时返回空持仓
+  bool GetPosition(const std::string& strategy, const std::string& ticker, Position* res) const;
+  bool GetPosition(uint32_t strategy_idx, uint32_t ticker_id, Position* res) const {
+    auto* slot = GetSlot(strategy_idx, ticker_id);
+    if (!slot) {
+      return false;
+    }
+    if (!slot->pos.Load(res)) {
+      *res = Position{};
+      res->ticker_id = ticker_id;
+    }
+    return true;
+  }
+
+  // 与TraderDB::GetAllPositions一致，只返回有过持仓变动的合约
+  bool GetAllPositions(const std::string& strategy, std::vector<Position>* res) const;
+
+  // 还没有查询到资金时返回false
+  bool GetAccount(Account* res) const { return account_ && account_->account.Load(res); }
+
+  // 策略名对应的下标，可以在初始化时查好，避免每次读取都比较字符串
+  bool FindStrategy(const std::string& strategy, uint32_t* strategy_idx) const;
+
+  uint32_t strategy_num() const { return strategy_num_; }
+  uint32_t ticker_num() const { return ticker_num_; }
+
+ private:
+  struct Header {
+    uint32_t magic;
+    uint32_t slot_size;
+    uint32_t strategy_num;
+    uint32_t ticker_num;
+  };
+
+  struct alignas(64) StrategySlot {
+    StrategyIdType name;
+  };
+
+  struct alignas(64) AccountSlot {
+    SeqLock<Account> account;
+  };
+
+  // 每个持仓独占cache line，避免不同持仓的读写互相影响
+  struct alignas(64) PositionSlot {
+    SeqLock<Position> pos;
+  };
+
+  static constexpr uint32_t kMagic = 0x706f7369;  // "posi"
+
+  // 布局: Header | StrategySlot * strategy_num | AccountSlot | PositionSlot * strategy_num *
+  // ticker_num，Header独占一个cache line
+  static std::size_t MappingSize(uint32_t strategy_num, uint32_t ticker_num) {
+    return 64 + strategy_num * sizeof(StrategySlot) + sizeof(AccountSlot) +
+           static_cast<std::size_t>(strategy_num) * ticker_num * sizeof(PositionSlot);
+  }
+
+  void Attach(void* addr, std::size_t size, bool writable);
+  void Close();
+
+  PositionSlot* GetSlot(uint32_t strategy_idx, uint32_t ticker_id) const {
+    if (strategy_idx >= strategy_num_ || ticker_id == 0 || ticker_id > ticker_num_) {
+      return nullptr;
+    }
+    return &positions_[strategy_idx * ticker_num_ + ticker_id - 1];
+  }
+
+  void* addr_ = nullptr;
+  std::size_t size_ = 0;
+  StrategySlot* strategies_ = nullptr;
+  AccountSlot* account_ = nullptr;
+  PositionSlot* positions_ = nullptr;
+  uint32_t strategy_num_ = 0;
+  uint32_t ticker_num_ = 0;
+  bool writable_ = false;
+};
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_COMPONENT_POSITION_CACHE_H_
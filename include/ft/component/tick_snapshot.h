@@ -0,0 +1,88 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_COMPONENT_TICK_SNAPSHOT_H_
+#define FT_INCLUDE_FT_COMPONENT_TICK_SNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+
+#include "ft/base/market_data.h"
+#include "ft/utils/seqlock.h"
+
+namespace ft {
+
+// 共享内存中的最新行情表，以ticker_id为下标，每个合约一个顺序锁保护的TickData
+// OMS行情线程写入，任何进程都可以无锁读取某个合约一致的最新快照，不需要消费md journal，
+// 适用于只关心最新行情的慢策略及监控工具
+// 映射文件为./ft_tick_snapshot.<name>
+class TickSnapshotTable {
+ public:
+  TickSnapshotTable() {}
+  ~TickSnapshotTable();
+
+  TickSnapshotTable(const TickSnapshotTable&) = delete;
+  TickSnapshotTable& operator=(const TickSnapshotTable&) = delete;
+
+  // 写端创建快照表，ticker_num为合约数量，已存在的表会被清空
+  bool Create(const std::string& name, uint32_t ticker_num);
+
+  // 读端以只读方式映射已存在的快照表
+  bool Open(const std::string& name);
+
+  // 只能由一个写端调用，ticker_id超出范围时返回false
+  bool Update(const TickData& tick) {
+    if (tick.ticker_id == 0 || tick.ticker_id > ticker_num_ || !writable_) {
+      return false;
+    }
+    slots_[tick.ticker_id - 1].tick.Store(tick);
+    return true;
+  }
+
+  // 读取最新快照，ticker_id不存在或该合约还没有行情时返回false
+  bool Get(uint32_t ticker_id, TickData* tick) const {
+    if (ticker_id == 0 || ticker_id > ticker_num_) {
+      return false;
+    }
+    return slots_[ticker_id - 1].tick.Load(tick);
+  }
+
+  // 该合约快照的更新次数
+  uint32_t version(uint32_t ticker_id) const {
+    if (ticker_id == 0 || ticker_id > ticker_num_) {
+      return 0;
+    }
+    return slots_[ticker_id - 1].tick.version();
+  }
+
+  uint32_t ticker_num() const { return ticker_num_; }
+
+ private:
+  struct Header {
+    uint32_t magic;
+    uint32_t slot_size;
+    uint32_t ticker_num;
+  };
+
+  // 每个合约独占cache line，避免不同合约的读写互相影响
+  struct alignas(64) Slot {
+    SeqLock<TickData> tick;
+  };
+
+  static constexpr uint32_t kMagic = 0x7469636b;  // "tick"
+
+  static std::size_t MappingSize(uint32_t ticker_num) {
+    return sizeof(Slot) + static_cast<std::size_t>(ticker_num) * sizeof(Slot);
+  }
+
+  void Close();
+
+  void* addr_ = nullptr;
+  std::size_t size_ = 0;
+  Slot* slots_ = nullptr;
+  uint32_t ticker_num_ = 0;
+  bool writable_ = false;
+};
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_COMPONENT_TICK_SNAPSHOT_H_
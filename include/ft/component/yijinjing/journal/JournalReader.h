@@ -45,16 +45,55 @@ class JournalReader : public JournalHandler {
   vector<IJournalVisitor*> visitors;
   /** map from journal short name to its idx */
   map<string, size_t> journalMap;
+
+  /** heap merge: journal heads with available frame, min-heap on (nano, idx) */
+  struct HeadEntry {
+    int64_t nano;
+    void* frame;
+    size_t idx;
+  };
+  bool heapMerge;
+  /** idle journals are polled again every idlePollInterval calls */
+  int idlePollInterval;
+  int idlePollCount;
+  /** journals changed outside (add/seek/expire), heap needs to be rebuilt */
+  bool mergeDirty;
+  /** heap top was passed last time, its next frame is located lazily
+   * because locating may release the page that last frame lives in */
+  bool topPassed;
+  vector<HeadEntry> heads;
+  /** journals with no available frame */
+  vector<size_t> idleJournals;
+
   /** private constructor */
   JournalReader(PageProviderPtr& ptr);
+  /** locate the frame with min nano and pass it,
+   * return nullptr if there is no new frame */
+  void* locateNextFrame();
+  /** heap version of locateNextFrame, O(log J) per frame */
+  void* locateNextFrameHeap();
+  void pollIdleJournals();
+  void siftUp(size_t pos);
+  void siftDown(size_t pos);
 
  public:
   /** [usage]: next frame, and process the frame */
   FramePtr getNextFrame();
+  /** [usage]: zero-copy version of getNextFrame, no heap allocation.
+   * return false if there is no new frame, otherwise frame points to
+   * the mmap'd frame, which keeps valid until next getNextFrame */
+  bool getNextFrame(Frame* frame);
   /** to keep the last time's getNextFrame's source. */
   string getFrameName() const;
   /** [usage]: keep looping and visiting */
   void startVisiting();
+  /** [usage]: merge journals with a min-heap over journal heads instead of
+   * scanning all journals on every call, cost per frame is O(log J).
+   * journals without new frame are skipped and polled again every
+   * idlePollInterval calls or when no journal has frame,
+   * idlePollInterval == 1 keeps exactly the same order as linear scan,
+   * larger value trades ordering accuracy of newly arrived frames for speed */
+  void enableHeapMerge(int idlePollInterval = 1);
 
   /** override JournalHandler's addJournal,
    * allow re-add journal with same name */
@@ -93,9 +132,12 @@ class JournalReader : public JournalHandler {
   ///    static const string PREFIX;
 };
 
-inline FramePtr JournalReader::getNextFrame() {
+inline void* JournalReader::locateNextFrame() {
+  if (heapMerge) return locateNextFrameHeap();
+
   int64_t minNano = TIME_TO_LAST;
   void* res_address = nullptr;
+  JournalPtr* res_journal = nullptr;
   for (JournalPtr& journal : journals) {
     FrameHeader* header = (FrameHeader*)(journal->locateFrame());
     if (header != nullptr) {
@@ -103,17 +145,33 @@ inline FramePtr JournalReader::getNextFrame() {
       if (minNano == TIME_TO_LAST || nano < minNano) {
         minNano = nano;
         res_address = header;
-        curJournal = journal;
+        res_journal = &journal;
       }
     }
   }
   if (res_address != nullptr) {
+    // avoid touching the shared_ptr's refcount when the source is unchanged
+    if (curJournal != *res_journal) curJournal = *res_journal;
     curJournal->passFrame();
+  }
+  return res_address;
+}
+
+inline FramePtr JournalReader::getNextFrame() {
+  void* res_address = locateNextFrame();
+  if (res_address != nullptr) {
     return FramePtr(new Frame(res_address));
   } else {
     return FramePtr();
   }
 }
 
+inline bool JournalReader::getNextFrame(Frame* frame) {
+  void* res_address = locateNextFrame();
+  if (res_address == nullptr) return false;
+  frame->set_address(res_address);
+  return true;
+}
+
 YJJ_NAMESPACE_END
 #endif  // YIJINJING_JOURNALREADER_H
@@ -28,6 +28,7 @@
 #include "ft/component/yijinjing/journal/JournalHandler.h"
 //#include "FrameHeader.h"
 #include "ft/component/yijinjing/journal/Frame.hpp"
+#include "ft/component/yijinjing/journal/PageProvider.h"
 
 YJJ_NAMESPACE_START
 
@@ -67,6 +68,20 @@ class JournalWriter : public JournalHandler {
     return write_frame(&data, sizeof(T), msgType, lastFlag);
   }
 
+  /** write the same frame into journals of multiple writers (fan-out).
+   * one timestamp is taken for the whole batch, frames in all journals are
+   * filled first and then published together.
+   * writers must be distinct, otherwise the same frame would be located twice */
+  static int64_t write_frame_multi(JournalWriter* const* writers, size_t num, const void* data,
+                                   FH_TYPE_LENGTH length, FH_TYPE_MSG_TP msgType,
+                                   FH_TYPE_LASTFG lastFlag);
+
+  template <typename T>
+  static inline int64_t write_data_multi(JournalWriter* const* writers, size_t num, const T& data,
+                                         FH_TYPE_MSG_TP msgType, FH_TYPE_LASTFG lastFlag) {
+    return write_frame_multi(writers, num, &data, sizeof(T), msgType, lastFlag);
+  }
+
   /*data is copied to frame from elsewhere (may avoid double copy where preparing data)*/
   /** get next writable frame address */
   Frame locateFrame();
@@ -77,6 +92,9 @@ class JournalWriter : public JournalHandler {
  public:
   // creators
   static JournalWriterPtr create(const string& dir, const string& jname, const string& writerName);
+  /** create writer whose new pages follow pageConfig */
+  static JournalWriterPtr create(const string& dir, const string& jname, const string& writerName,
+                                 const PageConfig& pageConfig);
   static JournalWriterPtr create(const string& dir, const string& jname, PageProviderPtr& ptr);
 
  public:
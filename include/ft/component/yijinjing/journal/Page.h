@@ -47,9 +47,13 @@ class Page {
   int frameNum;
   /** number of the page for the journal */
   short pageNum;
+  /** size of the mmap-file, fixed when the page is created */
+  const int pageSize;
+  /** writable frame must start before this position (pageSize - headroom) */
+  const int writableEnd;
 
   /** private constructor */
-  Page(void* buffer);
+  Page(void* buffer, int pageSize);
 
  private:
   /** internal usage */
@@ -60,6 +64,8 @@ class Page {
   inline void* getBuffer() { return buffer; }
   /** get current page number */
   inline short getPageNum() const { return pageNum; };
+  /** get size of the page file */
+  inline int getPageSize() const { return pageSize; }
 
   /** setup the page when finished */
   void finishPage();
@@ -79,9 +85,16 @@ class Page {
 
  public:
   /** load page, should be called by PageProvider
-   * will not lock memory if in quickMode (locked by page engine service)*/
+   * will not lock memory if in quickMode (locked by page engine service)
+   * pageSize only takes effect when writer creates a new page,
+   * size of an existing page is always taken from the file
+   * hugePage: madvise(MADV_HUGEPAGE) on the page before writer touches it */
   static PagePtr load(const string& dir, const string& jname, short pageNum, bool isWriting,
-                      bool quickMode);
+                      bool quickMode, int pageSize = JOURNAL_PAGE_SIZE, bool hugePage = false);
+  /** setup page on an already mapped buffer (e.g. pre-allocated page),
+   * return nullptr if the page is not initialized and not for writing */
+  static PagePtr attach(void* buffer, const string& jname, short pageNum, bool isWriting,
+                        int pageSize);
 };
 
 inline bool Page::isAtPageEnd() const { return getCurStatus() == JOURNAL_FRAME_STATUS_PAGE_END; }
@@ -102,7 +115,7 @@ inline void Page::passToTime(int64_t time) {
 inline void* Page::locateWritableFrame() {
   passWrittenFrame();
   return (getCurStatus() == JOURNAL_FRAME_STATUS_RAW &&
-          (position + PAGE_MIN_HEADROOM < JOURNAL_PAGE_SIZE))
+          (position < writableEnd))
              ? frame.get_address()
              : nullptr;
 }
@@ -0,0 +1,78 @@
+/*****************************************************************************
+ * Copyright [2017] [taurus.ai]
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+/**
+ * Page Preallocator.
+ * create, pre-fault and mlock the next page of a journal in background,
+ * and unmap the finished page in background,
+ * so that writer won't take page faults or munmap on the hot path after page rollover.
+ * the page is prepared as "<page path>.prealloc" (invisible to readers),
+ * and renamed to the real page path when writer takes it.
+ */
+
+#ifndef YIJINJING_PAGEPREALLOCATOR_H
+#define YIJINJING_PAGEPREALLOCATOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "ft/component/yijinjing/utils/YJJ_DECLARE.h"
+
+YJJ_NAMESPACE_START
+
+class PagePreallocator {
+ private:
+  struct Task {
+    int size;
+    bool hugePage;
+    bool ready;
+    void* buffer;
+  };
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  /** page path -> task */
+  map<string, Task> tasks;
+  /** page paths waiting to be prepared */
+  std::deque<string> pending;
+  /** finished pages waiting to be released */
+  std::deque<std::pair<void*, int>> releasing;
+  bool stopped;
+  std::thread worker;
+
+  PagePreallocator();
+  ~PagePreallocator();
+  void run();
+  /** create and pre-fault the file, return nullptr if failed */
+  static void* prepare(const string& path, int size, bool hugePage);
+
+ public:
+  /** one background thread per process */
+  static PagePreallocator& instance();
+  /** prepare the page in background, ignored if the page already exists */
+  void request(const string& path, int size, bool hugePage);
+  /** take the prepared page, wait if it is still being prepared.
+   * return nullptr if the page was not requested or failed to prepare */
+  void* take(const string& path, int size);
+  /** munlock and munmap the page in background */
+  void release(void* buffer, int size);
+};
+
+YJJ_NAMESPACE_END
+
+#endif  // YIJINJING_PAGEPREALLOCATOR_H
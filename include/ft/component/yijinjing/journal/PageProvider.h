@@ -24,9 +24,25 @@
 #define YIJINJING_PAGEPROVIDER_H
 
 #include "ft/component/yijinjing/utils/YJJ_DECLARE.h"
+#include "ft/component/yijinjing/utils/constants.h"
 
 YJJ_NAMESPACE_START
 
+/**
+ * PageConfig,
+ * how writer creates new pages, readers always follow the page file
+ */
+struct PageConfig {
+  /** size of new page, multiple of 4KB (2MB if hugePage) and >= JOURNAL_MIN_PAGE_SIZE */
+  int pageSize = JOURNAL_PAGE_SIZE;
+  /** create, pre-fault and mlock next page in background before current page ends */
+  bool preallocate = false;
+  /** madvise(MADV_HUGEPAGE) on new page, with or without preallocate,
+   * takes effect only if journal directory is on tmpfs mounted with huge=advise
+   * (or hugetlbfs) */
+  bool hugePage = false;
+};
+
 /**
  * PageProvider,
  * provide page via memory service, socket & comm
@@ -42,6 +58,7 @@ class PageProvider {
   const string client_name;
   void* comm_buffer;
   int hash_code;
+  const PageConfig page_config;
 
  public:
   /** return true if this is for writing */
@@ -53,7 +70,8 @@ class PageProvider {
 
  public:
   /** default constructor with client name and writing flag */
-  PageProvider(const string& clientName, bool isWriting);
+  PageProvider(const string& clientName, bool isWriting,
+               const PageConfig& pageConfig = PageConfig());
 
   /** register journal when added into JournalHandler */
   int register_journal(const string& dir, const string& jname);
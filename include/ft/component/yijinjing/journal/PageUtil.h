@@ -70,6 +70,8 @@ class PageUtil {
 
   // file
   static bool FileExists(const string& filename);
+  /** return size of the file, -1 if not exists */
+  static int GetFileSize(const string& filename);
 };
 
 YJJ_NAMESPACE_END
@@ -6,8 +6,11 @@
 #include <cassert>
 #include <string>
 
+#include "ft/base/contract_table.h"
 #include "ft/base/market_data.h"
 #include "ft/base/trade_msg.h"
+#include "ft/component/position/calculator.h"
+#include "ft/component/position_cache.h"
 #include "ft/component/trader_db.h"
 #include "ft/strategy/order_sender.h"
 
@@ -31,6 +34,14 @@ class AlgoOrderEngine {
 
   void SetTraderDB(TraderDB* trader_db) { trader_db_ = trader_db; }
 
+  // 设置后从共享内存读取持仓，不再访问redis
+  void SetPositionCache(const PositionCache* position_cache) { position_cache_ = position_cache; }
+
+  // 进程内回测时直接读取模拟网关计算的持仓，优先于共享内存及redis
+  void SetPositionCalculator(const PositionCalculator* positions) {
+    in_process_positions_ = positions;
+  }
+
   void SendOrder(uint32_t ticker_id, int volume, Direction direction, Offset offset, OrderType type,
                  double price, uint32_t client_order_id) {
     assert(order_sender_);
@@ -42,6 +53,18 @@ class AlgoOrderEngine {
   Position GetPosition(const std::string& ticker) const {
     Position ret{};
 
+    if (in_process_positions_) {
+      auto* contract = ContractTable::get_by_ticker(ticker);
+      auto* p = contract ? in_process_positions_->GetPosition(contract->ticker_id) : nullptr;
+      if (p) {
+        ret = *p;
+      }
+      return ret;
+    }
+    if (position_cache_) {
+      position_cache_->GetPosition(strategy_name_, ticker, &ret);
+      return ret;
+    }
     assert(trader_db_);
     trader_db_->GetPosition(strategy_name_, ticker, &ret);
     return ret;
@@ -51,6 +74,8 @@ class AlgoOrderEngine {
   std::string strategy_name_;
   OrderSender* order_sender_;
   TraderDB* trader_db_;
+  const PositionCache* position_cache_ = nullptr;
+  const PositionCalculator* in_process_positions_ = nullptr;
 };
 
 }  // namespace ft
@@ -8,16 +8,31 @@
 
 #include "ft/base/contract_table.h"
 #include "ft/base/trade_msg.h"
-#include "ft/component/yijinjing/journal/JournalWriter.h"
+#include "ft/component/journal_channel.h"
+#include "ft/component/latency_stats.h"
+#include "ft/component/position/calculator.h"
+#include "ft/utils/wait_strategy.h"
 
 namespace ft {
 
+// 进程内回测时指令直接交给OMS，不写入journal
+class TraderCmdSink {
+ public:
+  virtual ~TraderCmdSink() {}
+
+  virtual void OnTraderCmd(const TraderCommand& cmd) = 0;
+
+  // 不为nullptr时策略从这里查询持仓，不再需要position cache或redis
+  virtual const PositionCalculator* positions() const { return nullptr; }
+};
+
 class OrderSender {
  public:
   OrderSender() {}
 
-  void Init(const std::string& trade_mq_name) {
-    cmd_sender_ = yijinjing::JournalWriter::create(".", trade_mq_name, "order_sender");
+  void Init(const std::string& trade_mq_name,
+            const yijinjing::PageConfig& page_config = yijinjing::PageConfig()) {
+    cmd_sender_ = yijinjing::JournalWriter::create(".", trade_mq_name, "order_sender", page_config);
   }
 
   void SetStrategyId(const std::string& strategy_id) {
@@ -27,6 +42,19 @@ class OrderSender {
 
   void SetOrderFlag(OrderFlag flags) { flags_ = flags; }
 
+  // 写入指令后通过notifier唤醒OMS，为nullptr时不唤醒
+  void SetNotifier(Notifier* notifier) { notifier_ = notifier; }
+
+  // 设置后指令交给cmd_sink，不再写入journal，不需要调用Init
+  void SetCmdSink(TraderCmdSink* cmd_sink) { cmd_sink_ = cmd_sink; }
+
+  // 策略处理行情期间设置为该行情的打点，期间发出的订单统计从收到行情到写入指令的耗时，
+  // 并把行情的打点带给OMS统计tick-to-trade。处理完后设置为0
+  void SetTriggerTick(uint64_t tick_recv_tsc, uint64_t strategy_recv_tsc) {
+    tick_recv_tsc_ = tick_recv_tsc;
+    strategy_recv_tsc_ = strategy_recv_tsc;
+  }
+
   void BuyOpen(const std::string& ticker, int volume, double price,
                OrderType type = OrderType::kFak, uint32_t client_order_id = 0,
                uint64_t timestamp_us = 0) {
@@ -95,8 +123,11 @@ class OrderSender {
     cmd.order_req.type = type;
     cmd.order_req.price = price;
     cmd.order_req.flags = flags_;
+    cmd.tick_recv_tsc = tick_recv_tsc_;
+    cmd.write_tsc = RdTsc();
+    RecordLatency(kLatencyCmdWrite, strategy_recv_tsc_, cmd.write_tsc);
 
-    cmd_sender_->write_data(cmd, 0, 0);
+    SendCmd(cmd);
   }
 
   void SendOrder(const std::string& ticker, int volume, Direction direction, Offset offset,
@@ -116,7 +147,7 @@ class OrderSender {
     cmd.without_check = false;
     cmd.cancel_req.order_id = order_id;
 
-    cmd_sender_->write_data(cmd, 0, 0);
+    SendCmd(cmd);
   }
 
   void CancelForTicker(const std::string& ticker) {
@@ -128,7 +159,7 @@ class OrderSender {
     cmd.without_check = false;
     cmd.cancel_ticker_req.ticker_id = contract->ticker_id;
 
-    cmd_sender_->write_data(cmd, 0, 0);
+    SendCmd(cmd);
   }
 
   void CancelAll() {
@@ -137,7 +168,7 @@ class OrderSender {
     cmd.type = TraderCmdType::kCancelAll;
     cmd.without_check = false;
 
-    cmd_sender_->write_data(cmd, 0, 0);
+    SendCmd(cmd);
   }
 
   void SendNotification(uint64_t signal) {
@@ -146,14 +177,30 @@ class OrderSender {
     cmd.type = TraderCmdType::kNotify;
     cmd.notification.signal = signal;
 
-    cmd_sender_->write_data(cmd, 0, 0);
+    SendCmd(cmd);
+  }
+
+ private:
+  void SendCmd(const TraderCommand& cmd) {
+    if (cmd_sink_) {
+      cmd_sink_->OnTraderCmd(cmd);
+      return;
+    }
+    WriteMsg(cmd_sender_.get(), cmd);
+    if (notifier_) {
+      notifier_->Notify();
+    }
   }
 
  private:
   StrategyIdType strategy_id_;
   yijinjing::JournalWriterPtr cmd_sender_;
+  Notifier* notifier_ = nullptr;
+  TraderCmdSink* cmd_sink_ = nullptr;
   std::string ft_cmd_topic_;
   OrderFlag flags_{0};
+  uint64_t tick_recv_tsc_ = 0;
+  uint64_t strategy_recv_tsc_ = 0;
 };
 
 }  // namespace ft
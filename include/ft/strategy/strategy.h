@@ -3,6 +3,7 @@
 #ifndef FT_INCLUDE_FT_STRATEGY_STRATEGY_H_
 #define FT_INCLUDE_FT_STRATEGY_STRATEGY_H_
 
+#include <map>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -10,12 +11,17 @@
 #include "ft/base/config.h"
 #include "ft/base/market_data.h"
 #include "ft/base/trade_msg.h"
+#include "ft/base/contract_table.h"
+#include "ft/component/conflated_md_channel.h"
+#include "ft/component/journal_channel.h"
+#include "ft/component/latency_stats.h"
+#include "ft/component/position_cache.h"
+#include "ft/component/tick_snapshot.h"
 #include "ft/component/trader_db.h"
-#include "ft/component/yijinjing/journal/JournalReader.h"
-#include "ft/component/yijinjing/journal/JournalWriter.h"
 #include "ft/strategy/algo_order/algo_order_engine.h"
 #include "ft/strategy/order_sender.h"
 #include "ft/utils/spinlock.h"
+#include "ft/utils/wait_strategy.h"
 
 namespace ft {
 
@@ -28,6 +34,21 @@ class StrategyRunner {
   virtual void Run() = 0;
 
   virtual void RunBacktest() = 0;
+
+  // 以下用于进程内回测(ft_backtest)，策略与OMS运行在同一线程中，
+  // 指令通过cmd_sink直接交给OMS，行情及回报由ft_backtest直接传入
+  virtual bool InitInProcess(const StrategyConfig& config, const FlareTraderConfig& ft_config,
+                             TraderCmdSink* cmd_sink) {
+    return false;
+  }
+
+  virtual void Start() {}
+
+  virtual void Stop() {}
+
+  virtual void DispatchTick(const TickData& tick) {}
+
+  virtual void DispatchOrderResponse(const OrderResponse& rsp) {}
 };
 
 class Strategy : public StrategyRunner {
@@ -40,6 +61,17 @@ class Strategy : public StrategyRunner {
 
   void RunBacktest() override;
 
+  bool InitInProcess(const StrategyConfig& config, const FlareTraderConfig& ft_config,
+                     TraderCmdSink* cmd_sink) override;
+
+  void Start() override { OnInit(); }
+
+  void Stop() override { OnExit(); }
+
+  void DispatchTick(const TickData& tick) override { OnTickMsg(tick); }
+
+  void DispatchOrderResponse(const OrderResponse& rsp) override { OnOrderResponse(rsp); }
+
   virtual void OnInit() {}
 
   virtual void OnTick(const TickData& tick) {}
@@ -68,11 +100,16 @@ class Strategy : public StrategyRunner {
   }
 
   void OnTickMsg(const TickData& tick) {
+    uint64_t recv_tsc = RdTsc();
+    RecordLatency(kLatencyStrategyRecv, tick.dispatch_tsc, recv_tsc);
+
     std::unique_lock<SpinLock> lock(spinlock_);
+    sender_.SetTriggerTick(tick.recv_tsc, recv_tsc);
     for (auto algo_order_engine : algo_order_engines_) {
       algo_order_engine->OnTick(tick);
     }
     OnTick(tick);
+    sender_.SetTriggerTick(0, 0);
   }
 
   void RegisterAlgoOrderEngine(AlgoOrderEngine* engine);
@@ -115,15 +152,49 @@ class Strategy : public StrategyRunner {
 
   void SendNotification(uint64_t signal) { sender_.SendNotification(signal); }
 
+  // 开启global.position_cache时从共享内存读取，否则查询redis
   Position GetPosition(const std::string& ticker) const {
     Position pos{};
-    trader_db_.GetPosition(strategy_id_, ticker, &pos);
+    if (in_process_positions_) {
+      auto* contract = ContractTable::get_by_ticker(ticker);
+      auto* p = contract ? in_process_positions_->GetPosition(contract->ticker_id) : nullptr;
+      if (p) {
+        pos = *p;
+      }
+    } else if (use_position_cache_) {
+      position_cache_.GetPosition(strategy_id_, ticker, &pos);
+    } else {
+      trader_db_.GetPosition(strategy_id_, ticker, &pos);
+    }
     return pos;
   }
 
+  // 需开启global.position_cache，OMS还没有查询到资金时返回false
+  bool GetAccount(Account* account) const { return position_cache_.GetAccount(account); }
+
+  // 从共享内存快照表中读取最新行情，不经过md journal，需开启global.tick_snapshot
+  // 合约不存在或还没有行情时返回false
+  bool GetLatestTick(const std::string& ticker, TickData* tick) const {
+    auto contract = ContractTable::get_by_ticker(ticker);
+    return contract && tick_snapshot_.Get(contract->ticker_id, tick);
+  }
+
+  bool GetLatestTick(uint32_t ticker_id, TickData* tick) const {
+    return tick_snapshot_.Get(ticker_id, tick);
+  }
+
   uint64_t GetAccountId() const { return account_id_; }
 
+  // 配置文件中strategy_list的params，参数不存在时返回default_value
+  std::string GetParam(const std::string& name, const std::string& default_value = "") const {
+    auto it = params_.find(name);
+    return it == params_.end() ? default_value : it->second;
+  }
+
  private:
+  // 初始化Init及InitInProcess共用的部分
+  bool InitCommon(const StrategyConfig& config, const FlareTraderConfig& ft_config);
+
   void SendOrder(const std::string& ticker, int volume, Direction direction, Offset offset,
                  OrderType type, double price, uint32_t client_order_id, uint64_t timestamp_us) {
     sender_.SendOrder(ticker, volume, direction, offset, type, price, client_order_id,
@@ -135,8 +206,20 @@ class Strategy : public StrategyRunner {
   StrategyIdType strategy_id_;
   OrderSender sender_;
   TraderDB trader_db_;
-  yijinjing::JournalReaderPtr md_reader_;
-  yijinjing::JournalReaderPtr rsp_reader_;
+  PositionCache position_cache_;
+  bool use_position_cache_ = false;
+  const PositionCalculator* in_process_positions_ = nullptr;
+  std::map<std::string, std::string> params_;
+  // 行情及订单回报通过同一个cursor按时间顺序读取，根据msg_type分发
+  TypedJournalReader<TickData, OrderResponse> reader_;
+  // 开启conflate_md时行情从这里读取，优先处理订单回报
+  ConflatedMdChannel conflated_md_;
+  bool conflate_md_ = false;
+  WaitStrategy wait_strategy_;
+  Notifier notifier_;      // OMS写入行情及回报后唤醒策略
+  Notifier oms_notifier_;  // 写入指令后唤醒OMS
+  TickSnapshotTable tick_snapshot_;
+  LatencyStats latency_stats_;
 
   SpinLock spinlock_;
   std::vector<AlgoOrderEngine*> algo_order_engines_;
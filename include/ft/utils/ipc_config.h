@@ -0,0 +1,33 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_UTILS_IPC_CONFIG_H_
+#define FT_INCLUDE_FT_UTILS_IPC_CONFIG_H_
+
+#include <string>
+
+namespace ft {
+
+// OMS与策略之间的进程间通信对象(notifier及共享内存页)的命名
+
+// OMS核心线程及策略所等待的notifier名，写端写入消息后通过同名的notifier唤醒读端
+std::string GetOmsNotifierName(const std::string& investor_id);
+std::string GetStrategyNotifierName(const std::string& strategy_name);
+
+// 行情快照表名，同一个账户的OMS及策略共用
+std::string GetTickSnapshotName(const std::string& investor_id);
+
+// 持仓及资金缓存名，同一个账户的OMS及策略共用
+std::string GetPositionCacheName(const std::string& investor_id);
+
+// 延迟统计页名，同一个账户的OMS及策略共用
+std::string GetLatencyStatsName(const std::string& investor_id);
+
+// 报撤单计数页名，OMS重启后从中恢复当日的计数
+std::string GetCancelRatioName(const std::string& investor_id);
+
+// 策略的合并行情通道名
+std::string GetConflatedMdChannelName(const std::string& strategy_name);
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_UTILS_IPC_CONFIG_H_
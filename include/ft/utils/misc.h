@@ -3,6 +3,9 @@
 #ifndef FT_INCLUDE_FT_UTILS_MISC_H_
 #define FT_INCLUDE_FT_UTILS_MISC_H_
 
+#include <pthread.h>
+#include <sched.h>
+
 #define UNUSED(x) ((void)(x))
 
 namespace ft {
@@ -13,6 +16,14 @@ bool IsEqual(const RealType& lhs, const RealType& rhs, RealType error = RealType
   return rhs - error <= lhs && lhs <= rhs + error;
 }
 
+// 将当前线程绑定到指定的CPU核上
+inline bool SetCpuAffinity(int cpu_id) {
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  CPU_SET(cpu_id, &mask);
+  return 0 == pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+}
+
 }  // namespace ft
 
 #endif  // FT_INCLUDE_FT_UTILS_MISC_H_
@@ -0,0 +1,64 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_UTILS_SEQLOCK_H_
+#define FT_INCLUDE_FT_UTILS_SEQLOCK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "ft/utils/wait_strategy.h"
+
+namespace ft {
+
+// 单写者多读者的顺序锁，适用于只关心最新值的小对象(行情快照、持仓等)
+// 写端不会被读端阻塞，读端读到写入中途的数据时重试，读写均不进入内核
+// 只包含POD数据，可以直接放在共享内存中供不同进程读写
+template <class T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+ public:
+  // 只能由一个写端调用
+  void Store(const T& value) {
+    uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&value_, &value, sizeof(T));
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  // 从未写入过时返回false，version不为空时返回读到的数据对应的写入次数
+  bool Load(T* value, uint32_t* version = nullptr) const {
+    for (;;) {
+      uint32_t seq0 = seq_.load(std::memory_order_acquire);
+      if (seq0 & 1) {
+        CpuPause();
+        continue;
+      }
+      if (seq0 == 0) {
+        return false;
+      }
+      memcpy(value, &value_, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == seq0) {
+        if (version) {
+          *version = seq0 >> 1;
+        }
+        return true;
+      }
+    }
+  }
+
+  // 写入次数，可用于判断数据是否有更新
+  uint32_t version() const { return seq_.load(std::memory_order_acquire) >> 1; }
+
+ private:
+  std::atomic<uint32_t> seq_{0};
+  T value_;
+};
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_UTILS_SEQLOCK_H_
@@ -0,0 +1,46 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_UTILS_TSC_H_
+#define FT_INCLUDE_FT_UTILS_TSC_H_
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace ft {
+
+// 读取CPU时间戳计数器，只用于统计耗时，开销为几纳秒
+// 要求CPU支持constant_tsc及nonstop_tsc(现代x86均支持)，此时不同核心、不同进程读到的
+// 计数来自同一时钟，可以直接相减。rdtsc不是序列化指令，单次结果可能有几十个周期的误差
+inline uint64_t RdTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t tsc;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(tsc));
+  return tsc;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+// 以steady_clock为基准测量每纳秒的tsc计数，会阻塞当前线程约duration_ms毫秒
+inline double MeasureTscPerNs(int duration_ms = 50) {
+  auto t0 = std::chrono::steady_clock::now();
+  uint64_t tsc0 = RdTsc();
+  std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+  auto t1 = std::chrono::steady_clock::now();
+  uint64_t tsc1 = RdTsc();
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+  return ns > 0 ? static_cast<double>(tsc1 - tsc0) / ns : 1.0;
+}
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_UTILS_TSC_H_
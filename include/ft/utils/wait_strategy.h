@@ -0,0 +1,144 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_INCLUDE_FT_UTILS_WAIT_STRATEGY_H_
+#define FT_INCLUDE_FT_UTILS_WAIT_STRATEGY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace ft {
+
+inline void CpuPause() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// 消费者在没有新消息时的等待方式
+// kBusySpin: 一直自旋，延迟最低，独占一个核
+// kSpinYield: 自旋spin_count次后每次sched_yield
+// kSpinFutex: 自旋spin_count次后在notifier上futex wait，由写端唤醒
+// kSpinEventFd: 自旋spin_count次后在eventfd上阻塞，只适用于进程内的notifier，
+//               跨进程的notifier会退化为futex
+enum class WaitStrategyType {
+  kBusySpin,
+  kSpinYield,
+  kSpinFutex,
+  kSpinEventFd,
+};
+
+// name为busy_spin/spin_yield/futex/eventfd
+bool ParseWaitStrategyType(const std::string& name, WaitStrategyType* type);
+
+struct WaitStrategy {
+  WaitStrategyType type = WaitStrategyType::kBusySpin;
+  uint32_t spin_count = 1000;
+  uint32_t timeout_us = 1000;  // 阻塞等待的超时时间，防止写端异常退出后无法醒来
+};
+
+// 写端写入消息后调用Notify唤醒阻塞的读端
+// 只有存在阻塞的读端时才会进入内核，否则只有一次原子加及一次原子读
+// 一个notifier可以对应多个消息源，如OMS的核心线程同时等待所有策略的指令及gateway的回报
+// 每个阻塞的读端线程占用一个slot，阻塞期间置位对应的bit。读端在阻塞时被杀掉会留下置位的bit，
+// 写端唤醒不到任何线程时检查slot的持有线程是否还存在，清除已退出线程的bit，
+// 避免之后每次Notify都进入内核
+class Notifier {
+ public:
+  static constexpr uint32_t kMaxWaiters = 32;
+
+  Notifier() {}
+  ~Notifier();
+
+  Notifier(const Notifier&) = delete;
+  Notifier& operator=(const Notifier&) = delete;
+
+  // 映射./ft_notifier.<name>，供不同进程的读写端共享
+  bool OpenShared(const std::string& name);
+
+  // 为进程内的notifier创建eventfd，使读端可以通过kSpinEventFd等待
+  bool EnableEventFd();
+
+  void Notify() {
+    state_->seq.fetch_add(1, std::memory_order_seq_cst);
+    if (state_->waiters.load(std::memory_order_seq_cst) > 0) {
+      Wake();
+    }
+  }
+
+  // 是否有阻塞中的读端
+  bool has_waiters() const { return state_->waiters.load(std::memory_order_acquire) != 0; }
+
+ private:
+  friend class Waiter;
+
+  struct State {
+    std::atomic<uint32_t> seq{0};
+    std::atomic<uint32_t> waiters{0};  // 正在阻塞的slot的位图
+    // slot的持有线程，(pid << 32) | tid，0为空闲
+    std::atomic<uint64_t> owners[kMaxWaiters] = {};
+  };
+
+  void Wake();
+
+  // 清除持有线程已退出的slot
+  void ReapWaiters();
+
+  // 为当前线程分配slot，没有空闲slot时返回-1
+  int AcquireSlot();
+
+  State local_state_;
+  State* state_ = &local_state_;
+  int efd_ = -1;
+};
+
+// 读端的等待器。典型用法:
+//   for (;;) {
+//     if (Poll()) waiter.Reset(); else waiter.Wait();
+//   }
+class Waiter {
+ public:
+  Waiter() {}
+
+  Waiter(const WaitStrategy& strategy, Notifier* notifier)
+      : strategy_(strategy), notifier_(notifier) {
+    if (notifier_) {
+      seq_ = notifier_->state_->seq.load(std::memory_order_acquire);
+    }
+  }
+
+  // 读到消息后调用
+  void Reset() {
+    idle_count_ = 0;
+    if (notifier_) {
+      seq_ = notifier_->state_->seq.load(std::memory_order_acquire);
+    }
+  }
+
+  // 没有读到消息时调用，阻塞等待时需要在同一个线程中调用
+  void Wait() {
+    if (strategy_.type == WaitStrategyType::kBusySpin || ++idle_count_ <= strategy_.spin_count) {
+      CpuPause();
+      if (notifier_) {
+        seq_ = notifier_->state_->seq.load(std::memory_order_acquire);
+      }
+      return;
+    }
+    WaitSlow();
+  }
+
+ private:
+  void WaitSlow();
+
+  WaitStrategy strategy_{};
+  Notifier* notifier_ = nullptr;
+  uint32_t idle_count_ = 0;
+  uint32_t seq_ = 0;  // 上一次检查消息源之前notifier的序号
+  int slot_ = -1;     // 第一次阻塞时分配
+};
+
+}  // namespace ft
+
+#endif  // FT_INCLUDE_FT_UTILS_WAIT_STRATEGY_H_
@@ -0,0 +1,136 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "backtest/backtest_runner.h"
+
+#include <utility>
+
+#include "ft/base/log.h"
+
+namespace ft {
+
+BacktestRunner::BacktestRunner() {}
+
+BacktestRunner::~BacktestRunner() {}
+
+bool BacktestRunner::Init(const FlareTraderConfig& config) {
+  if (config.gateway_config.api != "backtest") {
+    LOG_ERROR("[BacktestRunner::Init] gateway api must be backtest");
+    return false;
+  }
+
+  config_ = &config;
+  oms_ = std::make_unique<OrderManagementSystem>();
+  if (!oms_->Init(config, this)) {
+    LOG_ERROR("[BacktestRunner::Init] failed to init oms");
+    return false;
+  }
+
+  strategies_.resize(config.strategy_config_list.size(), nullptr);
+  feed_cmd_.magic = kTradingCmdMagic;
+  feed_cmd_.type = TraderCmdType::kNotify;
+  return true;
+}
+
+bool BacktestRunner::AddStrategy(const std::string& strategy_name, StrategyRunner* strategy) {
+  auto& strategy_confs = config_->strategy_config_list;
+  for (uint32_t i = 0; i < strategy_confs.size(); ++i) {
+    if (strategy_confs[i].strategy_name != strategy_name) {
+      continue;
+    }
+    if (strategies_[i]) {
+      LOG_ERROR("[BacktestRunner::AddStrategy] duplicated strategy {}", strategy_name);
+      return false;
+    }
+
+    auto cmd_sink = std::make_unique<CmdSink>();
+    cmd_sink->runner = this;
+    cmd_sink->strategy_idx = i;
+    cmd_sink->pos_calculator = oms_->GetStrategyPositions(strategy_name);
+    if (!strategy->InitInProcess(strategy_confs[i], *config_, cmd_sink.get())) {
+      LOG_ERROR("[BacktestRunner::AddStrategy] failed to init strategy {}", strategy_name);
+      return false;
+    }
+    strategies_[i] = strategy;
+    cmd_sinks_.emplace_back(std::move(cmd_sink));
+    return true;
+  }
+
+  LOG_ERROR("[BacktestRunner::AddStrategy] strategy config not found. strategy name: {}",
+            strategy_name);
+  return false;
+}
+
+void BacktestRunner::Run() {
+  for (auto* strategy : strategies_) {
+    if (strategy) {
+      strategy->Start();
+    }
+  }
+  Drain();
+
+  for (;;) {
+    // BacktestGateway每收到一个通知推送一个tick，没有tick时说明行情已经回放完
+    oms_->ExecuteCmd(feed_cmd_, 0);
+    if (Drain() == 0) {
+      break;
+    }
+
+    if (last_tick_time_us_ >= last_query_time_us_ + kQueryAccountIntervalUs) {
+      last_query_time_us_ = last_tick_time_us_;
+      oms_->QueryAccount();
+      Drain();
+    }
+  }
+
+  for (auto* strategy : strategies_) {
+    if (strategy) {
+      strategy->Stop();
+    }
+  }
+  Drain();
+  LOG_INFO("[BacktestRunner::Run] finished. ticks:{} responses:{}", tick_num_, rsp_num_);
+}
+
+std::size_t BacktestRunner::Drain() {
+  std::size_t tick_count = 0;
+  for (;;) {
+    bool busy = false;
+    tick_count += oms_->PollTicks();
+
+    // 策略在回调中发出的指令先缓存，在OMS处理完当前消息之后再执行
+    while (!pending_cmds_.empty()) {
+      busy = true;
+      std::swap(pending_cmds_, executing_cmds_);
+      for (auto& pending_cmd : executing_cmds_) {
+        oms_->ExecuteCmd(pending_cmd.cmd, pending_cmd.strategy_idx);
+      }
+      executing_cmds_.clear();
+      tick_count += oms_->PollTicks();
+    }
+
+    busy |= oms_->PollResponses();
+    if (!busy) {
+      break;
+    }
+  }
+  return tick_count;
+}
+
+void BacktestRunner::OnTick(uint32_t strategy_idx, const TickData& tick) {
+  last_tick_time_us_ = tick.local_timestamp_us;
+  auto* strategy = strategies_[strategy_idx];
+  if (strategy) {
+    ++tick_num_;
+    strategy->DispatchTick(tick);
+  }
+}
+
+void BacktestRunner::OnOrderResponse(uint32_t strategy_idx, const OrderResponse& rsp) {
+  auto* strategy = strategies_[strategy_idx];
+  if (strategy) {
+    ++rsp_num_;
+    strategy->DispatchOrderResponse(rsp);
+  }
+}
+
+}  // namespace ft
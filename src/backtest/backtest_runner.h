@@ -0,0 +1,84 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_SRC_BACKTEST_BACKTEST_RUNNER_H_
+#define FT_SRC_BACKTEST_BACKTEST_RUNNER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ft/base/config.h"
+#include "ft/strategy/strategy.h"
+#include "trader/oms.h"
+
+namespace ft {
+
+// 进程内回测，OMS、RMS、BacktestGateway及策略运行在同一个线程中，通过函数调用交互
+// 与ft_trader + strategy_engine --backtest的语义相同：策略处理完一个tick后才推送下一个tick，
+// 但省去了每个tick的journal读写及进程间唤醒。处理顺序是确定的：
+// 1. 推送一个tick，OMS分发给订阅的策略
+// 2. 策略在回调中发出的指令在OMS处理完当前消息后依次执行，避免重入OMS
+// 3. 处理Gateway的回报并交给策略，直到没有新的指令及回报，再推送下一个tick
+// 资金按照行情时间每15秒查询一次，代替OMS的定时器线程
+class BacktestRunner : public OmsInProcessListener {
+ public:
+  BacktestRunner();
+  ~BacktestRunner();
+
+  // 初始化OMS，gateway需为backtest
+  bool Init(const FlareTraderConfig& config);
+
+  // 策略需在strategy_config_list中，strategy由调用者管理
+  bool AddStrategy(const std::string& strategy_name, StrategyRunner* strategy);
+
+  // 回放所有行情后返回
+  void Run();
+
+  uint64_t tick_num() const { return tick_num_; }
+  uint64_t rsp_num() const { return rsp_num_; }
+
+ private:
+  void OnTick(uint32_t strategy_idx, const TickData& tick) override;
+  void OnOrderResponse(uint32_t strategy_idx, const OrderResponse& rsp) override;
+
+  // 执行策略发出的指令并处理回报，直到没有新的消息，返回分发的tick数
+  std::size_t Drain();
+
+ private:
+  struct CmdSink : public TraderCmdSink {
+    void OnTraderCmd(const TraderCommand& cmd) override {
+      runner->pending_cmds_.emplace_back(PendingCmd{cmd, strategy_idx});
+    }
+
+    const PositionCalculator* positions() const override { return pos_calculator; }
+
+    BacktestRunner* runner;
+    uint32_t strategy_idx;
+    const PositionCalculator* pos_calculator;
+  };
+
+  struct PendingCmd {
+    TraderCommand cmd;
+    uint32_t strategy_idx;
+  };
+
+  static constexpr uint64_t kQueryAccountIntervalUs = 15 * 1000000UL;
+
+  const FlareTraderConfig* config_ = nullptr;
+  std::unique_ptr<OrderManagementSystem> oms_;
+  // 以策略在strategy_config_list中的下标为下标，未加载的策略为nullptr
+  std::vector<StrategyRunner*> strategies_;
+  std::vector<std::unique_ptr<CmdSink>> cmd_sinks_;
+  std::vector<PendingCmd> pending_cmds_;
+  std::vector<PendingCmd> executing_cmds_;
+  TraderCommand feed_cmd_{};
+
+  uint64_t tick_num_ = 0;
+  uint64_t rsp_num_ = 0;
+  uint64_t last_tick_time_us_ = 0;
+  uint64_t last_query_time_us_ = 0;
+};
+
+}  // namespace ft
+
+#endif  // FT_SRC_BACKTEST_BACKTEST_RUNNER_H_
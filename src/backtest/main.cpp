@@ -0,0 +1,96 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <dlfcn.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "backtest/backtest_runner.h"
+#include "ft/base/log.h"
+#include "ft/utils/getopt.hpp"
+#include "ft/utils/string_utils.h"
+
+static void Usage() {
+  printf("Usage: ./ft_backtest <--config=file> [-h -? --help]\n");
+  printf("                     <--name=name[,name]> [--loglevel=level]\n");
+  printf("                     <--strategy=so[,so]>\n");
+  printf("\n");
+  printf("    --config            配置文件，gateway.api需为backtest\n");
+  printf("    -h, -?, --help      帮助\n");
+  printf("    --name              策略的唯一标识，多个策略以逗号分隔\n");
+  printf("    --loglevel          日志等级(trace, debug, info, warn, error)\n");
+  printf("    --strategy          要加载的策略的动态库，与name一一对应\n");
+}
+
+static ft::StrategyRunner* LoadStrategy(const std::string& strategy_file) {
+  void* handle = dlopen(strategy_file.c_str(), RTLD_LAZY);
+  if (!handle) {
+    LOG_ERROR("Invalid strategy .so {}", strategy_file);
+    return nullptr;
+  }
+
+  auto strategy_ctor = reinterpret_cast<ft::StrategyRunner* (*)()>(dlsym(handle, "CreateStrategy"));
+  if (!strategy_ctor) {
+    LOG_ERROR("CreateStrategy not found. error: {}", dlerror());
+    return nullptr;
+  }
+  return strategy_ctor();
+}
+
+int main() {
+  std::string config_file = getarg("", "--config");
+  std::string strategy_files = getarg("", "--strategy");
+  std::string log_level = getarg("info", "--loglevel");
+  std::string strategy_ids = getarg("strategy", "--name");
+  bool help = getarg(false, "-h", "--help", "-?");
+
+  if (help) {
+    Usage();
+    exit(0);
+  }
+
+  spdlog::set_level(spdlog::level::from_str(log_level));
+
+  ft::FlareTraderConfig config;
+  if (!config.Load(config_file)) {
+    LOG_ERROR("failed to load config file {}", config_file);
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<std::string> files;
+  std::vector<std::string> names;
+  ft::StringSplit(strategy_files, ",", &files);
+  ft::StringSplit(strategy_ids, ",", &names);
+  if (files.empty() || files.size() != names.size()) {
+    LOG_ERROR("the number of strategies and names mismatch");
+    exit(EXIT_FAILURE);
+  }
+
+  ft::BacktestRunner runner;
+  if (!runner.Init(config)) {
+    LOG_ERROR("failed to init backtest runner");
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<std::unique_ptr<ft::StrategyRunner>> strategies;
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    auto* strategy = LoadStrategy(files[i]);
+    if (!strategy) {
+      exit(EXIT_FAILURE);
+    }
+    strategies.emplace_back(strategy);
+    if (!runner.AddStrategy(names[i], strategy)) {
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  spdlog::info("ready to start backtest");
+  auto start = std::chrono::steady_clock::now();
+  runner.Run();
+  double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  spdlog::info("backtest finished. ticks:{} responses:{} elapsed:{:.3f}s {:.0f} ticks/s",
+               runner.tick_num(), runner.rsp_num(), sec, runner.tick_num() / sec);
+  exit(EXIT_SUCCESS);
+}
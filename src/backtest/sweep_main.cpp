@@ -0,0 +1,73 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <dlfcn.h>
+
+#include <chrono>
+#include <string>
+
+#include "backtest/sweep_runner.h"
+#include "ft/base/log.h"
+#include "ft/utils/getopt.hpp"
+
+static void Usage() {
+  printf("Usage: ./ft_sweep <--config=file> [-h -? --help] [--loglevel=level]\n");
+  printf("\n");
+  printf("    --config            参数扫描的配置文件，格式见config/sweep_template.yml\n");
+  printf("    -h, -?, --help      帮助\n");
+  printf("    --loglevel          日志等级(trace, debug, info, warn, error)，默认warn\n");
+}
+
+int main() {
+  std::string sweep_file = getarg("", "--config");
+  std::string log_level = getarg("warn", "--loglevel");
+  bool help = getarg(false, "-h", "--help", "-?");
+
+  if (help) {
+    Usage();
+    exit(0);
+  }
+
+  spdlog::set_level(spdlog::level::from_str(log_level));
+
+  ft::SweepConfig sweep_config;
+  if (!sweep_config.Load(sweep_file)) {
+    LOG_ERROR("failed to load sweep config {}", sweep_file);
+    exit(EXIT_FAILURE);
+  }
+
+  ft::FlareTraderConfig config;
+  if (!config.Load(sweep_config.config_file)) {
+    LOG_ERROR("failed to load config file {}", sweep_config.config_file);
+    exit(EXIT_FAILURE);
+  }
+
+  void* handle = dlopen(sweep_config.strategy_file.c_str(), RTLD_LAZY);
+  if (!handle) {
+    LOG_ERROR("Invalid strategy .so {}", sweep_config.strategy_file);
+    exit(EXIT_FAILURE);
+  }
+  auto strategy_ctor = reinterpret_cast<ft::StrategyCreator>(dlsym(handle, "CreateStrategy"));
+  if (!strategy_ctor) {
+    LOG_ERROR("CreateStrategy not found. error: {}", dlerror());
+    exit(EXIT_FAILURE);
+  }
+
+  ft::SweepRunner runner;
+  if (!runner.Init(config, sweep_config.strategy_name, strategy_ctor)) {
+    LOG_ERROR("failed to init sweep runner");
+    exit(EXIT_FAILURE);
+  }
+  auto num = runner.SetParamGrid(sweep_config.param_grid);
+  printf("ticks:%lu param sets:%lu\n", runner.ticks().size(), num);
+
+  auto start = std::chrono::steady_clock::now();
+  runner.Run(sweep_config.threads);
+  double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  runner.PrintResults(stdout);
+  printf("elapsed:%.3fs\n", sec);
+  if (!sweep_config.output.empty() && !runner.WriteCsv(sweep_config.output)) {
+    exit(EXIT_FAILURE);
+  }
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,408 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "backtest/sweep_runner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "fmt/format.h"
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "trader/gateway/backtest/backtest_gateway.h"
+#include "trader/gateway/backtest/data_feed/memory_data_feed.h"
+#include "trader/oms.h"
+#include "yaml-cpp/yaml.h"
+
+namespace ft {
+
+namespace {
+
+// 参数取值可以是列表、单个值或{from, to, step}表示的等差数列(包含to)
+bool ParseParamValues(const YAML::Node& node, std::vector<std::string>* values) {
+  if (node.IsSequence()) {
+    *values = node.as<std::vector<std::string>>();
+  } else if (node.IsMap()) {
+    auto from = node["from"].as<std::string>();
+    auto to = node["to"].as<std::string>();
+    auto step = node["step"].as<std::string>();
+    // 都是整数时按整数输出，避免出现5.000000
+    if (from.find_first_of(".eE") == std::string::npos &&
+        to.find_first_of(".eE") == std::string::npos &&
+        step.find_first_of(".eE") == std::string::npos) {
+      auto i_from = std::stoll(from), i_to = std::stoll(to), i_step = std::stoll(step);
+      if (i_step <= 0) {
+        return false;
+      }
+      for (auto v = i_from; v <= i_to; v += i_step) {
+        values->emplace_back(std::to_string(v));
+      }
+    } else {
+      double d_from = std::stod(from), d_to = std::stod(to), d_step = std::stod(step);
+      if (d_step <= 0.0) {
+        return false;
+      }
+      for (int i = 0; d_from + i * d_step <= d_to + d_step * 1e-9; ++i) {
+        values->emplace_back(fmt::format("{:g}", d_from + i * d_step));
+      }
+    }
+  } else {
+    values->emplace_back(node.as<std::string>());
+  }
+  return !values->empty();
+}
+
+// 单个回测实例，在一个线程中运行，进程内的OMS(含RMS) + BacktestGateway，
+// 驱动方式及处理顺序与BacktestRunner相同，只运行一个策略
+class BacktestInstance : public OmsInProcessListener, public TraderCmdSink {
+ public:
+  BacktestInstance(const std::vector<TickData>* ticks, SweepResult* result)
+      : ticks_(ticks), result_(result) {}
+
+  // config.strategy_config_list中只有该策略
+  bool Init(const FlareTraderConfig& config, StrategyRunner* strategy);
+
+  void Run();
+
+  void OnTraderCmd(const TraderCommand& cmd) override {
+    if (cmd.type == TraderCmdType::kNewOrder) {
+      ++result_->orders;
+    }
+    pending_cmds_.emplace_back(cmd);
+  }
+
+  const PositionCalculator* positions() const override { return pos_calculator_; }
+
+ private:
+  void OnTick(uint32_t strategy_idx, const TickData& tick) override;
+  void OnOrderResponse(uint32_t strategy_idx, const OrderResponse& rsp) override;
+
+  std::size_t Drain();
+
+  // 按gateway中的资金计算盈亏及回撤
+  void UpdatePnl();
+
+ private:
+  static constexpr uint64_t kQueryAccountIntervalUs = 15 * 1000000UL;
+
+  const std::vector<TickData>* ticks_;
+  SweepResult* result_;
+  StrategyRunner* strategy_ = nullptr;
+  const PositionCalculator* pos_calculator_ = nullptr;
+  std::shared_ptr<BacktestGateway> gateway_;
+  std::unique_ptr<OrderManagementSystem> oms_;
+
+  std::vector<TraderCommand> pending_cmds_;
+  std::vector<TraderCommand> executing_cmds_;
+  TraderCommand feed_cmd_{};
+
+  double init_asset_ = 0.0;
+  double peak_pnl_ = 0.0;
+  uint64_t last_tick_time_us_ = 0;
+  uint64_t last_query_time_us_ = 0;
+};
+
+bool BacktestInstance::Init(const FlareTraderConfig& config, StrategyRunner* strategy) {
+  gateway_ = std::make_shared<BacktestGateway>();
+  gateway_->SetDataFeed(std::make_shared<MemoryDataFeed>(ticks_));
+  oms_ = std::make_unique<OrderManagementSystem>();
+  oms_->SetGateway(gateway_);
+  if (!oms_->Init(config, this)) {
+    LOG_ERROR("[BacktestInstance::Init] failed to init oms");
+    return false;
+  }
+  init_asset_ = gateway_->account().total_asset;
+
+  auto& strategy_conf = config.strategy_config_list[0];
+  pos_calculator_ = oms_->GetStrategyPositions(strategy_conf.strategy_name);
+  strategy_ = strategy;
+  if (!strategy_->InitInProcess(strategy_conf, config, this)) {
+    LOG_ERROR("[BacktestInstance::Init] failed to init strategy");
+    return false;
+  }
+
+  feed_cmd_.magic = kTradingCmdMagic;
+  feed_cmd_.type = TraderCmdType::kNotify;
+  return true;
+}
+
+void BacktestInstance::Run() {
+  strategy_->Start();
+  Drain();
+  for (;;) {
+    oms_->ExecuteCmd(feed_cmd_, 0);
+    if (Drain() == 0) {
+      break;
+    }
+    UpdatePnl();
+
+    if (last_tick_time_us_ >= last_query_time_us_ + kQueryAccountIntervalUs) {
+      last_query_time_us_ = last_tick_time_us_;
+      oms_->QueryAccount();
+      Drain();
+    }
+  }
+  strategy_->Stop();
+  Drain();
+  UpdatePnl();
+}
+
+std::size_t BacktestInstance::Drain() {
+  std::size_t tick_count = 0;
+  for (;;) {
+    bool busy = false;
+    tick_count += oms_->PollTicks();
+
+    while (!pending_cmds_.empty()) {
+      busy = true;
+      std::swap(pending_cmds_, executing_cmds_);
+      for (auto& cmd : executing_cmds_) {
+        oms_->ExecuteCmd(cmd, 0);
+      }
+      executing_cmds_.clear();
+      tick_count += oms_->PollTicks();
+    }
+
+    busy |= oms_->PollResponses();
+    if (!busy) {
+      break;
+    }
+  }
+  result_->ticks += tick_count;
+  return tick_count;
+}
+
+void BacktestInstance::OnTick(uint32_t strategy_idx, const TickData& tick) {
+  last_tick_time_us_ = tick.local_timestamp_us;
+  strategy_->DispatchTick(tick);
+}
+
+void BacktestInstance::OnOrderResponse(uint32_t strategy_idx, const OrderResponse& rsp) {
+  if (rsp.this_traded > 0) {
+    ++result_->trades;
+    result_->traded_volume += rsp.this_traded;
+  }
+  strategy_->DispatchOrderResponse(rsp);
+}
+
+void BacktestInstance::UpdatePnl() {
+  result_->pnl = gateway_->account().total_asset - init_asset_;
+  peak_pnl_ = std::max(peak_pnl_, result_->pnl);
+  result_->max_drawdown = std::max(result_->max_drawdown, peak_pnl_ - result_->pnl);
+}
+
+}  // namespace
+
+bool SweepConfig::Load(const std::string& file) {
+  try {
+    auto node = YAML::LoadFile(file);
+    config_file = node["config"].as<std::string>();
+    strategy_file = node["strategy"].as<std::string>();
+    strategy_name = node["name"].as<std::string>();
+    threads = node["threads"].as<int>(0);
+    output = node["output"].as<std::string>("");
+
+    param_grid.clear();
+    for (auto it : node["params"]) {
+      auto name = it.first.as<std::string>();
+      std::vector<std::string> values;
+      if (!ParseParamValues(it.second, &values)) {
+        LOG_ERROR("[SweepConfig::Load] invalid values of param {}", name);
+        return false;
+      }
+      param_grid.emplace_back(name, std::move(values));
+    }
+    return true;
+  } catch (YAML::Exception& e) {
+    LOG_ERROR("{}", e.what());
+    return false;
+  } catch (std::exception& e) {
+    LOG_ERROR("{}", e.what());
+    return false;
+  }
+}
+
+bool SweepRunner::Init(const FlareTraderConfig& config, const std::string& strategy_name,
+                       StrategyCreator creator) {
+  if (config.gateway_config.api != "backtest") {
+    LOG_ERROR("[SweepRunner::Init] gateway api must be backtest");
+    return false;
+  }
+
+  config_ = config;
+  // 实例之间互不影响，不使用共享内存中的行情快照及持仓缓存
+  config_.global_config.tick_snapshot = false;
+  config_.global_config.position_cache = false;
+  if (config_.gateway_config.investor_id.empty()) {
+    config_.gateway_config.investor_id = "0";
+  }
+
+  auto it = std::find_if(config.strategy_config_list.begin(), config.strategy_config_list.end(),
+                         [&](const auto& conf) { return conf.strategy_name == strategy_name; });
+  if (it == config.strategy_config_list.end()) {
+    LOG_ERROR("[SweepRunner::Init] strategy config not found. strategy name: {}", strategy_name);
+    return false;
+  }
+  strategy_conf_ = *it;
+  creator_ = creator;
+
+  if (!ContractTable::Init(config_.global_config.contract_file)) {
+    LOG_ERROR("[SweepRunner::Init] failed to init contract table");
+    return false;
+  }
+
+  // 所有实例共享同一份只读的行情
+  auto start = std::chrono::steady_clock::now();
+  if (!LoadTicks(config_.gateway_config.extended_args, &ticks_)) {
+    LOG_ERROR("[SweepRunner::Init] failed to load ticks");
+    return false;
+  }
+  ticks_.shrink_to_fit();
+  LOG_INFO("[SweepRunner::Init] {} ticks loaded in {:.3f}s, {:.1f}MB", ticks_.size(),
+           std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+           ticks_.size() * sizeof(TickData) / 1048576.0);
+
+  SetParamGrid({});
+  return true;
+}
+
+std::size_t SweepRunner::SetParamGrid(const ParamGrid& grid) {
+  param_names_.clear();
+  param_sets_.assign(1, {});
+  for (auto& [name, values] : grid) {
+    param_names_.emplace_back(name);
+    std::vector<std::map<std::string, std::string>> expanded;
+    for (auto& param_set : param_sets_) {
+      for (auto& value : values) {
+        expanded.emplace_back(param_set);
+        expanded.back()[name] = value;
+      }
+    }
+    param_sets_ = std::move(expanded);
+  }
+  return param_sets_.size();
+}
+
+void SweepRunner::Run(int thread_num) {
+  if (thread_num <= 0) {
+    thread_num = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  thread_num = std::max(1, std::min(thread_num, static_cast<int>(param_sets_.size())));
+  results_.assign(param_sets_.size(), SweepResult{});
+
+  // 每个线程依次领取下一个参数组合，各组合耗时不同时也能均衡负载
+  std::atomic<std::size_t> next_idx = 0;
+  std::vector<std::thread> workers;
+  for (int i = 0; i < thread_num; ++i) {
+    workers.emplace_back([this, &next_idx] {
+      for (;;) {
+        auto idx = next_idx.fetch_add(1, std::memory_order_relaxed);
+        if (idx >= param_sets_.size()) {
+          break;
+        }
+        RunOne(idx);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void SweepRunner::RunOne(std::size_t idx) {
+  auto& result = results_[idx];
+  result.params = param_sets_[idx];
+
+  auto strategy_conf = strategy_conf_;
+  for (auto& [name, value] : param_sets_[idx]) {
+    strategy_conf.params[name] = value;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<StrategyRunner> strategy(creator_());
+  // OMS只加载当前实例的策略，其下标为0
+  auto config = config_;
+  config.strategy_config_list = {strategy_conf};
+  auto instance = std::make_unique<BacktestInstance>(&ticks_, &result);
+  if (!instance->Init(config, strategy.get())) {
+    LOG_ERROR("[SweepRunner::RunOne] failed to init backtest instance {}", idx);
+    return;
+  }
+  instance->Run();
+  result.ok = true;
+  result.elapsed_sec =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SweepRunner::PrintResults(FILE* fp) const {
+  std::vector<std::size_t> order(results_.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+    if (results_[a].ok != results_[b].ok) {
+      return results_[a].ok;
+    }
+    return results_[a].pnl > results_[b].pnl;
+  });
+
+  std::vector<int> widths;
+  for (auto& name : param_names_) {
+    std::size_t width = name.size();
+    for (auto& result : results_) {
+      auto it = result.params.find(name);
+      if (it != result.params.end()) {
+        width = std::max(width, it->second.size());
+      }
+    }
+    widths.emplace_back(static_cast<int>(width));
+  }
+
+  fprintf(fp, "%6s", "id");
+  for (std::size_t i = 0; i < param_names_.size(); ++i) {
+    fprintf(fp, "  %*s", widths[i], param_names_[i].c_str());
+  }
+  fprintf(fp, "  %14s  %14s  %10s  %10s  %10s  %8s\n", "pnl", "max_drawdown", "trades", "volume",
+          "orders", "time(s)");
+  for (auto idx : order) {
+    auto& result = results_[idx];
+    fprintf(fp, "%6lu", idx);
+    for (std::size_t i = 0; i < param_names_.size(); ++i) {
+      fprintf(fp, "  %*s", widths[i], result.params.at(param_names_[i]).c_str());
+    }
+    if (!result.ok) {
+      fprintf(fp, "  failed\n");
+      continue;
+    }
+    fprintf(fp, "  %14.2f  %14.2f  %10lu  %10lu  %10lu  %8.3f\n", result.pnl, result.max_drawdown,
+            result.trades, result.traded_volume, result.orders, result.elapsed_sec);
+  }
+}
+
+bool SweepRunner::WriteCsv(const std::string& file) const {
+  FILE* fp = fopen(file.c_str(), "w");
+  if (!fp) {
+    LOG_ERROR("[SweepRunner::WriteCsv] failed to open {}", file);
+    return false;
+  }
+
+  fprintf(fp, "id");
+  for (auto& name : param_names_) {
+    fprintf(fp, ",%s", name.c_str());
+  }
+  fprintf(fp, ",ok,pnl,max_drawdown,trades,volume,orders,ticks,elapsed_sec\n");
+  for (std::size_t idx = 0; idx < results_.size(); ++idx) {
+    auto& result = results_[idx];
+    fprintf(fp, "%lu", idx);
+    for (auto& name : param_names_) {
+      fprintf(fp, ",%s", result.params.at(name).c_str());
+    }
+    fprintf(fp, ",%d,%.4f,%.4f,%lu,%lu,%lu,%lu,%.6f\n", result.ok, result.pnl, result.max_drawdown,
+            result.trades, result.traded_volume, result.orders, result.ticks, result.elapsed_sec);
+  }
+  return fclose(fp) == 0;
+}
+
+}  // namespace ft
@@ -0,0 +1,87 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_SRC_BACKTEST_SWEEP_RUNNER_H_
+#define FT_SRC_BACKTEST_SWEEP_RUNNER_H_
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ft/base/config.h"
+#include "ft/base/market_data.h"
+#include "ft/strategy/strategy.h"
+
+namespace ft {
+
+// 参数网格，按配置中的顺序保存，每个参数的所有取值做笛卡尔积
+using ParamGrid = std::vector<std::pair<std::string, std::vector<std::string>>>;
+
+// ft_sweep的配置文件，格式见config/sweep_template.yml
+struct SweepConfig {
+  bool Load(const std::string& file);
+
+  std::string config_file;    // ft的配置文件，gateway.api需为backtest
+  std::string strategy_file;  // 策略的动态库
+  std::string strategy_name;  // 策略在strategy_list中的name
+  int threads = 0;            // 为0时使用所有CPU核
+  std::string output;         // 为空时不输出csv
+  ParamGrid param_grid;
+};
+
+struct SweepResult {
+  std::map<std::string, std::string> params;
+  bool ok = false;
+  double pnl = 0.0;           // BacktestGateway资金的变化(平仓盈亏 + 浮动盈亏 - 手续费)
+  double max_drawdown = 0.0;  // pnl从最高点回撤的最大值，每个tick处理完后计算
+  uint64_t orders = 0;
+  uint64_t trades = 0;        // 成交回报的笔数
+  uint64_t traded_volume = 0;
+  uint64_t ticks = 0;
+  double elapsed_sec = 0.0;
+};
+
+using StrategyCreator = StrategyRunner* (*)();
+
+// 参数扫描，行情只加载一次，多个回测实例在线程池中并行运行
+// 每个实例与BacktestRunner一样在一个线程中运行进程内的OMS(含RMS)、BacktestGateway及策略，
+// 只共享只读的行情，不使用redis及共享内存，实例之间没有同步，耗时随线程数近似线性下降
+// 策略的仓位由OMS维护，需配置ft.risk.position
+class SweepRunner {
+ public:
+  // strategy_name为config.strategy_config_list中的策略，参数网格中的参数覆盖其params
+  bool Init(const FlareTraderConfig& config, const std::string& strategy_name,
+            StrategyCreator creator);
+
+  // 返回展开后的参数组合数
+  std::size_t SetParamGrid(const ParamGrid& grid);
+
+  // thread_num为0时使用所有CPU核
+  void Run(int thread_num);
+
+  const std::vector<SweepResult>& results() const { return results_; }
+
+  // 按盈亏从高到低输出结果表
+  void PrintResults(FILE* fp) const;
+
+  bool WriteCsv(const std::string& file) const;
+
+  const std::vector<TickData>& ticks() const { return ticks_; }
+
+ private:
+  void RunOne(std::size_t idx);
+
+ private:
+  FlareTraderConfig config_;
+  StrategyConfig strategy_conf_;
+  StrategyCreator creator_ = nullptr;
+  std::vector<std::string> param_names_;
+  std::vector<std::map<std::string, std::string>> param_sets_;
+  std::vector<TickData> ticks_;
+  std::vector<SweepResult> results_;
+};
+
+}  // namespace ft
+
+#endif  // FT_SRC_BACKTEST_SWEEP_RUNNER_H_
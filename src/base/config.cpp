@@ -14,9 +14,24 @@ bool FlareTraderConfig::Load(const std::string& file) {
     auto global_item = node["global"];
     global_config.contract_file = global_item["contract_file"].as<std::string>("");
     global_config.trader_db_address = global_item["trader_db_address"].as<std::string>("");
+    global_config.oms_cpu_affinity = global_item["oms_cpu_affinity"].as<int>(-1);
+    global_config.md_cpu_affinity = global_item["md_cpu_affinity"].as<int>(-1);
+    global_config.oms_batch_size = global_item["oms_batch_size"].as<int>(64);
+    global_config.wait_strategy = global_item["wait_strategy"].as<std::string>("busy_spin");
+    global_config.wait_spin_count = global_item["wait_spin_count"].as<int>(1000);
+    global_config.wait_timeout_us = global_item["wait_timeout_us"].as<int>(1000);
+    global_config.order_mq_page_size_mb = global_item["order_mq_page_size_mb"].as<int>(128);
+    global_config.md_mq_page_size_mb = global_item["md_mq_page_size_mb"].as<int>(128);
+    global_config.journal_preallocate = global_item["journal_preallocate"].as<bool>(false);
+    global_config.md_mq_huge_page = global_item["md_mq_huge_page"].as<bool>(false);
+    global_config.tick_snapshot = global_item["tick_snapshot"].as<bool>(false);
+    global_config.position_cache = global_item["position_cache"].as<bool>(false);
+    global_config.latency_stats = global_item["latency_stats"].as<bool>(true);
+    global_config.log_mode = global_item["log_mode"].as<std::string>("sync");
 
     auto gateway_item = node["gateway"];
     gateway_config.api = gateway_item["api"].as<std::string>();
+    gateway_config.md_api = gateway_item["md_api"].as<std::string>("");
     gateway_config.trade_server_address = gateway_item["trade_server_address"].as<std::string>("");
     gateway_config.quote_server_address = gateway_item["quote_server_address"].as<std::string>("");
     gateway_config.broker_id = gateway_item["broker_id"].as<std::string>("");
@@ -26,6 +41,8 @@ bool FlareTraderConfig::Load(const std::string& file) {
     gateway_config.app_id = gateway_item["app_id"].as<std::string>("");
     gateway_config.cancel_outstanding_orders_on_startup =
         gateway_item["cancel_outstanding_orders_on_startup"].as<bool>(true);
+    gateway_config.subscription_list =
+        gateway_item["subscription_list"].as<std::vector<std::string>>(std::vector<std::string>{});
 
     auto extended_args = gateway_item["extended_args"];
     for (auto it = extended_args.begin(); it != extended_args.end(); ++it) {
@@ -34,6 +51,16 @@ bool FlareTraderConfig::Load(const std::string& file) {
       gateway_config.extended_args.emplace(key, val);
     }
 
+    auto market_item = node["market"];
+    market_config.md_journal_prefix = market_item["md_journal_prefix"].as<std::string>("md");
+    market_config.upstream = market_item["upstream"].as<std::string>("");
+    market_config.upstream_address = market_item["upstream_address"].as<std::string>("");
+    market_config.upstream_port = market_item["upstream_port"].as<int>(0);
+    market_config.publish = market_item["publish"].as<std::string>("");
+    market_config.publish_address = market_item["publish_address"].as<std::string>("");
+    market_config.publish_port = market_item["publish_port"].as<int>(0);
+    market_config.multicast_interface = market_item["multicast_interface"].as<std::string>("");
+
     auto rms_item = node["rms"];
     assert(rms_item.IsSequence());
     for (std::size_t i = 0; i < rms_item.size(); ++i) {
@@ -62,6 +89,10 @@ bool FlareTraderConfig::Load(const std::string& file) {
       strategy_config.subscription_list =
           strategy_item["subscription_list"].as<std::vector<std::string>>(
               std::vector<std::string>{});
+      strategy_config.wait_strategy = strategy_item["wait_strategy"].as<std::string>("");
+      strategy_config.conflate_md = strategy_item["conflate_md"].as<bool>(false);
+      strategy_config.params = strategy_item["params"].as<std::map<std::string, std::string>>(
+          std::map<std::string, std::string>{});
       strategy_config_list.emplace_back(std::move(strategy_config));
     }
 
@@ -0,0 +1,540 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "ft/base/log.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ft/base/config.h"
+#include "ft/base/log_file.h"
+#include "spdlog/details/os.h"
+
+namespace ft {
+
+namespace log_detail {
+
+namespace {
+
+struct LogArg {
+  uint8_t type;
+  const char* data;
+  uint32_t len;
+};
+
+bool DecodeArgs(const char* p, std::size_t size, std::vector<LogArg>* args) {
+  const char* end = p + size;
+  while (p < end) {
+    LogArg arg{static_cast<uint8_t>(*p), p + 1, 0};
+    switch (arg.type) {
+      case kLogInt:
+      case kLogUInt:
+      case kLogDouble:
+      case kLogPointer:
+        arg.len = 8;
+        break;
+      case kLogFloat:
+        arg.len = 4;
+        break;
+      case kLogBool:
+      case kLogChar:
+        arg.len = 1;
+        break;
+      case kLogString:
+        if (end - arg.data < 4) {
+          return false;
+        }
+        memcpy(&arg.len, arg.data, 4);
+        arg.data += 4;
+        break;
+      default:
+        return false;
+    }
+    if (end - arg.data < arg.len) {
+      return false;
+    }
+    args->emplace_back(arg);
+    p = arg.data + arg.len;
+  }
+  return true;
+}
+
+template <class T>
+T Load(const char* data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+// field为去掉参数序号的替换域，如"{:>8.2f}"
+std::string FormatArg(fmt::string_view field, const LogArg& arg) {
+  switch (arg.type) {
+    case kLogInt:
+      return fmt::vformat(field, fmt::make_format_args(Load<int64_t>(arg.data)));
+    case kLogUInt:
+      return fmt::vformat(field, fmt::make_format_args(Load<uint64_t>(arg.data)));
+    case kLogFloat:
+      return fmt::vformat(field, fmt::make_format_args(Load<float>(arg.data)));
+    case kLogDouble:
+      return fmt::vformat(field, fmt::make_format_args(Load<double>(arg.data)));
+    case kLogBool:
+      return fmt::vformat(field, fmt::make_format_args(*arg.data != 0));
+    case kLogChar:
+      return fmt::vformat(field, fmt::make_format_args(*arg.data));
+    case kLogString:
+      return fmt::vformat(field, fmt::make_format_args(fmt::string_view(arg.data, arg.len)));
+    case kLogPointer:
+      return fmt::vformat(field, fmt::make_format_args(
+                                     reinterpret_cast<const void*>(Load<uint64_t>(arg.data))));
+    default:
+      return "";
+  }
+}
+
+}  // namespace
+
+bool FormatLogArgs(std::string_view fmt, const char* args, std::size_t size, std::string* out) {
+  if (size == 0) {
+    out->append(fmt.data(), fmt.size());
+    return true;
+  }
+
+  std::vector<LogArg> decoded;
+  if (!DecodeArgs(args, size, &decoded)) {
+    return false;
+  }
+
+  // 逐个替换域格式化，不支持嵌套的动态宽度及精度
+  std::size_t next_arg = 0;
+  std::string field;
+  try {
+    for (std::size_t i = 0; i < fmt.size(); ++i) {
+      char c = fmt[i];
+      if (c == '}') {
+        if (i + 1 < fmt.size() && fmt[i + 1] == '}') {
+          ++i;
+        }
+        out->push_back('}');
+        continue;
+      }
+      if (c != '{') {
+        out->push_back(c);
+        continue;
+      }
+      if (i + 1 < fmt.size() && fmt[i + 1] == '{') {
+        ++i;
+        out->push_back('{');
+        continue;
+      }
+
+      auto close = fmt.find('}', i);
+      if (close == std::string_view::npos) {
+        return false;
+      }
+      auto content = fmt.substr(i + 1, close - i - 1);
+      if (content.find('{') != std::string_view::npos) {
+        return false;
+      }
+      auto colon = content.find(':');
+      auto index = content.substr(0, colon);
+      std::size_t arg_idx;
+      if (index.empty()) {
+        arg_idx = next_arg++;
+      } else {
+        arg_idx = 0;
+        for (char d : index) {
+          if (d < '0' || d > '9') {
+            return false;
+          }
+          arg_idx = arg_idx * 10 + (d - '0');
+        }
+      }
+      if (arg_idx >= decoded.size()) {
+        return false;
+      }
+
+      field = "{";
+      if (colon != std::string_view::npos) {
+        field.append(content.data() + colon, content.size() - colon);
+      }
+      field.push_back('}');
+      out->append(FormatArg(field, decoded[arg_idx]));
+      i = close;
+    }
+  } catch (const std::exception& e) {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace log_detail
+
+using log_detail::LogRecordHeader;
+using log_detail::LogRing;
+
+struct Logger::AsyncContext {
+  struct Site {
+    const char* file;
+    int line;
+    spdlog::level::level_enum level;
+    std::string fmt;
+  };
+
+  struct Ring {
+    LogRing ring;
+    std::atomic<bool> in_use{true};
+    std::atomic<std::size_t> thread_id{0};
+    uint64_t reported_dropped = 0;  // 只由后台线程访问
+  };
+
+  std::mutex mutex;
+  std::vector<Site> sites;  // sites[i]的id为kFirstSiteId + i
+  std::vector<std::unique_ptr<Ring>> rings;
+
+  std::thread thread;
+  std::atomic<bool> running{false};
+  std::atomic<long> thread_tid{0};  // 后台线程的tid，避免在后台线程中等待自己
+
+  // Flush请求的序号，后台线程输出完请求之前的日志后更新flush_done
+  std::atomic<uint64_t> flush_requested{0};
+  std::atomic<uint64_t> flush_done{0};
+
+  // 二进制模式
+  FILE* file = nullptr;
+  std::vector<bool> site_written;
+};
+
+namespace {
+
+// 线程退出时归还环形队列，队列中剩余的日志输出后可被新线程复用
+struct LocalRingHolder {
+  std::atomic<bool>* in_use = nullptr;
+  ~LocalRingHolder() {
+    if (in_use) {
+      in_use->store(false, std::memory_order_release);
+    }
+  }
+};
+
+// 只使用原子操作及nanosleep，可以在信号处理函数中调用
+bool WaitFlushed(const std::atomic<uint64_t>& flush_done, uint64_t seq, int timeout_ms) {
+  timespec interval{0, 100000};
+  for (int i = 0; i < timeout_ms * 10; ++i) {
+    if (flush_done.load(std::memory_order_acquire) >= seq) {
+      return true;
+    }
+    nanosleep(&interval, nullptr);
+  }
+  return flush_done.load(std::memory_order_acquire) >= seq;
+}
+
+void OnTerminateSignal(int sig) {
+  Logger::Instance().FlushInSignalHandler();
+  signal(sig, SIG_DFL);
+  raise(sig);
+}
+
+void InstallTerminateHandlers() {
+  for (int sig : {SIGINT, SIGTERM, SIGABRT}) {
+    struct sigaction old_action {};
+    // 不覆盖程序自己安装的处理函数
+    if (sigaction(sig, nullptr, &old_action) != 0 || old_action.sa_handler != SIG_DFL) {
+      continue;
+    }
+    struct sigaction action {};
+    action.sa_handler = &OnTerminateSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(sig, &action, nullptr);
+  }
+}
+
+}  // namespace
+
+Logger::~Logger() { StopAsync(); }
+
+void Logger::Flush() {
+  if (!async()) {
+    logger_->flush();
+    return;
+  }
+  if (ctx_->thread_tid.load(std::memory_order_relaxed) == syscall(SYS_gettid)) {
+    return;
+  }
+  uint64_t seq = ctx_->flush_requested.fetch_add(1, std::memory_order_seq_cst) + 1;
+  WaitFlushed(ctx_->flush_done, seq, 1000);
+}
+
+void Logger::FlushInSignalHandler() {
+  if (!async() || ctx_->thread_tid.load(std::memory_order_relaxed) == syscall(SYS_gettid)) {
+    return;
+  }
+  uint64_t seq = ctx_->flush_requested.fetch_add(1, std::memory_order_seq_cst) + 1;
+  WaitFlushed(ctx_->flush_done, seq, 1000);
+}
+
+bool Logger::StartAsync(const std::string& binary_file) {
+  if (ctx_ && ctx_->running) {
+    LOG_ERROR("async log already started");
+    return false;
+  }
+
+  if (!ctx_) {
+    // 进程退出前不释放，其他线程的thread_local析构时仍可能访问
+    ctx_ = new AsyncContext;
+  }
+  if (!binary_file.empty()) {
+    ctx_->file = fopen(binary_file.c_str(), "wb");
+    if (!ctx_->file) {
+      LOG_ERROR("failed to open binary log file {}", binary_file);
+      return false;
+    }
+    setvbuf(ctx_->file, nullptr, _IOFBF, 1 << 20);
+    LogFileHeader header{kLogFileMagic, kLogFileVersion};
+    fwrite(&header, sizeof(header), 1, ctx_->file);
+    ctx_->site_written.clear();
+  }
+
+  ctx_->flush_done.store(ctx_->flush_requested.load(), std::memory_order_relaxed);
+  ctx_->running = true;
+  ctx_->thread = std::thread([this] { BackgroundLoop(); });
+  async_.store(true, std::memory_order_release);
+  return true;
+}
+
+void Logger::StopAsync() {
+  if (!ctx_ || !ctx_->running) {
+    return;
+  }
+  async_.store(false, std::memory_order_release);
+  ctx_->running = false;
+  ctx_->thread.join();
+  if (ctx_->file) {
+    fclose(ctx_->file);
+    ctx_->file = nullptr;
+  }
+}
+
+uint32_t Logger::RegisterSite(LogSite* site, spdlog::level::level_enum level,
+                              fmt::string_view fmt) {
+  std::unique_lock<std::mutex> lock(ctx_->mutex);
+  // 其他线程可能已经注册过
+  uint32_t id = site->id.load(std::memory_order_relaxed);
+  if (id != 0) {
+    return id;
+  }
+  ctx_->sites.emplace_back(
+      AsyncContext::Site{site->file, site->line, level, std::string(fmt.data(), fmt.size())});
+  id = log_detail::kFirstSiteId + static_cast<uint32_t>(ctx_->sites.size() - 1);
+  site->id.store(id, std::memory_order_release);
+  return id;
+}
+
+LogRing* Logger::CreateLocalRing() {
+  static thread_local LocalRingHolder holder;
+
+  std::unique_lock<std::mutex> lock(ctx_->mutex);
+  AsyncContext::Ring* ring = nullptr;
+  for (auto& r : ctx_->rings) {
+    if (!r->in_use.load(std::memory_order_acquire) && r->ring.Empty()) {
+      ring = r.get();
+      break;
+    }
+  }
+  if (!ring) {
+    ctx_->rings.emplace_back(std::make_unique<AsyncContext::Ring>());
+    ring = ctx_->rings.back().get();
+  }
+  ring->thread_id.store(spdlog::details::os::thread_id(), std::memory_order_relaxed);
+  ring->in_use.store(true, std::memory_order_relaxed);
+  holder.in_use = &ring->in_use;
+  return &ring->ring;
+}
+
+void Logger::BackgroundLoop() {
+  std::vector<AsyncContext::Site> sites;
+  std::vector<AsyncContext::Ring*> rings;
+  std::string payload;
+
+  auto sync_registry = [&]() {
+    std::unique_lock<std::mutex> lock(ctx_->mutex);
+    for (std::size_t i = sites.size(); i < ctx_->sites.size(); ++i) {
+      sites.emplace_back(ctx_->sites[i]);
+    }
+    for (std::size_t i = rings.size(); i < ctx_->rings.size(); ++i) {
+      rings.emplace_back(ctx_->rings[i].get());
+    }
+  };
+
+  auto write_binary = [&](const LogRecordHeader* header, std::size_t thread_id,
+                          const AsyncContext::Site* site) {
+    FILE* file = ctx_->file;
+    if (site) {
+      uint32_t idx = header->site_id - log_detail::kFirstSiteId;
+      if (ctx_->site_written.size() <= idx) {
+        ctx_->site_written.resize(idx + 1, false);
+      }
+      if (!ctx_->site_written[idx]) {
+        LogFileSite block{};
+        std::size_t file_len = strlen(site->file);
+        block.type = kLogFileSiteBlock;
+        block.size = static_cast<uint32_t>(sizeof(block) + file_len + site->fmt.size());
+        block.site_id = header->site_id;
+        block.level = site->level;
+        block.line = site->line;
+        block.file_len = static_cast<uint32_t>(file_len);
+        fwrite(&block, sizeof(block), 1, file);
+        fwrite(site->file, 1, file_len, file);
+        fwrite(site->fmt.data(), 1, site->fmt.size(), file);
+        ctx_->site_written[idx] = true;
+      }
+    }
+    std::size_t args_size = header->size - sizeof(LogRecordHeader);
+    LogFileRecord block{};
+    block.type = kLogFileRecordBlock;
+    block.size = static_cast<uint32_t>(sizeof(block) + args_size);
+    block.site_id = header->site_id;
+    block.timestamp_ns = header->timestamp_ns;
+    block.thread_id = thread_id;
+    fwrite(&block, sizeof(block), 1, file);
+    fwrite(header + 1, 1, args_size, file);
+  };
+
+  auto output = [&](const LogRecordHeader* header, std::size_t thread_id) {
+    const AsyncContext::Site* site = nullptr;
+    spdlog::level::level_enum level;
+    std::string_view fmt;
+    if (header->site_id >= log_detail::kFirstSiteId) {
+      uint32_t idx = header->site_id - log_detail::kFirstSiteId;
+      if (idx >= sites.size()) {
+        sync_registry();
+      }
+      site = &sites[idx];
+      level = site->level;
+      fmt = site->fmt;
+    } else {
+      level = static_cast<spdlog::level::level_enum>(header->site_id -
+                                                     log_detail::kPreformattedSiteId);
+      fmt = "{}";
+    }
+
+    if (ctx_->file) {
+      write_binary(header, thread_id, site);
+      return;
+    }
+
+    payload.clear();
+    if (!log_detail::FormatLogArgs(fmt, reinterpret_cast<const char*>(header + 1),
+                                   header->size - sizeof(LogRecordHeader), &payload)) {
+      payload.assign(fmt.data(), fmt.size());
+    }
+    auto time = spdlog::log_clock::time_point(
+        std::chrono::duration_cast<spdlog::log_clock::duration>(
+            std::chrono::nanoseconds(header->timestamp_ns)));
+    spdlog::details::log_msg msg(time, spdlog::source_loc{}, logger_->name(), level,
+                                 spdlog::string_view_t(payload.data(), payload.size()));
+    msg.thread_id = thread_id;
+    for (auto& sink : logger_->sinks()) {
+      if (sink->should_log(level)) {
+        sink->log(msg);
+      }
+    }
+    if (level >= logger_->flush_level()) {
+      for (auto& sink : logger_->sinks()) {
+        sink->flush();
+      }
+    }
+  };
+
+  auto drain = [&]() {
+    bool busy = false;
+    for (auto* ring : rings) {
+      const LogRecordHeader* header;
+      while ((header = ring->ring.Front()) != nullptr) {
+        // 复用的队列在新线程写入第一条日志前已设置好thread_id
+        output(header, ring->thread_id.load(std::memory_order_relaxed));
+        ring->ring.Pop((header->size + 7) & ~static_cast<std::size_t>(7));
+        busy = true;
+      }
+      uint64_t dropped = ring->ring.dropped();
+      if (dropped != ring->reported_dropped) {
+        logger_->warn("async log: {} records dropped in thread {}",
+                      dropped - ring->reported_dropped, ring->thread_id.load());
+        ring->reported_dropped = dropped;
+      }
+    }
+    return busy;
+  };
+
+  auto flush = [&]() {
+    if (ctx_->file) {
+      fflush(ctx_->file);
+    }
+    for (auto& sink : logger_->sinks()) {
+      sink->flush();
+    }
+  };
+
+  // 终止信号由其他线程处理，处理函数中会等待后台线程输出
+  sigset_t sigset;
+  sigemptyset(&sigset);
+  sigaddset(&sigset, SIGINT);
+  sigaddset(&sigset, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &sigset, nullptr);
+  ctx_->thread_tid.store(syscall(SYS_gettid), std::memory_order_relaxed);
+
+  while (ctx_->running.load(std::memory_order_acquire)) {
+    // 先读取请求序号再检查队列，请求之前写入的日志一定会被输出
+    uint64_t flush_seq = ctx_->flush_requested.load(std::memory_order_acquire);
+    sync_registry();
+    bool busy = drain();
+    if (flush_seq != ctx_->flush_done.load(std::memory_order_relaxed)) {
+      flush();
+      ctx_->flush_done.store(flush_seq, std::memory_order_release);
+    } else if (!busy) {
+      if (ctx_->file) {
+        fflush(ctx_->file);
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  // 退出前输出剩余的日志
+  sync_registry();
+  while (drain()) {
+  }
+  flush();
+  // 停止后不再有线程处理请求，之后的Flush不需要等待
+  ctx_->flush_done.store(UINT64_MAX, std::memory_order_release);
+  ctx_->thread_tid.store(0, std::memory_order_relaxed);
+}
+
+bool InitLogMode(const GlobalConfig& config, const std::string& name) {
+  if (config.log_mode.empty() || config.log_mode == "sync") {
+    return true;
+  } else if (config.log_mode == "async") {
+    if (!Logger::Instance().StartAsync()) {
+      return false;
+    }
+  } else if (config.log_mode == "binary") {
+    auto file = fmt::format("./ft_log.{}.{}.bin", name, getpid());
+    LOG_INFO("binary log: {}", file);
+    if (!Logger::Instance().StartAsync(file)) {
+      return false;
+    }
+  } else {
+    LOG_ERROR("unknown log_mode: {}", config.log_mode);
+    return false;
+  }
+
+  InstallTerminateHandlers();
+  return true;
+}
+
+}  // namespace ft
@@ -0,0 +1,126 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "ft/component/conflated_md_channel.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+namespace ft {
+
+static std::string GetConflatedMdChannelPath(const std::string& name) {
+  return "./ft_conflated_md." + name;
+}
+
+ConflatedMdChannel::~ConflatedMdChannel() { Close(); }
+
+void ConflatedMdChannel::Close() {
+  if (addr_) {
+    munmap(addr_, size_);
+  }
+  addr_ = nullptr;
+  size_ = 0;
+  counters_ = nullptr;
+  ring_head_ = nullptr;
+  ring_tail_ = nullptr;
+  ring_ = nullptr;
+  ring_mask_ = 0;
+  slots_ = nullptr;
+  ticker_num_ = 0;
+  delivered_versions_.clear();
+}
+
+uint32_t ConflatedMdChannel::RingSize(uint32_t ticker_num) {
+  // 每个合约在队列中最多出现一次
+  uint32_t size = 1;
+  while (size < ticker_num) {
+    size <<= 1;
+  }
+  return size;
+}
+
+bool ConflatedMdChannel::Create(const std::string& name, uint32_t ticker_num) {
+  return Map(name, true, ticker_num);
+}
+
+bool ConflatedMdChannel::Open(const std::string& name) { return Map(name, false, 0); }
+
+bool ConflatedMdChannel::Map(const std::string& name, bool create, uint32_t ticker_num) {
+  Close();
+
+  // 创建时先在临时文件中建好再替换原文件，仍映射着原文件的策略不受影响
+  auto path = GetConflatedMdChannelPath(name);
+  auto tmp_path = path + ".tmp";
+  int fd = create ? open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666)
+                  : open(path.c_str(), O_RDWR);
+  if (fd < 0) {
+    return false;
+  }
+
+  std::size_t size;
+  if (create) {
+    size = MappingSize(ticker_num, RingSize(ticker_num));
+    if (ftruncate(fd, size) != 0) {
+      close(fd);
+      unlink(tmp_path.c_str());
+      return false;
+    }
+  } else {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+      close(fd);
+      return false;
+    }
+    size = st.st_size;
+  }
+
+  void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    if (create) {
+      unlink(tmp_path.c_str());
+    }
+    return false;
+  }
+
+  auto* header = reinterpret_cast<Header*>(addr);
+  if (create) {
+    header->slot_size = sizeof(Slot);
+    header->ticker_num = ticker_num;
+    header->ring_size = RingSize(ticker_num);
+  } else if (header->magic != kMagic || header->slot_size != sizeof(Slot) ||
+             header->ring_size != RingSize(header->ticker_num) ||
+             MappingSize(header->ticker_num, header->ring_size) > size) {
+    // 写端与读端的TickData定义必须一致
+    munmap(addr, size);
+    return false;
+  }
+
+  auto* base = reinterpret_cast<char*>(addr);
+  addr_ = addr;
+  size_ = size;
+  counters_ = reinterpret_cast<Counters*>(base + 64);
+  ring_head_ = reinterpret_cast<RingIndex*>(base + 64 + sizeof(Counters));
+  ring_tail_ = ring_head_ + 1;
+  ring_ = reinterpret_cast<uint32_t*>(base + RingOffset());
+  ring_mask_ = header->ring_size - 1;
+  slots_ = reinterpret_cast<Slot*>(base + SlotOffset(header->ring_size));
+  ticker_num_ = header->ticker_num;
+  delivered_versions_.resize(ticker_num_ + 1, 0);
+
+  if (create) {
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kMagic;
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+      Close();
+      unlink(tmp_path.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace ft
@@ -0,0 +1,40 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "ft/component/journal_config.h"
+
+#include <algorithm>
+
+namespace ft {
+
+bool GetOrderMqPageConfig(const GlobalConfig& config, yijinjing::PageConfig* page_config) {
+  if (config.order_mq_page_size_mb < 1 || config.order_mq_page_size_mb > 1024) {
+    return false;
+  }
+  page_config->pageSize = config.order_mq_page_size_mb * yijinjing::MB;
+  page_config->preallocate = config.journal_preallocate;
+  page_config->hugePage = false;
+  return true;
+}
+
+bool GetMdMqPageConfig(const GlobalConfig& config, yijinjing::PageConfig* page_config) {
+  if (config.md_mq_page_size_mb < 1 || config.md_mq_page_size_mb > 1024 ||
+      (config.md_mq_huge_page && config.md_mq_page_size_mb % 2 != 0)) {
+    return false;
+  }
+  page_config->pageSize = config.md_mq_page_size_mb * yijinjing::MB;
+  page_config->preallocate = config.journal_preallocate;
+  page_config->hugePage = config.md_mq_huge_page;
+  return true;
+}
+
+bool GetWaitStrategy(const GlobalConfig& config, const std::string& name,
+                     WaitStrategy* strategy) {
+  if (!ParseWaitStrategyType(name.empty() ? config.wait_strategy : name, &strategy->type)) {
+    return false;
+  }
+  strategy->spin_count = static_cast<uint32_t>(std::max(config.wait_spin_count, 0));
+  strategy->timeout_us = static_cast<uint32_t>(std::max(config.wait_timeout_us, 1));
+  return true;
+}
+
+}  // namespace ft
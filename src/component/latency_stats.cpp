@@ -0,0 +1,207 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "ft/component/latency_stats.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+namespace ft {
+
+static std::string GetLatencyStatsPath(const std::string& name) {
+  return "./ft_latency_stats." + name;
+}
+
+const char* LatencyStageStr(LatencyStage stage) {
+  switch (stage) {
+    case kLatencyTickRing:
+      return "tick_ring";
+    case kLatencyOmsDispatch:
+      return "oms_dispatch";
+    case kLatencyStrategyRecv:
+      return "strategy_recv";
+    case kLatencyCmdWrite:
+      return "cmd_write";
+    case kLatencyCmdRead:
+      return "cmd_read";
+    case kLatencyRmsCheck:
+      return "rms_check";
+    case kLatencyGatewaySend:
+      return "gateway_send";
+    case kLatencyTickToTrade:
+      return "tick_to_trade";
+    default:
+      return "unknown";
+  }
+}
+
+uint64_t LatencyHistogram::Percentile(double p) const {
+  if (count == 0) {
+    return 0;
+  }
+  auto target = static_cast<uint64_t>(std::ceil(p * count));
+  if (target == 0) {
+    target = 1;
+  }
+  uint64_t sum = 0;
+  for (std::size_t i = 0; i < kBucketNum; ++i) {
+    sum += buckets[i];
+    if (sum >= target) {
+      return std::min(BucketValue(i), max);
+    }
+  }
+  return max;
+}
+
+LatencyStats::~LatencyStats() { Close(); }
+
+void LatencyStats::Close() {
+  if (addr_) {
+    munmap(addr_, kMappingSize);
+  }
+  addr_ = nullptr;
+  slots_ = nullptr;
+  writable_ = false;
+}
+
+bool LatencyStats::Create(const std::string& name) {
+  Close();
+
+  // 新的统计页先在临时文件中建好再替换原文件，仍映射着原文件的策略或读端不受影响，
+  // 不会因截断而SIGBUS，也不会写入已被重新分配的槽位
+  auto path = GetLatencyStatsPath(name);
+  auto tmp_path = path + ".tmp";
+  int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) {
+    return false;
+  }
+  if (ftruncate(fd, kMappingSize) != 0) {
+    close(fd);
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  void* addr = mmap(nullptr, kMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    unlink(tmp_path.c_str());
+    return false;
+  }
+
+  auto* header = reinterpret_cast<Header*>(addr);
+  header->slot_size = sizeof(Slot);
+  header->slot_num = kMaxThreadNum;
+  header->tsc_per_ns = MeasureTscPerNs();
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kMagic;
+  if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+    munmap(addr, kMappingSize);
+    unlink(tmp_path.c_str());
+    return false;
+  }
+
+  addr_ = addr;
+  slots_ = reinterpret_cast<Slot*>(reinterpret_cast<char*>(addr) + 64);
+  tsc_per_ns_ = header->tsc_per_ns;
+  writable_ = true;
+  return true;
+}
+
+bool LatencyStats::Open(const std::string& name, bool writable) {
+  Close();
+
+  auto path = GetLatencyStatsPath(name);
+  int fd = open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < kMappingSize) {
+    close(fd);
+    return false;
+  }
+  int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  void* addr = mmap(nullptr, kMappingSize, prot, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+
+  // 写端与读端的直方图定义必须一致
+  auto* header = reinterpret_cast<const Header*>(addr);
+  if (header->magic != kMagic || header->slot_size != sizeof(Slot) ||
+      header->slot_num != kMaxThreadNum) {
+    munmap(addr, kMappingSize);
+    return false;
+  }
+
+  addr_ = addr;
+  slots_ = reinterpret_cast<Slot*>(reinterpret_cast<char*>(addr) + 64);
+  tsc_per_ns_ = header->tsc_per_ns;
+  writable_ = writable;
+  return true;
+}
+
+bool LatencyStats::AcquireSlot(const std::string& thread_name, uint32_t* slot_idx) {
+  if (!writable_ || thread_name.empty() || thread_name.size() > kMaxThreadNameLen) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < kMaxThreadNum; ++i) {
+    if (slots_[i].state.load(std::memory_order_acquire) == kSlotUsed &&
+        strncmp(slots_[i].thread_name, thread_name.c_str(), kMaxThreadNameLen) == 0) {
+      *slot_idx = i;
+      return true;
+    }
+  }
+
+  // 多个进程可能同时分配，通过CAS抢占空闲slot
+  for (uint32_t i = 0; i < kMaxThreadNum; ++i) {
+    uint32_t expected = kSlotFree;
+    if (slots_[i].state.compare_exchange_strong(expected, kSlotClaiming,
+                                                std::memory_order_acq_rel)) {
+      strncpy(slots_[i].thread_name, thread_name.c_str(), kMaxThreadNameLen);
+      slots_[i].state.store(kSlotUsed, std::memory_order_release);
+      *slot_idx = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LatencyStats::Load(uint32_t slot_idx, std::string* thread_name,
+                        LatencyHistograms* histograms) const {
+  if (!addr_ || slot_idx >= kMaxThreadNum) {
+    return false;
+  }
+  auto& slot = slots_[slot_idx];
+  if (slot.state.load(std::memory_order_acquire) != kSlotUsed ||
+      !slot.histograms.Load(histograms)) {
+    return false;
+  }
+  *thread_name = std::string(slot.thread_name, strnlen(slot.thread_name, kMaxThreadNameLen));
+  return true;
+}
+
+bool RegisterLatencyRecorder(LatencyStats* stats, const std::string& thread_name,
+                             uint64_t flush_interval_ms) {
+  // 线程退出时释放recorder
+  static thread_local std::unique_ptr<LatencyRecorder> recorder;
+
+  uint32_t slot_idx;
+  if (!stats || !stats->is_open() || !stats->AcquireSlot(thread_name, &slot_idx)) {
+    return false;
+  }
+  auto interval = static_cast<uint64_t>(flush_interval_ms * 1000000 * stats->tsc_per_ns());
+  recorder = std::make_unique<LatencyRecorder>(stats, slot_idx, interval);
+  tls_latency_recorder = recorder.get();
+  return true;
+}
+
+}  // namespace ft
@@ -0,0 +1,267 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "ft/component/md_relay.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+
+#include "ft/base/contract_table.h"
+
+namespace ft {
+
+namespace {
+
+bool ParseAddress(const std::string& address, int port, sockaddr_in* addr) {
+  memset(addr, 0, sizeof(*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_port = htons(static_cast<uint16_t>(port));
+  return inet_pton(AF_INET, address.c_str(), &addr->sin_addr) == 1;
+}
+
+bool IsMulticast(const sockaddr_in& addr) { return IN_MULTICAST(ntohl(addr.sin_addr.s_addr)); }
+
+}  // namespace
+
+uint32_t GetContractTableHash() {
+  // FNV-1a
+  uint32_t hash = 2166136261U;
+  for (uint32_t ticker_id = 1; ticker_id <= ContractTable::size(); ++ticker_id) {
+    for (char c : ContractTable::get_by_index(ticker_id)->ticker) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * 16777619U;
+    }
+    hash = (hash ^ 0xff) * 16777619U;
+  }
+  return hash;
+}
+
+MdRelayPublisher::MdRelayPublisher() {
+  memset(buf_, 0, sizeof(buf_));
+  header()->magic = kMdRelayMagic;
+  header()->version = kMdRelayVersion;
+  header()->contract_hash = GetContractTableHash();
+  header()->session = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+}
+
+void MdRelayPublisher::Flush() {
+  if (tick_num_ == 0) {
+    return;
+  }
+  header()->tick_num = static_cast<uint16_t>(tick_num_);
+  header()->seq = next_seq_;
+  if (!SendPacket(buf_, sizeof(MdRelayHeader) + tick_num_ * sizeof(TickData))) {
+    LOG_ERROR("[MdRelayPublisher::Flush] failed to send packet. seq:{}", next_seq_);
+  }
+  // 发送失败的tick也占用序号，接收端会将其计为丢包
+  next_seq_ += tick_num_;
+  tick_num_ = 0;
+}
+
+MdRelayDecoder::MdRelayDecoder() : contract_hash_(GetContractTableHash()) {}
+
+bool MdRelayDecoder::CheckPacket(const char* data, std::size_t size, uint32_t* begin) {
+  if (size < sizeof(MdRelayHeader)) {
+    return false;
+  }
+  auto* header = reinterpret_cast<const MdRelayHeader*>(data);
+  if (header->magic != kMdRelayMagic || header->version != kMdRelayVersion ||
+      header->contract_hash != contract_hash_ || header->tick_num == 0 ||
+      size != sizeof(MdRelayHeader) + header->tick_num * sizeof(TickData)) {
+    return false;
+  }
+
+  if (header->session != session_) {
+    if (session_ != 0) {
+      LOG_WARN("[MdRelayDecoder] publisher restarted. last seq:{}", next_seq_ - 1);
+    }
+    session_ = header->session;
+    next_seq_ = header->seq;
+  }
+
+  uint64_t seq = header->seq;
+  uint64_t end = seq + header->tick_num;
+  if (seq > next_seq_) {
+    ++gap_count_;
+    lost_ticks_ += seq - next_seq_;
+    LOG_WARN("[MdRelayDecoder] gap detected. expected seq:{} received seq:{}", next_seq_, seq);
+    *begin = 0;
+  } else if (end <= next_seq_) {
+    dup_ticks_ += header->tick_num;
+    *begin = header->tick_num;
+    return true;
+  } else {
+    dup_ticks_ += next_seq_ - seq;
+    *begin = static_cast<uint32_t>(next_seq_ - seq);
+  }
+  next_seq_ = end;
+  return true;
+}
+
+UdpMdPublisher::~UdpMdPublisher() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+bool UdpMdPublisher::Init(const std::string& address, int port, const std::string& interface) {
+  static_assert(sizeof(dst_addr_) == sizeof(sockaddr_in));
+  auto* dst = reinterpret_cast<sockaddr_in*>(dst_addr_);
+  if (!ParseAddress(address, port, dst)) {
+    LOG_ERROR("[UdpMdPublisher::Init] invalid address {}", address);
+    return false;
+  }
+
+  fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd_ < 0) {
+    LOG_ERROR("[UdpMdPublisher::Init] failed to create socket");
+    return false;
+  }
+
+  if (IsMulticast(*dst)) {
+    // 允许同一主机上的接收端收到组播
+    int loop = 1;
+    int ttl = 1;
+    if (setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0 ||
+        setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) != 0) {
+      LOG_ERROR("[UdpMdPublisher::Init] failed to set multicast options");
+      return false;
+    }
+    if (!interface.empty()) {
+      in_addr if_addr;
+      if (inet_pton(AF_INET, interface.c_str(), &if_addr) != 1 ||
+          setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_IF, &if_addr, sizeof(if_addr)) != 0) {
+        LOG_ERROR("[UdpMdPublisher::Init] invalid interface {}", interface);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool UdpMdPublisher::SendPacket(const char* data, std::size_t size) {
+  auto res = sendto(fd_, data, size, 0, reinterpret_cast<const sockaddr*>(dst_addr_),
+                    sizeof(sockaddr_in));
+  return res == static_cast<ssize_t>(size);
+}
+
+UdpMdReceiver::~UdpMdReceiver() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+bool UdpMdReceiver::Init(const std::string& address, int port, const std::string& interface) {
+  sockaddr_in addr;
+  if (!ParseAddress(address, port, &addr)) {
+    LOG_ERROR("[UdpMdReceiver::Init] invalid address {}", address);
+    return false;
+  }
+
+  fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd_ < 0) {
+    LOG_ERROR("[UdpMdReceiver::Init] failed to create socket");
+    return false;
+  }
+  // 同一主机上可以有多个接收端，加大接收缓冲区以应对突发行情
+  int reuse = 1;
+  int rcvbuf = 8 << 20;
+  setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+  sockaddr_in bind_addr = addr;
+  if (!IsMulticast(addr)) {
+    bind_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  }
+  if (bind(fd_, reinterpret_cast<sockaddr*>(&bind_addr), sizeof(bind_addr)) != 0) {
+    LOG_ERROR("[UdpMdReceiver::Init] failed to bind port {}", port);
+    return false;
+  }
+
+  if (IsMulticast(addr)) {
+    ip_mreq mreq;
+    mreq.imr_multiaddr = addr.sin_addr;
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (!interface.empty() && inet_pton(AF_INET, interface.c_str(), &mreq.imr_interface) != 1) {
+      LOG_ERROR("[UdpMdReceiver::Init] invalid interface {}", interface);
+      return false;
+    }
+    if (setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+      LOG_ERROR("[UdpMdReceiver::Init] failed to join multicast group {}", address);
+      return false;
+    }
+  }
+
+  if (fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) | O_NONBLOCK) != 0) {
+    LOG_ERROR("[UdpMdReceiver::Init] failed to set nonblocking");
+    return false;
+  }
+  return true;
+}
+
+bool UdpMdReceiver::Poll(TickData* tick) {
+  while (tick_idx_ == tick_num_) {
+    auto res = recv(fd_, buf_, sizeof(buf_), 0);
+    if (res <= 0) {
+      return false;
+    }
+    tick_idx_ = tick_num_ = 0;
+    if (!decoder_.Decode(buf_, res, [this](const TickData& t) { ticks_[tick_num_++] = t; })) {
+      LOG_ERROR("[UdpMdReceiver::Poll] invalid packet. size:{}", res);
+    }
+  }
+  *tick = ticks_[tick_idx_++];
+  return true;
+}
+
+bool TcpMdPublisher::SendPacket(const char* data, std::size_t size) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    snapshot_.assign(conn_ids_.begin(), conn_ids_.end());
+  }
+  bool res = true;
+  for (int conn_id : snapshot_) {
+    res &= SendMsg(conn_id, kMdRelayMsgType, data, size);
+  }
+  return res;
+}
+
+void TcpMdPublisher::OnConnected(int conn_id) {
+  LOG_INFO("[TcpMdPublisher] subscriber connected. conn_id:{}", conn_id);
+  std::unique_lock<std::mutex> lock(mutex_);
+  conn_ids_.emplace(conn_id);
+}
+
+void TcpMdPublisher::OnDisconnected(int conn_id) {
+  LOG_INFO("[TcpMdPublisher] subscriber disconnected. conn_id:{}", conn_id);
+  std::unique_lock<std::mutex> lock(mutex_);
+  conn_ids_.erase(conn_id);
+}
+
+bool TcpMdReceiver::Init(const std::string& ip, int port) {
+  ip_ = ip;
+  port_ = port;
+  return StartClient() && Connect(ip_, port_, GenConnId());
+}
+
+void TcpMdReceiver::OnRecvMsg(int conn_id, uint32_t msg_type, const char* data,
+                              std::size_t size) {
+  if (msg_type != kMdRelayMsgType ||
+      !decoder_.Decode(data, size, [this](const TickData& tick) { rb_->PutWithBlocking(tick); })) {
+    LOG_ERROR("[TcpMdReceiver] invalid packet. msg_type:{} size:{}", msg_type, size);
+  }
+}
+
+void TcpMdReceiver::OnDisconnected(int conn_id) {
+  LOG_WARN("[TcpMdReceiver] disconnected from {}:{}. reconnect in 1s", ip_, port_);
+  // 在事件循环线程中回调，不能阻塞
+  ConnectLater(ip_, port_, GenConnId(), 1000);
+}
+
+}  // namespace ft
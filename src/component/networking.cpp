@@ -2,6 +2,7 @@
 
 #include "ft/component/networking.h"
 
+#include <cstring>
 #include <stdexcept>
 
 #include "ft/base/log.h"
@@ -21,9 +22,18 @@ void uv_connection_cb(uv_stream_t* server, int status) {
   reinterpret_cast<NetworkNode*>(server->data)->OnUvConnection(status);
 }
 
+constexpr std::size_t kInitRecvBufSize = 256 * 1024;
+constexpr std::size_t kMinRecvSpace = 64 * 1024;
+// 发送过大消息后发送缓冲区超过该大小时释放，避免一直占用内存
+constexpr std::size_t kMaxIdleSendBufSize = 4 * 1024 * 1024;
+
+std::size_t FrameSize(uint32_t body_size) {
+  return sizeof(NetworkMsgHeader) + ((body_size + 7UL) & ~7UL);
+}
+
 void uv_alloc_cb(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf) {
-  buf->base = new char[suggested_size];
-  buf->len = suggested_size;
+  auto* conn = reinterpret_cast<NetworkNode::Connection*>(handle->data);
+  conn->node->OnUvAlloc(conn, buf);
 }
 
 void uv_async_task(uv_async_t* handle) {
@@ -34,12 +44,18 @@ void uv_async_exit(uv_async_t* handle) {
   reinterpret_cast<NetworkNode*>(handle->data)->OnUvAsyncExit();
 }
 
+void uv_connect_timer_cb(uv_timer_t* handle) {
+  auto* delayed = reinterpret_cast<NetworkNode::DelayedConnect*>(handle->data);
+  delayed->node->OnUvConnectTimer(delayed);
+}
+
+void uv_connect_timer_close_cb(uv_handle_t* handle) {
+  delete reinterpret_cast<NetworkNode::DelayedConnect*>(handle->data);
+}
+
 auto uv_read_cb(uv_stream_t* client, ssize_t nread, const uv_buf_t* buf) {
   auto* conn = reinterpret_cast<NetworkNode::Connection*>(client->data);
-  if (buf->base) {
-    reinterpret_cast<NetworkNode*>(conn->node)->OnUvRead(conn->conn_id, buf->base, nread);
-    delete[] buf->base;
-  }
+  conn->node->OnUvRead(conn->conn_id, nread);
 }
 
 }  // namespace
@@ -63,9 +79,11 @@ NetworkNode::~NetworkNode() {
   }
 }
 
-bool NetworkNode::StartServer(int port) {
+bool NetworkNode::StartServer(int port) { return StartServer("127.0.0.1", port); }
+
+bool NetworkNode::StartServer(const std::string& ip, int port) {
   struct sockaddr_in addr;
-  if (uv_ip4_addr("127.0.0.1", port, &addr) != 0) {
+  if (uv_ip4_addr(ip.c_str(), port, &addr) != 0) {
     return false;
   }
 
@@ -93,11 +111,19 @@ bool NetworkNode::StartClient() {
 
 int NetworkNode::GenConnId() { return next_conn_id(); }
 
-bool NetworkNode::Connect(int port, int conn_id) {
+bool NetworkNode::Connect(int port, int conn_id) { return Connect("127.0.0.1", port, conn_id); }
+
+bool NetworkNode::Connect(const std::string& ip, int port, int conn_id) {
+  struct sockaddr_in addr;
+  if (uv_ip4_addr(ip.c_str(), port, &addr) != 0) {
+    return false;
+  }
+
   Task task{};
   task.conn_id = conn_id;
   task.type = kConnect;
   task.args[0] = port;
+  task.args[1] = addr.sin_addr.s_addr;
   PutTask(task);
   Notify();
 
@@ -106,6 +132,24 @@ bool NetworkNode::Connect(int port, int conn_id) {
 
 bool NetworkNode::Connect(int port) { return Connect(port, GenConnId()); }
 
+bool NetworkNode::ConnectLater(const std::string& ip, int port, int conn_id, uint64_t delay_ms) {
+  struct sockaddr_in addr;
+  if (uv_ip4_addr(ip.c_str(), port, &addr) != 0) {
+    return false;
+  }
+
+  Task task{};
+  task.conn_id = conn_id;
+  task.type = kConnect;
+  task.args[0] = port;
+  task.args[1] = addr.sin_addr.s_addr;
+  task.args[2] = delay_ms;
+  PutTask(task);
+  Notify();
+
+  return true;
+}
+
 bool NetworkNode::Disconnect(int conn_id) {
   Task task{};
   task.conn_id = conn_id;
@@ -120,24 +164,47 @@ bool NetworkNode::SendMsg(int conn_id, const nlohmann::json& msg) {
   if (msg_str.size() == 0) {
     return true;
   }
+  return PutSendTask(conn_id, kJsonMsgType, msg_str.data(), msg_str.size());
+}
 
-  std::size_t data_size = msg_str.size() + sizeof(uint64_t);
-  char* data = new char[data_size];
-  *reinterpret_cast<uint64_t*>(data) = msg_str.size();
-  memcpy(data + sizeof(uint64_t), msg_str.c_str(), msg_str.size());
+bool NetworkNode::SendMsg(int conn_id, uint32_t msg_type, const void* data, std::size_t size) {
+  if (msg_type == kJsonMsgType) {
+    return false;
+  }
+  return PutSendTask(conn_id, msg_type, data, size);
+}
+
+bool NetworkNode::PutSendTask(int conn_id, uint32_t msg_type, const void* data,
+                              std::size_t size) {
+  if (size > kMaxBodySize) {
+    LOG_ERROR("[NetworkNode::SendMsg] msg too large. size:{}", size);
+    return false;
+  }
+
+  std::size_t frame_size = FrameSize(static_cast<uint32_t>(size));
+  NetworkMsgHeader header{static_cast<uint32_t>(size), msg_type};
 
   Task task{};
   task.conn_id = conn_id;
   task.type = kSend;
-  task.args[0] = reinterpret_cast<uint64_t>(data);
-  task.args[1] = data_size;
-  PutTask(task);
+  task.args[1] = frame_size;
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    std::size_t offset = snd_buf_.size();
+    snd_buf_.resize(offset + frame_size);
+    char* frame = snd_buf_.data() + offset;
+    memcpy(frame, &header, sizeof(header));
+    memcpy(frame + sizeof(header), data, size);
+    memset(frame + sizeof(header) + size, 0, frame_size - sizeof(header) - size);
+    task.args[0] = offset;
+    task_queue_.emplace_back(task);
+  }
   Notify();
 
   return true;
 }
 
-void NetworkNode::DoConnect(int conn_id, int port) {
+void NetworkNode::DoConnect(int conn_id, uint32_t ip, int port) {
   if (connections_.find(conn_id) != connections_.end()) {
     return;
   }
@@ -151,9 +218,10 @@ void NetworkNode::DoConnect(int conn_id, int port) {
   auto* connect_req = new uv_connect_t;
   connect_req->data = this;
 
-  if (uv_ip4_addr("127.0.0.1", static_cast<int>(port), &addr) != 0) {
-    goto handle_error;
-  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  addr.sin_addr.s_addr = ip;
 
   if (uv_tcp_init(&loop_, &client) != 0) {
     goto handle_error;
@@ -174,6 +242,29 @@ handle_error:
   OnDisconnected(conn_id);
 }
 
+void NetworkNode::DoConnectLater(int conn_id, uint32_t ip, int port, uint64_t delay_ms) {
+  auto* delayed = new DelayedConnect{this, {}, conn_id, ip, port};
+  delayed->timer.data = delayed;
+  if (uv_timer_init(&loop_, &delayed->timer) != 0) {
+    delete delayed;
+    OnDisconnected(conn_id);
+    return;
+  }
+  if (uv_timer_start(&delayed->timer, uv_connect_timer_cb, delay_ms, 0) != 0) {
+    uv_close(reinterpret_cast<uv_handle_t*>(&delayed->timer), uv_connect_timer_close_cb);
+    OnDisconnected(conn_id);
+  }
+}
+
+void NetworkNode::OnUvConnectTimer(DelayedConnect* delayed) {
+  // 定时器在close回调中释放，先取出连接参数
+  int conn_id = delayed->conn_id;
+  uint32_t ip = delayed->ip;
+  int port = delayed->port;
+  uv_close(reinterpret_cast<uv_handle_t*>(&delayed->timer), uv_connect_timer_close_cb);
+  DoConnect(conn_id, ip, port);
+}
+
 void NetworkNode::DoDisconnect(int conn_id) {
   auto it = connections_.find(conn_id);
   if (it == connections_.end()) {
@@ -187,19 +278,19 @@ void NetworkNode::DoDisconnect(int conn_id) {
   OnDisconnected(conn_id);
 }
 
-void NetworkNode::DoSendMsg(int conn_id, char* data, std::size_t size) {
+void NetworkNode::DoSendMsg(int conn_id, const char* data, std::size_t size) {
   std::shared_ptr<Connection> conn;
   uv_buf_t buf;
   std::size_t nsend = 0;
 
   auto it = connections_.find(conn_id);
   if (it == connections_.end() || conn_id != it->second->conn_id) {
-    goto free_data;
+    return;
   }
 
   conn = it->second;
   for (;;) {
-    buf = uv_buf_init(data + nsend, size - nsend);
+    buf = uv_buf_init(const_cast<char*>(data) + nsend, size - nsend);
     int r = uv_try_write(reinterpret_cast<uv_stream_t*>(&conn->client), &buf, 1);
     if (r == UV_EAGAIN) {
       continue;
@@ -215,9 +306,6 @@ void NetworkNode::DoSendMsg(int conn_id, char* data, std::size_t size) {
       break;
     }
   }
-
-free_data:
-  delete[] data;
 }
 
 void NetworkNode::OnHeartBeat(int conn_id) {}
@@ -291,28 +379,60 @@ handle_error:
   OnDisconnected(conn_id);
 }
 
-void NetworkNode::OnUvRead(int conn_id, const char* data, ssize_t len) {
+void NetworkNode::OnUvAlloc(Connection* conn, uv_buf_t* buf) {
+  auto& rcv_buf = conn->rcv_buf;
+  if (rcv_buf.empty()) {
+    rcv_buf.resize(kInitRecvBufSize);
+  } else if (rcv_buf.size() - conn->rcv_size < kMinRecvSpace) {
+    // 缓冲区中只会剩下不完整的消息，空间不足说明有大消息，扩容以容纳整条消息
+    rcv_buf.resize(rcv_buf.size() * 2);
+  }
+  buf->base = rcv_buf.data() + conn->rcv_size;
+  buf->len = rcv_buf.size() - conn->rcv_size;
+}
+
+bool NetworkNode::DispatchMsgs(Connection* conn) {
+  auto& buf = conn->rcv_buf;
+  std::size_t pos = 0;
+  while (conn->rcv_size - pos >= sizeof(NetworkMsgHeader)) {
+    auto* header = reinterpret_cast<const NetworkMsgHeader*>(&buf[pos]);
+    if (header->body_size > kMaxBodySize) {
+      return false;
+    }
+    std::size_t frame_size = FrameSize(header->body_size);
+    if (conn->rcv_size - pos < frame_size) {
+      break;
+    }
+    const char* body = &buf[pos + sizeof(NetworkMsgHeader)];
+    if (header->msg_type == kJsonMsgType) {
+      auto msg = nlohmann::json::parse(body, body + header->body_size);
+      OnRecvMsg(conn->conn_id, msg);
+    } else {
+      OnRecvMsg(conn->conn_id, header->msg_type, body, header->body_size);
+    }
+    pos += frame_size;
+  }
+  if (pos > 0) {
+    conn->rcv_size -= pos;
+    memmove(buf.data(), buf.data() + pos, conn->rcv_size);
+  }
+  return true;
+}
+
+void NetworkNode::OnUvRead(int conn_id, ssize_t len) {
   auto it = connections_.find(conn_id);
   if (it == connections_.end() || it->second->conn_id != conn_id) {
     return;
   }
-  auto& conn = it->second;
+  auto conn = it->second;
 
   if (len > 0) {
-    auto& buf = conn->rcv_buf;
-    buf.insert(buf.end(), data, data + len);
-    std::size_t pos = 0;
-    while (pos + sizeof(uint64_t) <= buf.size() &&
-           pos + sizeof(uint64_t) + *reinterpret_cast<uint64_t*>(&buf[pos]) <= buf.size()) {
-      uint64_t msg_size = *reinterpret_cast<uint64_t*>(&buf[pos]);
-      auto msg = nlohmann::json::parse(&buf[pos + sizeof(uint64_t)],
-                                       &buf[pos + sizeof(uint64_t) + msg_size]);
-      OnRecvMsg(conn_id, msg);
-      pos += sizeof(uint64_t) + msg_size;
-    }
-    if (pos > 0) {
-      std::vector<char> new_buf(buf.begin() + pos, buf.end());
-      buf = std::move(new_buf);
+    conn->rcv_size += len;
+    if (!DispatchMsgs(conn.get())) {
+      LOG_ERROR("invalid msg. conn_id:{}", conn_id);
+      uv_close(reinterpret_cast<uv_handle_t*>(&conn->client), nullptr);
+      connections_.erase(conn_id);
+      OnDisconnected(conn_id);
     }
   } else if (len < 0) {
     if (len == UV_EOF) {
@@ -327,18 +447,33 @@ void NetworkNode::OnUvRead(int conn_id, const char* data, ssize_t len) {
 }
 
 void NetworkNode::OnUvAsyncTask() {
-  Task task{};
-  while (GetTask(&task)) {
-    if (task.type == kConnect) {
-      DoConnect(task.conn_id, task.args[0]);
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    std::swap(task_queue_, executing_tasks_);
+    std::swap(snd_buf_, sending_buf_);
+  }
+
+  // 回调中可能再次发起任务，新任务追加到交换后的task_queue_中，不影响当前的遍历
+  for (auto& task : executing_tasks_) {
+    if (task.type == kConnect && task.args[2] > 0) {
+      DoConnectLater(task.conn_id, static_cast<uint32_t>(task.args[1]),
+                     static_cast<int>(task.args[0]), task.args[2]);
+    } else if (task.type == kConnect) {
+      DoConnect(task.conn_id, static_cast<uint32_t>(task.args[1]),
+                static_cast<int>(task.args[0]));
     } else if (task.type == kDisconnect) {
       DoDisconnect(task.conn_id);
     } else if (task.type == kSend) {
-      DoSendMsg(task.conn_id, reinterpret_cast<char*>(task.args[0]), task.args[1]);
+      DoSendMsg(task.conn_id, sending_buf_.data() + task.args[0], task.args[1]);
     } else {
       abort();
     }
   }
+  executing_tasks_.clear();
+  sending_buf_.clear();
+  if (sending_buf_.capacity() > kMaxIdleSendBufSize) {
+    std::vector<char>().swap(sending_buf_);
+  }
 }
 
 void NetworkNode::OnUvAsyncExit() {
@@ -348,17 +483,7 @@ void NetworkNode::OnUvAsyncExit() {
 
 void NetworkNode::PutTask(const Task& task) {
   std::unique_lock<std::mutex> lock(mtx_);
-  task_queue_.push(task);
-}
-
-bool NetworkNode::GetTask(Task* task) {
-  std::unique_lock<std::mutex> lock(mtx_);
-  if (task_queue_.empty()) {
-    return false;
-  }
-  *task = task_queue_.front();
-  task_queue_.pop();
-  return true;
+  task_queue_.emplace_back(task);
 }
 
 void NetworkNode::Notify() { uv_async_send(&async_task_req_); }
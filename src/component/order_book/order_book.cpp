@@ -2,76 +2,318 @@
 
 #include "ft/component/order_book/order_book.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
 namespace ft::orderbook {
 
-void OrderBook::AddOrder(LimitOrder* order) {
-  auto* level = FindOrCreateLevel(order->price(), order->decimal_price(), order->is_buy());
-  order->set_level(level);
-  level->AddOrder(order);
-  order_map_.emplace(order->id(), *order);
+namespace {
+
+constexpr std::size_t kMinLevelNum = 1024;
+
+inline std::size_t RoundUpPow2(std::size_t n) {
+  std::size_t res = 1;
+  while (res < n) {
+    res <<= 1;
+  }
+  return res;
 }
 
-void OrderBook::ModifyOrder(LimitOrder* order) {
-  auto it = order_map_.find(order->id());
-  if (it == order_map_.end()) {
-    auto* level = FndLevel(order->decimal_price(), order->is_buy());
-    level->AddOrder(order);
-    order_map_.emplace(order->id(), *order);
+// 返回a是否为比b更优的价位
+inline bool IsBetter(bool is_buy, int64_t a, int64_t b) { return is_buy ? a > b : a < b; }
+
+}  // namespace
+
+OrderBook::OrderBook(uint32_t ticker_id, double price_tick, std::size_t capacity)
+    : tid_(ticker_id), price_tick_(price_tick) {
+  assert(price_tick > 0);
+  auto cap = RoundUpPow2(capacity);
+  nodes_.reserve(cap);
+  // 负载因子不超过0.5
+  index_.resize(cap * 2);
+  index_mask_ = index_.size() - 1;
+
+  bid_.is_buy = true;
+  ask_.is_buy = false;
+}
+
+int64_t OrderBook::to_tick_price(double price) const { return std::llround(price / price_tick_); }
+
+void OrderBook::to_tick(TickData* tick) const {
+  tick->ticker_id = tid_;
+  for (int i = 0; i < kMaxMarketLevel; ++i) {
+    auto* level = top_level(bid_, i);
+    tick->bid[i] = level ? level->price() : 0.0;
+    tick->bid_volume[i] = level ? level->total_volume() : 0;
+    level = top_level(ask_, i);
+    tick->ask[i] = level ? level->price() : 0.0;
+    tick->ask_volume[i] = level ? level->total_volume() : 0;
+  }
+}
+
+bool OrderBook::AddOrder(const LimitOrder* order) {
+  if (order->id() == 0 || order->volume() <= 0 || order->price() <= 0 ||
+      find_index(order->id()) != kNotFound) {
+    return false;
+  }
+
+  uint32_t idx = AllocNode();
+  auto& node = nodes_[idx];
+  node = *order;
+  node.tick_price_ = to_tick_price(order->price());
+  insert_index(order->id(), idx);
+  Link(idx);
+  ++order_num_;
+  return true;
+}
+
+bool OrderBook::ModifyOrder(const LimitOrder* order) {
+  auto pos = find_index(order->id());
+  if (pos == kNotFound || order->volume() <= 0 || order->price() <= 0) {
+    return false;
+  }
+
+  uint32_t idx = index_[pos].slot;
+  auto& node = nodes_[idx];
+  auto tick_price = to_tick_price(order->price());
+  if (node.is_buy_ != order->is_buy() || node.tick_price_ != tick_price) {
+    Unlink(idx);
+    node.is_buy_ = order->is_buy();
+    node.volume_ = order->volume();
+    node.price_ = order->price();
+    node.decimal_price_ = order->decimal_price();
+    node.tick_price_ = tick_price;
+    Link(idx);
   } else {
-    auto& ori_order = it->second;
-    auto* ori_level = FndLevel(ori_order.decimal_price(), ori_order.is_buy());
-    assert(ori_level);
-    if (ori_order.decimal_price() != order->decimal_price()) {
-      ori_level->RemoveOrder(&ori_order);
-      if (ori_level->total_volume() == 0) {
-        if (ori_order.is_buy())
-          buy_levels_.erase(ori_level->decimal_price());
-        else
-          sell_levels_.erase(ori_level->decimal_price());
-      }
-      auto new_level = FindOrCreateLevel(order->price(), order->decimal_price(), order->is_buy());
-      new_level->AddOrder(order);
-      order->set_level(new_level);
-    } else {
-      ori_level->ModifyOrder(order);
-      order->set_level(ori_level);
+    auto& side = side_of(node.is_buy_);
+    auto& level = side.levels[tick_price & (side.levels.size() - 1)];
+    level.total_volume_ += order->volume() - node.volume_;
+    node.volume_ = order->volume();
+  }
+  return true;
+}
+
+bool OrderBook::CancelOrder(uint64_t order_id) {
+  auto pos = find_index(order_id);
+  if (pos == kNotFound) {
+    return false;
+  }
+
+  uint32_t idx = index_[pos].slot;
+  erase_index(pos);
+  Unlink(idx);
+  FreeNode(idx);
+  --order_num_;
+  return true;
+}
+
+bool OrderBook::ExecuteOrder(uint64_t order_id, int volume) {
+  auto pos = find_index(order_id);
+  if (pos == kNotFound || volume <= 0) {
+    return false;
+  }
+
+  uint32_t idx = index_[pos].slot;
+  auto& node = nodes_[idx];
+  if (volume >= node.volume_) {
+    erase_index(pos);
+    Unlink(idx);
+    FreeNode(idx);
+    --order_num_;
+  } else {
+    auto& side = side_of(node.is_buy_);
+    side.levels[node.tick_price_ & (side.levels.size() - 1)].total_volume_ -= volume;
+    node.volume_ -= volume;
+  }
+  return true;
+}
+
+void OrderBook::Link(uint32_t idx) {
+  auto& node = nodes_[idx];
+  auto& side = side_of(node.is_buy_);
+  auto p = node.tick_price_;
+
+  bool created = false;
+  if (side.level_num == 0 || p < side.low || p > side.high ||
+      side.levels[p & (side.levels.size() - 1)].empty()) {
+    ReserveLevel(&side, p);
+    created = true;
+  }
+
+  auto& level = side.levels[p & (side.levels.size() - 1)];
+  if (created) {
+    level.price_ = node.price_;
+    level.decimal_price_ = node.decimal_price_;
+  }
+  node.prev_ = level.tail_;
+  node.next_ = PriceLevel::kNil;
+  if (level.tail_ == PriceLevel::kNil) {
+    level.head_ = idx;
+  } else {
+    nodes_[level.tail_].next_ = idx;
+  }
+  level.tail_ = idx;
+  level.total_volume_ += node.volume_;
+  ++level.order_num_;
+
+  if (created) {
+    ++side.level_num;
+    OnLevelCreated(&side, p);
+  }
+}
+
+void OrderBook::Unlink(uint32_t idx) {
+  auto& node = nodes_[idx];
+  auto& side = side_of(node.is_buy_);
+  auto mask = side.levels.size() - 1;
+  auto p = node.tick_price_;
+  auto& level = side.levels[p & mask];
+
+  if (node.prev_ == PriceLevel::kNil) {
+    level.head_ = node.next_;
+  } else {
+    nodes_[node.prev_].next_ = node.next_;
+  }
+  if (node.next_ == PriceLevel::kNil) {
+    level.tail_ = node.prev_;
+  } else {
+    nodes_[node.next_].prev_ = node.prev_;
+  }
+  level.total_volume_ -= node.volume_;
+  --level.order_num_;
+  if (!level.empty()) {
+    return;
+  }
+
+  // 价位被清空时收缩非空价位的范围
+  --side.level_num;
+  if (side.level_num > 0) {
+    while (side.levels[side.low & mask].empty()) {
+      ++side.low;
+    }
+    while (side.levels[side.high & mask].empty()) {
+      --side.high;
     }
-    ori_order = *order;
   }
+  OnLevelRemoved(&side, p);
 }
 
-void OrderBook::RemoveOrder(LimitOrder* order) {
-  auto it = order_map_.find(order->id());
-  if (it == order_map_.end()) return;
-  order_map_.erase(it);
-  auto* level = FndLevel(order->decimal_price(), order->is_buy());
-  assert(level);
-  level->RemoveOrder(order);
-  if (level->total_volume() == 0) {
-    if (order->is_buy())
-      buy_levels_.erase(order->decimal_price());
-    else
-      sell_levels_.erase(order->decimal_price());
+void OrderBook::ReserveLevel(BookSide* side, int64_t p) {
+  if (side->level_num == 0) {
+    if (side->levels.empty()) {
+      side->levels.resize(kMinLevelNum);
+    }
+    side->low = p;
+    side->high = p;
+    return;
   }
+
+  auto low = std::min(side->low, p);
+  auto high = std::max(side->high, p);
+  auto level_num = side->levels.size();
+  if (static_cast<std::size_t>(high - low) >= level_num) {
+    auto new_level_num = RoundUpPow2(high - low + 1);
+    std::vector<PriceLevel> levels(new_level_num);
+    for (auto i = side->low; i <= side->high; ++i) {
+      levels[i & (new_level_num - 1)] = side->levels[i & (level_num - 1)];
+    }
+    side->levels.swap(levels);
+  }
+  side->low = low;
+  side->high = high;
 }
 
-void OrderBook::to_tick(TickData* tick) {
-  tick->ticker_id = tid_;
+void OrderBook::OnLevelCreated(BookSide* side, int64_t p) {
+  if (side->depth_num == kMaxMarketLevel &&
+      !IsBetter(side->is_buy, p, side->depth[kMaxMarketLevel - 1])) {
+    return;
+  }
+
+  int i = side->depth_num < kMaxMarketLevel ? side->depth_num : kMaxMarketLevel - 1;
+  for (; i > 0 && IsBetter(side->is_buy, p, side->depth[i - 1]); --i) {
+    side->depth[i] = side->depth[i - 1];
+  }
+  side->depth[i] = p;
+  if (side->depth_num < kMaxMarketLevel) {
+    ++side->depth_num;
+  }
+}
 
+void OrderBook::OnLevelRemoved(BookSide* side, int64_t p) {
   int i = 0;
-  for (auto& [_, bid_level] : buy_levels_) {
-    tick->bid[i] = bid_level.price();
-    tick->bid_volume[i] = bid_level.total_volume();
+  while (i < side->depth_num && side->depth[i] != p) {
     ++i;
-    if (i == kMaxMarketLevel) break;
   }
-  i = 0;
-  for (auto& [_, ask_level] : sell_levels_) {
-    tick->ask[i] = ask_level.price();
-    tick->ask_volume[i] = ask_level.total_volume();
-    ++i;
-    if (i == kMaxMarketLevel) break;
+  if (i == side->depth_num) {
+    return;
+  }
+  for (; i + 1 < side->depth_num; ++i) {
+    side->depth[i] = side->depth[i + 1];
+  }
+  --side->depth_num;
+
+  // 档位外还有价位时，从当前最后一档往劣方向找下一个非空价位
+  if (side->level_num > static_cast<uint32_t>(side->depth_num)) {
+    auto mask = side->levels.size() - 1;
+    auto next = side->depth_num > 0 ? side->depth[side->depth_num - 1]
+                                    : (side->is_buy ? side->high + 1 : side->low - 1);
+    do {
+      next += side->is_buy ? -1 : 1;
+    } while (side->levels[next & mask].empty());
+    side->depth[side->depth_num++] = next;
+  }
+}
+
+uint32_t OrderBook::AllocNode() {
+  if (free_head_ == PriceLevel::kNil) {
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+  }
+  uint32_t idx = free_head_;
+  free_head_ = nodes_[idx].next_;
+  return idx;
+}
+
+void OrderBook::FreeNode(uint32_t idx) {
+  nodes_[idx].next_ = free_head_;
+  free_head_ = idx;
+}
+
+void OrderBook::insert_index(uint64_t order_id, uint32_t slot) {
+  // 负载因子超过0.5时扩容并重建索引
+  if ((order_num_ + 1) * 2 > index_.size()) {
+    std::vector<IndexEntry> old_index(index_.size() * 2);
+    old_index.swap(index_);
+    index_mask_ = index_.size() - 1;
+    for (auto& entry : old_index) {
+      if (entry.order_id != 0) {
+        insert_index(entry.order_id, entry.slot);
+      }
+    }
+  }
+
+  std::size_t pos = order_id & index_mask_;
+  while (index_[pos].order_id != 0) {
+    pos = (pos + 1) & index_mask_;
+  }
+  index_[pos].order_id = order_id;
+  index_[pos].slot = slot;
+}
+
+void OrderBook::erase_index(std::size_t pos) {
+  // backward shift deletion，保证线性探测链不断开
+  std::size_t hole = pos;
+  std::size_t next = (hole + 1) & index_mask_;
+  while (index_[next].order_id != 0) {
+    std::size_t home = index_[next].order_id & index_mask_;
+    if (((next - home) & index_mask_) >= ((next - hole) & index_mask_)) {
+      index_[hole] = index_[next];
+      hole = next;
+    }
+    next = (next + 1) & index_mask_;
   }
+  index_[hole].order_id = 0;
 }
 
 }  // namespace ft::orderbook
@@ -0,0 +1,179 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "ft/component/position_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "ft/base/contract_table.h"
+
+namespace ft {
+
+static std::string GetPositionCachePath(const std::string& name) {
+  return "./ft_position_cache." + name;
+}
+
+PositionCache::~PositionCache() { Close(); }
+
+void PositionCache::Close() {
+  if (addr_) {
+    munmap(addr_, size_);
+  }
+  addr_ = nullptr;
+  size_ = 0;
+  strategies_ = nullptr;
+  account_ = nullptr;
+  positions_ = nullptr;
+  strategy_num_ = 0;
+  ticker_num_ = 0;
+  writable_ = false;
+}
+
+void PositionCache::Attach(void* addr, std::size_t size, bool writable) {
+  auto* header = reinterpret_cast<const Header*>(addr);
+  auto* p = reinterpret_cast<char*>(addr) + 64;
+  addr_ = addr;
+  size_ = size;
+  strategy_num_ = header->strategy_num;
+  ticker_num_ = header->ticker_num;
+  strategies_ = reinterpret_cast<StrategySlot*>(p);
+  p += strategy_num_ * sizeof(StrategySlot);
+  account_ = reinterpret_cast<AccountSlot*>(p);
+  p += sizeof(AccountSlot);
+  positions_ = reinterpret_cast<PositionSlot*>(p);
+  writable_ = writable;
+}
+
+bool PositionCache::Create(const std::string& name, const std::vector<std::string>& strategies,
+                           uint32_t ticker_num) {
+  Close();
+
+  for (auto& strategy : strategies) {
+    if (strategy.size() >= sizeof(StrategyIdType)) {
+      return false;
+    }
+  }
+
+  // 在临时文件中建好后再替换原文件，OMS重启期间仍映射着原文件的策略不会读到清零的页
+  auto path = GetPositionCachePath(name);
+  auto tmp_path = path + ".tmp";
+  int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) {
+    return false;
+  }
+  auto strategy_num = static_cast<uint32_t>(strategies.size());
+  std::size_t size = MappingSize(strategy_num, ticker_num);
+  if (ftruncate(fd, size) != 0) {
+    close(fd);
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    unlink(tmp_path.c_str());
+    return false;
+  }
+
+  auto* header = reinterpret_cast<Header*>(addr);
+  header->slot_size = sizeof(PositionSlot);
+  header->strategy_num = strategy_num;
+  header->ticker_num = ticker_num;
+  Attach(addr, size, true);
+  for (uint32_t i = 0; i < strategy_num; ++i) {
+    strncpy(strategies_[i].name, strategies[i].c_str(), sizeof(StrategyIdType) - 1);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kMagic;
+  if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+    Close();
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool PositionCache::Open(const std::string& name) {
+  Close();
+
+  auto path = GetPositionCachePath(name);
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+    close(fd);
+    return false;
+  }
+  std::size_t size = st.st_size;
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+
+  // 写端与读端的Position定义必须一致
+  auto* header = reinterpret_cast<const Header*>(addr);
+  if (header->magic != kMagic || header->slot_size != sizeof(PositionSlot) ||
+      MappingSize(header->strategy_num, header->ticker_num) > size) {
+    munmap(addr, size);
+    return false;
+  }
+
+  Attach(addr, size, false);
+  return true;
+}
+
+bool PositionCache::FindStrategy(const std::string& strategy, uint32_t* strategy_idx) const {
+  for (uint32_t i = 0; i < strategy_num_; ++i) {
+    if (strncmp(strategies_[i].name, strategy.c_str(), sizeof(StrategyIdType)) == 0) {
+      *strategy_idx = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PositionCache::SetPosition(const std::string& strategy, const Position& pos) {
+  uint32_t strategy_idx;
+  if (!FindStrategy(strategy, &strategy_idx)) {
+    return false;
+  }
+  return SetPosition(strategy_idx, pos);
+}
+
+bool PositionCache::GetPosition(const std::string& strategy, const std::string& ticker,
+                                Position* res) const {
+  uint32_t strategy_idx;
+  if (!FindStrategy(strategy, &strategy_idx)) {
+    return false;
+  }
+  auto* contract = ContractTable::get_by_ticker(ticker);
+  if (!contract) {
+    return false;
+  }
+  return GetPosition(strategy_idx, contract->ticker_id, res);
+}
+
+bool PositionCache::GetAllPositions(const std::string& strategy,
+                                    std::vector<Position>* res) const {
+  uint32_t strategy_idx;
+  if (!FindStrategy(strategy, &strategy_idx)) {
+    return false;
+  }
+  Position pos;
+  for (uint32_t ticker_id = 1; ticker_id <= ticker_num_; ++ticker_id) {
+    if (GetSlot(strategy_idx, ticker_id)->pos.Load(&pos)) {
+      res->emplace_back(pos);
+    }
+  }
+  return true;
+}
+
+}  // namespace ft
@@ -0,0 +1,109 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "ft/component/tick_snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+namespace ft {
+
+static std::string GetTickSnapshotPath(const std::string& name) {
+  return "./ft_tick_snapshot." + name;
+}
+
+TickSnapshotTable::~TickSnapshotTable() { Close(); }
+
+void TickSnapshotTable::Close() {
+  if (addr_) {
+    munmap(addr_, size_);
+  }
+  addr_ = nullptr;
+  size_ = 0;
+  slots_ = nullptr;
+  ticker_num_ = 0;
+  writable_ = false;
+}
+
+bool TickSnapshotTable::Create(const std::string& name, uint32_t ticker_num) {
+  Close();
+
+  // 新的快照表先在临时文件中建好再替换原文件，仍映射着原文件的读端不受影响，重新打开后读到新表
+  auto path = GetTickSnapshotPath(name);
+  auto tmp_path = path + ".tmp";
+  int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) {
+    return false;
+  }
+  std::size_t size = MappingSize(ticker_num);
+  if (ftruncate(fd, size) != 0) {
+    close(fd);
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    unlink(tmp_path.c_str());
+    return false;
+  }
+
+  auto* header = reinterpret_cast<Header*>(addr);
+  header->slot_size = sizeof(Slot);
+  header->ticker_num = ticker_num;
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kMagic;
+  if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+    munmap(addr, size);
+    unlink(tmp_path.c_str());
+    return false;
+  }
+
+  addr_ = addr;
+  size_ = size;
+  slots_ = reinterpret_cast<Slot*>(reinterpret_cast<char*>(addr) + sizeof(Slot));
+  ticker_num_ = ticker_num;
+  writable_ = true;
+  return true;
+}
+
+bool TickSnapshotTable::Open(const std::string& name) {
+  Close();
+
+  auto path = GetTickSnapshotPath(name);
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Slot)) {
+    close(fd);
+    return false;
+  }
+  std::size_t size = st.st_size;
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+
+  // 写端与读端的TickData定义必须一致
+  auto* header = reinterpret_cast<const Header*>(addr);
+  if (header->magic != kMagic || header->slot_size != sizeof(Slot) ||
+      MappingSize(header->ticker_num) > size) {
+    munmap(addr, size);
+    return false;
+  }
+
+  addr_ = addr;
+  size_ = size;
+  slots_ = reinterpret_cast<Slot*>(reinterpret_cast<char*>(addr) + sizeof(Slot));
+  ticker_num_ = header->ticker_num;
+  writable_ = false;
+  return true;
+}
+
+}  // namespace ft
@@ -41,7 +41,7 @@ JournalPtr Journal::create(const string &dir, const string &jname, int serviceId
 bool Journal::seekTime(int64_t time) {
   // before seek to time, should release current page first
   if (curPage.get() != nullptr)
-    pageProvider->releasePage(curPage->getBuffer(), JOURNAL_PAGE_SIZE, serviceIdx);
+    pageProvider->releasePage(curPage->getBuffer(), curPage->getPageSize(), serviceIdx);
 
   if (time == TIME_TO_LAST) {
     const vector<short> pageNums = PageUtil::GetPageNums(directory, shortName);
@@ -75,7 +75,7 @@ void Journal::loadNextPage() {
     if (isWriting) {
       curPage->finishPage();
     }
-    pageProvider->releasePage(curPage->getBuffer(), JOURNAL_PAGE_SIZE, serviceIdx);
+    pageProvider->releasePage(curPage->getBuffer(), curPage->getPageSize(), serviceIdx);
     // reset current page
     curPage = newPage;
   }
@@ -85,7 +85,7 @@ void Journal::expire() {
   if (!expired) {
     expired = true;
     if (curPage.get() != nullptr) {
-      pageProvider->releasePage(curPage->getBuffer(), JOURNAL_PAGE_SIZE, serviceIdx);
+      pageProvider->releasePage(curPage->getBuffer(), curPage->getPageSize(), serviceIdx);
       curPage.reset();
     }
     // set page expire in page engine
@@ -36,12 +36,112 @@ USING_YJJ_NAMESPACE
 
 /// const string JournalReader::PREFIX = "reader";
 
-JournalReader::JournalReader(PageProviderPtr& ptr) : JournalHandler(ptr) { journalMap.clear(); }
+JournalReader::JournalReader(PageProviderPtr& ptr)
+    : JournalHandler(ptr),
+      heapMerge(false),
+      idlePollInterval(1),
+      idlePollCount(0),
+      mergeDirty(true),
+      topPassed(false) {
+  journalMap.clear();
+}
+
+void JournalReader::enableHeapMerge(int idlePollInterval) {
+  heapMerge = true;
+  this->idlePollInterval = idlePollInterval < 1 ? 1 : idlePollInterval;
+  mergeDirty = true;
+}
+
+static inline bool headLess(int64_t nano1, size_t idx1, int64_t nano2, size_t idx2) {
+  return nano1 < nano2 || (nano1 == nano2 && idx1 < idx2);
+}
+
+void JournalReader::siftUp(size_t pos) {
+  HeadEntry entry = heads[pos];
+  while (pos > 0) {
+    size_t parent = (pos - 1) / 2;
+    if (!headLess(entry.nano, entry.idx, heads[parent].nano, heads[parent].idx)) break;
+    heads[pos] = heads[parent];
+    pos = parent;
+  }
+  heads[pos] = entry;
+}
+
+void JournalReader::siftDown(size_t pos) {
+  HeadEntry entry = heads[pos];
+  size_t size = heads.size();
+  while (true) {
+    size_t child = pos * 2 + 1;
+    if (child >= size) break;
+    if (child + 1 < size &&
+        headLess(heads[child + 1].nano, heads[child + 1].idx, heads[child].nano, heads[child].idx))
+      child += 1;
+    if (!headLess(heads[child].nano, heads[child].idx, entry.nano, entry.idx)) break;
+    heads[pos] = heads[child];
+    pos = child;
+  }
+  heads[pos] = entry;
+}
+
+void JournalReader::pollIdleJournals() {
+  for (size_t i = 0; i < idleJournals.size();) {
+    size_t idx = idleJournals[i];
+    FrameHeader* header = (FrameHeader*)(journals[idx]->locateFrame());
+    if (header == nullptr) {
+      ++i;
+      continue;
+    }
+    heads.push_back(HeadEntry{header->nano, header, idx});
+    siftUp(heads.size() - 1);
+    idleJournals[i] = idleJournals.back();
+    idleJournals.pop_back();
+  }
+}
+
+void* JournalReader::locateNextFrameHeap() {
+  if (mergeDirty) {
+    heads.clear();
+    idleJournals.clear();
+    for (size_t idx = 0; idx < journals.size(); idx++) idleJournals.push_back(idx);
+    mergeDirty = false;
+    topPassed = false;
+    idlePollCount = 0;
+    pollIdleJournals();
+  } else if (topPassed) {
+    // refresh the journal we read from last time, it is still on the top
+    topPassed = false;
+    HeadEntry& top = heads[0];
+    FrameHeader* header = (FrameHeader*)(journals[top.idx]->locateFrame());
+    if (header != nullptr) {
+      top.nano = header->nano;
+      top.frame = header;
+    } else {
+      idleJournals.push_back(top.idx);
+      top = heads.back();
+      heads.pop_back();
+    }
+    if (!heads.empty()) siftDown(0);
+  }
+
+  if (!idleJournals.empty() && (heads.empty() || ++idlePollCount >= idlePollInterval)) {
+    idlePollCount = 0;
+    pollIdleJournals();
+  }
+  if (heads.empty()) return nullptr;
+
+  JournalPtr& journal = journals[heads[0].idx];
+  // avoid touching the shared_ptr's refcount when the source is unchanged
+  if (curJournal != journal) curJournal = journal;
+  curJournal->passFrame();
+  topPassed = true;
+  return heads[0].frame;
+}
 
 size_t JournalReader::addJournal(const string& dir, const string& jname) {
   if (journalMap.find(jname) != journalMap.end()) {
     return journalMap[jname];
   } else {
+    mergeDirty = true;
     size_t idx = JournalHandler::addJournal(dir, jname);
     journalMap[jname] = idx;
     return idx;
@@ -80,6 +180,7 @@ JournalReaderPtr JournalReader::create(const vector<string>& dirs, const vector<
 }
 
 void JournalReader::jumpStart(int64_t startTime) {
+  mergeDirty = true;
   for (JournalPtr& journal : journals) journal->seekTime(startTime);
 }
 
@@ -91,12 +192,11 @@ string JournalReader::getFrameName() const {
 }
 
 void JournalReader::startVisiting() {
-  FramePtr frame;
+  Frame frame(nullptr);
   while (true) {
-    frame = getNextFrame();
-    if (frame.get() != nullptr) {
+    if (getNextFrame(&frame)) {
       string name = getFrameName();
-      for (auto visitor : visitors) visitor->visit(name, *frame);
+      for (auto visitor : visitors) visitor->visit(name, frame);
     }
   }
 }
@@ -108,6 +208,7 @@ bool JournalReader::addVisitor(IJournalVisitor* visitor) {
 
 bool JournalReader::expireJournal(size_t idx) {
   if (idx < journals.size()) {
+    mergeDirty = true;
     journals[idx]->expire();
     return true;
   }
@@ -116,6 +217,7 @@ bool JournalReader::expireJournal(size_t idx) {
 
 bool JournalReader::seekTimeJournal(size_t idx, int64_t nano) {
   if (idx < journals.size()) {
+    mergeDirty = true;
     return journals[idx]->seekTime(nano);
     /// return true;
   }
@@ -60,6 +60,36 @@ int64_t JournalWriter::write_frame(const void* data, FH_TYPE_LENGTH length, FH_T
   return nano;
 }
 
+int64_t JournalWriter::write_frame_multi(JournalWriter* const* writers, size_t num,
+                                         const void* data, FH_TYPE_LENGTH length,
+                                         FH_TYPE_MSG_TP msgType, FH_TYPE_LASTFG lastFlag) {
+  /** frames are reserved in batches so that no allocation is needed */
+  const size_t MAX_BATCH = 64;
+  void* buffers[MAX_BATCH];
+
+  int64_t nano = getNanoTime();
+  for (size_t begin = 0; begin < num; begin += MAX_BATCH) {
+    size_t end = begin + MAX_BATCH < num ? begin + MAX_BATCH : num;
+    // reserve and fill, nothing is visible to readers yet
+    for (size_t i = begin; i < end; i++) {
+      void* buffer = writers[i]->journal->locateFrame();
+      Frame frame(buffer);
+      frame.setMsgType(msgType);
+      frame.setLastFlag(lastFlag);
+      frame.setData(data, length);
+      frame.setNano(nano);
+      buffers[i - begin] = buffer;
+    }
+    // publish
+    for (size_t i = begin; i < end; i++) {
+      Frame frame(buffers[i - begin]);
+      frame.setStatusWritten();
+      writers[i]->journal->passFrame();
+    }
+  }
+  return nano;
+}
+
 Frame JournalWriter::locateFrame() {
   FH_TYPE_NANOTM nano = getNanoTime();
 
@@ -85,6 +115,12 @@ JournalWriterPtr JournalWriter::create(const string& dir, const string& jname,
   return JournalWriter::create(dir, jname, provider);
 }
 
+JournalWriterPtr JournalWriter::create(const string& dir, const string& jname,
+                                       const string& writerName, const PageConfig& pageConfig) {
+  PageProviderPtr provider = PageProviderPtr(new PageProvider(writerName, true, pageConfig));
+  return JournalWriter::create(dir, jname, provider);
+}
+
 JournalWriterPtr JournalWriter::create(const string& dir, const string& jname,
                                        PageProviderPtr& provider) {
   JournalWriterPtr jwp = JournalWriterPtr(new JournalWriter(provider));
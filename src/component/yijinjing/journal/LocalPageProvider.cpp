@@ -22,6 +22,7 @@
 
 #include "ft/component/yijinjing/journal/Page.h"
 #include "ft/component/yijinjing/journal/PageCommStruct.h"
+#include "ft/component/yijinjing/journal/PagePreallocator.h"
 #include "ft/component/yijinjing/journal/PageProvider.h"
 #include "ft/component/yijinjing/journal/PageSocketStruct.h"
 #include "ft/component/yijinjing/journal/PageUtil.h"
@@ -34,17 +35,43 @@ void PageProvider::exit_client() {}
 
 int PageProvider::register_journal(const string& dir, const string& jname) { return -1; };
 
-PageProvider::PageProvider(const string& clientName, bool isWriting)
-    : is_writer(isWriting), client_name(clientName), comm_buffer(nullptr), hash_code(0) {
+PageProvider::PageProvider(const string& clientName, bool isWriting,
+                           const PageConfig& pageConfig)
+    : is_writer(isWriting),
+      client_name(clientName),
+      comm_buffer(nullptr),
+      hash_code(0),
+      page_config(pageConfig) {
   //  is_writer = isWriting;
   //  revise_allowed = is_writer || reviseAllowed;
 }
 
 PagePtr PageProvider::getPage(const string& dir, const string& jname, int serviceIdx,
                               short pageNum) {
-  return Page::load(dir, jname, pageNum, is_writer, false);
+  if (!is_writer || !page_config.preallocate || pageNum <= 0)
+    return Page::load(dir, jname, pageNum, is_writer, false, page_config.pageSize,
+                      page_config.hugePage);
+
+  // take the pre-faulted page if it is ready, then prepare the next one
+  PagePreallocator& preallocator = PagePreallocator::instance();
+  const string path = PageUtil::GenPageFullPath(dir, jname, pageNum);
+  PagePtr page;
+  void* buffer = preallocator.take(path, page_config.pageSize);
+  if (buffer != nullptr)
+    page = Page::attach(buffer, jname, pageNum, true, page_config.pageSize);
+  else
+    page = Page::load(dir, jname, pageNum, true, false, page_config.pageSize,
+                      page_config.hugePage);
+
+  if (page.get() != nullptr)
+    preallocator.request(PageUtil::GenPageFullPath(dir, jname, pageNum + 1),
+                         page_config.pageSize, page_config.hugePage);
+  return page;
 }
 
 void PageProvider::releasePage(void* buffer, int size, int serviceIdx) {
-  PageUtil::ReleasePageBuffer(buffer, size, false);
+  if (is_writer && page_config.preallocate)
+    PagePreallocator::instance().release(buffer, size);
+  else
+    PageUtil::ReleasePageBuffer(buffer, size, false);
 }
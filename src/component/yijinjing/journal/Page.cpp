@@ -19,7 +19,9 @@
 
 #include "ft/component/yijinjing/journal/Page.h"
 
+#include <algorithm>
 #include <sstream>
+#include <sys/mman.h>
 
 #include "ft/component/yijinjing/journal/PageHeader.h"
 #include "ft/component/yijinjing/journal/PageUtil.h"
@@ -29,12 +31,14 @@ USING_YJJ_NAMESPACE
 
 #define PAGE_INIT_POSITION sizeof(PageHeader)
 
-Page::Page(void* buffer)
+Page::Page(void* buffer, int pageSize)
     : frame(ADDRESS_ADD(buffer, PAGE_INIT_POSITION)),
       buffer(buffer),
       position(PAGE_INIT_POSITION),
       frameNum(0),
-      pageNum(-1) {}
+      pageNum(-1),
+      pageSize(pageSize),
+      writableEnd(pageSize - std::min(PAGE_MIN_HEADROOM, pageSize / 8)) {}
 
 void Page::finishPage() {
   PageHeader* header = (PageHeader*)buffer;
@@ -45,13 +49,28 @@ void Page::finishPage() {
 }
 
 PagePtr Page::load(const string& dir, const string& jname, short pageNum, bool isWriting,
-                   bool quickMode) {
+                   bool quickMode, int pageSize, bool hugePage) {
   const string path = PageUtil::GenPageFullPath(dir, jname, pageNum);
-  void* buffer =
-      PageUtil::LoadPageBuffer(path, JOURNAL_PAGE_SIZE, isWriting,
-                               quickMode /*from local then we need to do mlock manually*/);
+  // readers and writers of an existing page must agree on its size
+  int fileSize = PageUtil::GetFileSize(path);
+  if (fileSize >= (int)sizeof(PageHeader))
+    pageSize = fileSize;
+  else if (!isWriting)
+    return PagePtr();
+
+  void* buffer = PageUtil::LoadPageBuffer(
+      path, pageSize, isWriting, quickMode /*from local then we need to do mlock manually*/);
   if (buffer == nullptr) return PagePtr();
+  // best effort, ignored if the file system does not support huge page
+  if (isWriting && hugePage) madvise(buffer, pageSize, MADV_HUGEPAGE);
+
+  PagePtr page = attach(buffer, jname, pageNum, isWriting, pageSize);
+  if (page.get() == nullptr) PageUtil::ReleasePageBuffer(buffer, pageSize, quickMode);
+  return page;
+}
 
+PagePtr Page::attach(void* buffer, const string& jname, short pageNum, bool isWriting,
+                     int pageSize) {
   PageHeader* header = (PageHeader*)buffer;
   if (header->status == JOURNAL_PAGE_STATUS_RAW) {
     if (!isWriting) return PagePtr();
@@ -75,7 +94,7 @@ PagePtr Page::load(const string& dir, const string& jname, short pageNum, bool i
     throw std::runtime_error(ss.str().c_str());
   }
 
-  PagePtr page = PagePtr(new Page(buffer));
+  PagePtr page = PagePtr(new Page(buffer, pageSize));
   page->pageNum = pageNum;
   return page;
 }
@@ -0,0 +1,152 @@
+/*****************************************************************************
+ * Copyright [2017] [taurus.ai]
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include "ft/component/yijinjing/journal/PagePreallocator.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+#include "ft/component/yijinjing/journal/PageUtil.h"
+
+USING_YJJ_NAMESPACE
+
+#define PREALLOC_SUFFIX string(".prealloc")
+
+PagePreallocator::PagePreallocator() : stopped(false) {
+  worker = std::thread(&PagePreallocator::run, this);
+}
+
+PagePreallocator::~PagePreallocator() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    stopped = true;
+  }
+  cond.notify_all();
+  worker.join();
+
+  for (auto& item : releasing) PageUtil::ReleasePageBuffer(item.first, item.second, false);
+
+  // remove the pages nobody takes
+  for (auto& item : tasks) {
+    if (item.second.buffer != nullptr)
+      PageUtil::ReleasePageBuffer(item.second.buffer, item.second.size, false);
+    unlink((item.first + PREALLOC_SUFFIX).c_str());
+  }
+}
+
+PagePreallocator& PagePreallocator::instance() {
+  static PagePreallocator preallocator;
+  return preallocator;
+}
+
+void PagePreallocator::request(const string& path, int size, bool hugePage) {
+  if (PageUtil::FileExists(path)) return;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  if (tasks.find(path) != tasks.end()) return;
+  tasks[path] = Task{size, hugePage, false, nullptr};
+  pending.push_back(path);
+  lock.unlock();
+  // the worker sleeps until there is work, request is only called once per page
+  cond.notify_all();
+}
+
+void* PagePreallocator::take(const string& path, int size) {
+  std::unique_lock<std::mutex> lock(mutex);
+  auto it = tasks.find(path);
+  if (it == tasks.end()) return nullptr;
+  if (!it->second.ready) {
+    cond.notify_all();
+    cond.wait(lock, [&] { return it->second.ready; });
+  }
+  Task task = it->second;
+  tasks.erase(it);
+  lock.unlock();
+
+  if (task.buffer == nullptr) return nullptr;
+  const string tmpPath = path + PREALLOC_SUFFIX;
+  if (task.size != size || PageUtil::FileExists(path) ||
+      rename(tmpPath.c_str(), path.c_str()) != 0) {
+    PageUtil::ReleasePageBuffer(task.buffer, task.size, false);
+    unlink(tmpPath.c_str());
+    return nullptr;
+  }
+  return task.buffer;
+}
+
+void PagePreallocator::release(void* buffer, int size) {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    releasing.emplace_back(buffer, size);
+  }
+  cond.notify_all();
+}
+
+void PagePreallocator::run() {
+  while (true) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this] { return stopped || !pending.empty() || !releasing.empty(); });
+    if (stopped) return;
+    // preparing next page is more urgent
+    if (pending.empty()) {
+      auto item = releasing.front();
+      releasing.pop_front();
+      lock.unlock();
+      PageUtil::ReleasePageBuffer(item.first, item.second, false);
+      continue;
+    }
+    string path = pending.front();
+    pending.pop_front();
+    Task task = tasks[path];
+    lock.unlock();
+
+    void* buffer = prepare(path + PREALLOC_SUFFIX, task.size, task.hugePage);
+
+    lock.lock();
+    tasks[path].buffer = buffer;
+    tasks[path].ready = true;
+    cond.notify_all();
+  }
+}
+
+void* PagePreallocator::prepare(const string& path, int size, bool hugePage) {
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, (mode_t)0600);
+  if (fd < 0) return nullptr;
+  if (ftruncate(fd, size) != 0) {
+    close(fd);
+    unlink(path.c_str());
+    return nullptr;
+  }
+  // reserve disk blocks, not supported by some file systems
+  posix_fallocate(fd, 0, size);
+
+  void* buffer = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (buffer == MAP_FAILED) {
+    unlink(path.c_str());
+    return nullptr;
+  }
+
+  if (hugePage) madvise(buffer, size, MADV_HUGEPAGE);
+  // touch every page so that all page faults happen here
+  long osPageSize = sysconf(_SC_PAGESIZE);
+  for (long offset = 0; offset < size; offset += osPageSize) ((volatile char*)buffer)[offset] = 0;
+  // best effort, may fail because of RLIMIT_MEMLOCK
+  mlock(buffer, size);
+  return buffer;
+}
@@ -188,6 +188,12 @@ void PageUtil::ReleasePageBuffer(void* buffer, int size, bool quickMode) {
   }
 }
 
+int PageUtil::GetFileSize(const string& filename) {
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0) return -1;
+  return (int)st.st_size;
+}
+
 bool PageUtil::FileExists(const string& filename) {
   int fd = open(filename.c_str(), O_RDONLY, (mode_t)0600);
   if (fd >= 0) {
@@ -1,3 +1,43 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
 
+#include "ft/base/log.h"
+#include "ft/utils/getopt.hpp"
+#include "market/market_server.h"
 
-int main() {}
+static void Usage(const char* pname) {
+  printf("Usage: %s [--config=<file>] [-h -? --help] [--loglevel=level]\n", pname);
+  printf("    --config            配置文件，行情转发相关配置见market\n");
+  printf("    -h, -?, --help      帮助\n");
+  printf("    --loglevel          日志等级(trace, debug, info, warn, error)\n");
+}
+
+int main(int argc, char** argv) {
+  std::string config_file = getarg("../config/config.yml", "--config");
+  std::string log_level = getarg("info", "--loglevel");
+  bool help = getarg(false, "-h", "--help", "-?");
+
+  if (help) {
+    Usage(argv[0]);
+    exit(EXIT_SUCCESS);
+  }
+
+  LOG_SET_LEVEL(log_level);
+
+  ft::FlareTraderConfig config;
+  if (!config.Load(config_file)) {
+    LOG_ERROR("failed to load config from {}", config_file);
+    exit(EXIT_FAILURE);
+  }
+
+  if (!ft::InitLogMode(config.global_config, "market")) {
+    exit(EXIT_FAILURE);
+  }
+
+  auto server = std::make_unique<ft::MarketServer>();
+  if (!server->Init(config)) {
+    LOG_ERROR("failed to init market server");
+    exit(EXIT_FAILURE);
+  }
+
+  server->Run();
+}
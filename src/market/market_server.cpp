@@ -1,3 +1,203 @@
-#include "market_server.h"
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
 
-namespace ft {}  // namespace ft
+#include "market/market_server.h"
+
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "ft/component/journal_channel.h"
+#include "ft/component/journal_config.h"
+#include "ft/utils/ipc_config.h"
+#include "ft/utils/misc.h"
+
+namespace ft {
+
+bool MarketServer::Init(const FlareTraderConfig& conf) {
+  config_ = &conf;
+
+  if (!GetWaitStrategy(conf.global_config, "", &wait_strategy_)) {
+    LOG_ERROR("[MarketServer::Init] invalid wait strategy: {}", conf.global_config.wait_strategy);
+    return false;
+  }
+  if (wait_strategy_.type == WaitStrategyType::kSpinEventFd && !tick_notifier_.EnableEventFd()) {
+    LOG_ERROR("[MarketServer::Init] failed to create eventfd");
+    return false;
+  }
+
+  if (!ContractTable::Init(conf.global_config.contract_file)) {
+    LOG_ERROR("[MarketServer::Init] failed to init contract table");
+    return false;
+  }
+
+  if (!InitJournals()) {
+    return false;
+  }
+
+  if (!InitPublisher()) {
+    return false;
+  }
+
+  if (!InitSource()) {
+    return false;
+  }
+
+  LOG_INFO("[MarketServer::Init] market server inited");
+  return true;
+}
+
+bool MarketServer::InitJournals() {
+  yijinjing::PageConfig page_config;
+  if (!GetMdMqPageConfig(config_->global_config, &page_config)) {
+    LOG_ERROR("[MarketServer::InitJournals] invalid md_mq_page_size_mb");
+    return false;
+  }
+
+  ticker_writers_.resize(ContractTable::size() + 1, nullptr);
+  for (uint32_t ticker_id = 1; ticker_id <= ContractTable::size(); ++ticker_id) {
+    auto* contract = ContractTable::get_by_index(ticker_id);
+    auto& writer = exchange_writers_[contract->exchange];
+    if (!writer) {
+      auto jname = config_->market_config.md_journal_prefix + "." + contract->exchange;
+      writer = yijinjing::JournalWriter::create(".", jname, "market_server", page_config);
+      LOG_INFO("[MarketServer::InitJournals] md of {} will be written to {}", contract->exchange,
+               jname);
+    }
+    ticker_writers_[ticker_id] = writer.get();
+  }
+  return true;
+}
+
+bool MarketServer::InitPublisher() {
+  auto& market_config = config_->market_config;
+  if (market_config.publish.empty()) {
+    return true;
+  }
+
+  if (market_config.publish == "udp") {
+    auto publisher = std::make_unique<UdpMdPublisher>();
+    if (!publisher->Init(market_config.publish_address, market_config.publish_port,
+                         market_config.multicast_interface)) {
+      LOG_ERROR("[MarketServer::InitPublisher] failed to init udp publisher");
+      return false;
+    }
+    publisher_ = std::move(publisher);
+  } else if (market_config.publish == "tcp") {
+    auto publisher = std::make_unique<TcpMdPublisher>();
+    if (!publisher->Init(market_config.publish_address, market_config.publish_port)) {
+      LOG_ERROR("[MarketServer::InitPublisher] failed to listen on {}:{}",
+                market_config.publish_address, market_config.publish_port);
+      return false;
+    }
+    publisher_ = std::move(publisher);
+  } else {
+    LOG_ERROR("[MarketServer::InitPublisher] unknown publish type: {}", market_config.publish);
+    return false;
+  }
+
+  LOG_INFO("[MarketServer::InitPublisher] publish md via {} {}:{}", market_config.publish,
+           market_config.publish_address, market_config.publish_port);
+  return true;
+}
+
+bool MarketServer::InitSource() {
+  auto& market_config = config_->market_config;
+  if (market_config.upstream == "udp") {
+    auto receiver = std::make_unique<UdpMdReceiver>();
+    if (!receiver->Init(market_config.upstream_address, market_config.upstream_port,
+                        market_config.multicast_interface)) {
+      LOG_ERROR("[MarketServer::InitSource] failed to init udp receiver");
+      return false;
+    }
+    upstream_ = std::move(receiver);
+    return true;
+  } else if (market_config.upstream == "tcp") {
+    auto receiver = std::make_unique<TcpMdReceiver>();
+    if (!receiver->Init(market_config.upstream_address, market_config.upstream_port)) {
+      LOG_ERROR("[MarketServer::InitSource] failed to connect to {}:{}",
+                market_config.upstream_address, market_config.upstream_port);
+      return false;
+    }
+    upstream_ = std::move(receiver);
+    return true;
+  } else if (!market_config.upstream.empty()) {
+    LOG_ERROR("[MarketServer::InitSource] unknown upstream type: {}", market_config.upstream);
+    return false;
+  }
+
+  // 只登录行情服务器
+  auto gateway_config = config_->gateway_config;
+  gateway_config.trade_server_address.clear();
+
+  gateway_ = CreateGateway(gateway_config.api);
+  if (!gateway_) {
+    LOG_ERROR("[MarketServer::InitSource] failed to create gateway");
+    return false;
+  }
+  gateway_->SetNotifier(nullptr, &tick_notifier_);
+  if (!gateway_->Init(gateway_config)) {
+    LOG_ERROR("[MarketServer::InitSource] failed to init gateway");
+    return false;
+  }
+
+  auto sub_list = gateway_config.subscription_list;
+  if (sub_list.empty()) {
+    for (uint32_t ticker_id = 1; ticker_id <= ContractTable::size(); ++ticker_id) {
+      sub_list.emplace_back(ContractTable::get_by_index(ticker_id)->ticker);
+    }
+  }
+  if (!gateway_->Subscribe(sub_list)) {
+    LOG_ERROR("[MarketServer::InitSource] failed to subscribe market data");
+    return false;
+  }
+  return true;
+}
+
+bool MarketServer::PollTick(TickData* tick) {
+  if (gateway_) {
+    return gateway_->GetTickRB()->Get(tick);
+  }
+  return upstream_->Poll(tick);
+}
+
+void MarketServer::Run() {
+  int cpu_id = config_->global_config.md_cpu_affinity;
+  if (cpu_id >= 0) {
+    if (!SetCpuAffinity(cpu_id)) {
+      LOG_WARN("[MarketServer::Run] failed to bind to cpu {}", cpu_id);
+    } else {
+      LOG_INFO("[MarketServer::Run] bound to cpu {}", cpu_id);
+    }
+  }
+
+  // 转发时一次最多取一个包的tick，突发行情可以合并到同一个包中，没有新行情时立即发出
+  TickData tick;
+  Waiter waiter(wait_strategy_, gateway_ ? &tick_notifier_ : nullptr);
+  for (;;) {
+    std::size_t n = 0;
+    while (n < kMaxTicksPerMdRelayPacket && PollTick(&tick)) {
+      OnTick(tick);
+      ++n;
+    }
+    if (n > 0) {
+      if (publisher_) {
+        publisher_->Flush();
+      }
+      waiter.Reset();
+    } else {
+      waiter.Wait();
+    }
+  }
+}
+
+void MarketServer::OnTick(const TickData& tick) {
+  if (tick.ticker_id == 0 || tick.ticker_id >= ticker_writers_.size()) {
+    LOG_ERROR("[MarketServer::OnTick] unknown ticker_id {}", tick.ticker_id);
+    return;
+  }
+
+  WriteMsg(ticker_writers_[tick.ticker_id], tick);
+  if (publisher_) {
+    publisher_->Publish(tick);
+  }
+}
+
+}  // namespace ft
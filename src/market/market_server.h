@@ -1,10 +1,25 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
 #ifndef FT_SRC_MARKET_MARKET_SERVER_H_
 #define FT_SRC_MARKET_MARKET_SERVER_H_
 
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "ft/base/config.h"
+#include "ft/base/market_data.h"
+#include "ft/component/md_relay.h"
+#include "ft/component/yijinjing/journal/JournalWriter.h"
+#include "ft/utils/wait_strategy.h"
+#include "trader/gateway/gateway.h"
 
 namespace ft {
 
+// 行情服务，一台行情接入机登录行情服务器后，把行情按交易所写入journal，
+// 并可通过UDP组播或TCP转发给其他主机，其他主机上的ft_market以upstream方式接收后
+// 同样写入本地journal，不需要每个OMS各自登录行情服务器
 class MarketServer {
  public:
   bool Init(const FlareTraderConfig& conf);
@@ -12,6 +27,28 @@ class MarketServer {
   void Run();
 
  private:
+  bool InitSource();
+  bool InitJournals();
+  bool InitPublisher();
+
+  bool PollTick(TickData* tick);
+  void OnTick(const TickData& tick);
+
+ private:
+  const FlareTraderConfig* config_;
+
+  // 行情来源，gateway_与upstream_只有一个不为空
+  std::shared_ptr<Gateway> gateway_;
+  std::unique_ptr<MdRelayReceiver> upstream_;
+
+  // 以ticker_id为下标，指向该合约所属交易所的journal
+  std::map<std::string, yijinjing::JournalWriterPtr> exchange_writers_;
+  std::vector<yijinjing::JournalWriter*> ticker_writers_;
+
+  std::unique_ptr<MdRelayPublisher> publisher_;
+
+  WaitStrategy wait_strategy_;
+  Notifier tick_notifier_;
 };
 
 }  // namespace ft
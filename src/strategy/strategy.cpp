@@ -3,12 +3,25 @@
 #include "ft/strategy/strategy.h"
 
 #include <thread>
+#include <type_traits>
 
+#include "ft/component/journal_config.h"
 #include "ft/component/yijinjing/journal/Timer.h"
+#include "ft/utils/ipc_config.h"
 #include "spdlog/spdlog.h"
 
 namespace ft {
 
+namespace {
+
+// 无法识别的消息说明策略与OMS的消息定义不一致，继续运行会丢失回报或行情
+void OnUnknownMsg(const yijinjing::Frame& frame) {
+  printf("invalid msg. msg_type:%d len:%d\n", frame.getMsgType(), frame.getDataLength());
+  abort();
+}
+
+}  // namespace
+
 Strategy::Strategy() {}
 
 bool Strategy::Init(const StrategyConfig& config, const FlareTraderConfig& ft_config) {
@@ -17,46 +30,122 @@ bool Strategy::Init(const StrategyConfig& config, const FlareTraderConfig& ft_co
     return false;
   }
 
-  if (!trader_db_.Init(ft_config.global_config.trader_db_address, "", "")) {
+  if (!InitCommon(config, ft_config)) {
+    return false;
+  }
+
+  // 开启合并行情后行情从合并通道读取，journal中只有订单回报
+  conflate_md_ = config.conflate_md;
+  if (conflate_md_ &&
+      !conflated_md_.Open(GetConflatedMdChannelName(config.strategy_name))) {
+    printf("cannot open conflated md channel\n");
+    return false;
+  }
+
+  std::vector<std::string> dirs{"."};
+  std::vector<std::string> jnames{config.rsp_mq_name};
+  if (!conflate_md_ && config.md_mq_name != config.rsp_mq_name) {
+    dirs.emplace_back(".");
+    jnames.emplace_back(config.md_mq_name);
+  }
+  reader_ = TypedJournalReader<TickData, OrderResponse>(yijinjing::JournalReader::create(
+      dirs, jnames, yijinjing::getNanoTime(), config.strategy_name));
+  if (!GetWaitStrategy(ft_config.global_config, config.wait_strategy, &wait_strategy_)) {
+    printf("invalid wait strategy\n");
+    return false;
+  }
+  if (!notifier_.OpenShared(GetStrategyNotifierName(config.strategy_name)) ||
+      !oms_notifier_.OpenShared(GetOmsNotifierName(ft_config.gateway_config.investor_id))) {
+    printf("cannot open notifier\n");
+    return false;
+  }
+
+  yijinjing::PageConfig page_config;
+  if (!GetOrderMqPageConfig(ft_config.global_config, &page_config)) {
+    printf("invalid order_mq_page_size_mb\n");
+    return false;
+  }
+
+  sender_.Init(config.trade_mq_name, page_config);
+  sender_.SetNotifier(&oms_notifier_);
+
+  // 统计页由OMS创建，打开失败时只是不统计延迟
+  if (ft_config.global_config.latency_stats &&
+      !latency_stats_.Open(GetLatencyStatsName(ft_config.gateway_config.investor_id), true)) {
+    printf("cannot open latency stats, latency will not be recorded\n");
+  }
+  return true;
+}
+
+bool Strategy::InitInProcess(const StrategyConfig& config, const FlareTraderConfig& ft_config,
+                             TraderCmdSink* cmd_sink) {
+  // 合约表通常已由同一进程中的OMS初始化，此时不会重新加载
+  if (!ft::ContractTable::Init(ft_config.global_config.contract_file)) {
+    printf("invalid contract list file\n");
+    return false;
+  }
+
+  in_process_positions_ = cmd_sink->positions();
+  if (!InitCommon(config, ft_config)) {
+    return false;
+  }
+  sender_.SetCmdSink(cmd_sink);
+  return true;
+}
+
+bool Strategy::InitCommon(const StrategyConfig& config, const FlareTraderConfig& ft_config) {
+  // 开启持仓缓存后策略不再需要连接redis，进程内回测提供持仓时两者都不需要
+  use_position_cache_ = ft_config.global_config.position_cache && !in_process_positions_;
+  if (use_position_cache_) {
+    if (!position_cache_.Open(GetPositionCacheName(ft_config.gateway_config.investor_id))) {
+      printf("cannot open position cache\n");
+      return false;
+    }
+  } else if (!in_process_positions_ &&
+             !trader_db_.Init(ft_config.global_config.trader_db_address, "", "")) {
     printf("cannot open db connection\n");
     return false;
   }
 
-  rsp_reader_ = yijinjing::JournalReader::create(".", config.rsp_mq_name, yijinjing::getNanoTime(),
-                                                 config.strategy_name);
-  md_reader_ = yijinjing::JournalReader::create(".", config.md_mq_name, yijinjing::getNanoTime(),
-                                                config.strategy_name);
-  sender_.Init(config.trade_mq_name);
-  sender_.SetStrategyId(config.strategy_name.c_str());
+  if (ft_config.global_config.tick_snapshot &&
+      !tick_snapshot_.Open(GetTickSnapshotName(ft_config.gateway_config.investor_id))) {
+    printf("cannot open tick snapshot table\n");
+    return false;
+  }
 
+  sender_.SetStrategyId(config.strategy_name.c_str());
+  params_ = config.params;
   account_id_ = std::stoul(ft_config.gateway_config.investor_id);
   strncpy(strategy_id_, config.strategy_name.c_str(), sizeof(strategy_id_));
-
   return true;
 }
 
 void Strategy::Run() {
+  if (latency_stats_.is_open() &&
+      !RegisterLatencyRecorder(&latency_stats_, std::string("strategy.") + strategy_id_)) {
+    printf("failed to register latency recorder\n");
+  }
+
   OnInit();
 
-  for (;;) {
-    auto frame = rsp_reader_->getNextFrame();
-    if (frame) {
-      if (frame->getDataLength() != sizeof(OrderResponse)) {
-        printf("invalid order rsp len\n");
-        abort();
-      }
-      auto* rsp = reinterpret_cast<OrderResponse*>(frame->getData());
-      OnOrderResponse(*rsp);
+  auto handler = [this](const auto& msg) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(msg)>, TickData>) {
+      OnTickMsg(msg);
+    } else {
+      OnOrderResponse(msg);
     }
-
-    frame = md_reader_->getNextFrame();
-    if (frame) {
-      if (frame->getDataLength() != sizeof(TickData)) {
-        printf("invalid tick data len\n");
-        abort();
-      }
-      TickData* tick = reinterpret_cast<TickData*>(frame->getData());
-      OnTickMsg(*tick);
+  };
+  Waiter waiter(wait_strategy_, &notifier_);
+  TickData tick;
+  for (;;) {
+    if (reader_.Poll(handler, OnUnknownMsg)) {
+      waiter.Reset();
+    } else if (conflate_md_ && conflated_md_.Poll(&tick)) {
+      OnTickMsg(tick);
+      waiter.Reset();
+    } else {
+      FlushLatencyStats();
+      waiter.Wait();
     }
   }
 }
@@ -65,26 +154,25 @@ void Strategy::RunBacktest() {
   OnInit();
   SendNotification(0);
 
-  for (;;) {
-    auto frame = rsp_reader_->getNextFrame();
-    if (frame) {
-      if (frame->getDataLength() != sizeof(OrderResponse)) {
-        printf("invalid order rsp len\n");
-        abort();
-      }
-      auto* rsp = reinterpret_cast<OrderResponse*>(frame->getData());
-      OnOrderResponse(*rsp);
+  auto handler = [this](const auto& msg) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(msg)>, TickData>) {
+      OnTickMsg(msg);
+      SendNotification(0);
+    } else {
+      OnOrderResponse(msg);
     }
-
-    frame = md_reader_->getNextFrame();
-    if (frame) {
-      if (frame->getDataLength() != sizeof(TickData)) {
-        printf("invalid tick data len\n");
-        abort();
-      }
-      TickData* tick = reinterpret_cast<TickData*>(frame->getData());
-      OnTickMsg(*tick);
+  };
+  Waiter waiter(wait_strategy_, &notifier_);
+  TickData tick;
+  for (;;) {
+    if (reader_.Poll(handler, OnUnknownMsg)) {
+      waiter.Reset();
+    } else if (conflate_md_ && conflated_md_.Poll(&tick)) {
+      OnTickMsg(tick);
       SendNotification(0);
+      waiter.Reset();
+    } else {
+      waiter.Wait();
     }
   }
 }
@@ -93,6 +181,11 @@ void Strategy::RegisterAlgoOrderEngine(AlgoOrderEngine* engine) {
   engine->SetStrategyName(strategy_id_);
   engine->SetOrderSender(&sender_);
   engine->SetTraderDB(&trader_db_);
+  if (in_process_positions_) {
+    engine->SetPositionCalculator(in_process_positions_);
+  } else if (use_position_cache_) {
+    engine->SetPositionCache(&position_cache_);
+  }
   engine->Init();
   algo_order_engines_.emplace_back(engine);
 }
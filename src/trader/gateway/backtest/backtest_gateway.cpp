@@ -4,12 +4,14 @@
 
 #include <cassert>
 #include <fstream>
+#include <utility>
 
 #include "ft/base/contract_table.h"
 #include "ft/base/log.h"
 #include "ft/utils/misc.h"
 #include "ft/utils/protocol_utils.h"
 #include "ft/utils/string_utils.h"
+#include "ft/utils/tsc.h"
 
 namespace ft {
 
@@ -19,7 +21,7 @@ bool BacktestGateway::Init(const GatewayConfig& config) {
   }
 
   current_ticks_.resize(ContractTable::size() + 1);
-  if (!LoadDataFeed(config.extended_args)) {
+  if (!data_feed_ && !LoadDataFeed(config.extended_args)) {
     return false;
   }
 
@@ -30,7 +32,12 @@ bool BacktestGateway::Init(const GatewayConfig& config) {
   init_fund.margin = 0.0;
   init_fund.frozen = 0.0;
   init_fund.floating_pnl = 0.0;
-  if (!fund_calculator_.Init(init_fund)) {
+  double commission_rate = 0.0;
+  auto commission_rate_it = config.extended_args.find("commission_rate");
+  if (commission_rate_it != config.extended_args.end()) {
+    commission_rate = std::stod(commission_rate_it->second);
+  }
+  if (!fund_calculator_.Init(init_fund, commission_rate)) {
     LOG_ERROR("init fund calculator failed");
     return false;
   }
@@ -48,8 +55,7 @@ bool BacktestGateway::SendOrder(const OrderRequest& order, uint64_t* privdata_pt
   pos_calculator_.UpdatePending(order.contract->ticker_id, order.direction, order.offset,
                                 order.volume);
 
-  *privdata_ptr = order.contract->ticker_id;
-  if (!match_engine_->InsertOrder(order)) {
+  if (!match_engine_->InsertOrder(order, privdata_ptr)) {
     fund_calculator_.UpdatePending(order, -order.volume);
     pos_calculator_.UpdatePending(order.contract->ticker_id, order.direction, order.offset,
                                   -order.volume);
@@ -60,7 +66,7 @@ bool BacktestGateway::SendOrder(const OrderRequest& order, uint64_t* privdata_pt
 
 bool BacktestGateway::CancelOrder(uint64_t order_id, uint64_t privdata) {
   std::unique_lock<SpinLock> lock(spinlock_);
-  return match_engine_->CancelOrder(order_id, static_cast<uint32_t>(privdata));
+  return match_engine_->CancelOrder(order_id, privdata);
 }
 
 bool BacktestGateway::Subscribe(const std::vector<std::string>& sub_list) { return true; }
@@ -104,7 +110,8 @@ void BacktestGateway::OnRejected(const OrderRequest& order) {
 
 void BacktestGateway::OnTraded(const OrderRequest& order, int volume, double price,
                                uint64_t timestamp_us) {
-  fund_calculator_.UpdateTraded(order, volume, price, current_ticks_[order.contract->ticker_id]);
+  fund_calculator_.UpdateTraded(order, volume, price, current_ticks_[order.contract->ticker_id],
+                                pos_calculator_.GetPosition(order.contract->ticker_id));
   pos_calculator_.UpdateTraded(order.contract->ticker_id, order.direction, order.offset, volume,
                                price);
 
@@ -130,16 +137,25 @@ void BacktestGateway::OnCancelRejected(uint64_t order_id) {
   OnOrderCancelRejected(rsp);
 }
 
-void BacktestGateway::OnDataFeed(TickData* tick) {
+void BacktestGateway::OnDataFeed(const TickData* tick) {
   std::unique_lock<SpinLock> lock(spinlock_);
   auto* pos = pos_calculator_.GetPosition(tick->ticker_id);
   if (pos && (pos->long_pos.holdings > 0 || pos->short_pos.holdings > 0)) {
     fund_calculator_.UpdatePrice(*pos, current_ticks_[tick->ticker_id], *tick);
   }
-  current_ticks_[tick->ticker_id] = *tick;
+  auto& current_tick = current_ticks_[tick->ticker_id];
+  current_tick = *tick;
+  // 回放的行情可能带有录制时的打点，重新以回放时刻作为收到行情的时间
+  current_tick.recv_tsc = RdTsc();
+  current_tick.dispatch_tsc = 0;
+
+  match_engine_->OnNewTick(current_tick);
+  OnTick(current_tick);
+}
 
-  match_engine_->OnNewTick(*tick);
-  OnTick(*tick);
+void BacktestGateway::SetDataFeed(std::shared_ptr<DataFeed> data_feed) {
+  data_feed_ = std::move(data_feed);
+  data_feed_->RegisterListener(this);
 }
 
 bool BacktestGateway::LoadMatchEngine(const std::map<std::string, std::string>& args) {
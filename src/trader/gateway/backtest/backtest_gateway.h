@@ -40,7 +40,14 @@ class BacktestGateway : public Gateway, public OrderEventListener, public Market
   void OnCanceled(const OrderRequest& order, int canceled_volume) override;
   void OnCancelRejected(uint64_t order_id) override;
 
-  void OnDataFeed(TickData* tick) override;
+  void OnDataFeed(const TickData* tick) override;
+
+  // 需在Init之前调用，设置后不再根据extended_args创建data feed，用于多个回测实例共享行情
+  void SetDataFeed(std::shared_ptr<DataFeed> data_feed);
+
+  const PositionCalculator& positions() const { return pos_calculator_; }
+
+  const Account& account() const { return fund_calculator_.GetFundAccount(); }
 
  private:
   bool LoadMatchEngine(const std::map<std::string, std::string>& args);
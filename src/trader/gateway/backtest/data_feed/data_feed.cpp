@@ -4,6 +4,8 @@
 
 #include "ft/base/log.h"
 #include "trader/gateway/backtest/data_feed/csv_data_feed.h"
+#include "trader/gateway/backtest/data_feed/journal_data_feed.h"
+#include "trader/gateway/backtest/data_feed/tick_file_data_feed.h"
 
 namespace ft {
 
@@ -35,5 +37,7 @@ std::shared_ptr<DataFeed> CreateDataFeed(const std::string& name) {
   }();
 
 REGISTER_DATA_FEED("ft.data_feed.csv", CsvDataFeed);
+REGISTER_DATA_FEED("ft.data_feed.tick_file", TickFileDataFeed);
+REGISTER_DATA_FEED("ft.data_feed.journal", JournalDataFeed);
 
 }  // namespace ft
@@ -14,7 +14,8 @@ class MarketDataListener {
  public:
   virtual ~MarketDataListener() {}
 
-  virtual void OnDataFeed(TickData* tick) = 0;
+  // tick可能直接指向data feed的数据源(如journal的映射)，不能修改
+  virtual void OnDataFeed(const TickData* tick) = 0;
 };
 
 class DataFeed {
@@ -0,0 +1,121 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "trader/gateway/backtest/data_feed/journal_data_feed.h"
+
+#include <ctime>
+#include <limits>
+
+#include "ft/base/log.h"
+#include "ft/base/msg_type.h"
+#include "ft/utils/string_utils.h"
+
+namespace ft {
+
+namespace {
+
+bool ParseTime(const std::string& str, int64_t* nano) {
+  if (str.find_first_not_of("0123456789") == std::string::npos) {
+    *nano = std::stoll(str);
+    return true;
+  }
+  struct tm tm {};
+  tm.tm_isdst = -1;
+  auto* end = strptime(str.c_str(), "%Y%m%d-%H:%M:%S", &tm);
+  if (!end || *end != '\0') {
+    return false;
+  }
+  *nano = static_cast<int64_t>(mktime(&tm)) * 1000000000L;
+  return true;
+}
+
+}  // namespace
+
+bool JournalDataFeed::Init(const std::map<std::string, std::string>& args) {
+  auto dir_iter = args.find("journal_dir");
+  auto jname_iter = args.find("journal");
+  if (dir_iter == args.end() || jname_iter == args.end()) {
+    LOG_ERROR("journal_dir or journal conf not found");
+    return false;
+  }
+  StringSplit(dir_iter->second, ",", &dirs_, true);
+  StringSplit(jname_iter->second, ",", &jnames_, true);
+  if (dirs_.empty() || jnames_.empty()) {
+    LOG_ERROR("journal_dir or journal is empty");
+    return false;
+  }
+
+  start_time_ = 0;
+  end_time_ = std::numeric_limits<int64_t>::max();
+  auto iter = args.find("start_time");
+  if (iter != args.end() && !ParseTime(iter->second, &start_time_)) {
+    LOG_ERROR("invalid start_time {}", iter->second);
+    return false;
+  }
+  iter = args.find("end_time");
+  if (iter != args.end() && !ParseTime(iter->second, &end_time_)) {
+    LOG_ERROR("invalid end_time {}", iter->second);
+    return false;
+  }
+
+  dir_idx_ = 0;
+  bad_tick_num_ = 0;
+  skipped_frame_num_ = 0;
+  reader_.reset();
+  return OpenNextDir();
+}
+
+bool JournalDataFeed::OpenNextDir() {
+  if (dir_idx_ >= dirs_.size()) {
+    return false;
+  }
+  auto& dir = dirs_[dir_idx_++];
+  std::vector<std::string> dirs(jnames_.size(), dir);
+  // 从start_time开始读取，之前的frame会被跳过
+  reader_ = yijinjing::JournalReader::create(dirs, jnames_, start_time_, "journal_data_feed");
+  LOG_INFO("replay journals in {}", dir);
+  return true;
+}
+
+bool JournalDataFeed::Finish() {
+  if (bad_tick_num_ > 0) {
+    LOG_ERROR("{} ticks dropped because of mismatched TickData length", bad_tick_num_);
+  }
+  if (skipped_frame_num_ > 0) {
+    LOG_INFO("{} non-tick frames skipped", skipped_frame_num_);
+  }
+  return false;
+}
+
+bool JournalDataFeed::Feed() {
+  for (;;) {
+    if (!reader_->getNextFrame(&frame_)) {
+      if (!OpenNextDir()) {
+        return Finish();
+      }
+      continue;
+    }
+    if (frame_.getNano() > end_time_) {
+      // 后面的目录的时间更晚，不需要再读取
+      dir_idx_ = dirs_.size();
+      return Finish();
+    }
+    // 之前的OMS以msg_type 0记录行情，也按tick回放
+    auto msg_type = frame_.getMsgType();
+    if (msg_type != kMsgTypeOf<TickData> && msg_type != kLegacyTickMsgType) {
+      ++skipped_frame_num_;
+      continue;
+    }
+    if (frame_.getDataLength() != sizeof(TickData)) {
+      // 通常是journal记录于TickData定义变化之前
+      if (bad_tick_num_++ == 0) {
+        LOG_ERROR("TickData length mismatched. msg_type:{} expected:{} actual:{}", msg_type,
+                  sizeof(TickData), frame_.getDataLength());
+      }
+      continue;
+    }
+    listener()->OnDataFeed(reinterpret_cast<const TickData*>(frame_.getData()));
+    return true;
+  }
+}
+
+}  // namespace ft
@@ -0,0 +1,48 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ft/component/yijinjing/journal/JournalReader.h"
+#include "trader/gateway/backtest/data_feed/data_feed.h"
+
+namespace ft {
+
+// 直接回放yijinjing中记录的行情(OMS的md_mq或ft_market按交易所写入的journal)，
+// tick直接从journal的映射中交给listener，不经过拷贝及解析
+// 参数:
+//   journal_dir: journal所在目录，多个目录(如按日期存放)以逗号分隔，按顺序依次回放
+//   journal: journal名，多个journal以逗号分隔，同一目录下的journal按时间顺序合并
+//   start_time/end_time: 选填，只回放该时间段内写入的行情，格式为%Y%m%d-%H:%M:%S或纳秒时间戳
+// 回测时使用的合约表需与记录行情时的一致，TickData的定义也需一致，长度不符的tick会被丢弃并报错
+// 引入消息类型之前记录的行情的msg_type为0，长度与TickData一致时同样回放
+class JournalDataFeed : public DataFeed {
+ public:
+  bool Init(const std::map<std::string, std::string>& args) override;
+
+  bool Feed() override;
+
+ private:
+  bool OpenNextDir();
+
+  // 回放结束，有被丢弃的tick时报错
+  bool Finish();
+
+ private:
+  static constexpr int16_t kLegacyTickMsgType = 0;
+
+  std::vector<std::string> dirs_;
+  std::vector<std::string> jnames_;
+  std::size_t dir_idx_ = 0;
+  int64_t start_time_ = 0;
+  int64_t end_time_ = 0;
+  uint64_t bad_tick_num_ = 0;
+  uint64_t skipped_frame_num_ = 0;  // 非行情消息
+  yijinjing::JournalReaderPtr reader_;
+  yijinjing::Frame frame_{nullptr};
+};
+
+}  // namespace ft
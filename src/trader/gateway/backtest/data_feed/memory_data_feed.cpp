@@ -0,0 +1,59 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "trader/gateway/backtest/data_feed/memory_data_feed.h"
+
+#include "ft/base/log.h"
+
+namespace ft {
+
+bool MemoryDataFeed::Init(const std::map<std::string, std::string>& args) {
+  cursor_ = 0;
+  return ticks_ != nullptr;
+}
+
+bool MemoryDataFeed::Feed() {
+  if (cursor_ >= ticks_->size()) {
+    return false;
+  }
+  listener()->OnDataFeed(&(*ticks_)[cursor_++]);
+  return true;
+}
+
+namespace {
+
+class TickCollector : public MarketDataListener {
+ public:
+  explicit TickCollector(std::vector<TickData>* ticks) : ticks_(ticks) {}
+
+  void OnDataFeed(const TickData* tick) override { ticks_->emplace_back(*tick); }
+
+ private:
+  std::vector<TickData>* ticks_;
+};
+
+}  // namespace
+
+bool LoadTicks(const std::map<std::string, std::string>& args, std::vector<TickData>* ticks) {
+  auto feed_name_it = args.find("data_feed");
+  if (feed_name_it == args.end()) {
+    LOG_ERROR("[LoadTicks] option data_feed not indicated");
+    return false;
+  }
+  auto data_feed = CreateDataFeed(feed_name_it->second);
+  if (!data_feed) {
+    LOG_ERROR("[LoadTicks] data feed {} not found", feed_name_it->second);
+    return false;
+  }
+
+  TickCollector collector(ticks);
+  data_feed->RegisterListener(&collector);
+  if (!data_feed->Init(args)) {
+    LOG_ERROR("[LoadTicks] data feed {} init failed", feed_name_it->second);
+    return false;
+  }
+  while (data_feed->Feed()) {
+  }
+  return true;
+}
+
+}  // namespace ft
@@ -0,0 +1,31 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "trader/gateway/backtest/data_feed/data_feed.h"
+
+namespace ft {
+
+// 回放内存中已经加载好的行情，不通过CreateDataFeed创建，而是由BacktestGateway::SetDataFeed设置
+// ticks由调用者持有，回放期间不能修改，多个回测实例可以共享同一份ticks
+class MemoryDataFeed : public DataFeed {
+ public:
+  explicit MemoryDataFeed(const std::vector<TickData>* ticks) : ticks_(ticks) {}
+
+  bool Init(const std::map<std::string, std::string>& args) override;
+
+  bool Feed() override;
+
+ private:
+  const std::vector<TickData>* ticks_;
+  std::size_t cursor_ = 0;
+};
+
+// 通过data feed把所有行情加载到内存中，args与BacktestGateway的extended_args相同
+bool LoadTicks(const std::map<std::string, std::string>& args, std::vector<TickData>* ticks);
+
+}  // namespace ft
@@ -0,0 +1,512 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "trader/gateway/backtest/data_feed/tick_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+
+namespace ft {
+
+namespace {
+
+enum class ColumnType : uint32_t {
+  kInteger,
+  kPrice,
+};
+
+struct Column {
+  uint32_t offset;  // 在TickData中的偏移
+  uint32_t size;
+  ColumnType type;
+};
+
+constexpr Column LevelColumn(std::size_t offset, std::size_t size, ColumnType type, int level) {
+  return Column{static_cast<uint32_t>(offset + level * size), static_cast<uint32_t>(size), type};
+}
+
+#define TICK_COLUMN(field, type) \
+  Column { offsetof(TickData, field), sizeof(TickData::field), ColumnType::type }
+#define TICK_LEVEL_COLUMNS(field, type)                                                   \
+  LevelColumn(offsetof(TickData, field), sizeof(TickData::field[0]), ColumnType::type, 0),  \
+      LevelColumn(offsetof(TickData, field), sizeof(TickData::field[0]), ColumnType::type, 1), \
+      LevelColumn(offsetof(TickData, field), sizeof(TickData::field[0]), ColumnType::type, 2), \
+      LevelColumn(offsetof(TickData, field), sizeof(TickData::field[0]), ColumnType::type, 3), \
+      LevelColumn(offsetof(TickData, field), sizeof(TickData::field[0]), ColumnType::type, 4)
+
+static_assert(kMaxMarketLevel == 5, "update TICK_LEVEL_COLUMNS");
+
+// 列的顺序即文件中的顺序，修改后需要升级kTickFileVersion
+// ticker列必须是第一列，解码其他列时需要先知道合约
+const Column kColumns[] = {
+    TICK_COLUMN(ticker_id, kInteger),
+    TICK_COLUMN(local_timestamp_us, kInteger),
+    TICK_COLUMN(exchange_timestamp_us, kInteger),
+    TICK_COLUMN(last_price, kPrice),
+    TICK_COLUMN(open_price, kPrice),
+    TICK_COLUMN(highest_price, kPrice),
+    TICK_COLUMN(lowest_price, kPrice),
+    TICK_COLUMN(pre_close_price, kPrice),
+    TICK_COLUMN(upper_limit_price, kPrice),
+    TICK_COLUMN(lower_limit_price, kPrice),
+    TICK_COLUMN(volume, kInteger),
+    TICK_COLUMN(turnover, kInteger),
+    TICK_COLUMN(open_interest, kInteger),
+    TICK_LEVEL_COLUMNS(ask, kPrice),
+    TICK_LEVEL_COLUMNS(bid, kPrice),
+    TICK_LEVEL_COLUMNS(ask_volume, kInteger),
+    TICK_LEVEL_COLUMNS(bid_volume, kInteger),
+    TICK_COLUMN(source, kInteger),
+};
+
+constexpr uint32_t kColumnNum = sizeof(kColumns) / sizeof(kColumns[0]);
+
+struct BlockHeader {
+  uint64_t bytes;  // 包括BlockHeader及对齐的字节
+  uint32_t tick_num;
+  uint32_t reserved;
+  uint32_t column_bytes[kColumnNum];
+  uint8_t column_scales[kColumnNum];
+} __attribute__((__aligned__(8)));
+
+constexpr uint8_t kRawScale = 0xff;  // 价格列不能以整数精确表示，按double的位模式存放
+constexpr double kPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+constexpr uint8_t kMaxScale = sizeof(kPow10) / sizeof(kPow10[0]) - 1;
+constexpr std::size_t kMaxVarintBytes = 10;
+
+inline uint64_t LoadInteger(const TickData& tick, const Column& column) {
+  auto* src = reinterpret_cast<const char*>(&tick) + column.offset;
+  switch (column.size) {
+    case 8: {
+      uint64_t v;
+      memcpy(&v, src, 8);
+      return v;
+    }
+    case 4: {
+      int32_t v;  // 有符号扩展，int的负数差分后依然很小
+      memcpy(&v, src, 4);
+      return static_cast<uint64_t>(static_cast<int64_t>(v));
+    }
+    default: {
+      uint8_t v;
+      memcpy(&v, src, 1);
+      return v;
+    }
+  }
+}
+
+inline void StoreInteger(TickData* tick, const Column& column, uint64_t v) {
+  auto* dst = reinterpret_cast<char*>(tick) + column.offset;
+  switch (column.size) {
+    case 8:
+      memcpy(dst, &v, 8);
+      break;
+    case 4: {
+      auto v32 = static_cast<uint32_t>(v);
+      memcpy(dst, &v32, 4);
+      break;
+    }
+    default: {
+      auto v8 = static_cast<uint8_t>(v);
+      memcpy(dst, &v8, 1);
+      break;
+    }
+  }
+}
+
+inline double LoadPrice(const TickData& tick, const Column& column) {
+  double v;
+  memcpy(&v, reinterpret_cast<const char*>(&tick) + column.offset, sizeof(v));
+  return v;
+}
+
+inline double ScaledToPrice(uint64_t v, uint8_t scale) {
+  return static_cast<double>(static_cast<int64_t>(v)) / kPow10[scale];
+}
+
+// 价格能否以10^scale倍的整数精确表示，能则返回该整数
+inline bool PriceToScaled(double price, uint8_t scale, uint64_t* v) {
+  double scaled = price * kPow10[scale];
+  if (!(std::fabs(scaled) < 9007199254740992.0)) {  // 2^53，同时排除nan及inf
+    return false;
+  }
+  auto n = static_cast<int64_t>(std::llround(scaled));
+  *v = static_cast<uint64_t>(n);
+  return ScaledToPrice(*v, scale) == price;
+}
+
+// 编码时列的取值，价格列按scale转换
+inline uint64_t EncodeValue(const TickData& tick, const Column& column, uint8_t scale) {
+  if (column.type == ColumnType::kInteger) {
+    return LoadInteger(tick, column);
+  }
+  double price = LoadPrice(tick, column);
+  uint64_t v;
+  if (scale == kRawScale) {
+    memcpy(&v, &price, sizeof(v));
+  } else {
+    PriceToScaled(price, scale, &v);
+  }
+  return v;
+}
+
+inline void DecodeValue(TickData* tick, const Column& column, uint8_t scale, uint64_t v) {
+  if (column.type == ColumnType::kInteger) {
+    StoreInteger(tick, column, v);
+    return;
+  }
+  double price;
+  if (scale == kRawScale) {
+    memcpy(&price, &v, sizeof(price));
+  } else {
+    price = ScaledToPrice(v, scale);
+  }
+  memcpy(reinterpret_cast<char*>(tick) + column.offset, &price, sizeof(price));
+}
+
+inline uint8_t* PutVarint(uint8_t* p, uint64_t v) {
+  while (v >= 0x80) {
+    *p++ = static_cast<uint8_t>(v | 0x80);
+    v >>= 7;
+  }
+  *p++ = static_cast<uint8_t>(v);
+  return p;
+}
+
+inline bool GetVarint(const uint8_t** p, const uint8_t* end, uint64_t* v) {
+  uint64_t res = 0;
+  for (uint32_t shift = 0; shift < 64 && *p < end; shift += 7) {
+    uint8_t byte = *(*p)++;
+    res |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      *v = res;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline uint64_t ZigZag(uint64_t delta) {
+  return (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+}
+
+inline uint64_t UnZigZag(uint64_t v) { return (v >> 1) ^ (~(v & 1) + 1); }
+
+inline uint64_t Align8(uint64_t n) { return (n + 7) & ~7UL; }
+
+}  // namespace
+
+TickFileWriter::~TickFileWriter() {
+  if (fp_) {
+    Close();
+  }
+}
+
+bool TickFileWriter::Open(const std::string& file, uint32_t block_ticks) {
+  if (fp_ || block_ticks == 0) {
+    return false;
+  }
+  fp_ = fopen(file.c_str(), "wb");
+  if (!fp_) {
+    LOG_ERROR("[TickFileWriter::Open] failed to open {}", file);
+    return false;
+  }
+
+  header_ = TickFileHeader{};
+  header_.version = kTickFileVersion;
+  header_.column_num = kColumnNum;
+  header_.block_ticks = block_ticks;
+  // magic在Close时写入，未正常关闭的文件无法被读取
+  if (fwrite(&header_, sizeof(header_), 1, fp_) != 1) {
+    LOG_ERROR("[TickFileWriter::Open] failed to write {}", file);
+    return false;
+  }
+
+  block_.clear();
+  block_.reserve(block_ticks);
+  block_buf_.resize(sizeof(BlockHeader) +
+                    static_cast<std::size_t>(kColumnNum) * kMaxVarintBytes * block_ticks + 8);
+  ticker_index_.clear();
+  tickers_.clear();
+  return true;
+}
+
+bool TickFileWriter::Write(const TickData& tick) {
+  if (!fp_) {
+    return false;
+  }
+
+  auto it = ticker_index_.find(tick.ticker_id);
+  if (it == ticker_index_.end()) {
+    auto* contract = ContractTable::get_by_index(tick.ticker_id);
+    if (!contract || contract->ticker.size() >= kTickFileTickerLen) {
+      LOG_ERROR("[TickFileWriter::Write] invalid ticker_id {}", tick.ticker_id);
+      return false;
+    }
+    it = ticker_index_.emplace(tick.ticker_id, static_cast<uint32_t>(tickers_.size())).first;
+    tickers_.emplace_back(contract->ticker);
+  }
+
+  block_.emplace_back(tick);
+  block_.back().ticker_id = it->second;
+  if (block_.size() == header_.block_ticks) {
+    return FlushBlock();
+  }
+  return true;
+}
+
+bool TickFileWriter::FlushBlock() {
+  auto n = static_cast<uint32_t>(block_.size());
+  auto* header = reinterpret_cast<BlockHeader*>(block_buf_.data());
+  *header = BlockHeader{};
+  header->tick_num = n;
+
+  last_values_.assign(tickers_.size() * kColumnNum, 0);
+  uint8_t* p = block_buf_.data() + sizeof(BlockHeader);
+  for (uint32_t c = 0; c < kColumnNum; ++c) {
+    auto& column = kColumns[c];
+    uint8_t scale = 0;
+    if (column.type == ColumnType::kPrice) {
+      // 选取能精确表示所有值的最小scale
+      uint64_t v;
+      for (; scale <= kMaxScale; ++scale) {
+        if (std::all_of(block_.begin(), block_.end(), [&](auto& tick) {
+              return PriceToScaled(LoadPrice(tick, column), scale, &v);
+            })) {
+          break;
+        }
+      }
+      if (scale > kMaxScale) {
+        scale = kRawScale;
+      }
+    }
+    header->column_scales[c] = scale;
+
+    auto* begin = p;
+    for (auto& tick : block_) {
+      uint64_t v = EncodeValue(tick, column, scale);
+      if (c == 0) {
+        p = PutVarint(p, v);
+        continue;
+      }
+      auto& last = last_values_[static_cast<std::size_t>(tick.ticker_id) * kColumnNum + c];
+      p = PutVarint(p, ZigZag(v - last));
+      last = v;
+    }
+    header->column_bytes[c] = static_cast<uint32_t>(p - begin);
+  }
+
+  header->bytes = Align8(p - block_buf_.data());
+  memset(p, 0, block_buf_.data() + header->bytes - p);
+  if (fwrite(block_buf_.data(), 1, header->bytes, fp_) != header->bytes) {
+    LOG_ERROR("[TickFileWriter::FlushBlock] failed to write");
+    return false;
+  }
+  header_.tick_num += n;
+  ++header_.block_num;
+  block_.clear();
+  return true;
+}
+
+bool TickFileWriter::Close() {
+  if (!fp_) {
+    return false;
+  }
+
+  bool res = false;
+  if (block_.empty() || FlushBlock()) {
+    header_.ticker_table_offset = static_cast<uint64_t>(ftell(fp_));
+    header_.ticker_num = static_cast<uint32_t>(tickers_.size());
+    res = true;
+    for (auto& ticker : tickers_) {
+      char buf[kTickFileTickerLen]{};
+      memcpy(buf, ticker.data(), ticker.size());
+      if (fwrite(buf, sizeof(buf), 1, fp_) != 1) {
+        res = false;
+        break;
+      }
+    }
+  }
+
+  if (res) {
+    header_.magic = kTickFileMagic;
+    res = fseek(fp_, 0, SEEK_SET) == 0 && fwrite(&header_, sizeof(header_), 1, fp_) == 1;
+  }
+  res = fclose(fp_) == 0 && res;
+  fp_ = nullptr;
+  if (!res) {
+    LOG_ERROR("[TickFileWriter::Close] failed to write");
+  }
+  return res;
+}
+
+TickFileReader::~TickFileReader() { Close(); }
+
+void TickFileReader::Close() {
+  if (addr_) {
+    munmap(addr_, size_);
+    addr_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+  }
+}
+
+bool TickFileReader::Open(const std::string& file) {
+  Close();
+
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG_ERROR("[TickFileReader::Open] failed to open {}", file);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(TickFileHeader)) {
+    LOG_ERROR("[TickFileReader::Open] invalid tick file {}", file);
+    close(fd);
+    return false;
+  }
+  size_ = st.st_size;
+  void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    LOG_ERROR("[TickFileReader::Open] failed to mmap {}", file);
+    size_ = 0;
+    return false;
+  }
+  addr_ = reinterpret_cast<char*>(addr);
+  madvise(addr_, size_, MADV_SEQUENTIAL);
+  header_ = reinterpret_cast<const TickFileHeader*>(addr_);
+
+  if (header_->magic != kTickFileMagic || header_->version != kTickFileVersion ||
+      header_->column_num != kColumnNum || header_->block_ticks == 0 ||
+      header_->ticker_table_offset < sizeof(TickFileHeader) ||
+      header_->ticker_table_offset +
+              static_cast<uint64_t>(header_->ticker_num) * kTickFileTickerLen >
+          size_) {
+    LOG_ERROR("[TickFileReader::Open] invalid tick file {}", file);
+    Close();
+    return false;
+  }
+
+  // block的长度不固定，依次检查各block的边界，解码时不再需要检查
+  uint64_t offset = sizeof(TickFileHeader);
+  uint64_t tick_num = 0;
+  for (uint32_t i = 0; i < header_->block_num; ++i) {
+    if (offset + sizeof(BlockHeader) > header_->ticker_table_offset) {
+      break;
+    }
+    auto* block = reinterpret_cast<const BlockHeader*>(addr_ + offset);
+    uint64_t bytes = sizeof(BlockHeader);
+    for (auto column_bytes : block->column_bytes) {
+      bytes += column_bytes;
+    }
+    if (block->tick_num == 0 || block->tick_num > header_->block_ticks || block->bytes < bytes ||
+        block->bytes % 8 != 0 || offset + block->bytes > header_->ticker_table_offset) {
+      break;
+    }
+    offset += block->bytes;
+    tick_num += block->tick_num;
+  }
+  if (offset != header_->ticker_table_offset || tick_num != header_->tick_num) {
+    LOG_ERROR("[TickFileReader::Open] invalid tick file {}", file);
+    Close();
+    return false;
+  }
+
+  ticker_ids_.clear();
+  auto* ticker_table = addr_ + header_->ticker_table_offset;
+  for (uint32_t i = 0; i < header_->ticker_num; ++i) {
+    auto* p = ticker_table + i * kTickFileTickerLen;
+    std::string ticker(p, strnlen(p, kTickFileTickerLen));
+    auto* contract = ContractTable::get_by_ticker(ticker);
+    if (!contract) {
+      LOG_ERROR("[TickFileReader::Open] ticker {} not found", ticker);
+      Close();
+      return false;
+    }
+    ticker_ids_.emplace_back(contract->ticker_id);
+  }
+
+  read_num_ = 0;
+  failed_ = false;
+  block_begin_ = sizeof(TickFileHeader);
+  block_bytes_ = 0;
+  block_size_ = 0;
+  cursor_ = 0;
+  return true;
+}
+
+void TickFileReader::LoadBlock(uint64_t offset) {
+  // 释放已经读完的block，映射的是文件，之后需要时会重新从page cache中读取
+  auto page_mask = ~(static_cast<uint64_t>(getpagesize()) - 1);
+  if (block_bytes_ > 0) {
+    auto begin = block_begin_ & page_mask;
+    auto end = (block_begin_ + block_bytes_) & page_mask;
+    if (end > begin) {
+      madvise(addr_ + begin, end - begin, MADV_DONTNEED);
+    }
+  }
+
+  auto* block = reinterpret_cast<const BlockHeader*>(addr_ + offset);
+  block_begin_ = offset;
+  block_bytes_ = block->bytes;
+  block_size_ = block->tick_num;
+  cursor_ = 0;
+
+  columns_.resize(kColumnNum);
+  column_ends_.resize(kColumnNum);
+  scales_.assign(block->column_scales, block->column_scales + kColumnNum);
+  const auto* p = reinterpret_cast<const uint8_t*>(block + 1);
+  for (uint32_t i = 0; i < kColumnNum; ++i) {
+    columns_[i] = p;
+    p += block->column_bytes[i];
+    column_ends_[i] = p;
+  }
+  last_values_.assign(ticker_ids_.size() * kColumnNum, 0);
+
+  auto begin = block_begin_ & page_mask;
+  madvise(addr_ + begin, block_begin_ + block_bytes_ - begin, MADV_WILLNEED);
+}
+
+bool TickFileReader::Next(TickData* tick) {
+  if (!header_ || failed_ || read_num_ >= header_->tick_num) {
+    return false;
+  }
+  if (cursor_ == block_size_) {
+    LoadBlock(block_begin_ + block_bytes_);
+  }
+
+  uint64_t ticker_idx;
+  if (!GetVarint(&columns_[0], column_ends_[0], &ticker_idx) ||
+      ticker_idx >= ticker_ids_.size()) {
+    LOG_ERROR("[TickFileReader::Next] invalid ticker index at tick {}", read_num_);
+    failed_ = true;
+    return false;
+  }
+  auto* last_values = last_values_.data() + ticker_idx * kColumnNum;
+  for (uint32_t i = 1; i < kColumnNum; ++i) {
+    uint64_t delta;
+    if (!GetVarint(&columns_[i], column_ends_[i], &delta)) {
+      LOG_ERROR("[TickFileReader::Next] invalid column {} at tick {}", i, read_num_);
+      failed_ = true;
+      return false;
+    }
+    last_values[i] += UnZigZag(delta);
+    DecodeValue(tick, kColumns[i], scales_[i], last_values[i]);
+  }
+  tick->ticker_id = ticker_ids_[ticker_idx];
+  ++cursor_;
+  ++read_num_;
+  return true;
+}
+
+}  // namespace ft
@@ -0,0 +1,111 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ft/base/market_data.h"
+
+namespace ft {
+
+// 列式tick文件，用于回测时代替csv，加载时不需要解析
+// 文件按block划分，每个block内按列(TickData的每个字段及每一档)连续存放，
+// 写入时只需缓存一个block，读取时按block顺序映射
+// 布局: Header(64B) | Block * block_num | 合约表
+// 合约表记录写入时的合约代码，ticker列存放的是合约表下标，读取时映射为当前的ticker_id
+//
+// 列的编码(block内，各合约分别做差分，每个block重新开始):
+// 1. 整数列: 与同一合约上一个tick的差值，zigzag后以varint存放
+// 2. 价格列: 若block内该列所有值都能以10^scale倍的整数精确表示，则按整数列编码并
+//    记录scale，否则按double的位模式做差分，保证无损
+// block的长度不固定，Block: BlockHeader | 各列数据，按8字节对齐
+
+struct TickFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t column_num;
+  uint32_t block_ticks;  // 每个block最多的tick数
+  uint64_t tick_num;
+  uint64_t ticker_table_offset;
+  uint32_t ticker_num;
+  uint32_t block_num;
+  uint32_t reserved[6];
+};
+static_assert(sizeof(TickFileHeader) == 64);
+
+constexpr uint32_t kTickFileMagic = 0x6b637466;  // "ftck"
+constexpr uint32_t kTickFileVersion = 2;
+constexpr uint32_t kTickFileTickerLen = 32;
+
+class TickFileWriter {
+ public:
+  ~TickFileWriter();
+
+  // block_ticks为每个block的tick数，决定了写入时缓存的大小
+  bool Open(const std::string& file, uint32_t block_ticks = 65536);
+
+  // 合约代码从ContractTable中查询，需先初始化ContractTable
+  bool Write(const TickData& tick);
+
+  // 写入剩余数据、合约表并更新文件头
+  bool Close();
+
+  uint64_t tick_num() const { return header_.tick_num; }
+
+ private:
+  bool FlushBlock();
+
+ private:
+  FILE* fp_ = nullptr;
+  TickFileHeader header_{};
+  std::vector<TickData> block_;
+  std::vector<uint8_t> block_buf_;
+  std::vector<uint64_t> last_values_;  // 合约表下标 * 列数 + 列 -> 上一个值
+  std::map<uint32_t, uint32_t> ticker_index_;  // ticker_id -> 合约表下标
+  std::vector<std::string> tickers_;
+};
+
+class TickFileReader {
+ public:
+  ~TickFileReader();
+
+  // 以只读方式映射文件，合约表中的合约需存在于当前的ContractTable
+  bool Open(const std::string& file);
+
+  void Close();
+
+  // 顺序读取下一个tick，读完或数据有误时返回false，通过failed()区分
+  // 已经读完的block会从内存中释放，常驻内存只有当前block
+  bool Next(TickData* tick);
+
+  uint64_t tick_num() const { return header_ ? header_->tick_num : 0; }
+
+  // 数据有误(如合约表下标越界)时为true，之后的Next都返回false
+  bool failed() const { return failed_; }
+
+ private:
+  void LoadBlock(uint64_t offset);
+
+ private:
+  char* addr_ = nullptr;
+  std::size_t size_ = 0;
+  const TickFileHeader* header_ = nullptr;
+  std::vector<uint32_t> ticker_ids_;  // 合约表下标 -> ticker_id
+
+  uint64_t block_begin_ = 0;  // 当前block在文件中的偏移
+  uint64_t block_bytes_ = 0;
+  uint32_t block_size_ = 0;   // 当前block的tick数
+  uint32_t cursor_ = 0;       // 当前block中下一个tick的下标
+  uint64_t read_num_ = 0;
+  bool failed_ = false;
+  std::vector<const uint8_t*> columns_;      // 各列下一个待解码的位置
+  std::vector<const uint8_t*> column_ends_;
+  std::vector<uint8_t> scales_;
+  std::vector<uint64_t> last_values_;
+};
+
+}  // namespace ft
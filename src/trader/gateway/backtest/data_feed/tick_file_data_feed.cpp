@@ -0,0 +1,59 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "trader/gateway/backtest/data_feed/tick_file_data_feed.h"
+
+#include "ft/base/log.h"
+#include "ft/utils/string_utils.h"
+
+namespace ft {
+
+bool TickFileDataFeed::Init(const std::map<std::string, std::string>& args) {
+  auto data_file_iter = args.find("data_file");
+  if (data_file_iter == args.end()) {
+    LOG_ERROR("data_file conf not found");
+    return false;
+  }
+
+  StringSplit(data_file_iter->second, ",", &files_, true);
+  if (files_.empty()) {
+    LOG_ERROR("data_file is empty");
+    return false;
+  }
+
+  // 提前检查所有文件，避免回测到一半才发现文件有误
+  for (auto& file : files_) {
+    if (!reader_.Open(file)) {
+      LOG_ERROR("load data failed. data_file: {}", file);
+      return false;
+    }
+    LOG_INFO("tick file {}: {} ticks", file, reader_.tick_num());
+  }
+
+  file_idx_ = 0;
+  return reader_.Open(files_[0]);
+}
+
+bool TickFileDataFeed::Feed() {
+  while (!reader_.Next(&tick_)) {
+    // 文件损坏时停止回放，不能跳过剩余的行情继续回放下一个文件
+    if (reader_.failed()) {
+      LOG_ERROR("[TickFileDataFeed::Feed] failed to read {}", files_[file_idx_]);
+      return false;
+    }
+    if (!OpenNextFile()) {
+      return false;
+    }
+  }
+  listener()->OnDataFeed(&tick_);
+  return true;
+}
+
+bool TickFileDataFeed::OpenNextFile() {
+  if (file_idx_ + 1 >= files_.size()) {
+    return false;
+  }
+  ++file_idx_;
+  return reader_.Open(files_[file_idx_]);
+}
+
+}  // namespace ft
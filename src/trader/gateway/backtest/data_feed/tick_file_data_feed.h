@@ -0,0 +1,32 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "trader/gateway/backtest/data_feed/data_feed.h"
+#include "trader/gateway/backtest/data_feed/tick_file.h"
+
+namespace ft {
+
+// 从列式tick文件中读取行情，文件通过tick_converter从csv或journal转换得到
+// data_file可以是以逗号分隔的多个文件，按顺序回放
+class TickFileDataFeed : public DataFeed {
+ public:
+  bool Init(const std::map<std::string, std::string>& args) override;
+
+  bool Feed() override;
+
+ private:
+  bool OpenNextFile();
+
+ private:
+  std::vector<std::string> files_;
+  std::size_t file_idx_ = 0;
+  TickFileReader reader_;
+  TickData tick_{};
+};
+
+}  // namespace ft
@@ -10,8 +10,13 @@
 
 namespace ft {
 
-bool FundCalculator::Init(const Account& init_fund) {
+bool FundCalculator::Init(const Account& init_fund, double commission_rate) {
+  if (commission_rate < 0.0) {
+    LOG_ERROR("invalid commission rate: {}", commission_rate);
+    return false;
+  }
   account_ = init_fund;
+  commission_rate_ = commission_rate;
   return true;
 }
 
@@ -36,19 +41,40 @@ void FundCalculator::UpdatePending(const OrderRequest& order, int changed) {
 }
 
 void FundCalculator::UpdateTraded(const OrderRequest& order, int volume, double price,
-                                  const TickData& current_tick) {
+                                  const TickData& current_tick, const Position* pos) {
+  double quote = GetMarketQuote(current_tick);
+  double commission = order.contract->size * volume * price * commission_rate_;
   if (IsOffsetOpen(order.offset)) {
     double fund_return = order.contract->size * volume * order.price;
     account_.frozen -= fund_return;
     account_.cash += fund_return;
 
-    account_.margin += order.contract->size * volume * GetMarketQuote(current_tick);
+    account_.margin += order.contract->size * volume * quote;
     account_.cash -= order.contract->size * volume * price;
+
+    // 新开的仓位按最新价计算浮动盈亏
+    int signed_volume = order.direction == Direction::kBuy ? volume : -volume;
+    account_.floating_pnl += signed_volume * order.contract->size * (quote - price);
   } else {
-    // TODO(K): update balance and cash
-    account_.margin -= order.contract->size * volume * GetMarketQuote(current_tick);
+    account_.margin -= order.contract->size * volume * quote;
     account_.cash += order.contract->size * volume * price;
+
+    // 平掉部分的浮动盈亏按成交价结算到balance
+    assert(pos);
+    if (order.direction == Direction::kSell) {
+      double cost_price = pos->long_pos.cost_price;
+      account_.floating_pnl -= order.contract->size * volume * (quote - cost_price);
+      account_.balance += order.contract->size * volume * (price - cost_price);
+    } else {
+      double cost_price = pos->short_pos.cost_price;
+      account_.floating_pnl -= order.contract->size * volume * (cost_price - quote);
+      account_.balance += order.contract->size * volume * (cost_price - price);
+    }
   }
+
+  account_.balance -= commission;
+  account_.cash -= commission;
+  account_.total_asset = account_.balance + account_.floating_pnl;
 }
 
 void FundCalculator::UpdatePrice(const Position& pos, const TickData& old_tick,
@@ -66,8 +92,9 @@ void FundCalculator::UpdatePrice(const Position& pos, const TickData& old_tick,
   account_.margin += margin_changed;
   account_.cash -= margin_changed;
 
-  // TODO(K): update floating_pnl and cash
-  // account_.cash = account_.balance + account_.floating_pnl;
+  account_.floating_pnl += contract->size * (long_pos - short_pos) *
+                           (GetMarketQuote(new_tick) - GetMarketQuote(old_tick));
+  account_.total_asset = account_.balance + account_.floating_pnl;
 }
 
 }  // namespace ft
@@ -8,16 +8,20 @@
 
 namespace ft {
 
+// balance为初始资金加上扣除手续费后的平仓盈亏，floating_pnl为持仓按最新价计算的浮动盈亏，
+// total_asset = balance + floating_pnl
 class FundCalculator {
  public:
-  bool Init(const Account& init_fund);
+  // commission_rate为手续费占成交金额的比例，开平相同
+  bool Init(const Account& init_fund, double commission_rate = 0.0);
 
   bool CheckFund(const OrderRequest& order) const;
 
   void UpdatePending(const OrderRequest& order, int changed);
 
+  // pos为成交前的持仓，平仓时按其成本价计算平仓盈亏
   void UpdateTraded(const OrderRequest& order, int volume, double price,
-                    const TickData& current_tick);
+                    const TickData& current_tick, const Position* pos);
 
   void UpdatePrice(const Position& pos, const TickData& old_tick, const TickData& new_tick);
 
@@ -40,6 +44,7 @@ class FundCalculator {
 
  private:
   Account account_{};
+  double commission_rate_ = 0.0;
 };
 
 }  // namespace ft
@@ -2,7 +2,9 @@
 
 #include "trader/gateway/backtest/match_engine/advanced_match_engine.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 #include "ft/base/contract_table.h"
 #include "ft/base/log.h"
@@ -10,17 +12,42 @@
 
 namespace ft {
 
-static inline uint64_t u64_price(double p) {
-  return (static_cast<uint64_t>(p * 100000000UL) + 50UL) / 10000UL;
+namespace {
+
+// 未配置最小变动价位的合约按1e-4的精度映射价格
+constexpr double kDefaultPriceTick = 0.0001;
+constexpr std::size_t kMinLevelNum = 256;
+// 按涨跌停价预分配价位时的上限，超出后按需扩容
+constexpr std::size_t kMaxInitLevelNum = 65536;
+constexpr std::size_t kInitNodeNum = 4096;
+
+inline int64_t ToTicks(double price, double price_tick) {
+  return std::llround(price / price_tick);
+}
+
+inline std::size_t RoundUpPow2(std::size_t n) {
+  std::size_t res = 1;
+  while (res < n) {
+    res <<= 1;
+  }
+  return res;
 }
 
+}  // namespace
+
 bool AdvancedMatchEngine::Init() {
   orderbooks_.resize(ContractTable::size());
+  for (uint32_t i = 0; i < orderbooks_.size(); ++i) {
+    auto* contract = ContractTable::get_by_index(i + 1);
+    orderbooks_[i].price_tick =
+        contract && contract->price_tick > 0 ? contract->price_tick : kDefaultPriceTick;
+  }
+  nodes_.reserve(kInitNodeNum);
   ticks_.resize(ContractTable::size());
   return true;
 }
 
-bool AdvancedMatchEngine::InsertOrder(const OrderRequest& order) {
+bool AdvancedMatchEngine::InsertOrder(const OrderRequest& order, uint64_t* handle) {
   auto& tick = ticks_[order.contract->ticker_id - 1];
   double ask = tick.ask[0];
   double bid = tick.bid[0];
@@ -32,33 +59,17 @@ bool AdvancedMatchEngine::InsertOrder(const OrderRequest& order) {
         double price = order.direction == Direction::kBuy ? ask : bid;
         listener()->OnTraded(order, order.volume, price, tick.exchange_timestamp_us);
       } else {
-        InnerOrder inner_order{};
-        inner_order.orig_order = order;
-        if (order.direction == Direction::kBuy) {
-          for (int level = 0; level < kMaxMarketLevel; ++level) {
-            if (IsEqual(tick.bid[level], order.price)) {
-              inner_order.queue_position = tick.bid_volume[level];
-              LOG_DEBUG("queue_position:{}", inner_order.queue_position);
-              break;
-            }
-          }
-          uint64_t price_u64 = u64_price(order.price);
-          orderbooks_[order.contract->ticker_id - 1].bid_levels[price_u64].emplace_back(
-              inner_order);
-          id_price_map_.emplace(order.order_id, price_u64);
-        } else {
-          for (int level = 0; level < kMaxMarketLevel; ++level) {
-            if (IsEqual(tick.ask[level], order.price)) {
-              inner_order.queue_position = tick.ask_volume[level];
-              LOG_DEBUG("queue_position:{}", inner_order.queue_position);
-              break;
-            }
+        int queue_position = 0;
+        for (int level = 0; level < kMaxMarketLevel; ++level) {
+          if (order.direction == Direction::kBuy ? IsEqual(tick.bid[level], order.price)
+                                                 : IsEqual(tick.ask[level], order.price)) {
+            queue_position = order.direction == Direction::kBuy ? tick.bid_volume[level]
+                                                                : tick.ask_volume[level];
+            LOG_DEBUG("queue_position:{}", queue_position);
+            break;
           }
-          uint64_t price_u64 = u64_price(order.price);
-          orderbooks_[order.contract->ticker_id - 1].ask_levels[price_u64].emplace_back(
-              inner_order);
-          id_price_map_.emplace(order.order_id, price_u64);
         }
+        AddOrder(order, order.price, queue_position, handle);
         listener()->OnAccepted(order);
       }
       break;
@@ -68,22 +79,10 @@ bool AdvancedMatchEngine::InsertOrder(const OrderRequest& order) {
           (order.direction == Direction::kSell && tick.ask_volume[0] == 0)) {
         listener()->OnRejected(order);
       } else {
-        InnerOrder inner_order;
-        inner_order.orig_order = order;
         if (order.direction == Direction::kBuy) {
-          inner_order.orig_order.price = bid;
-          inner_order.queue_position = tick.bid_volume[0];
-          uint64_t price_u64 = u64_price(bid);
-          orderbooks_[order.contract->ticker_id - 1].bid_levels[price_u64].emplace_back(
-              inner_order);
-          id_price_map_.emplace(order.order_id, price_u64);
+          AddOrder(order, bid, tick.bid_volume[0], handle);
         } else {
-          inner_order.orig_order.price = ask;
-          inner_order.queue_position = tick.ask_volume[0];
-          uint64_t price_u64 = u64_price(ask);
-          orderbooks_[order.contract->ticker_id - 1].ask_levels[price_u64].emplace_back(
-              inner_order);
-          id_price_map_.emplace(order.order_id, price_u64);
+          AddOrder(order, ask, tick.ask_volume[0], handle);
         }
         listener()->OnAccepted(order);
       }
@@ -118,51 +117,168 @@ bool AdvancedMatchEngine::InsertOrder(const OrderRequest& order) {
   return true;
 }
 
-bool AdvancedMatchEngine::CancelOrder(uint64_t order_id, uint32_t ticker_id) {
-  auto it = id_price_map_.find(order_id);
-  if (it == id_price_map_.end()) {
-    return false;
+bool AdvancedMatchEngine::CancelOrder(uint64_t order_id, uint64_t handle) {
+  // handle对应的节点可能已经成交并被复用，需校验order_id
+  if (handle >= nodes_.size() || !nodes_[handle].in_use ||
+      nodes_[handle].orig_order.order_id != order_id) {
+    listener()->OnCancelRejected(order_id);
+    return true;
   }
-  uint64_t price_u64 = it->second;
-  id_price_map_.erase(it);
-
-  auto& bid_levels = orderbooks_[ticker_id - 1].bid_levels;
-  auto& ask_levels = orderbooks_[ticker_id - 1].ask_levels;
-
-  auto bid_order_list_it = bid_levels.find(price_u64);
-  if (bid_order_list_it == bid_levels.end()) {
-    auto ask_order_list_it = ask_levels.find(price_u64);
-    if (ask_order_list_it == ask_levels.end()) {
-      // bug
-      abort();
+
+  auto idx = static_cast<uint32_t>(handle);
+  auto& order = nodes_[idx].orig_order;
+  auto& orderbook = orderbooks_[order.contract->ticker_id - 1];
+  listener()->OnCanceled(order, order.volume);
+  RemoveOrder(order.direction == Direction::kBuy ? &orderbook.bid : &orderbook.ask, idx);
+  return true;
+}
+
+void AdvancedMatchEngine::AddOrder(const OrderRequest& order, double price, int queue_position,
+                                   uint64_t* handle) {
+  auto& orderbook = orderbooks_[order.contract->ticker_id - 1];
+  auto* side = order.direction == Direction::kBuy ? &orderbook.bid : &orderbook.ask;
+  int64_t price_ticks = ToTicks(price, orderbook.price_tick);
+  ReserveLevels(side, ticks_[order.contract->ticker_id - 1], orderbook.price_tick, price_ticks);
+
+  uint32_t idx = AllocNode();
+  auto& node = nodes_[idx];
+  node.orig_order = order;
+  node.orig_order.price = price;
+  node.price = price_ticks;
+  node.queue_position = queue_position;
+  node.next = kNullNode;
+
+  auto& level = side->levels[price_ticks & (side->levels.size() - 1)];
+  node.prev = level.tail;
+  if (level.tail == kNullNode) {
+    level.head = idx;
+  } else {
+    nodes_[level.tail].next = idx;
+  }
+  level.tail = idx;
+  ++side->order_num;
+  *handle = idx;
+}
+
+void AdvancedMatchEngine::RemoveOrder(BookSide* side, uint32_t idx) {
+  auto mask = side->levels.size() - 1;
+  auto& node = nodes_[idx];
+  auto& level = side->levels[node.price & mask];
+  if (node.prev == kNullNode) {
+    level.head = node.next;
+  } else {
+    nodes_[node.prev].next = node.next;
+  }
+  if (node.next == kNullNode) {
+    level.tail = node.prev;
+  } else {
+    nodes_[node.next].prev = node.prev;
+  }
+  --side->order_num;
+
+  // 价位被清空时收缩挂单范围，使low和high分别为最低和最高的挂单价位
+  if (level.head == kNullNode && side->order_num > 0) {
+    while (side->levels[side->low & mask].head == kNullNode) {
+      ++side->low;
     }
-    auto& order_list = ask_order_list_it->second;
-    for (auto order_it = order_list.begin(); order_it != order_list.end();) {
-      if (order_it->orig_order.order_id == order_id) {
-        listener()->OnCanceled(order_it->orig_order, order_it->orig_order.volume);
-        order_list.erase(order_it);
-        if (order_list.empty()) {
-          ask_levels.erase(ask_order_list_it);
-        }
-        return true;
-      }
+    while (side->levels[side->high & mask].head == kNullNode) {
+      --side->high;
     }
-  } else {
-    auto& order_list = bid_order_list_it->second;
-    for (auto order_it = order_list.begin(); order_it != order_list.end();) {
-      if (order_it->orig_order.order_id == order_id) {
-        listener()->OnCanceled(order_it->orig_order, order_it->orig_order.volume);
-        order_list.erase(order_it);
-        if (order_list.empty()) {
-          bid_levels.erase(bid_order_list_it);
-        }
-        return true;
+  }
+  FreeNode(idx);
+}
+
+AdvancedMatchEngine::PriceLevel* AdvancedMatchEngine::FindLevel(BookSide* side, int64_t price) {
+  if (side->order_num == 0 || price < side->low || price > side->high) {
+    return nullptr;
+  }
+  return &side->levels[price & (side->levels.size() - 1)];
+}
+
+void AdvancedMatchEngine::ReserveLevels(BookSide* side, const TickData& tick, double price_tick,
+                                        int64_t price) {
+  if (side->order_num == 0) {
+    if (side->levels.empty()) {
+      // 首次挂单时按涨跌停价之间的价位数分配，使得当日的挂单不需要扩容
+      std::size_t level_num = kMinLevelNum;
+      if (tick.lower_limit_price > 0 && tick.upper_limit_price > tick.lower_limit_price) {
+        auto band = ToTicks(tick.upper_limit_price - tick.lower_limit_price, price_tick) + 1;
+        level_num = std::max(level_num, std::min<std::size_t>(band, kMaxInitLevelNum));
       }
+      side->levels.resize(RoundUpPow2(level_num));
     }
+    side->low = price;
+    side->high = price;
+    return;
   }
 
-  // bug
-  abort();
+  int64_t low = std::min(side->low, price);
+  int64_t high = std::max(side->high, price);
+  auto level_num = side->levels.size();
+  if (static_cast<std::size_t>(high - low) >= level_num) {
+    auto new_level_num = RoundUpPow2(high - low + 1);
+    std::vector<PriceLevel> levels(new_level_num);
+    for (int64_t p = side->low; p <= side->high; ++p) {
+      levels[p & (new_level_num - 1)] = side->levels[p & (level_num - 1)];
+    }
+    side->levels.swap(levels);
+  }
+  side->low = low;
+  side->high = high;
+}
+
+void AdvancedMatchEngine::FillLevel(BookSide* side, int64_t price, uint64_t timestamp_us) {
+  auto* level = FindLevel(side, price);
+  if (!level) {
+    return;
+  }
+  while (level->head != kNullNode) {
+    uint32_t idx = level->head;
+    auto& order = nodes_[idx].orig_order;
+    listener()->OnTraded(order, order.volume, order.price, timestamp_us);
+    RemoveOrder(side, idx);
+  }
+}
+
+void AdvancedMatchEngine::FillQueue(BookSide* side, int64_t price, int filled,
+                                    uint64_t timestamp_us) {
+  auto* level = FindLevel(side, price);
+  if (!level) {
+    return;
+  }
+  uint32_t idx = level->head;
+  while (idx != kNullNode) {
+    auto& node = nodes_[idx];
+    uint32_t next = node.next;
+    LOG_DEBUG("queue_position:{} filled:{}", node.queue_position, filled);
+    if (node.queue_position < filled) {
+      listener()->OnTraded(node.orig_order, node.orig_order.volume, node.orig_order.price,
+                           timestamp_us);
+      RemoveOrder(side, idx);
+    } else {
+      node.queue_position -= filled;
+    }
+    idx = next;
+  }
+}
+
+uint32_t AdvancedMatchEngine::AllocNode() {
+  uint32_t idx;
+  if (free_head_ == kNullNode) {
+    idx = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+  } else {
+    idx = free_head_;
+    free_head_ = nodes_[idx].next;
+  }
+  nodes_[idx].in_use = true;
+  return idx;
+}
+
+void AdvancedMatchEngine::FreeNode(uint32_t idx) {
+  nodes_[idx].in_use = false;
+  nodes_[idx].next = free_head_;
+  free_head_ = idx;
 }
 
 void AdvancedMatchEngine::OnNewTick(const TickData& tick) {
@@ -223,23 +339,17 @@ void AdvancedMatchEngine::OnNewTick(const TickData& tick) {
 
   LOG_DEBUG("bid_filled:{} ask_filled:{}", bid_filled, ask_filled);
 
-  if (bid_filled > 0) {
-    auto& bid_levels = orderbooks_[tick.ticker_id - 1].bid_levels;
+  auto& orderbook = orderbooks_[tick.ticker_id - 1];
+  double price_tick = orderbook.price_tick;
+  uint64_t timestamp_us = tick.exchange_timestamp_us;
 
+  if (bid_filled > 0) {
+    auto* side = &orderbook.bid;
+    // 高于买一价的挂单全部成交
     if (tick.bid_volume[0] > 0) {
-      uint64_t bid_u64 = u64_price(tick.bid[0]);
-      while (!bid_levels.empty()) {
-        auto begin = bid_levels.begin();
-        if (begin->first <= bid_u64) {
-          break;
-        }
-        auto& order_list = begin->second;
-        for (auto& order : order_list) {
-          listener()->OnTraded(order.orig_order, order.orig_order.volume, order.orig_order.price,
-                               tick.exchange_timestamp_us);
-          id_price_map_.erase(order.orig_order.order_id);
-        }
-        bid_levels.erase(begin);
+      int64_t bid = ToTicks(tick.bid[0], price_tick);
+      while (side->order_num > 0 && side->high > bid) {
+        FillLevel(side, side->high, timestamp_us);
       }
     }
 
@@ -247,26 +357,7 @@ void AdvancedMatchEngine::OnNewTick(const TickData& tick) {
       if (tick.bid_volume[level] == 0) {
         continue;
       }
-      auto order_list_it = bid_levels.find(u64_price(tick.bid[level]));
-      if (order_list_it != bid_levels.end()) {
-        auto& order_list = order_list_it->second;
-        for (auto order_it = order_list.begin(); order_it != order_list.end();) {
-          auto& order = *order_it;
-          LOG_DEBUG("queue_position:{} bid_filled:{}", order.queue_position, bid_filled);
-          if (order.queue_position < bid_filled) {
-            listener()->OnTraded(order.orig_order, order.orig_order.volume, order.orig_order.price,
-                                 tick.exchange_timestamp_us);
-            id_price_map_.erase(order.orig_order.order_id);
-            order_it = order_list.erase(order_it);
-          } else {
-            order.queue_position -= bid_filled;
-            ++order_it;
-          }
-          if (order_list.empty()) {
-            bid_levels.erase(order_list_it);
-          }
-        }
-      }
+      FillQueue(side, ToTicks(tick.bid[level], price_tick), bid_filled, timestamp_us);
       bid_filled -= tick.bid_volume[level];
       if (bid_filled <= 0) {
         break;
@@ -275,22 +366,12 @@ void AdvancedMatchEngine::OnNewTick(const TickData& tick) {
   }
 
   if (ask_filled > 0) {
-    auto& ask_levels = orderbooks_[tick.ticker_id - 1].ask_levels;
-
+    auto* side = &orderbook.ask;
+    // 低于卖一价的挂单全部成交
     if (tick.ask_volume[0] > 0) {
-      uint64_t ask_u64 = u64_price(tick.bid[0]);
-      while (!ask_levels.empty()) {
-        auto begin = ask_levels.begin();
-        if (begin->first >= ask_u64) {
-          break;
-        }
-        auto& order_list = begin->second;
-        for (auto& order : order_list) {
-          listener()->OnTraded(order.orig_order, order.orig_order.volume, order.orig_order.price,
-                               tick.exchange_timestamp_us);
-          id_price_map_.erase(order.orig_order.order_id);
-        }
-        ask_levels.erase(begin);
+      int64_t ask = ToTicks(tick.ask[0], price_tick);
+      while (side->order_num > 0 && side->low < ask) {
+        FillLevel(side, side->low, timestamp_us);
       }
     }
 
@@ -298,26 +379,7 @@ void AdvancedMatchEngine::OnNewTick(const TickData& tick) {
       if (tick.ask_volume[level] == 0) {
         continue;
       }
-      auto order_list_it = ask_levels.find(u64_price(tick.ask[level]));
-      if (order_list_it != ask_levels.end()) {
-        auto& order_list = order_list_it->second;
-        for (auto order_it = order_list.begin(); order_it != order_list.end();) {
-          auto& order = *order_it;
-          LOG_DEBUG("queue_position:{} ask_filled:{}", order.queue_position, ask_filled);
-          if (order.queue_position < ask_filled) {
-            listener()->OnTraded(order.orig_order, order.orig_order.volume, order.orig_order.price,
-                                 tick.exchange_timestamp_us);
-            id_price_map_.erase(order.orig_order.order_id);
-            order_it = order_list.erase(order_it);
-          } else {
-            order.queue_position -= ask_filled;
-            ++order_it;
-          }
-          if (order_list.empty()) {
-            ask_levels.erase(order_list_it);
-          }
-        }
-      }
+      FillQueue(side, ToTicks(tick.ask[level], price_tick), ask_filled, timestamp_us);
       ask_filled -= tick.ask_volume[level];
       if (ask_filled <= 0) {
         break;
@@ -327,39 +389,19 @@ void AdvancedMatchEngine::OnNewTick(const TickData& tick) {
 
   // 空方小于bid价格的单应该全部成交
   if (tick.bid_volume[0] > 0) {
-    auto& ask_levels = orderbooks_[tick.ticker_id - 1].ask_levels;
-    while (!ask_levels.empty()) {
-      auto begin = ask_levels.begin();
-      auto price_u64 = begin->first;
-      if (price_u64 > u64_price(tick.bid[0])) {
-        break;
-      }
-      auto& order_list = begin->second;
-      for (auto& order : order_list) {
-        listener()->OnTraded(order.orig_order, order.orig_order.volume, order.orig_order.price,
-                             tick.exchange_timestamp_us);
-        id_price_map_.erase(order.orig_order.order_id);
-      }
-      ask_levels.erase(begin);
+    auto* side = &orderbook.ask;
+    int64_t bid = ToTicks(tick.bid[0], price_tick);
+    while (side->order_num > 0 && side->low <= bid) {
+      FillLevel(side, side->low, timestamp_us);
     }
   }
 
   // 多方大于ask价格的单应该全部成交
   if (tick.ask_volume[0] > 0) {
-    auto& bid_levels = orderbooks_[tick.ticker_id - 1].bid_levels;
-    while (!bid_levels.empty()) {
-      auto begin = bid_levels.begin();
-      auto price_u64 = begin->first;
-      if (price_u64 < u64_price(tick.ask[0])) {
-        break;
-      }
-      auto& order_list = begin->second;
-      for (auto& order : order_list) {
-        listener()->OnTraded(order.orig_order, order.orig_order.volume, order.orig_order.price,
-                             tick.exchange_timestamp_us);
-        id_price_map_.erase(order.orig_order.order_id);
-      }
-      bid_levels.erase(begin);
+    auto* side = &orderbook.bid;
+    int64_t ask = ToTicks(tick.ask[0], price_tick);
+    while (side->order_num > 0 && side->high >= ask) {
+      FillLevel(side, side->high, timestamp_us);
     }
   }
 
@@ -2,9 +2,7 @@
 
 #pragma once
 
-#include <functional>
-#include <list>
-#include <map>
+#include <cstdint>
 #include <vector>
 
 #include "match_engine.h"
@@ -12,31 +10,70 @@
 namespace ft {
 
 // 估算订单位置双边成交量来确定挂单是否成交
+// 挂单按价格(以price_tick为单位)映射到环形数组中的价位，每个价位是一个侵入式的FIFO队列，
+// 订单节点从预分配的节点池中分配，撤单时通过handle(节点下标)直接定位，成交时不会分配内存
 class AdvancedMatchEngine : public MatchEngine {
  public:
   bool Init() override;
 
-  bool InsertOrder(const OrderRequest& order) override;
+  bool InsertOrder(const OrderRequest& order, uint64_t* handle) override;
 
-  bool CancelOrder(uint64_t order_id, uint32_t ticker_id) override;
+  bool CancelOrder(uint64_t order_id, uint64_t handle) override;
 
   void OnNewTick(const TickData& tick) override;
 
  private:
+  static constexpr uint32_t kNullNode = UINT32_MAX;
+
   struct InnerOrder {
     OrderRequest orig_order;
+    int64_t price;  // 以price_tick为单位
     int queue_position;
+    uint32_t prev;
+    uint32_t next;
+    bool in_use;
+  };
+
+  struct PriceLevel {
+    uint32_t head = kNullNode;
+    uint32_t tail = kNullNode;
+  };
+
+  // 单边挂单，价格p对应的价位为levels[p & (levels.size() - 1)]
+  // 挂单的价格范围始终在[low, high]内且high - low < levels.size()，超出时扩容
+  struct BookSide {
+    std::vector<PriceLevel> levels;
+    int64_t low = 0;
+    int64_t high = 0;
+    uint32_t order_num = 0;
   };
 
   struct OrderBook {
-    std::map<uint64_t, std::list<InnerOrder>, std::greater<uint64_t>> bid_levels;
-    std::map<uint64_t, std::list<InnerOrder>, std::less<uint64_t>> ask_levels;
+    double price_tick;
+    BookSide bid;
+    BookSide ask;
   };
 
+ private:
+  void AddOrder(const OrderRequest& order, double price, int queue_position, uint64_t* handle);
+  void RemoveOrder(BookSide* side, uint32_t idx);
+
+  // 价位不在挂单范围内时返回nullptr
+  PriceLevel* FindLevel(BookSide* side, int64_t price);
+  void ReserveLevels(BookSide* side, const TickData& tick, double price_tick, int64_t price);
+
+  // 成交价位上的所有挂单
+  void FillLevel(BookSide* side, int64_t price, uint64_t timestamp_us);
+  // 按队列位置成交盘口价位上的挂单
+  void FillQueue(BookSide* side, int64_t price, int filled, uint64_t timestamp_us);
+
+  uint32_t AllocNode();
+  void FreeNode(uint32_t idx);
+
  private:
   std::vector<OrderBook> orderbooks_;
-  // order_id -> price_u64：用于撤单时能快速找到订单队列
-  std::map<uint64_t, uint64_t> id_price_map_;
+  std::vector<InnerOrder> nodes_;
+  uint32_t free_head_ = kNullNode;
   std::vector<TickData> ticks_;
 };
 
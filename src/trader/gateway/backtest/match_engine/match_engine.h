@@ -33,9 +33,10 @@ class MatchEngine {
 
   virtual bool Init() = 0;
 
-  virtual bool InsertOrder(const OrderRequest& order) = 0;
+  // handle由撮合引擎写入，撤单时原样传回，用于定位挂单
+  virtual bool InsertOrder(const OrderRequest& order, uint64_t* handle) = 0;
 
-  virtual bool CancelOrder(uint64_t order_id, uint32_t ticker_id) = 0;
+  virtual bool CancelOrder(uint64_t order_id, uint64_t handle) = 0;
 
   virtual void OnNewTick(const TickData& tick) = 0;
 
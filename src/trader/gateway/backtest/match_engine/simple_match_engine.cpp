@@ -13,7 +13,8 @@ bool SimpleMatchEngine::Init() {
   return true;
 }
 
-bool SimpleMatchEngine::InsertOrder(const OrderRequest& order) {
+bool SimpleMatchEngine::InsertOrder(const OrderRequest& order, uint64_t* handle) {
+  *handle = order.contract->ticker_id;
   auto& tick = ticks_[order.contract->ticker_id];
   double ask = tick.ask[0];
   double bid = tick.bid[0];
@@ -71,8 +72,8 @@ bool SimpleMatchEngine::InsertOrder(const OrderRequest& order) {
   return true;
 }
 
-bool SimpleMatchEngine::CancelOrder(uint64_t order_id, uint32_t ticker_id) {
-  auto& map = orders_[ticker_id];
+bool SimpleMatchEngine::CancelOrder(uint64_t order_id, uint64_t handle) {
+  auto& map = orders_[handle];
   auto it = map.find(order_id);
   if (it == map.end()) {
     listener()->OnCancelRejected(order_id);
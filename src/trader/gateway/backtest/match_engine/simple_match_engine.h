@@ -13,9 +13,9 @@ class SimpleMatchEngine : public MatchEngine {
  public:
   bool Init() override;
 
-  bool InsertOrder(const OrderRequest& order) override;
+  bool InsertOrder(const OrderRequest& order, uint64_t* handle) override;
 
-  bool CancelOrder(uint64_t order_id, uint32_t ticker_id) override;
+  bool CancelOrder(uint64_t order_id, uint64_t handle) override;
 
   void OnNewTick(const TickData& tick) override;
 
@@ -5,6 +5,7 @@
 #include <utility>
 
 #include "ft/base/log.h"
+#include "ft/utils/tsc.h"
 #include "trader/gateway/ctp/ctp_gateway.h"
 
 namespace ft {
@@ -150,6 +151,7 @@ void CtpQuoteApi::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *md) {
     return;
   }
 
+  uint64_t recv_tsc = RdTsc();
   timespec ts;
   clock_gettime(CLOCK_REALTIME, &ts);
 
@@ -167,6 +169,7 @@ void CtpQuoteApi::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *md) {
 
   TickData tick{};
   tick.local_timestamp_us = ts.tv_sec * 1000000UL + ts.tv_nsec / 1000UL;
+  tick.recv_tsc = recv_tsc;
   tick.source = MarketDataSource::kCTP;
   tick.ticker_id = contract->ticker_id;
   tick.exchange_timestamp_us = dt_converter_.GetExchTimeStamp(md->UpdateTime, md->UpdateMillisec);
@@ -4,6 +4,7 @@
 
 #include "trader/gateway/backtest/backtest_gateway.h"
 #include "trader/gateway/ctp/ctp_gateway.h"
+#include "trader/gateway/market/market_gateway.h"
 #include "trader/gateway/stub/stub_gateway.h"
 #include "trader/gateway/xtp/xtp_gateway.h"
 
@@ -40,5 +41,6 @@ REGISTER_GATEWAY("ctp", CtpGateway);
 REGISTER_GATEWAY("xtp", XtpGateway);
 REGISTER_GATEWAY("backtest", BacktestGateway);
 REGISTER_GATEWAY("stub", StubGateway);
+REGISTER_GATEWAY("market", MarketGateway);
 
 }  // namespace ft
@@ -13,6 +13,7 @@
 #include "ft/base/market_data.h"
 #include "ft/base/trade_msg.h"
 #include "ft/utils/ring_buffer.h"
+#include "ft/utils/wait_strategy.h"
 #include "trader/msg.h"
 
 namespace ft {
@@ -85,6 +86,13 @@ class Gateway {
 
   TickRB* GetTickRB() { return &tick_rb_; }
 
+  // 回报及查询结果写入后唤醒rsp_notifier上等待的OMS核心线程，行情写入后唤醒
+  // tick_notifier上等待的行情分发线程，为nullptr时不唤醒
+  void SetNotifier(Notifier* rsp_notifier, Notifier* tick_notifier) {
+    rsp_notifier_ = rsp_notifier;
+    tick_notifier_ = tick_notifier;
+  }
+
  protected:
   void OnOrderAccepted(const OrderAcceptedRsp& rsp);
 
@@ -119,9 +127,17 @@ class Gateway {
   void OnTick(const TickData& tick_data);
 
  private:
+  void NotifyRsp() {
+    if (rsp_notifier_) {
+      rsp_notifier_->Notify();
+    }
+  }
+
   OrderRspRB rsp_rb_;
   QryReultRB qry_result_rb_;
   TickRB tick_rb_;
+  Notifier* rsp_notifier_ = nullptr;
+  Notifier* tick_notifier_ = nullptr;
 };
 
 inline void Gateway::OnOrderAccepted(const OrderAcceptedRsp& rsp) {
@@ -129,6 +145,7 @@ inline void Gateway::OnOrderAccepted(const OrderAcceptedRsp& rsp) {
   gtw_rsp.msg_type = GatewayMsgType::kOrderAcceptedRsp;
   gtw_rsp.data = rsp;
   rsp_rb_.PutWithBlocking(std::move(gtw_rsp));
+  NotifyRsp();
 }
 
 inline void Gateway::OnOrderTraded(const OrderTradedRsp& rsp) {
@@ -136,6 +153,7 @@ inline void Gateway::OnOrderTraded(const OrderTradedRsp& rsp) {
   gtw_rsp.msg_type = GatewayMsgType::kOrderOrderTradedRsp;
   gtw_rsp.data = rsp;
   rsp_rb_.PutWithBlocking(std::move(gtw_rsp));
+  NotifyRsp();
 }
 
 inline void Gateway::OnOrderRejected(const OrderRejectedRsp& rsp) {
@@ -143,6 +161,7 @@ inline void Gateway::OnOrderRejected(const OrderRejectedRsp& rsp) {
   gtw_rsp.msg_type = GatewayMsgType::kOrderRejectedRsp;
   gtw_rsp.data = rsp;
   rsp_rb_.PutWithBlocking(std::move(gtw_rsp));
+  NotifyRsp();
 }
 
 inline void Gateway::OnOrderCanceled(const OrderCanceledRsp& rsp) {
@@ -150,6 +169,7 @@ inline void Gateway::OnOrderCanceled(const OrderCanceledRsp& rsp) {
   gtw_rsp.msg_type = GatewayMsgType::kOrderCanceledRsp;
   gtw_rsp.data = rsp;
   rsp_rb_.PutWithBlocking(std::move(gtw_rsp));
+  NotifyRsp();
 }
 
 inline void Gateway::OnOrderCancelRejected(const OrderCancelRejectedRsp& rsp) {
@@ -157,6 +177,7 @@ inline void Gateway::OnOrderCancelRejected(const OrderCancelRejectedRsp& rsp) {
   gtw_rsp.msg_type = GatewayMsgType::kOrderCancelRejectedRsp;
   gtw_rsp.data = rsp;
   rsp_rb_.PutWithBlocking(std::move(gtw_rsp));
+  NotifyRsp();
 }
 
 inline void Gateway::OnQueryAccount(const Account& rsp) {
@@ -164,12 +185,14 @@ inline void Gateway::OnQueryAccount(const Account& rsp) {
   gtw_rsp.msg_type = GatewayMsgType::kAccount;
   gtw_rsp.data = rsp;
   qry_result_rb_.PutWithBlocking(gtw_rsp);
+  NotifyRsp();
 }
 
 inline void Gateway::OnQueryAccountEnd() {
   GatewayQueryResult gtw_rsp;
   gtw_rsp.msg_type = GatewayMsgType::kAccountEnd;
   qry_result_rb_.PutWithBlocking(gtw_rsp);
+  NotifyRsp();
 }
 
 inline void Gateway::OnQueryPosition(const Position& rsp) {
@@ -177,12 +200,14 @@ inline void Gateway::OnQueryPosition(const Position& rsp) {
   gtw_rsp.msg_type = GatewayMsgType::kPosition;
   gtw_rsp.data = rsp;
   qry_result_rb_.PutWithBlocking(gtw_rsp);
+  NotifyRsp();
 }
 
 inline void Gateway::OnQueryPositionEnd() {
   GatewayQueryResult gtw_rsp;
   gtw_rsp.msg_type = GatewayMsgType::kPositionEnd;
   qry_result_rb_.PutWithBlocking(gtw_rsp);
+  NotifyRsp();
 }
 
 inline void Gateway::OnQueryOrder(const HistoricalOrder& rsp) {
@@ -190,12 +215,14 @@ inline void Gateway::OnQueryOrder(const HistoricalOrder& rsp) {
   gtw_rsp.msg_type = GatewayMsgType::kOrder;
   gtw_rsp.data = rsp;
   qry_result_rb_.PutWithBlocking(gtw_rsp);
+  NotifyRsp();
 }
 
 inline void Gateway::OnQueryOrderEnd() {
   GatewayQueryResult gtw_rsp;
   gtw_rsp.msg_type = GatewayMsgType::kOrderEnd;
   qry_result_rb_.PutWithBlocking(gtw_rsp);
+  NotifyRsp();
 }
 
 inline void Gateway::OnQueryTrade(const HistoricalTrade& rsp) {
@@ -203,12 +230,14 @@ inline void Gateway::OnQueryTrade(const HistoricalTrade& rsp) {
   gtw_rsp.msg_type = GatewayMsgType::kTrade;
   gtw_rsp.data = rsp;
   qry_result_rb_.PutWithBlocking(gtw_rsp);
+  NotifyRsp();
 }
 
 inline void Gateway::OnQueryTradeEnd() {
   GatewayQueryResult gtw_rsp;
   gtw_rsp.msg_type = GatewayMsgType::kTradeEnd;
   qry_result_rb_.PutWithBlocking(gtw_rsp);
+  NotifyRsp();
 }
 
 inline void Gateway::OnQueryContract(const Contract& rsp) {
@@ -216,15 +245,22 @@ inline void Gateway::OnQueryContract(const Contract& rsp) {
   gtw_rsp.msg_type = GatewayMsgType::kContract;
   gtw_rsp.data = rsp;
   qry_result_rb_.PutWithBlocking(gtw_rsp);
+  NotifyRsp();
 }
 
 inline void Gateway::OnQueryContractEnd() {
   GatewayQueryResult gtw_rsp;
   gtw_rsp.msg_type = GatewayMsgType::kContractEnd;
   qry_result_rb_.PutWithBlocking(gtw_rsp);
+  NotifyRsp();
 }
 
-inline void Gateway::OnTick(const TickData& tick_data) { tick_rb_.PutWithBlocking(tick_data); }
+inline void Gateway::OnTick(const TickData& tick_data) {
+  tick_rb_.PutWithBlocking(tick_data);
+  if (tick_notifier_) {
+    tick_notifier_->Notify();
+  }
+}
 
 std::shared_ptr<Gateway> CreateGateway(const std::string& name);
 
@@ -0,0 +1,177 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "trader/gateway/market/market_gateway.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <set>
+
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "ft/component/yijinjing/journal/PageUtil.h"
+#include "ft/component/yijinjing/journal/Timer.h"
+#include "ft/utils/tsc.h"
+
+namespace ft {
+
+namespace {
+
+std::string GetArg(const GatewayConfig& config, const std::string& key,
+                   const std::string& default_value) {
+  auto it = config.extended_args.find(key);
+  return it == config.extended_args.end() ? default_value : it->second;
+}
+
+}  // namespace
+
+MarketGateway::~MarketGateway() { Logout(); }
+
+bool MarketGateway::Init(const GatewayConfig& config) {
+  source_ = GetArg(config, "md_source", "journal");
+  if (source_ == "journal") {
+    journal_dir_ = GetArg(config, "md_journal_dir", ".");
+    journal_prefix_ = GetArg(config, "md_journal_prefix", "md");
+    return true;
+  }
+
+  auto address = GetArg(config, "md_address", "");
+  auto port_str = GetArg(config, "md_port", "");
+  if (address.empty() || port_str.empty()) {
+    LOG_ERROR("[MarketGateway::Init] md_address and md_port are required for {}", source_);
+    return false;
+  }
+  char* end = nullptr;
+  errno = 0;
+  long port_val = strtol(port_str.c_str(), &end, 10);
+  if (errno != 0 || *end != '\0' || port_val <= 0 || port_val > 65535) {
+    LOG_ERROR("[MarketGateway::Init] invalid md_port: {}", port_str);
+    return false;
+  }
+  int port = static_cast<int>(port_val);
+
+  if (source_ == "udp") {
+    auto receiver = std::make_unique<UdpMdReceiver>();
+    if (!receiver->Init(address, port, GetArg(config, "md_multicast_interface", ""))) {
+      LOG_ERROR("[MarketGateway::Init] failed to init udp receiver");
+      return false;
+    }
+    receiver_ = std::move(receiver);
+  } else if (source_ == "tcp") {
+    auto receiver = std::make_unique<TcpMdReceiver>();
+    if (!receiver->Init(address, port)) {
+      LOG_ERROR("[MarketGateway::Init] failed to connect to {}:{}", address, port);
+      return false;
+    }
+    receiver_ = std::move(receiver);
+  } else {
+    LOG_ERROR("[MarketGateway::Init] unknown md_source: {}", source_);
+    return false;
+  }
+
+  LOG_INFO("[MarketGateway::Init] receive md via {} {}:{}", source_, address, port);
+  return true;
+}
+
+void MarketGateway::Logout() {
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+bool MarketGateway::Subscribe(const std::vector<std::string>& sub_list) {
+  if (running_) {
+    LOG_ERROR("[MarketGateway::Subscribe] already subscribed");
+    return false;
+  }
+
+  subscribed_.assign(ContractTable::size() + 1, 0);
+  for (auto& ticker : sub_list) {
+    auto* contract = ContractTable::get_by_ticker(ticker);
+    if (!contract) {
+      LOG_ERROR("[MarketGateway::Subscribe] contract not found. ticker:{}", ticker);
+      return false;
+    }
+    subscribed_[contract->ticker_id] = 1;
+  }
+
+  if (source_ == "journal" && !InitJournalReader()) {
+    return false;
+  }
+
+  running_ = true;
+  thread_ = std::thread(std::mem_fn(&MarketGateway::Run), this);
+  return true;
+}
+
+bool MarketGateway::InitJournalReader() {
+  std::set<std::string> jnames;
+  for (uint32_t ticker_id = 1; ticker_id < subscribed_.size(); ++ticker_id) {
+    if (subscribed_[ticker_id]) {
+      jnames.emplace(journal_prefix_ + "." + ContractTable::get_by_index(ticker_id)->exchange);
+    }
+  }
+  if (jnames.empty()) {
+    return true;
+  }
+
+  // 不存在的journal会被reader视为已结束，之后也不会再读取，需先启动ft_market
+  for (auto& jname : jnames) {
+    if (yijinjing::PageUtil::GetPageNums(journal_dir_, jname).empty()) {
+      LOG_ERROR("[MarketGateway::InitJournalReader] journal {} not found in {}", jname,
+                journal_dir_);
+      return false;
+    }
+  }
+
+  std::vector<std::string> dirs(jnames.size(), journal_dir_);
+  std::vector<std::string> jname_list(jnames.begin(), jnames.end());
+  reader_ = TypedJournalReader<TickData>(yijinjing::JournalReader::create(
+      dirs, jname_list, yijinjing::getNanoTime(), "market_gateway"));
+  LOG_INFO("[MarketGateway::InitJournalReader] read md from {} journals in {}", jnames.size(),
+           journal_dir_);
+  return true;
+}
+
+bool MarketGateway::PollTick(TickData* tick) {
+  if (receiver_) {
+    return receiver_->Poll(tick);
+  }
+  if (!reader_.reader()) {
+    return false;
+  }
+  // 同一journal中可能有其他类型的消息，跳过
+  for (;;) {
+    bool got = false;
+    if (!reader_.Poll([&](const TickData& data) {
+          *tick = data;
+          got = true;
+        })) {
+      return false;
+    }
+    if (got) {
+      return true;
+    }
+  }
+}
+
+void MarketGateway::Run() {
+  TickData tick;
+  WaitStrategy wait_strategy{};
+  wait_strategy.type = WaitStrategyType::kSpinYield;
+  Waiter waiter(wait_strategy, nullptr);
+  while (running_) {
+    if (!PollTick(&tick)) {
+      waiter.Wait();
+      continue;
+    }
+    waiter.Reset();
+    if (tick.ticker_id >= subscribed_.size() || !subscribed_[tick.ticker_id]) {
+      continue;
+    }
+    tick.recv_tsc = RdTsc();
+    OnTick(tick);
+  }
+}
+
+}  // namespace ft
@@ -0,0 +1,60 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_SRC_TRADER_GATEWAY_MARKET_MARKET_GATEWAY_H_
+#define FT_SRC_TRADER_GATEWAY_MARKET_MARKET_GATEWAY_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ft/component/journal_channel.h"
+#include "ft/component/md_relay.h"
+#include "trader/gateway/gateway.h"
+
+namespace ft {
+
+// 只接入行情的Gateway，行情来自ft_market，OMS通过gateway.md_api使用，如md_api: market
+// 这样OMS不需要自己登录行情服务器，多个OMS可以共用一个ft_market
+// extended_args:
+//   md_source: journal | udp | tcp，默认journal
+//     journal: 读取本机ft_market写入的./yjj.<md_journal_prefix>.<exchange>，ft_market需先启动，
+//              只读取订阅之后写入的行情
+//     udp/tcp: 接收ft_market转发的行情
+//   md_journal_dir: journal所在目录，默认为当前目录
+//   md_journal_prefix: 与ft_market的market.md_journal_prefix一致，默认md
+//   md_address/md_port: 与ft_market的market.publish_address/publish_port一致
+//   md_multicast_interface: 接收组播所用的本机网卡地址，为空时由系统选择
+class MarketGateway : public Gateway {
+ public:
+  ~MarketGateway();
+
+  bool Init(const GatewayConfig& config) override;
+
+  void Logout() override;
+
+  bool Subscribe(const std::vector<std::string>& sub_list) override;
+
+ private:
+  bool InitJournalReader();
+
+  bool PollTick(TickData* tick);
+
+  void Run();
+
+ private:
+  std::string source_;
+  std::string journal_dir_;
+  std::string journal_prefix_;
+  TypedJournalReader<TickData> reader_;
+  std::unique_ptr<MdRelayReceiver> receiver_;
+
+  std::vector<uint8_t> subscribed_;  // ticker_id -> 是否已订阅
+  std::atomic<bool> running_ = false;
+  std::thread thread_;
+};
+
+}  // namespace ft
+
+#endif  // FT_SRC_TRADER_GATEWAY_MARKET_MARKET_GATEWAY_H_
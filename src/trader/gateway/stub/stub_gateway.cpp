@@ -4,10 +4,22 @@
 
 #include "ft/base/contract_table.h"
 #include "ft/base/log.h"
+#include "ft/utils/tsc.h"
 
 namespace ft {
 
-bool StubGateway::Init(const GatewayConfig& config) { return true; }
+bool StubGateway::Init(const GatewayConfig& config) {
+  auto it = config.extended_args.find("fill_mode");
+  if (it != config.extended_args.end()) {
+    if (it->second == "partial") {
+      partial_fill_ = true;
+    } else if (it->second != "all") {
+      LOG_ERROR("[StubGateway::Init] unknown fill_mode: {}", it->second);
+      return false;
+    }
+  }
+  return true;
+}
 
 void StubGateway::Logout() {
   running_ = false;
@@ -22,18 +34,22 @@ bool StubGateway::SendOrder(const OrderRequest& order, uint64_t* privdata_ptr) {
   OrderTradedRsp trade{};
   trade.order_id = order.order_id;
   trade.price = order.price;
-  trade.volume = order.volume;
+  trade.volume = partial_fill_ ? order.volume / 2 : order.volume;
 
   timespec ts;
   clock_gettime(CLOCK_REALTIME, &ts);
   trade.timestamp_us = ts.tv_nsec / 1000UL + ts.tv_sec * 1000000UL;
-  OnOrderTraded(trade);
+  if (trade.volume > 0) {
+    OnOrderTraded(trade);
+  }
 
+  // 未成交的数量交由OMS保存，撤单时取回
+  *privdata_ptr = static_cast<uint64_t>(order.volume - trade.volume);
   return true;
 }
 
 bool StubGateway::CancelOrder(uint64_t order_id, uint64_t privdata) {
-  OnOrderCanceled(OrderCanceledRsp{order_id});
+  OnOrderCanceled(OrderCanceledRsp{order_id, static_cast<int>(privdata)});
   return true;
 }
 
@@ -81,6 +97,7 @@ void StubGateway::GenerateTickData() {
       timespec ts;
       clock_gettime(CLOCK_REALTIME, &ts);
       tick.local_timestamp_us = ts.tv_nsec / 1000UL + ts.tv_sec * 1000000UL;
+      tick.recv_tsc = RdTsc();
 
       OnTick(tick);
       std::this_thread::sleep_for(std::chrono::milliseconds(500));
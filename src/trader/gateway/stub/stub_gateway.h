@@ -12,6 +12,9 @@
 
 namespace ft {
 
+// 用于测试的Gateway，所有订单立即被接受并成交
+// extended_args:
+//   fill_mode: all | partial。partial模式下订单只成交一半，剩余部分挂单直至被撤销
 class StubGateway : public Gateway {
  public:
   bool Init(const GatewayConfig& config) override;
@@ -34,6 +37,7 @@ class StubGateway : public Gateway {
   void GenerateTickData();
 
  private:
+  bool partial_fill_ = false;
   std::atomic<bool> running_ = false;
   std::vector<std::string> sub_list_;
   std::thread tick_thread_;
@@ -9,6 +9,7 @@
 #include "ft/base/contract_table.h"
 #include "ft/base/log.h"
 #include "ft/utils/misc.h"
+#include "ft/utils/tsc.h"
 #include "trader/gateway/xtp/xtp_gateway.h"
 
 namespace ft {
@@ -164,6 +165,7 @@ void XtpQuoteApi::OnDepthMarketData(XTPMD* market_data, int64_t bid1_qty[], int3
     return;
   }
 
+  uint64_t recv_tsc = RdTsc();
   timespec ts;
   clock_gettime(CLOCK_REALTIME, &ts);
 
@@ -180,6 +182,7 @@ void XtpQuoteApi::OnDepthMarketData(XTPMD* market_data, int64_t bid1_qty[], int3
   tick.source = MarketDataSource::kXTP;
   tick.ticker_id = contract->ticker_id;
   tick.local_timestamp_us = ts.tv_sec * 1000000UL + ts.tv_nsec / 1000UL;
+  tick.recv_tsc = recv_tsc;
   tick.exchange_timestamp_us = dt_converter_.GetExchTimeStamp(market_data->data_time);
 
   tick.volume = market_data->qty;
@@ -30,6 +30,10 @@ int main(int argc, char** argv) {
     exit(EXIT_FAILURE);
   }
 
+  if (!ft::InitLogMode(config.global_config, "trader")) {
+    exit(EXIT_FAILURE);
+  }
+
   auto oms = std::make_unique<ft::OrderManagementSystem>();
   if (!oms->Init(config)) {
     LOG_ERROR("failed to init oms");
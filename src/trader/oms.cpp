@@ -4,11 +4,17 @@
 
 #include <dlfcn.h>
 
+#include <algorithm>
+#include <cstring>
+#include <string>
 #include <utility>
 
 #include "ft/base/contract_table.h"
 #include "ft/base/log.h"
+#include "ft/component/journal_channel.h"
+#include "ft/component/journal_config.h"
 #include "ft/component/yijinjing/journal/Timer.h"
+#include "ft/utils/ipc_config.h"
 #include "ft/utils/misc.h"
 #include "ft/utils/protocol_utils.h"
 
@@ -16,10 +22,38 @@ namespace ft {
 
 OrderManagementSystem::OrderManagementSystem() { rms_ = std::make_unique<RiskManagementSystem>(); }
 
-bool OrderManagementSystem::Init(const FlareTraderConfig& config) {
+bool OrderManagementSystem::Init(const FlareTraderConfig& config,
+                                 OmsInProcessListener* in_process_listener) {
   LOG_INFO("OMS compiling time: {} {}", __TIME__, __DATE__);
 
   config_ = &config;
+  in_process_listener_ = in_process_listener;
+  batch_size_ = std::max(config.global_config.oms_batch_size, 1);
+
+  if (!GetWaitStrategy(config.global_config, "", &wait_strategy_)) {
+    LOG_ERROR("[OMS::Init] invalid wait strategy: {}", config.global_config.wait_strategy);
+    return false;
+  }
+  if (!GetOrderMqPageConfig(config.global_config, &order_mq_page_config_) ||
+      !GetMdMqPageConfig(config.global_config, &md_mq_page_config_)) {
+    LOG_ERROR("[OMS::Init] invalid journal page config");
+    return false;
+  }
+  if (!cmd_notifier_.OpenShared(GetOmsNotifierName(config.gateway_config.investor_id))) {
+    LOG_ERROR("[OMS::Init] failed to open oms notifier");
+    return false;
+  }
+  if (wait_strategy_.type == WaitStrategyType::kSpinEventFd && !tick_notifier_.EnableEventFd()) {
+    LOG_ERROR("[OMS::Init] failed to create eventfd");
+    return false;
+  }
+
+  // 进程内回测时BacktestGateway同步返回查询结果，不需要等待
+  auto wait_gateway = [this] {
+    if (!in_process_listener_) {
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+  };
 
   if (!InitContractTable()) {
     return false;
@@ -36,22 +70,22 @@ bool OrderManagementSystem::Init(const FlareTraderConfig& config) {
   if (!InitGateway()) {
     return false;
   }
-  std::this_thread::sleep_for(std::chrono::seconds(1));
+  wait_gateway();
 
   if (!InitAccount()) {
     return false;
   }
-  std::this_thread::sleep_for(std::chrono::seconds(1));
+  wait_gateway();
 
   if (!InitPositions()) {
     return false;
   }
-  std::this_thread::sleep_for(std::chrono::seconds(1));
+  wait_gateway();
 
   if (!InitTradeInfo()) {
     return false;
   }
-  std::this_thread::sleep_for(std::chrono::seconds(1));
+  wait_gateway();
 
   if (!InitRMS()) {
     return false;
@@ -62,10 +96,12 @@ bool OrderManagementSystem::Init(const FlareTraderConfig& config) {
   }
 
   // 启动个线程去定时查询资金账户信息
-  timer_thread_.AddTask(15 * 1000, std::mem_fn(&OrderManagementSystem::OnTimer), this);
-  timer_thread_.Start();
+  if (!in_process_listener_) {
+    timer_thread_.AddTask(15 * 1000, std::mem_fn(&OrderManagementSystem::OnTimer), this);
+    timer_thread_.Start();
 
-  tick_thread_ = std::thread(std::mem_fn(&OrderManagementSystem::ProcessTick), this);
+    tick_thread_ = std::thread(std::mem_fn(&OrderManagementSystem::ProcessTick), this);
+  }
 
   LOG_INFO("ft_trader inited");
   is_logon_ = true;
@@ -74,43 +110,123 @@ bool OrderManagementSystem::Init(const FlareTraderConfig& config) {
 }
 
 void OrderManagementSystem::Run() {
+  int cpu_id = config_->global_config.oms_cpu_affinity;
+  if (cpu_id >= 0) {
+    if (!SetCpuAffinity(cpu_id)) {
+      LOG_WARN("[OMS::Run] failed to bind oms thread to cpu {}", cpu_id);
+    } else {
+      LOG_INFO("[OMS::Run] oms thread is bound to cpu {}", cpu_id);
+    }
+  }
+
+  if (latency_stats_.is_open() && !RegisterLatencyRecorder(&latency_stats_, "oms")) {
+    LOG_WARN("[OMS::Run] failed to register latency recorder");
+  }
+
+  Waiter waiter(wait_strategy_, &cmd_notifier_);
   for (;;) {
-    ProcessCmd();
-    ProcessRsp();
+    bool busy = ProcessCmd();
+    busy |= ProcessRsp();
+    busy |= ProcessQryResult();
+    if (busy) {
+      waiter.Reset();
+    } else {
+      FlushLatencyStats();
+      waiter.Wait();
+    }
   }
 }
 
-void OrderManagementSystem::ProcessCmd() {
-  yijinjing::FramePtr frame;
+bool OrderManagementSystem::ProcessCmd() {
+  bool busy = false;
+  yijinjing::Frame frame(nullptr);
   for (std::size_t i = 0; i < trade_msg_readers_.size(); ++i) {
     auto& reader = trade_msg_readers_[i];
-    while ((frame = reader->getNextFrame()) != nullptr) {
-      if (frame->getDataLength() != sizeof(TraderCommand)) {
-        LOG_ERROR("[OMS::ProcessCmd] invalid trader cmd size");
-        continue;
+    auto handler = [this, i](const TraderCommand& cmd) {
+      ExecuteCmd(cmd, static_cast<uint32_t>(i));
+    };
+    for (int count = 0; count < batch_size_ && reader->getNextFrame(&frame); ++count) {
+      busy = true;
+      if (!MsgDispatcher<TraderCommand>::Dispatch(frame, handler)) {
+        LOG_ERROR("[OMS::ProcessCmd] invalid trader cmd. msg_type:{} size:{}", frame.getMsgType(),
+                  frame.getDataLength());
       }
-      auto* cmd = reinterpret_cast<TraderCommand*>(frame->getData());
-      ExecuteCmd(*cmd, static_cast<uint32_t>(i));
     }
   }
+  return busy;
 }
 
-void OrderManagementSystem::ProcessRsp() {
-  int count = 0;
+bool OrderManagementSystem::ProcessRsp() {
   auto* rsp_rb = gateway_->GetOrderRspRB();
   GatewayOrderResponse rsp;
-  while (count < 3 && rsp_rb->Get(&rsp)) {
+  int count = 0;
+  for (; count < batch_size_ && rsp_rb->Get(&rsp); ++count) {
     std::visit(*this, rsp.data);
+  }
+  return count > 0;
+}
+
+bool OrderManagementSystem::PollResponses() {
+  bool busy = false;
+  while (ProcessRsp()) {
+    busy = true;
+  }
+  busy |= ProcessQryResult();
+  return busy;
+}
+
+std::size_t OrderManagementSystem::PollTicks() {
+  auto* tick_rb = md_gateway_->GetTickRB();
+  TickData tick;
+  std::size_t count = 0;
+  while (tick_rb->Get(&tick)) {
+    OnTick(tick);
     ++count;
   }
+  return count;
+}
+
+bool OrderManagementSystem::ProcessQryResult() {
+  auto* qry_res_rb = gateway_->GetQryResultRB();
+  GatewayQueryResult qry_res;
+  bool busy = false;
+  while (qry_res_rb->Get(&qry_res)) {
+    busy = true;
+    if (qry_res.msg_type == GatewayMsgType::kAccount) {
+      OnAccount(std::get<Account>(qry_res.data));
+    }
+  }
+  return busy;
 }
 
 void OrderManagementSystem::ProcessTick() {
-  auto* tick_rb = gateway_->GetTickRB();
+  int cpu_id = config_->global_config.md_cpu_affinity;
+  if (cpu_id >= 0) {
+    if (!SetCpuAffinity(cpu_id)) {
+      LOG_WARN("[OMS::ProcessTick] failed to bind md thread to cpu {}", cpu_id);
+    } else {
+      LOG_INFO("[OMS::ProcessTick] md thread is bound to cpu {}", cpu_id);
+    }
+  }
+
+  if (latency_stats_.is_open() && !RegisterLatencyRecorder(&latency_stats_, "oms.md")) {
+    LOG_WARN("[OMS::ProcessTick] failed to register latency recorder");
+  }
+
+  auto* tick_rb = md_gateway_->GetTickRB();
   TickData tick;
+  Waiter waiter(wait_strategy_, &tick_notifier_);
   for (;;) {
-    tick_rb->GetWithBlocking(&tick);
-    OnTick(tick);
+    if (tick_rb->Get(&tick)) {
+      tick.dispatch_tsc = RdTsc();
+      RecordLatency(kLatencyTickRing, tick.recv_tsc, tick.dispatch_tsc);
+      OnTick(tick);
+      RecordLatency(kLatencyOmsDispatch, tick.dispatch_tsc, RdTsc());
+      waiter.Reset();
+    } else {
+      FlushLatencyStats();
+      waiter.Wait();
+    }
   }
 }
 
@@ -149,6 +265,9 @@ void OrderManagementSystem::ExecuteCmd(const TraderCommand& cmd, uint32_t mq_id)
 }
 
 bool OrderManagementSystem::SendOrder(const TraderCommand& cmd, uint32_t mq_id) {
+  uint64_t read_tsc = RdTsc();
+  RecordLatency(kLatencyCmdRead, cmd.write_tsc, read_tsc);
+
   auto contract = ContractTable::get_by_index(cmd.order_req.ticker_id);
   if (!contract) {
     LOG_ERROR("[OMS::SendOrder] contract not found. ticker_id:{}", cmd.order_req.ticker_id);
@@ -168,9 +287,20 @@ bool OrderManagementSystem::SendOrder(const TraderCommand& cmd, uint32_t mq_id)
   order.client_order_id = cmd.order_req.client_order_id;
   order.mq_id = mq_id;
   order.status = OrderStatus::kSubmitting;
-  order.strategy_id = cmd.strategy_id;
 
-  std::unique_lock<SpinLock> lock(spinlock_);
+  if (!strategy_table_.Find(cmd.strategy_id, &order.strategy_id)) {
+    LOG_ERROR("[OMS::SendOrder] unknown strategy:{}",
+              std::string(cmd.strategy_id, strnlen(cmd.strategy_id, sizeof(StrategyIdType))));
+    SendRspToStrategy(order, 0, 0.0, ErrorCode::kSendFailed);
+    return false;
+  }
+
+  if (order_map_.full()) {
+    LOG_ERROR("[OMS::SendOrder] order map is full. max pending orders:{}", order_map_.capacity());
+    SendRspToStrategy(order, 0, 0.0, ErrorCode::kSendFailed);
+    return false;
+  }
+
   // 增加是否经过风控检查字段，在紧急情况下可以设置该字段绕过风控下单
   if (!cmd.without_check) {
     auto error_code = rms_->CheckOrderRequest(order);
@@ -181,11 +311,8 @@ bool OrderManagementSystem::SendOrder(const TraderCommand& cmd, uint32_t mq_id)
     }
   }
 
-#ifdef FT_MEASURE_TICK_TO_TRADE
-  timespec ts;
-  clock_gettime(CLOCK_REALTIME, &ts);
-  LOG_INFO("tick-to-trade: {} us", ts.tv_sec * 1000000UL + ts.tv_nsec / 1000UL - cmd.timestamp_us);
-#endif
+  uint64_t checked_tsc = RdTsc();
+  RecordLatency(kLatencyRmsCheck, read_tsc, checked_tsc);
 
   if (!gateway_->SendOrder(req, &order.privdata)) {
     LOG_ERROR("[OMS::SendOrder] failed to send order. {}, {}{}, {}, Volume:{}, Price:{:.3f}",
@@ -197,8 +324,11 @@ bool OrderManagementSystem::SendOrder(const TraderCommand& cmd, uint32_t mq_id)
     return false;
   }
 
-  order_map_.emplace(req.order_id, order);
-  rms_->OnOrderSent(order);
+  uint64_t sent_tsc = RdTsc();
+  RecordLatency(kLatencyGatewaySend, checked_tsc, sent_tsc);
+  RecordLatency(kLatencyTickToTrade, cmd.tick_recv_tsc, sent_tsc);
+
+  rms_->OnOrderSent(*order_map_.emplace(order));
 
   LOG_DEBUG("[OMS::SendOrder] success. OrderID:{}, {}, {}{}, {}, Volume:{}, Price:{:.3f}",
             req.order_id, contract->ticker, ToString(req.direction), ToString(req.offset),
@@ -218,56 +348,88 @@ void OrderManagementSystem::DoCancelOrder(const Order& order, bool without_check
     LOG_ERROR("[OMS::DoCancelOrder] error occurred in Gateway::CancelOrder");
     return;
   }
+  rms_->OnCancelReqSent(order);
 }
 
 void OrderManagementSystem::CancelOrder(uint64_t order_id, bool without_check) {
-  std::unique_lock<SpinLock> lock(spinlock_);
-  auto iter = order_map_.find(order_id);
-  if (iter == order_map_.end()) {
+  auto* order = order_map_.find(order_id);
+  if (!order) {
     LOG_ERROR("[OMS::CancelOrder] order not found. order_id:{}", order_id);
     return;
   }
-  DoCancelOrder(iter->second, without_check);
+  DoCancelOrder(*order, without_check);
 }
 
 void OrderManagementSystem::CancelForTicker(uint32_t ticker_id, bool without_check) {
-  std::unique_lock<SpinLock> lock(spinlock_);
-  for (const auto& [order_id, order] : order_map_) {
-    (void)order_id;
-    if (ticker_id == order.req.contract->ticker_id) {
-      DoCancelOrder(order, without_check);
-    }
-  }
+  order_map_.for_each_pending(
+      ticker_id, [&](const Order& order) { DoCancelOrder(order, without_check); });
 }
 
 void OrderManagementSystem::CancelAll(bool without_check) {
-  std::unique_lock<SpinLock> lock(spinlock_);
-  for (const auto& [order_id, order] : order_map_) {
-    (void)order_id;
+  for (const auto& order : order_map_) {
     DoCancelOrder(order, without_check);
   }
 }
 
 bool OrderManagementSystem::InitTraderDBConn() {
-  if (!trader_db_updater_.Init(config_->global_config.trader_db_address, "", "")) {
+  // 进程内回测的持仓只保存在内存中，不连接redis
+  if (!in_process_listener_ &&
+      !trader_db_updater_.Init(config_->global_config.trader_db_address, "", "")) {
     LOG_ERROR("[OMS::InitTraderDBConn] failed");
     return false;
   }
+
+  if (config_->global_config.position_cache) {
+    std::vector<std::string> strategies{PositionManager::kCommonPosPool};
+    for (auto& strategy_conf : config_->strategy_config_list) {
+      strategies.emplace_back(strategy_conf.strategy_name);
+    }
+    if (!position_cache_.Create(GetPositionCacheName(config_->gateway_config.investor_id),
+                                strategies, static_cast<uint32_t>(ContractTable::size()))) {
+      LOG_ERROR("[OMS::InitTraderDBConn] failed to create position cache");
+      return false;
+    }
+  }
   return true;
 }
 
 bool OrderManagementSystem::InitGateway() {
-  gateway_ = CreateGateway(config_->gateway_config.api);
+  if (!gateway_) {
+    gateway_ = CreateGateway(config_->gateway_config.api);
+  }
   if (!gateway_) {
     LOG_ERROR("[OMS::InitGateway] failed to create gateway");
     return false;
   }
+  gateway_->SetNotifier(&cmd_notifier_, &tick_notifier_);
 
   if (!gateway_->Init(config_->gateway_config)) {
     LOG_ERROR("[OMS::InitGateway] failed to init gateway");
     return false;
   }
   LOG_INFO("[OMS::InitGateway] gateway inited");
+
+  auto& md_api = config_->gateway_config.md_api;
+  if (md_api.empty()) {
+    md_gateway_ = gateway_;
+    return true;
+  }
+
+  // 行情gateway只登录行情服务器
+  auto md_gateway_config = config_->gateway_config;
+  md_gateway_config.api = md_api;
+  md_gateway_config.trade_server_address.clear();
+  md_gateway_ = CreateGateway(md_api);
+  if (!md_gateway_) {
+    LOG_ERROR("[OMS::InitGateway] failed to create md gateway {}", md_api);
+    return false;
+  }
+  md_gateway_->SetNotifier(nullptr, &tick_notifier_);
+  if (!md_gateway_->Init(md_gateway_config)) {
+    LOG_ERROR("[OMS::InitGateway] failed to init md gateway {}", md_api);
+    return false;
+  }
+  LOG_INFO("[OMS::InitGateway] md gateway {} inited", md_api);
   return true;
 }
 
@@ -276,6 +438,11 @@ bool OrderManagementSystem::InitContractTable() {
     LOG_ERROR("[OMS::InitContractTable] failed to init contract table");
     return false;
   }
+  // 按合约数量预先分配挂单索引，下单路径上不再扩容
+  if (!order_map_.init_tickers(static_cast<uint32_t>(ContractTable::size()))) {
+    LOG_ERROR("[OMS::InitContractTable] failed to init order map");
+    return false;
+  }
   return true;
 }
 
@@ -312,10 +479,16 @@ bool OrderManagementSystem::InitPositions() {
           new_pos.ticker_id);
       return;
     }
-    if (!trader_db_updater_.SetPosition(strategy, contract->ticker, new_pos)) {
+    if (!in_process_listener_ &&
+        !trader_db_updater_.SetPosition(strategy, contract->ticker, new_pos)) {
       LOG_ERROR("[OMS::UpdatePosition] failed");
       // TODO: 异常处理
     }
+    // 共享内存立即可见，redis由后台线程定期写入
+    if (config_->global_config.position_cache && !position_cache_.SetPosition(strategy, new_pos)) {
+      LOG_ERROR("[OMS::UpdatePosition] failed to update position cache. {} {}", strategy,
+                contract->ticker);
+    }
   });
 
   std::vector<Position> init_positions;
@@ -372,6 +545,10 @@ bool OrderManagementSystem::InitRMS() {
   risk_params.account = &account_;
   risk_params.pos_manager = &pos_manager_;
   risk_params.order_map = &order_map_;
+  risk_params.strategy_table = &strategy_table_;
+  risk_params.investor_id = config_->gateway_config.investor_id;
+  risk_params.backtest = in_process_listener_ || config_->gateway_config.api == "backtest";
+  risk_params.md_time_us = in_process_listener_ ? &md_time_us_ : nullptr;
   if (!rms_->Init(&risk_params)) {
     LOG_ERROR("[OMS::InitRMS] failed to init rms");
     return false;
@@ -380,15 +557,63 @@ bool OrderManagementSystem::InitRMS() {
 }
 
 bool OrderManagementSystem::InitMQ() {
-  for (auto& strategy_conf : config_->strategy_config_list) {
+  md_dispatch_table_.resize(ContractTable::size() + 1);
+  if (config_->global_config.tick_snapshot &&
+      !tick_snapshot_.Create(GetTickSnapshotName(config_->gateway_config.investor_id),
+                             static_cast<uint32_t>(ContractTable::size()))) {
+    LOG_ERROR("[OMS::InitMQ] failed to create tick snapshot table");
+    return false;
+  }
+  // 进程内回测时不统计延迟，避免并行回测争用同一个统计页
+  if (config_->global_config.latency_stats && !in_process_listener_ &&
+      !latency_stats_.Create(GetLatencyStatsName(config_->gateway_config.investor_id))) {
+    LOG_ERROR("[OMS::InitMQ] failed to create latency stats");
+    return false;
+  }
+  for (uint32_t mq_id = 0; mq_id < config_->strategy_config_list.size(); ++mq_id) {
+    auto& strategy_conf = config_->strategy_config_list[mq_id];
     if (strategy_conf.strategy_name.size() >= sizeof(StrategyIdType)) {
       LOG_ERROR("[OMS::InitMQ] max len of stratey name is {}", sizeof(StrategyIdType) - 1);
       return false;
     }
-    auto rsp_writer =
-        yijinjing::JournalWriter::create(".", strategy_conf.rsp_mq_name, "rsp_writer");
+    strategy_table_.Intern(strategy_conf.strategy_name);
+
+    // 进程内回测时行情及回报直接交给策略，不需要journal及notifier
+    if (in_process_listener_) {
+      for (auto& ticker : strategy_conf.subscription_list) {
+        auto* contract = ContractTable::get_by_ticker(ticker);
+        if (!contract) {
+          LOG_ERROR("[OMS::InitMQ] failed to subscribe market data {}. contract not found.",
+                    ticker);
+          return false;
+        }
+        auto& strategies = md_dispatch_table_[contract->ticker_id].strategies;
+        if (std::find(strategies.begin(), strategies.end(), mq_id) == strategies.end()) {
+          strategies.emplace_back(mq_id);
+        }
+        subscription_set_.emplace(ticker);
+      }
+      continue;
+    }
+
+    // 回报由核心线程写入，行情由行情线程写入，不能共用同一个journal
+    if (strategy_conf.rsp_mq_name == strategy_conf.md_mq_name &&
+        !strategy_conf.subscription_list.empty()) {
+      LOG_ERROR("[OMS::InitMQ] rsp_mq and md_mq of {} must be different",
+                strategy_conf.strategy_name);
+      return false;
+    }
+
+    auto rsp_writer = yijinjing::JournalWriter::create(".", strategy_conf.rsp_mq_name, "rsp_writer",
+                                                       order_mq_page_config_);
     rsp_writers_.emplace_back(rsp_writer);
 
+    auto notifier = std::make_unique<Notifier>();
+    if (!notifier->OpenShared(GetStrategyNotifierName(strategy_conf.strategy_name))) {
+      LOG_ERROR("[OMS::InitMQ] failed to open notifier of {}", strategy_conf.strategy_name);
+      return false;
+    }
+
     auto trade_msg_reader = yijinjing::JournalReader::create(
         ".", strategy_conf.trade_mq_name, yijinjing::getNanoTime(), "trade_msg_reader");
     trade_msg_readers_.emplace_back(trade_msg_reader);
@@ -396,8 +621,23 @@ bool OrderManagementSystem::InitMQ() {
     std::set<std::string> sub_set(strategy_conf.subscription_list.begin(),
                                   strategy_conf.subscription_list.end());
     if (!sub_set.empty()) {
-      auto md_writer =
-          yijinjing::JournalWriter::create(".", strategy_conf.md_mq_name, "oms_md_writer");
+      yijinjing::JournalWriterPtr md_writer;
+      ConflatedMdChannel* channel = nullptr;
+      if (strategy_conf.conflate_md) {
+        auto conflated_channel = std::make_unique<ConflatedMdChannel>();
+        if (!conflated_channel->Create(GetConflatedMdChannelName(strategy_conf.strategy_name),
+                                       static_cast<uint32_t>(ContractTable::size()))) {
+          LOG_ERROR("[OMS::InitMQ] failed to create conflated md channel of {}",
+                    strategy_conf.strategy_name);
+          return false;
+        }
+        channel = conflated_channel.get();
+        conflated_md_channels_.emplace_back(std::move(conflated_channel));
+      } else {
+        md_writer = yijinjing::JournalWriter::create(".", strategy_conf.md_mq_name,
+                                                     "oms_md_writer", md_mq_page_config_);
+        md_writers_.emplace_back(md_writer);
+      }
       for (auto& ticker : sub_set) {
         auto* contract = ContractTable::get_by_ticker(ticker);
         if (!contract) {
@@ -405,10 +645,17 @@ bool OrderManagementSystem::InitMQ() {
                     ticker);
           return false;
         }
-        md_dispatch_map_[contract->ticker_id].emplace_back(md_writer);
+        auto& subscribers = md_dispatch_table_[contract->ticker_id];
+        if (channel) {
+          subscribers.channels.emplace_back(channel);
+        } else {
+          subscribers.writers.emplace_back(md_writer.get());
+        }
+        subscribers.notifiers.emplace_back(notifier.get());
       }
       subscription_set_.merge(sub_set);
     }
+    strategy_notifiers_.emplace_back(std::move(notifier));
   }
 
   return true;
@@ -419,7 +666,7 @@ bool OrderManagementSystem::SubscribeMarketData() {
   for (auto& ticker : subscription_set_) {
     sub_list.emplace_back(ticker);
   }
-  if (!gateway_->Subscribe(sub_list)) {
+  if (!md_gateway_->Subscribe(sub_list)) {
     LOG_ERROR("[OMS::SubscribeMarketData] failed to subscribe market data");
     return false;
   }
@@ -443,21 +690,28 @@ void OrderManagementSystem::SendRspToStrategy(const Order& order, int this_trade
                   error_code != ErrorCode::kNoError;
   rsp.error_code = error_code;
 
-  rsp_writers_[order.mq_id]->write_data(rsp, 0, 0);
+  if (in_process_listener_) {
+    in_process_listener_->OnOrderResponse(order.mq_id, rsp);
+    return;
+  }
+  WriteMsg(rsp_writers_[order.mq_id].get(), rsp);
+  strategy_notifiers_[order.mq_id]->Notify();
 }
 
 void OrderManagementSystem::OnAccount(const Account& account) {
-  std::unique_lock<SpinLock> lock(spinlock_);
   account_ = account;
-  lock.unlock();
+  if (config_->global_config.position_cache) {
+    position_cache_.SetAccount(account);
+  }
 
   LOG_DEBUG("[OMS::OnAccount] account_id:{} total_asset:{} cash:{} margin:{} frozen:{}",
             account.account_id, account.total_asset, account.cash, account.margin, account.frozen);
 }
 
 bool OrderManagementSystem::OnPositions(std::vector<Position>* positions) {
-  auto* trader_db = trader_db_updater_.GetTraderDB();
-  trader_db->ClearPositions(PositionManager::kCommonPosPool);
+  if (!in_process_listener_) {
+    trader_db_updater_.GetTraderDB()->ClearPositions(PositionManager::kCommonPosPool);
+  }
 
   for (auto& position : *positions) {
     auto contract = ContractTable::get_by_index(position.ticker_id);
@@ -484,6 +738,10 @@ bool OrderManagementSystem::OnPositions(std::vector<Position>* positions) {
     }
   }
 
+  // 进程内回测没有需要恢复的策略持仓
+  if (in_process_listener_) {
+    return true;
+  }
   std::this_thread::sleep_for(std::chrono::milliseconds(100));  // 确保仓位已被写入数据库
   return RecoveryStrategyPositions();
 }
@@ -517,11 +775,30 @@ bool OrderManagementSystem::RecoveryStrategyPositions() {
 
 void OrderManagementSystem::OnTick(const TickData& tick) {
   auto contract = ContractTable::get_by_index(tick.ticker_id);
-  assert(contract);
+  if (!contract) {
+    LOG_ERROR("[OMS::OnTick] unknown ticker_id {}", tick.ticker_id);
+    return;
+  }
 
-  auto& writers = md_dispatch_map_[contract->ticker_id];
-  for (auto& writer : writers) {
-    writer->write_data(tick, 0, 0);
+  // 先更新快照，只读快照的策略可以更早看到行情。未开启快照时Update直接返回
+  tick_snapshot_.Update(tick);
+  // 进程内回测时行情与订单在同一线程中处理
+  if (in_process_listener_) {
+    md_time_us_ = tick.local_timestamp_us;
+  }
+
+  auto& subscribers = md_dispatch_table_[tick.ticker_id];
+  if (!subscribers.writers.empty()) {
+    WriteMsgToAll(subscribers.writers.data(), subscribers.writers.size(), tick);
+  }
+  for (auto* channel : subscribers.channels) {
+    channel->Publish(tick);
+  }
+  for (auto* notifier : subscribers.notifiers) {
+    notifier->Notify();
+  }
+  for (auto strategy_idx : subscribers.strategies) {
+    in_process_listener_->OnTick(strategy_idx, tick);
   }
 
   LOG_TRACE("[OMS::OnTick] {}  ask:{:.3f}  bid:{:.3f}", contract->ticker, tick.ask[0], tick.bid[0]);
@@ -529,18 +806,9 @@ void OrderManagementSystem::OnTick(const TickData& tick) {
 
 void OrderManagementSystem::OnTrades(std::vector<HistoricalTrade>* trades) {}
 
+// 定时器线程只发起查询，查询结果由核心线程在ProcessQryResult中处理
 bool OrderManagementSystem::OnTimer() {
   gateway_->QueryAccount();
-
-  GatewayQueryResult res;
-  gateway_->GetQryResultRB()->GetWithBlocking(&res);
-  if (res.msg_type == GatewayMsgType::kAccount) {
-    OnAccount(std::get<Account>(res.data));
-    gateway_->GetQryResultRB()->GetWithBlocking(&res);
-    assert(res.msg_type == GatewayMsgType::kAccountEnd);
-  } else {
-    assert(res.msg_type == GatewayMsgType::kAccountEnd);
-  }
   return true;
 }
 
@@ -549,14 +817,13 @@ bool OrderManagementSystem::OnTimer() {
  * 告知策略order_id，策略可通过此order_id撤单
  */
 void OrderManagementSystem::operator()(const OrderAcceptedRsp& rsp) {
-  std::unique_lock<SpinLock> lock(spinlock_);
-  auto iter = order_map_.find(rsp.order_id);
-  if (iter == order_map_.end()) {
+  auto* order_ptr = order_map_.find(rsp.order_id);
+  if (!order_ptr) {
     LOG_WARN("[OMS::OnOrderAccepted] order not found. OrderID: {}", rsp.order_id);
     return;
   }
 
-  auto& order = iter->second;
+  auto& order = *order_ptr;
   if (order.accepted) {
     return;
   }
@@ -573,14 +840,13 @@ void OrderManagementSystem::operator()(const OrderAcceptedRsp& rsp) {
 }
 
 void OrderManagementSystem::operator()(const OrderRejectedRsp& rsp) {
-  std::unique_lock<SpinLock> lock(spinlock_);
-  auto iter = order_map_.find(rsp.order_id);
-  if (iter == order_map_.end()) {
+  auto* order_ptr = order_map_.find(rsp.order_id);
+  if (!order_ptr) {
     LOG_WARN("[OMS::OnOrderRejected] order not found. order_id:{}", rsp.order_id);
     return;
   }
 
-  auto& order = iter->second;
+  auto& order = *order_ptr;
   order.status = OrderStatus::kRejected;
   rms_->OnOrderRejected(order, ErrorCode::kRejected);
   SendRspToStrategy(order, 0, 0.0, ErrorCode::kRejected);
@@ -590,21 +856,20 @@ void OrderManagementSystem::operator()(const OrderRejectedRsp& rsp) {
             ToString(order.req.offset), ToString(order.req.type), order.req.volume,
             order.req.price);
 
-  order_map_.erase(iter);
+  order_map_.erase(order_ptr);
 }
 
 void OrderManagementSystem::operator()(const OrderTradedRsp& rsp) { OnSecondaryMarketTraded(rsp); }
 
 void OrderManagementSystem::OnSecondaryMarketTraded(const OrderTradedRsp& rsp) {
-  std::unique_lock<SpinLock> lock(spinlock_);
-  auto iter = order_map_.find(rsp.order_id);
-  if (iter == order_map_.end()) {
+  auto* order_ptr = order_map_.find(rsp.order_id);
+  if (!order_ptr) {
     LOG_WARN("[OMS::OnSecondaryMarketTraded] Order not found. OrderID:{}, Traded:{}, Price:{:.3f}",
              rsp.order_id, rsp.volume, rsp.price);
     return;
   }
 
-  auto& order = iter->second;
+  auto& order = *order_ptr;
   if (!order.accepted) {
     order.accepted = true;
     rms_->OnOrderAccepted(order);
@@ -639,19 +904,18 @@ void OrderManagementSystem::OnSecondaryMarketTraded(const OrderTradedRsp& rsp) {
 
     // 订单结束，通知风控模块
     rms_->OnOrderCompleted(order);
-    order_map_.erase(iter);
+    order_map_.erase(order_ptr);
   }
 }
 
 void OrderManagementSystem::operator()(const OrderCanceledRsp& rsp) {
-  std::unique_lock<SpinLock> lock(spinlock_);
-  auto iter = order_map_.find(rsp.order_id);
-  if (iter == order_map_.end()) {
+  auto* order_ptr = order_map_.find(rsp.order_id);
+  if (!order_ptr) {
     LOG_WARN("[OMS::OnOrderCanceled] Order not found. OrderID:{}", rsp.order_id);
     return;
   }
 
-  auto& order = iter->second;
+  auto& order = *order_ptr;
   order.canceled_volume = rsp.canceled_volume;
   order.status = OrderStatus::kCanceled;
 
@@ -670,7 +934,7 @@ void OrderManagementSystem::operator()(const OrderCanceledRsp& rsp) {
         order.req.volume);
 
     rms_->OnOrderCompleted(order);
-    order_map_.erase(iter);
+    order_map_.erase(order_ptr);
   }
 }
 
@@ -4,7 +4,6 @@
 #define FT_SRC_TRADER_OMS_H_
 
 #include <list>
-#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -15,26 +14,73 @@
 #include "ft/base/market_data.h"
 #include "ft/base/trade_msg.h"
 #include "ft/component/position/manager.h"
+#include "ft/component/conflated_md_channel.h"
+#include "ft/component/latency_stats.h"
+#include "ft/component/position_cache.h"
+#include "ft/component/tick_snapshot.h"
 #include "ft/component/yijinjing/journal/JournalReader.h"
 #include "ft/component/yijinjing/journal/JournalWriter.h"
-#include "ft/utils/spinlock.h"
 #include "ft/utils/timer_thread.h"
+#include "ft/utils/wait_strategy.h"
 #include "trader/gateway/gateway.h"
 #include "trader/order.h"
+#include "trader/order_map.h"
 #include "trader/risk/rms.h"
+#include "trader/strategy_table.h"
 #include "trader/trader_db_updater.h"
 
 namespace ft {
 
+// 进程内回测时OMS通过该接口把行情及回报直接交给策略，不经过journal
+// strategy_idx为策略在strategy_config_list中的下标
+class OmsInProcessListener {
+ public:
+  virtual ~OmsInProcessListener() {}
+
+  virtual void OnTick(uint32_t strategy_idx, const TickData& tick) = 0;
+
+  virtual void OnOrderResponse(uint32_t strategy_idx, const OrderResponse& rsp) = 0;
+};
+
 // 当前不支持销毁
+//
+// 线程模型：
+// 1. 核心线程(Run)独占订单、仓位、资金及风控的状态，依次从策略指令队列、
+//    Gateway回报队列及查询结果队列中批量取出消息处理，订单路径上无锁
+// 2. 行情线程只负责把Gateway的行情分发到各策略的行情队列
+// 3. 定时器线程只负责发起资金查询，查询结果经由查询结果队列交给核心线程
+// 其他线程与核心线程之间只通过SPSC队列通信
+// 核心线程及行情线程没有新消息时按照配置的wait_strategy等待，写端写入后通过notifier唤醒
+//
+// 进程内回测(in_process_listener不为空)时不创建journal，也不启动行情线程及定时器线程，
+// 由调用者在同一线程中通过ExecuteCmd、PollResponses及PollTicks驱动
 class OrderManagementSystem {
  public:
   OrderManagementSystem();
 
-  bool Init(const FlareTraderConfig& config);
+  bool Init(const FlareTraderConfig& config, OmsInProcessListener* in_process_listener = nullptr);
+
+  // 需在Init之前调用，使用调用者创建的gateway而不是根据gateway.api创建，
+  // 如参数扫描时各实例的BacktestGateway共享同一份行情
+  void SetGateway(std::shared_ptr<Gateway> gateway) { gateway_ = std::move(gateway); }
 
   void Run();
 
+  // 执行策略指令，mq_id为策略在strategy_config_list中的下标
+  void ExecuteCmd(const TraderCommand& cmd, uint32_t mq_id);
+
+  // 以下用于进程内回测
+  // 处理Gateway的所有回报及查询结果，返回是否处理了消息
+  bool PollResponses();
+  // 分发Gateway的所有行情，返回分发的tick数
+  std::size_t PollTicks();
+  // 代替定时器线程查询资金
+  void QueryAccount() { OnTimer(); }
+  // 策略在OMS中的仓位，策略与OMS在同一进程时直接读取
+  const PositionCalculator* GetStrategyPositions(const std::string& strategy) const {
+    return pos_manager_.GetCalculator(strategy);
+  }
+
   void operator()(const OrderAcceptedRsp& rsp);
   void operator()(const OrderRejectedRsp& rsp);
   void operator()(const OrderTradedRsp& rsp);
@@ -42,12 +88,12 @@ class OrderManagementSystem {
   void operator()(const OrderCancelRejectedRsp& rsp);
 
  private:
-  void ProcessCmd();
-  void ProcessRsp();
+  // 返回是否处理了消息
+  bool ProcessCmd();
+  bool ProcessRsp();
+  bool ProcessQryResult();
   void ProcessTick();
 
-  void ExecuteCmd(const TraderCommand& cmd, uint32_t mq_id);
-
   bool SendOrder(const TraderCommand& cmd, uint32_t mq_id);
   void DoCancelOrder(const Order& order, bool without_check);
   void CancelOrder(uint64_t order_id, bool without_check);
@@ -82,22 +128,46 @@ class OrderManagementSystem {
 
  private:
   std::shared_ptr<Gateway> gateway_{nullptr};
+  std::shared_ptr<Gateway> md_gateway_{nullptr};  // 未配置md_api时与gateway_相同
   const FlareTraderConfig* config_;
+  OmsInProcessListener* in_process_listener_ = nullptr;
+  uint64_t md_time_us_ = 0;  // 进程内回测时最新行情的本地时间，风控以此代替系统时间
 
   std::vector<yijinjing::JournalReaderPtr> trade_msg_readers_;
   std::vector<yijinjing::JournalWriterPtr> rsp_writers_;
 
   std::set<std::string> subscription_set_;
-  std::map<uint32_t, std::vector<yijinjing::JournalWriterPtr>> md_dispatch_map_;
+  // 以ticker_id为下标，同一合约的行情通过一次批量写入分发给所有订阅的策略
+  // 开启了合并行情的策略通过channels分发，进程内回测时通过strategies分发
+  struct MdSubscribers {
+    std::vector<yijinjing::JournalWriter*> writers;
+    std::vector<ConflatedMdChannel*> channels;
+    std::vector<Notifier*> notifiers;
+    std::vector<uint32_t> strategies;
+  };
+  std::vector<yijinjing::JournalWriterPtr> md_writers_;
+  std::vector<std::unique_ptr<ConflatedMdChannel>> conflated_md_channels_;
+  std::vector<MdSubscribers> md_dispatch_table_;
+  TickSnapshotTable tick_snapshot_;
+
+  WaitStrategy wait_strategy_;
+  yijinjing::PageConfig order_mq_page_config_;
+  yijinjing::PageConfig md_mq_page_config_;
+  Notifier cmd_notifier_;   // 唤醒核心线程，由策略指令、Gateway回报及查询结果共用
+  Notifier tick_notifier_;  // 唤醒行情线程
+  std::vector<std::unique_ptr<Notifier>> strategy_notifiers_;
 
   volatile bool is_logon_{false};
+  int batch_size_{64};
   uint64_t next_oms_order_id_{1};
 
-  SpinLock spinlock_;
   Account account_;
   PositionManager pos_manager_;
 
   TraderDBUpdater trader_db_updater_;
+  PositionCache position_cache_;
+  LatencyStats latency_stats_;
+  StrategyTable strategy_table_;
   OrderMap order_map_;
   std::unique_ptr<RiskManagementSystem> rms_{nullptr};
   TimerThread timer_thread_;
@@ -3,8 +3,6 @@
 #ifndef FT_SRC_TRADER_ORDER_H_
 #define FT_SRC_TRADER_ORDER_H_
 
-#include <string>
-
 #include "ft/base/trade_msg.h"
 #include "trader/msg.h"
 
@@ -17,13 +15,15 @@ struct Order {
   uint32_t client_order_id;
   uint32_t mq_id;
 
-  bool accepted = false;
-  int traded_volume = 0;
-  int canceled_volume = 0;
+  // 策略名在StrategyTable中的ID
+  uint32_t strategy_id;
+
+  bool accepted;
+  int traded_volume;
+  int canceled_volume;
   OrderStatus status;
   uint64_t privdata;
   uint64_t insert_time;
-  std::string strategy_id;
 };
 
 }  // namespace ft
@@ -0,0 +1,308 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_SRC_TRADER_ORDER_MAP_H_
+#define FT_SRC_TRADER_ORDER_MAP_H_
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "ft/base/trade_msg.h"
+#include "trader/order.h"
+
+namespace ft {
+
+// 预分配的订单表，替代std::unordered_map<uint64_t, Order>
+// 1. 订单存放在连续的slab中，空闲槽位由free list管理，订单生命周期内不会申请内存
+// 2. order_id -> slot的索引为开放寻址表，order_id单调递增，绝大多数情况下直接命中
+// 3. 另外维护一个存活订单的稠密数组，用于遍历所有挂单
+// 4. 按ticker_id及买卖方向维护挂单链表，并记录该方向上最激进的挂单价格，
+//    使自成交检查为O(1)，按ticker撤单时只需遍历该ticker的挂单。
+//    挂单索引按max_ticker_id预先分配，下单路径上不会扩容
+// 非线程安全，由调用方加锁
+class OrderMap {
+ private:
+  static constexpr uint32_t kNil = static_cast<uint32_t>(-1);
+
+ public:
+  static constexpr std::size_t kDefaultCapacity = 1UL << 16;
+  static constexpr uint32_t kDefaultMaxTickerId = 1024;
+
+  // 同一ticker同一方向的挂单汇总
+  struct PendingSide {
+    uint32_t head = kNil;
+    uint32_t count = 0;
+    uint32_t market_count = 0;  // 市价单或价格为0的挂单数量
+    double best_price = 0.0;    // 限价挂单中最激进的价格，买方向为最高价，卖方向为最低价
+  };
+
+  class const_iterator {
+   public:
+    const_iterator(const OrderMap* map, const uint32_t* pos) : map_(map), pos_(pos) {}
+    const Order& operator*() const { return map_->slab_[*pos_]; }
+    const Order* operator->() const { return &map_->slab_[*pos_]; }
+    const_iterator& operator++() {
+      ++pos_;
+      return *this;
+    }
+    bool operator==(const const_iterator& rhs) const { return pos_ == rhs.pos_; }
+    bool operator!=(const const_iterator& rhs) const { return pos_ != rhs.pos_; }
+
+   private:
+    const OrderMap* map_;
+    const uint32_t* pos_;
+  };
+
+ public:
+  // capacity会向上取整为2的幂，ticker_id大于max_ticker_id的订单无法插入
+  explicit OrderMap(std::size_t capacity = kDefaultCapacity,
+                    uint32_t max_ticker_id = kDefaultMaxTickerId) {
+    std::size_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+
+    slab_.resize(cap);
+    live_pos_.resize(cap);
+    prev_.resize(cap);
+    next_.resize(cap);
+    live_.reserve(cap);
+    free_list_.reserve(cap);
+    for (std::size_t i = cap; i > 0; --i) {
+      free_list_.emplace_back(static_cast<uint32_t>(i - 1));
+    }
+
+    // 负载因子不超过0.5
+    index_.resize(cap * 2);
+    index_mask_ = index_.size() - 1;
+
+    pending_sides_.resize(static_cast<std::size_t>(max_ticker_id) + 1);
+  }
+
+  // 合约表加载后重新设置ticker_id的上限，只能在没有订单时调用
+  bool init_tickers(uint32_t max_ticker_id) {
+    if (!empty()) {
+      return false;
+    }
+    pending_sides_.assign(static_cast<std::size_t>(max_ticker_id) + 1, {});
+    return true;
+  }
+
+  // 插入订单，order_id必须非0。表已满、order_id已存在或ticker_id超出上限时返回nullptr
+  Order* emplace(const Order& order) {
+    uint64_t order_id = order.req.order_id;
+    assert(order_id != 0);
+    if (free_list_.empty() || order.req.contract->ticker_id >= pending_sides_.size()) {
+      return nullptr;
+    }
+
+    std::size_t pos = order_id & index_mask_;
+    while (index_[pos].order_id != 0) {
+      if (index_[pos].order_id == order_id) {
+        return nullptr;
+      }
+      pos = (pos + 1) & index_mask_;
+    }
+
+    uint32_t slot = free_list_.back();
+    free_list_.pop_back();
+    slab_[slot] = order;
+    index_[pos].order_id = order_id;
+    index_[pos].slot = slot;
+    live_pos_[slot] = static_cast<uint32_t>(live_.size());
+    live_.emplace_back(slot);
+    link_pending(slot);
+    return &slab_[slot];
+  }
+
+  Order* find(uint64_t order_id) {
+    auto pos = find_index(order_id);
+    return pos == kNotFound ? nullptr : &slab_[index_[pos].slot];
+  }
+
+  const Order* find(uint64_t order_id) const {
+    auto pos = find_index(order_id);
+    return pos == kNotFound ? nullptr : &slab_[index_[pos].slot];
+  }
+
+  bool erase(uint64_t order_id) {
+    auto pos = find_index(order_id);
+    if (pos == kNotFound) {
+      return false;
+    }
+    release(pos);
+    return true;
+  }
+
+  // order必须是由本表返回的指针
+  void erase(Order* order) {
+    assert(order >= slab_.data() && order < slab_.data() + slab_.size());
+    auto pos = find_index(order->req.order_id);
+    assert(pos != kNotFound);
+    release(pos);
+  }
+
+  // ticker在某个方向上没有挂单时，返回的PendingSide的count为0
+  const PendingSide& pending_side(uint32_t ticker_id, Direction direction) const {
+    if (ticker_id >= pending_sides_.size()) {
+      return empty_side_;
+    }
+    return pending_sides_[ticker_id][side_index(direction)];
+  }
+
+  // 遍历某个ticker的所有挂单，遍历过程中不能插入或删除订单
+  template <class F>
+  void for_each_pending(uint32_t ticker_id, F&& f) const {
+    if (ticker_id >= pending_sides_.size()) {
+      return;
+    }
+    for (auto& side : pending_sides_[ticker_id]) {
+      for (uint32_t slot = side.head; slot != kNil; slot = next_[slot]) {
+        f(slab_[slot]);
+      }
+    }
+  }
+
+  const_iterator begin() const { return const_iterator(this, live_.data()); }
+  const_iterator end() const { return const_iterator(this, live_.data() + live_.size()); }
+
+  std::size_t size() const { return live_.size(); }
+  std::size_t capacity() const { return slab_.size(); }
+  bool empty() const { return live_.empty(); }
+  bool full() const { return free_list_.empty(); }
+
+ private:
+  static constexpr std::size_t kNotFound = static_cast<std::size_t>(-1);
+
+  struct IndexEntry {
+    uint64_t order_id = 0;
+    uint32_t slot = 0;
+  };
+
+  std::size_t find_index(uint64_t order_id) const {
+    if (order_id == 0) {
+      return kNotFound;
+    }
+    std::size_t pos = order_id & index_mask_;
+    for (;;) {
+      auto id = index_[pos].order_id;
+      if (id == order_id) return pos;
+      if (id == 0) return kNotFound;
+      pos = (pos + 1) & index_mask_;
+    }
+  }
+
+  static std::size_t side_index(Direction direction) {
+    return direction == Direction::kBuy ? 0 : 1;
+  }
+
+  static bool is_market_order(const OrderRequest& req) {
+    return req.price < 1e-5 || req.type == OrderType::kMarket;
+  }
+
+  // 返回price是否比best更激进
+  static bool is_better(Direction direction, double price, double best) {
+    return direction == Direction::kBuy ? price > best : price < best;
+  }
+
+  void link_pending(uint32_t slot) {
+    auto& req = slab_[slot].req;
+    auto& side = pending_sides_[req.contract->ticker_id][side_index(req.direction)];
+
+    prev_[slot] = kNil;
+    next_[slot] = side.head;
+    if (side.head != kNil) {
+      prev_[side.head] = slot;
+    }
+    side.head = slot;
+
+    if (is_market_order(req)) {
+      ++side.market_count;
+    } else if (side.count == side.market_count ||
+               is_better(req.direction, req.price, side.best_price)) {
+      side.best_price = req.price;
+    }
+    ++side.count;
+  }
+
+  void unlink_pending(uint32_t slot) {
+    auto& req = slab_[slot].req;
+    auto& side = pending_sides_[req.contract->ticker_id][side_index(req.direction)];
+
+    if (prev_[slot] != kNil) {
+      next_[prev_[slot]] = next_[slot];
+    } else {
+      side.head = next_[slot];
+    }
+    if (next_[slot] != kNil) {
+      prev_[next_[slot]] = prev_[slot];
+    }
+    --side.count;
+
+    if (is_market_order(req)) {
+      --side.market_count;
+      return;
+    }
+
+    // 最优价格的挂单被移除时，只需重新扫描该ticker该方向的挂单
+    if (req.price == side.best_price) {
+      bool found = false;
+      for (uint32_t i = side.head; i != kNil; i = next_[i]) {
+        auto& pending = slab_[i].req;
+        if (is_market_order(pending)) {
+          continue;
+        }
+        if (!found || is_better(pending.direction, pending.price, side.best_price)) {
+          side.best_price = pending.price;
+          found = true;
+        }
+      }
+    }
+  }
+
+  void release(std::size_t pos) {
+    uint32_t slot = index_[pos].slot;
+    unlink_pending(slot);
+
+    // 从存活数组中swap-remove
+    uint32_t lpos = live_pos_[slot];
+    uint32_t last = live_.back();
+    live_[lpos] = last;
+    live_pos_[last] = lpos;
+    live_.pop_back();
+    free_list_.emplace_back(slot);
+
+    // backward shift deletion，保证线性探测链不断开
+    std::size_t hole = pos;
+    std::size_t next = (hole + 1) & index_mask_;
+    while (index_[next].order_id != 0) {
+      std::size_t home = index_[next].order_id & index_mask_;
+      if (((next - home) & index_mask_) >= ((next - hole) & index_mask_)) {
+        index_[hole] = index_[next];
+        hole = next;
+      }
+      next = (next + 1) & index_mask_;
+    }
+    index_[hole].order_id = 0;
+  }
+
+ private:
+  std::vector<Order> slab_;
+  std::vector<uint32_t> free_list_;
+  std::vector<uint32_t> live_;      // 存活订单的slot
+  std::vector<uint32_t> live_pos_;  // slot在live_中的位置
+  std::vector<IndexEntry> index_;
+  std::size_t index_mask_;
+
+  // 按ticker_id及方向索引的挂单链表，链表节点为slot
+  std::vector<std::array<PendingSide, 2>> pending_sides_;
+  PendingSide empty_side_;
+  std::vector<uint32_t> prev_;
+  std::vector<uint32_t> next_;
+};
+
+static_assert(std::is_trivially_copyable_v<Order>);
+
+}  // namespace ft
+
+#endif  // FT_SRC_TRADER_ORDER_MAP_H_
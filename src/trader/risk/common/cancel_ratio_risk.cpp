@@ -0,0 +1,333 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "trader/risk/common/cancel_ratio_risk.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "ft/utils/ipc_config.h"
+#include "ft/utils/string_utils.h"
+
+namespace ft {
+
+static std::string GetCancelRatioPath(const std::string& name) {
+  return "./ft_cancel_ratio." + name;
+}
+
+CancelRatioRisk::~CancelRatioRisk() {
+  if (addr_) {
+    munmap(addr_, size_);
+  }
+}
+
+uint32_t CancelRatioRisk::GetTradingDay(time_t now) {
+  struct tm tm;
+  localtime_r(&now, &tm);
+  // 夜盘从21:00开始，收盘后(17:00之后)即算作下一个交易日
+  int days = tm.tm_hour >= 17 ? 1 : 0;
+  int wday = (tm.tm_wday + days) % 7;
+  if (wday == 6) {
+    days += 2;
+  } else if (wday == 0) {
+    days += 1;
+  }
+  // 从当天中午开始加，避免夏令时等问题跨天
+  tm.tm_mday += days;
+  tm.tm_hour = 12;
+  tm.tm_min = 0;
+  tm.tm_sec = 0;
+  tm.tm_isdst = -1;
+  mktime(&tm);
+  return static_cast<uint32_t>((tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday);
+}
+
+bool CancelRatioRisk::Init(RiskRuleParams* params) {
+  auto& risk_conf = params->config->risk_conf_list[GetId()];
+  std::vector<std::string> exchanges;
+  bool persistent = true;
+  for (auto& [opt, val] : risk_conf.options) {
+    if (opt == "exchanges") {
+      StringSplit(val, ",", &exchanges);
+    } else if (opt == "cancel_limit") {
+      cancel_limit_ = static_cast<uint32_t>(std::stoul(val));
+    } else if (opt == "order_trade_ratio") {
+      order_trade_ratio_ = std::stod(val);
+    } else if (opt == "ratio_min_count") {
+      ratio_min_count_ = static_cast<uint32_t>(std::stoul(val));
+    } else if (opt == "persistent") {
+      persistent = val == "true";
+    } else {
+      LOG_ERROR("unknown opt {}:{}", opt, val);
+      return false;
+    }
+  }
+
+  auto ticker_num = static_cast<uint32_t>(ContractTable::size());
+  enabled_.assign(ticker_num + 1, 0);
+  for (uint32_t ticker_id = 1; ticker_id <= ticker_num; ++ticker_id) {
+    auto& exchange = ContractTable::get_by_index(ticker_id)->exchange;
+    enabled_[ticker_id] = exchanges.empty() || std::find(exchanges.begin(), exchanges.end(),
+                                                         exchange) != exchanges.end();
+  }
+
+  if (params->backtest && persistent) {
+    LOG_INFO("cancel ratio risk: counters are not persisted in backtest");
+    persistent = false;
+  }
+  md_time_us_ = params->md_time_us;
+  if (!md_time_us_) {
+    auto now = Now();
+    trading_day_ = GetTradingDay(now);
+    next_roll_time_ = NextRollTime(now);
+  }
+  if (persistent) {
+    if (params->investor_id.empty()) {
+      LOG_ERROR("cancel ratio risk: investor_id is required when persistent");
+      return false;
+    }
+    if (!MapCounters(GetCancelRatioName(params->investor_id))) {
+      LOG_ERROR("cancel ratio risk: failed to map counters");
+      return false;
+    }
+  } else {
+    local_slots_.assign(ticker_num + 1, Slot{});
+    slots_ = local_slots_.data();
+  }
+
+  LOG_INFO("cancel ratio risk inited. trading_day:{} cancel_limit:{} order_trade_ratio:{} "
+           "ratio_min_count:{}",
+           trading_day_, cancel_limit_, order_trade_ratio_, ratio_min_count_);
+  return true;
+}
+
+time_t CancelRatioRisk::NextRollTime(time_t now) {
+  struct tm tm;
+  localtime_r(&now, &tm);
+  if (tm.tm_hour >= 17) {
+    tm.tm_mday += 1;
+  }
+  tm.tm_hour = 17;
+  tm.tm_min = 0;
+  tm.tm_sec = 0;
+  tm.tm_isdst = -1;
+  return mktime(&tm);
+}
+
+void CancelRatioRisk::UpdateTradingDay(time_t now) {
+  next_roll_time_ = NextRollTime(now);
+  uint32_t trading_day = GetTradingDay(now);
+  if (trading_day == trading_day_) {
+    return;
+  }
+
+  LOG_INFO("cancel ratio risk: trading day changed from {} to {}, counters reset", trading_day_,
+           trading_day);
+  for (std::size_t ticker_id = 0; ticker_id < enabled_.size(); ++ticker_id) {
+    auto& slot = slots_[ticker_id];
+    slot.orders = 0;
+    slot.cancels = 0;
+    slot.trades = 0;
+  }
+  trading_day_ = trading_day;
+  if (header_) {
+    header_->trading_day = trading_day;
+  }
+}
+
+bool CancelRatioRisk::MapCounters(const std::string& name) {
+  if (addr_) {
+    munmap(addr_, size_);
+    addr_ = nullptr;
+    header_ = nullptr;
+    slots_ = nullptr;
+  }
+
+  auto path = GetCancelRatioPath(name);
+  int fd = open(path.c_str(), O_RDWR | O_CREAT, 0666);
+  if (fd < 0) {
+    return false;
+  }
+
+  // 合约表与上次一致时直接映射原文件，不重写，进程在任何时刻退出都不会丢失计数
+  auto ticker_num = static_cast<uint32_t>(ContractTable::size());
+  std::size_t size = MappingSize(ticker_num);
+  Header header{};
+  struct stat st;
+  bool same_layout = fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) == size &&
+                     pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+                     header.magic == kMagic && header.slot_size == sizeof(Slot) &&
+                     header.ticker_num == ticker_num;
+  void* addr = nullptr;
+  if (same_layout) {
+    addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+    auto* slots = reinterpret_cast<Slot*>(reinterpret_cast<char*>(addr) + 64);
+    for (uint32_t ticker_id = 1; ticker_id <= ticker_num && same_layout; ++ticker_id) {
+      auto& ticker = ContractTable::get_by_index(ticker_id)->ticker;
+      same_layout = strncmp(slots[ticker_id].ticker, ticker.c_str(), kMaxTickerLen + 1) == 0;
+    }
+    if (!same_layout) {
+      munmap(addr, size);
+    }
+  }
+
+  if (!same_layout) {
+    bool ok = RebuildCounters(path, fd);
+    close(fd);
+    if (!ok) {
+      return false;
+    }
+    fd = open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+      return false;
+    }
+    addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+  }
+  close(fd);
+
+  addr_ = addr;
+  size_ = size;
+  header_ = reinterpret_cast<Header*>(addr);
+  slots_ = reinterpret_cast<Slot*>(reinterpret_cast<char*>(addr) + 64);
+
+  // 上一个交易日留下的计数作废
+  if (header_->trading_day != trading_day_) {
+    LOG_INFO("cancel ratio risk: counters of trading day {} discarded", header_->trading_day);
+    for (uint32_t ticker_id = 0; ticker_id <= ticker_num; ++ticker_id) {
+      slots_[ticker_id].orders = 0;
+      slots_[ticker_id].cancels = 0;
+      slots_[ticker_id].trades = 0;
+    }
+    header_->trading_day = trading_day_;
+  } else {
+    for (uint32_t ticker_id = 1; ticker_id <= ticker_num; ++ticker_id) {
+      auto& slot = slots_[ticker_id];
+      if (slot.orders != 0 || slot.cancels != 0 || slot.trades != 0) {
+        LOG_INFO("cancel ratio risk: {} restored. orders:{} cancels:{} trades:{}", slot.ticker,
+                 slot.orders, slot.cancels, slot.trades);
+      }
+    }
+  }
+  return true;
+}
+
+bool CancelRatioRisk::RebuildCounters(const std::string& path, int old_fd) {
+  // 读出当日已有的计数，按合约名迁移，合约表的顺序可能与上次不同
+  std::map<std::string, Slot> prev;
+  Header header{};
+  struct stat st;
+  if (fstat(old_fd, &st) == 0 && pread(old_fd, &header, sizeof(header), 0) == sizeof(header) &&
+      header.magic == kMagic && header.slot_size == sizeof(Slot) &&
+      header.trading_day == trading_day_ &&
+      static_cast<std::size_t>(st.st_size) >= MappingSize(header.ticker_num)) {
+    std::vector<Slot> slots(header.ticker_num + 1);
+    auto len = static_cast<ssize_t>(slots.size() * sizeof(Slot));
+    if (pread(old_fd, slots.data(), len, 64) == len) {
+      for (auto& slot : slots) {
+        slot.ticker[kMaxTickerLen] = '\0';
+        if (slot.ticker[0] != '\0') {
+          prev.emplace(slot.ticker, slot);
+        }
+      }
+    }
+  }
+
+  // 新的布局先写入临时文件，落盘后再替换原文件，替换之前原文件保持不变
+  auto ticker_num = static_cast<uint32_t>(ContractTable::size());
+  std::vector<char> buf(MappingSize(ticker_num), 0);
+  auto* new_header = reinterpret_cast<Header*>(buf.data());
+  new_header->magic = kMagic;
+  new_header->slot_size = sizeof(Slot);
+  new_header->ticker_num = ticker_num;
+  new_header->trading_day = trading_day_;
+  auto* slots = reinterpret_cast<Slot*>(buf.data() + 64);
+  for (uint32_t ticker_id = 1; ticker_id <= ticker_num; ++ticker_id) {
+    auto& ticker = ContractTable::get_by_index(ticker_id)->ticker;
+    auto it = prev.find(ticker);
+    if (it != prev.end()) {
+      slots[ticker_id] = it->second;
+    }
+    strncpy(slots[ticker_id].ticker, ticker.c_str(), kMaxTickerLen);
+  }
+
+  auto tmp_path = path + ".tmp";
+  int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = write(fd, buf.data(), buf.size()) == static_cast<ssize_t>(buf.size()) && fsync(fd) == 0;
+  close(fd);
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+ErrorCode CancelRatioRisk::CheckCancelReq(const Order& order) {
+  auto* slot = GetSlot(order);
+  if (!slot) {
+    return ErrorCode::kNoError;
+  }
+
+  if (cancel_limit_ > 0 && slot->cancels >= cancel_limit_) {
+    LOG_ERROR("cancel limit reached. Ticker: {}, Cancels: {}, Limit: {}",
+              order.req.contract->ticker, slot->cancels, cancel_limit_);
+    return ErrorCode::kExceedCancelLimit;
+  }
+
+  if (order_trade_ratio_ > 0) {
+    uint32_t count = slot->orders + slot->cancels + 1;
+    uint32_t trades = std::max(slot->trades, 1U);
+    if (count >= ratio_min_count_ && count > order_trade_ratio_ * trades) {
+      LOG_ERROR(
+          "order trade ratio reached. Ticker: {}, Orders: {}, Cancels: {}, Trades: {}, Limit: {}",
+          order.req.contract->ticker, slot->orders, slot->cancels, slot->trades,
+          order_trade_ratio_);
+      return ErrorCode::kExceedOrderTradeRatio;
+    }
+  }
+
+  return ErrorCode::kNoError;
+}
+
+void CancelRatioRisk::OnOrderSent(const Order& order) {
+  auto* slot = GetSlot(order);
+  if (slot) {
+    ++slot->orders;
+  }
+}
+
+void CancelRatioRisk::OnCancelReqSent(const Order& order) {
+  auto* slot = GetSlot(order);
+  if (slot) {
+    ++slot->cancels;
+  }
+}
+
+void CancelRatioRisk::OnOrderTraded(const Order& order, const OrderTradedRsp& trade) {
+  auto* slot = GetSlot(order);
+  if (slot) {
+    ++slot->trades;
+  }
+}
+
+REGISTER_RISK_RULE("ft.risk.cancel_ratio", CancelRatioRisk);
+
+}  // namespace ft
@@ -0,0 +1,118 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_SRC_TRADER_RISK_COMMON_CANCEL_RATIO_RISK_H_
+#define FT_SRC_TRADER_RISK_COMMON_CANCEL_RATIO_RISK_H_
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "trader/risk/risk_rule.h"
+
+namespace ft {
+
+// 交易所(如中金所、大商所)对每个合约每日的撤单次数及报撤单与成交的比例有限制，超出会被收取
+// 申报费甚至限制开仓，这里在撤单前预先拦截
+//   exchanges: 需要限制的交易所，逗号分隔，如CFFEX,DCE，不配置时对所有合约生效
+//   cancel_limit: 每个合约每日的撤单次数上限
+//   order_trade_ratio: (报单数 + 撤单数) / 成交笔数的上限，成交为0时按1计算
+//   ratio_min_count: 报单数 + 撤单数达到该值后才检查比例，默认0
+//   persistent: 是否把计数写入共享内存，默认true，OMS重启后恢复当日的计数
+// 未配置或为0的不限制
+//
+// 计数按ticker_id平铺在映射文件./ft_cancel_ratio.<name>中，交易日变化时清零，包括运行期间
+// 跨过交易日的情况。合约表变化时在临时文件中按合约名迁移已有的计数，再替换原文件
+// 映射文件只按investor_id区分，回测时忽略persistent，计数只保存在内存中，以免与实盘或其他
+// 回测共用计数。进程内回测时交易日按行情时间计算，第一个回调时才确定
+class CancelRatioRisk final : public RiskRule {
+ public:
+  CancelRatioRisk() {}
+  ~CancelRatioRisk();
+
+  bool Init(RiskRuleParams* params) override;
+
+  uint32_t GetHooks() const override {
+    return kRiskCheckCancelReq | kRiskOnOrderSent | kRiskOnCancelReqSent | kRiskOnOrderTraded;
+  }
+
+  ErrorCode CheckCancelReq(const Order& order) override;
+
+  void OnOrderSent(const Order& order) override;
+
+  void OnCancelReqSent(const Order& order) override;
+
+  void OnOrderTraded(const Order& order, const OrderTradedRsp& trade) override;
+
+  // 交易日，夜盘属于下一个交易日，周五夜盘属于下周一，不考虑节假日
+  static uint32_t GetTradingDay(time_t now);
+
+  // 交易日变化时清零所有计数，每个回调都会检查，到了切换时间才会调用
+  void UpdateTradingDay(time_t now);
+
+  uint32_t trading_day() const { return trading_day_; }
+
+ private:
+  static constexpr std::size_t kMaxTickerLen = 31;
+
+  struct Header {
+    uint32_t magic;
+    uint32_t slot_size;
+    uint32_t ticker_num;
+    uint32_t trading_day;
+  };
+
+  struct Slot {
+    char ticker[kMaxTickerLen + 1];
+    uint32_t orders;
+    uint32_t cancels;
+    uint32_t trades;
+    uint32_t reserved;
+  };
+
+  static constexpr uint32_t kMagic = 0x636e6c72;  // "cnlr"
+
+  // 布局: Header | Slot * (ticker_num + 1)，下标为ticker_id，Header独占一个cache line
+  static std::size_t MappingSize(uint32_t ticker_num) {
+    return 64 + (static_cast<std::size_t>(ticker_num) + 1) * sizeof(Slot);
+  }
+
+  // 下一次可能切换交易日的时间，即下一个17:00
+  static time_t NextRollTime(time_t now);
+
+  bool MapCounters(const std::string& name);
+  bool RebuildCounters(const std::string& path, int old_fd);
+
+  // 进程内回测时为最新行情的时间
+  time_t Now() const {
+    return md_time_us_ ? static_cast<time_t>(*md_time_us_ / 1000000) : time(nullptr);
+  }
+
+  Slot* GetSlot(const Order& order) {
+    auto now = Now();
+    if (now >= next_roll_time_) {
+      UpdateTradingDay(now);
+    }
+    uint32_t ticker_id = order.req.contract->ticker_id;
+    return ticker_id < enabled_.size() && enabled_[ticker_id] ? &slots_[ticker_id] : nullptr;
+  }
+
+ private:
+  uint32_t cancel_limit_ = 0;
+  double order_trade_ratio_ = 0;
+  uint32_t ratio_min_count_ = 0;
+
+  std::vector<uint8_t> enabled_;  // ticker_id -> 是否需要限制
+  const uint64_t* md_time_us_ = nullptr;
+  uint32_t trading_day_ = 0;
+  time_t next_roll_time_ = 0;
+  Header* header_ = nullptr;
+  Slot* slots_ = nullptr;
+  std::vector<Slot> local_slots_;  // 不持久化时使用
+  void* addr_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}  // namespace ft
+
+#endif  // FT_SRC_TRADER_RISK_COMMON_CANCEL_RATIO_RISK_H_
@@ -10,10 +10,15 @@
 
 namespace ft {
 
-class FundRisk : public RiskRule {
+class FundRisk final : public RiskRule {
  public:
   bool Init(RiskRuleParams* params) override;
 
+  uint32_t GetHooks() const override {
+    return kRiskCheckOrderRequest | kRiskOnOrderSent | kRiskOnOrderTraded | kRiskOnOrderCanceled |
+           kRiskOnOrderRejected;
+  }
+
   ErrorCode CheckOrderRequest(const Order& order) override;
 
   void OnOrderSent(const Order& order) override;
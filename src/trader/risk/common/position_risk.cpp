@@ -10,6 +10,7 @@ namespace ft {
 
 bool PositionRisk::Init(RiskRuleParams* params) {
   pos_manager_ = params->pos_manager;
+  strategy_table_ = params->strategy_table;
   LOG_INFO("position risk inited");
   return true;
 }
@@ -18,7 +19,8 @@ ErrorCode PositionRisk::CheckOrderRequest(const Order& order) {
   auto& req = order.req;
   if (IsOffsetClose(req.offset)) {
     int available = 0;
-    auto pos = pos_manager_->GetPosition(order.strategy_id, req.contract->ticker_id);
+    auto& strategy = strategy_table_->GetName(order.strategy_id);
+    auto pos = pos_manager_->GetPosition(strategy, req.contract->ticker_id);
 
     if (pos) {
       auto& detail = (req.direction == Direction::kBuy ? pos->short_pos : pos->long_pos);
@@ -38,23 +40,27 @@ ErrorCode PositionRisk::CheckOrderRequest(const Order& order) {
 }
 
 void PositionRisk::OnOrderSent(const Order& order) {
-  pos_manager_->UpdatePending(order.strategy_id, order.req.contract->ticker_id, order.req.direction,
-                              order.req.offset, order.req.volume);
+  auto& req = order.req;
+  pos_manager_->UpdatePending(strategy_table_->GetName(order.strategy_id), req.contract->ticker_id,
+                              req.direction, req.offset, req.volume);
 }
 
 void PositionRisk::OnOrderTraded(const Order& order, const OrderTradedRsp& trade) {
-  pos_manager_->UpdateTraded(order.strategy_id, order.req.contract->ticker_id, order.req.direction,
-                             order.req.offset, trade.volume, trade.price);
+  auto& req = order.req;
+  pos_manager_->UpdateTraded(strategy_table_->GetName(order.strategy_id), req.contract->ticker_id,
+                             req.direction, req.offset, trade.volume, trade.price);
 }
 
 void PositionRisk::OnOrderCanceled(const Order& order, int canceled) {
-  pos_manager_->UpdatePending(order.strategy_id, order.req.contract->ticker_id, order.req.direction,
-                              order.req.offset, 0 - canceled);
+  auto& req = order.req;
+  pos_manager_->UpdatePending(strategy_table_->GetName(order.strategy_id), req.contract->ticker_id,
+                              req.direction, req.offset, 0 - canceled);
 }
 
 void PositionRisk::OnOrderRejected(const Order& order, ErrorCode error_code) {
-  pos_manager_->UpdatePending(order.strategy_id, order.req.contract->ticker_id, order.req.direction,
-                              order.req.offset, 0 - order.req.volume);
+  auto& req = order.req;
+  pos_manager_->UpdatePending(strategy_table_->GetName(order.strategy_id), req.contract->ticker_id,
+                              req.direction, req.offset, 0 - req.volume);
 }
 
 REGISTER_RISK_RULE("ft.risk.position", PositionRisk);
@@ -9,10 +9,15 @@
 
 namespace ft {
 
-class PositionRisk : public RiskRule {
+class PositionRisk final : public RiskRule {
  public:
   bool Init(RiskRuleParams* params) override;
 
+  uint32_t GetHooks() const override {
+    return kRiskCheckOrderRequest | kRiskOnOrderSent | kRiskOnOrderTraded | kRiskOnOrderCanceled |
+           kRiskOnOrderRejected;
+  }
+
   ErrorCode CheckOrderRequest(const Order& order) override;
 
   void OnOrderSent(const Order& order) override;
@@ -25,6 +30,7 @@ class PositionRisk : public RiskRule {
 
  private:
   PositionManager* pos_manager_;
+  const StrategyTable* strategy_table_;
 };
 
 };  // namespace ft
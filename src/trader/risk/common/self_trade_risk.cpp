@@ -4,7 +4,6 @@
 
 #include "ft/base/contract_table.h"
 #include "ft/base/log.h"
-#include "ft/utils/misc.h"
 #include "ft/utils/protocol_utils.h"
 
 namespace ft {
@@ -20,28 +19,21 @@ ErrorCode SelfTradeRisk::CheckOrderRequest(const Order& order) {
   auto contract = req.contract;
 
   auto oppsite_direction = OppositeDirection(req.direction);  // 对手方
-  const OrderRequest* pending_order;
-  for (auto& [oms_order_id, o] : *order_map_) {
-    UNUSED(oms_order_id);
-    pending_order = &o.req;
-    if (pending_order->contract->ticker_id != req.contract->ticker_id) {
-      continue;
-    }
-    if (pending_order->direction != oppsite_direction) {
-      continue;
-    }
-
-    // 存在市价单直接拒绝
-    if (pending_order->price < 1e-5 || pending_order->type == OrderType::kMarket ||
-        (req.direction == Direction::kBuy && req.price > pending_order->price - 1e-5) ||
-        (req.direction == Direction::kSell && req.price < pending_order->price + 1e-5)) {
-      LOG_ERROR(
-          "[RiskMgr] Self trade! Ticker: {}. This Order: [Direction: {}, Type: {}, Price: {:.2f}]. "
-          "Pending Order: [Direction: {}, Type: {}, Price: {:.2f}]",
-          contract->ticker, ToString(req.direction), ToString(req.type), req.price,
-          ToString(pending_order->direction), ToString(pending_order->type), pending_order->price);
-      return ErrorCode::kSelfTrade;
-    }
+  auto& pending = order_map_->pending_side(contract->ticker_id, oppsite_direction);
+  if (pending.count == 0) {
+    return ErrorCode::kNoError;
+  }
+
+  // 存在市价单直接拒绝，否则只需和对手方最激进的挂单价格比较
+  if (pending.market_count > 0 ||
+      (req.direction == Direction::kBuy && req.price > pending.best_price - 1e-5) ||
+      (req.direction == Direction::kSell && req.price < pending.best_price + 1e-5)) {
+    LOG_ERROR(
+        "[RiskMgr] Self trade! Ticker: {}. This Order: [Direction: {}, Type: {}, Price: {:.2f}]. "
+        "Pending Orders: [Direction: {}, Count: {}, MarketOrders: {}, BestPrice: {:.2f}]",
+        contract->ticker, ToString(req.direction), ToString(req.type), req.price,
+        ToString(oppsite_direction), pending.count, pending.market_count, pending.best_price);
+    return ErrorCode::kSelfTrade;
   }
 
   return ErrorCode::kNoError;
@@ -14,10 +14,12 @@ namespace ft {
 // 拦截自成交订单，检查相反方向的挂单
 // 1. 市价单
 // 2. 非市价单的其他订单，且价格可以成功撮合的
-class SelfTradeRisk : public RiskRule {
+class SelfTradeRisk final : public RiskRule {
  public:
   bool Init(RiskRuleParams* params) override;
 
+  uint32_t GetHooks() const override { return kRiskCheckOrderRequest; }
+
   ErrorCode CheckOrderRequest(const Order& req) override;
 
  private:
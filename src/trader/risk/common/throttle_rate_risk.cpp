@@ -2,55 +2,158 @@
 
 #include "trader/risk/common/throttle_rate_risk.h"
 
+#include <map>
+#include <string>
+
+#include "ft/base/contract_table.h"
 #include "ft/base/log.h"
 #include "ft/utils/protocol_utils.h"
 
 namespace ft {
 
+const char* ThrottleRateRisk::ScopeStr(uint32_t scope) {
+  switch (scope) {
+    case kScopeAccount:
+      return "account";
+    case kScopeStrategy:
+      return "strategy";
+    case kScopeTicker:
+      return "ticker";
+    case kScopeExchange:
+      return "exchange";
+    default:
+      return "unknown";
+  }
+}
+
 bool ThrottleRateRisk::Init(RiskRuleParams* params) {
+  static const char* kPrefixes[kScopeNum] = {"", "strategy_", "ticker_", "exchange_"};
+
   auto& risk_conf = params->config->risk_conf_list[GetId()];
   for (auto& [opt, val] : risk_conf.options) {
-    if (opt == "order_limit") {
-      order_limit_ = std::stoull(val);
-    } else if (opt == "period_ms") {
-      period_ms_ = std::stoull(val);
-    } else {
+    bool found = false;
+    for (uint32_t scope = 0; scope < kScopeNum && !found; ++scope) {
+      std::string prefix = kPrefixes[scope];
+      if (opt == prefix + "order_limit") {
+        limits_[scope].order_limit = static_cast<uint32_t>(std::stoul(val));
+        found = true;
+      } else if (opt == prefix + "period_ms") {
+        limits_[scope].period_ms = std::stoull(val);
+        found = true;
+      }
+    }
+    if (!found) {
       LOG_ERROR("unknown opt {}:{}", opt, val);
       return false;
     }
   }
+
+  // 交易所按出现的顺序编号
+  std::map<std::string, uint32_t> exchanges;
+  ticker_exchange_.assign(ContractTable::size() + 1, 0);
+  for (uint32_t ticker_id = 1; ticker_id <= ContractTable::size(); ++ticker_id) {
+    auto& exchange = ContractTable::get_by_index(ticker_id)->exchange;
+    auto it = exchanges.emplace(exchange, static_cast<uint32_t>(exchanges.size())).first;
+    ticker_exchange_[ticker_id] = it->second;
+  }
+
+  std::size_t bucket_num[kScopeNum];
+  bucket_num[kScopeAccount] = 1;
+  bucket_num[kScopeStrategy] = params->strategy_table ? params->strategy_table->size() : 0;
+  bucket_num[kScopeTicker] = ContractTable::size() + 1;
+  bucket_num[kScopeExchange] = exchanges.size();
+
+  md_time_us_ = params->md_time_us;
+  double tsc_per_ns = 0;
+  enabled_num_ = 0;
+  for (uint32_t scope = 0; scope < kScopeNum; ++scope) {
+    auto& limit = limits_[scope];
+    if (limit.order_limit == 0 || limit.period_ms == 0) {
+      continue;
+    }
+    if (md_time_us_) {
+      limit.period = limit.period_ms * 1000;
+    } else {
+      if (tsc_per_ns == 0) {
+        tsc_per_ns = MeasureTscPerNs();
+      }
+      limit.period = static_cast<uint64_t>(limit.period_ms * 1000000 * tsc_per_ns);
+    }
+    limit.bucket_num = bucket_num[scope];
+    limit.slots.assign(limit.bucket_num * (limit.order_limit + 1), 0);
+    enabled_scopes_[enabled_num_++] = scope;
+    LOG_INFO("throttle rate risk: {} order_limit:{} period_ms:{}", ScopeStr(scope),
+             limit.order_limit, limit.period_ms);
+  }
+
   LOG_INFO("throttle rate risk inited");
   return true;
 }
 
+uint64_t* ThrottleRateRisk::GetBucket(uint32_t scope, const Order& order) {
+  auto& limit = limits_[scope];
+  std::size_t idx = 0;
+  uint32_t ticker_id = order.req.contract->ticker_id;
+  switch (scope) {
+    case kScopeStrategy:
+      idx = order.strategy_id;
+      break;
+    case kScopeTicker:
+      idx = ticker_id;
+      break;
+    case kScopeExchange:
+      idx = ticker_id < ticker_exchange_.size() ? ticker_exchange_[ticker_id] : limit.bucket_num;
+      break;
+    default:
+      break;
+  }
+  if (idx >= limit.bucket_num) {
+    return nullptr;
+  }
+  return &limit.slots[idx * (limit.order_limit + 1)];
+}
+
 ErrorCode ThrottleRateRisk::CheckOrderRequest(const Order& order) {
-  if (order_limit_ == 0 || period_ms_ == 0) {
+  if (enabled_num_ == 0) {
     return ErrorCode::kNoError;
   }
 
-  current_ms_ = GetCurrentTimeMs();
-  uint64_t lower_bound_ms = current_ms_ - period_ms_;
-
-  while (!time_queue_.empty()) {
-    auto oldest = time_queue_.front();
-    if (oldest > lower_bound_ms) {
-      break;
+  uint64_t now = Now();
+  for (uint32_t i = 0; i < enabled_num_; ++i) {
+    uint32_t scope = enabled_scopes_[i];
+    auto* bucket = GetBucket(scope, order);
+    if (!bucket) {
+      continue;
+    }
+    auto& limit = limits_[scope];
+    uint64_t oldest = bucket[1 + bucket[0]];
+    if (oldest != 0 && now - oldest < limit.period) {
+      LOG_ERROR("{} order num reached limit within {} ms. Ticker: {}, Limit: {}", ScopeStr(scope),
+                limit.period_ms, order.req.contract->ticker, limit.order_limit);
+      return ErrorCode::kExceedThrottleRateRisk;
     }
-    time_queue_.pop();
-  }
-
-  if (time_queue_.size() >= order_limit_) {
-    LOG_ERROR("Order num reached limit within {} ms. Current: {}, Limit: {}", period_ms_,
-              time_queue_.size(), order_limit_);
-    return ErrorCode::kExceedThrottleRateRisk;
   }
 
   return ErrorCode::kNoError;
 }
 
 void ThrottleRateRisk::OnOrderSent(const Order& order) {
-  if (order_limit_ > 0 && period_ms_ > 0) {
-    time_queue_.push(current_ms_);
+  if (enabled_num_ == 0) {
+    return;
+  }
+
+  // 以实际发出的时间计入，without_check的订单没有经过检查，检查通过的订单也可能被
+  // 后面的规则或Gateway拒绝而没有发出，都不能沿用检查时的时间
+  uint64_t sent_time = Now();
+  for (uint32_t i = 0; i < enabled_num_; ++i) {
+    uint32_t scope = enabled_scopes_[i];
+    auto* bucket = GetBucket(scope, order);
+    if (!bucket) {
+      continue;
+    }
+    auto& head = bucket[0];
+    bucket[1 + head] = sent_time;
+    head = head + 1 == limits_[scope].order_limit ? 0 : head + 1;
   }
 }
 
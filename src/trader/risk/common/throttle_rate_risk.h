@@ -3,33 +3,64 @@
 #ifndef FT_SRC_TRADER_RISK_COMMON_THROTTLE_RATE_RISK_H_
 #define FT_SRC_TRADER_RISK_COMMON_THROTTLE_RATE_RISK_H_
 
-#include <ctime>
-#include <queue>
+#include <cstdint>
+#include <vector>
 
+#include "ft/utils/tsc.h"
 #include "trader/risk/risk_rule.h"
 
 namespace ft {
 
-class ThrottleRateRisk : public RiskRule {
+// 流控，限制period_ms内的报单数量，可分别对账户、每个策略、每个合约、每个交易所设置
+//   order_limit/period_ms: 整个账户
+//   strategy_order_limit/strategy_period_ms: 每个策略分别计数
+//   ticker_order_limit/ticker_period_ms: 每个合约分别计数
+//   exchange_order_limit/exchange_period_ms: 每个交易所分别计数
+// 未配置或为0的不限制。时间使用tsc计数，所有状态在Init时分配，检查及更新均为O(1)
+// 进程内回测时使用行情时间(微秒)，结果不受回放速度影响
+class ThrottleRateRisk final : public RiskRule {
  public:
   bool Init(RiskRuleParams* params) override;
 
+  uint32_t GetHooks() const override { return kRiskCheckOrderRequest | kRiskOnOrderSent; }
+
   ErrorCode CheckOrderRequest(const Order& order) override;
 
   void OnOrderSent(const Order& order) override;
 
  private:
-  uint64_t GetCurrentTimeMs() {
-    timespec ts;
-    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
-    return ts.tv_nsec / 1000000 + ts.tv_sec * 1000;
-  }
+  enum Scope : uint32_t {
+    kScopeAccount = 0,
+    kScopeStrategy,
+    kScopeTicker,
+    kScopeExchange,
+    kScopeNum,
+  };
+
+  // 滑动窗口，每个桶用环形数组记录最近order_limit笔报单的时间，
+  // 最早的一笔距今不足period时拒绝
+  // 桶i占用slots[i * (order_limit + 1), (i + 1) * (order_limit + 1))，第一个元素为最早一笔的位置
+  struct Limit {
+    uint32_t order_limit = 0;
+    uint64_t period_ms = 0;
+    uint64_t period = 0;  // 以Now()的单位计
+    std::size_t bucket_num = 0;
+    std::vector<uint64_t> slots;
+  };
+
+  static const char* ScopeStr(uint32_t scope);
+
+  uint64_t Now() const { return md_time_us_ ? *md_time_us_ : RdTsc(); }
+
+  // 返回order在scope中对应的桶，超出范围时返回nullptr
+  uint64_t* GetBucket(uint32_t scope, const Order& order);
 
  private:
-  uint64_t order_limit_ = 0;
-  uint64_t period_ms_ = 0;
-  std::queue<uint64_t> time_queue_;
-  uint64_t current_ms_;
+  Limit limits_[kScopeNum];
+  uint32_t enabled_scopes_[kScopeNum];
+  uint32_t enabled_num_ = 0;
+  std::vector<uint32_t> ticker_exchange_;  // ticker_id -> 交易所下标
+  const uint64_t* md_time_us_ = nullptr;
 };
 
 }  // namespace ft
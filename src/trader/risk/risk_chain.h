@@ -0,0 +1,222 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_SRC_TRADER_RISK_RISK_CHAIN_H_
+#define FT_SRC_TRADER_RISK_RISK_CHAIN_H_
+
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+#include "trader/risk/risk_rule.h"
+
+namespace ft {
+
+// 按回调分组的风控规则链，在RMS初始化时构建一次
+// 每个回调只保存声明了该回调的规则，按加入的顺序连续存放
+// Rules为内置规则(需为final类)。加入规则时按其具体类型为每个回调实例化一个跳板函数，
+// 调用时只有一次间接调用，内置规则的函数体在跳板中直接调用；其他规则(如插件)的跳板通过虚函数调用
+template <class... Rules>
+class RiskChain {
+ public:
+  void Clear() {
+    check_order_.clear();
+    check_cancel_.clear();
+    order_sent_.clear();
+    cancel_sent_.clear();
+    order_accepted_.clear();
+    order_traded_.clear();
+    order_canceled_.clear();
+    order_completed_.clear();
+    order_rejected_.clear();
+  }
+
+  // 只匹配确切的类型，内置规则的子类通过虚函数调用
+  void Add(RiskRule* rule) {
+    bool builtin = ((typeid(*rule) == typeid(Rules) && (AddAs<Rules>(rule), true)) || ...);
+    if (!builtin) {
+      AddAs<RiskRule>(rule);
+    }
+  }
+
+  ErrorCode CheckOrderRequest(const Order& order) const {
+    for (auto& entry : check_order_) {
+      auto error_code = entry.fn(entry.rule, order);
+      if (error_code != ErrorCode::kNoError) {
+        return error_code;
+      }
+    }
+    return ErrorCode::kNoError;
+  }
+
+  ErrorCode CheckCancelReq(const Order& order) const {
+    for (auto& entry : check_cancel_) {
+      auto error_code = entry.fn(entry.rule, order);
+      if (error_code != ErrorCode::kNoError) {
+        return error_code;
+      }
+    }
+    return ErrorCode::kNoError;
+  }
+
+  void OnOrderSent(const Order& order) const {
+    for (auto& entry : order_sent_) {
+      entry.fn(entry.rule, order);
+    }
+  }
+
+  void OnCancelReqSent(const Order& order) const {
+    for (auto& entry : cancel_sent_) {
+      entry.fn(entry.rule, order);
+    }
+  }
+
+  void OnOrderAccepted(const Order& order) const {
+    for (auto& entry : order_accepted_) {
+      entry.fn(entry.rule, order);
+    }
+  }
+
+  void OnOrderTraded(const Order& order, const OrderTradedRsp& trade) const {
+    for (auto& entry : order_traded_) {
+      entry.fn(entry.rule, order, trade);
+    }
+  }
+
+  void OnOrderCanceled(const Order& order, int canceled) const {
+    for (auto& entry : order_canceled_) {
+      entry.fn(entry.rule, order, canceled);
+    }
+  }
+
+  void OnOrderCompleted(const Order& order) const {
+    for (auto& entry : order_completed_) {
+      entry.fn(entry.rule, order);
+    }
+  }
+
+  void OnOrderRejected(const Order& order, ErrorCode error_code) const {
+    for (auto& entry : order_rejected_) {
+      entry.fn(entry.rule, order, error_code);
+    }
+  }
+
+  // 声明了hook的规则数量
+  std::size_t size(RiskHook hook) const {
+    switch (hook) {
+      case kRiskCheckOrderRequest:
+        return check_order_.size();
+      case kRiskCheckCancelReq:
+        return check_cancel_.size();
+      case kRiskOnOrderSent:
+        return order_sent_.size();
+      case kRiskOnCancelReqSent:
+        return cancel_sent_.size();
+      case kRiskOnOrderAccepted:
+        return order_accepted_.size();
+      case kRiskOnOrderTraded:
+        return order_traded_.size();
+      case kRiskOnOrderCanceled:
+        return order_canceled_.size();
+      case kRiskOnOrderCompleted:
+        return order_completed_.size();
+      case kRiskOnOrderRejected:
+        return order_rejected_.size();
+      default:
+        return 0;
+    }
+  }
+
+ private:
+  using CheckFn = ErrorCode (*)(RiskRule*, const Order&);
+  using OrderFn = void (*)(RiskRule*, const Order&);
+  using TradedFn = void (*)(RiskRule*, const Order&, const OrderTradedRsp&);
+  using CanceledFn = void (*)(RiskRule*, const Order&, int);
+  using RejectedFn = void (*)(RiskRule*, const Order&, ErrorCode);
+
+  template <class Fn>
+  struct Entry {
+    RiskRule* rule;
+    Fn fn;
+  };
+
+  // 每个回调的跳板函数，Rule为final类时调用不经过虚函数表
+  template <class Rule>
+  struct Call {
+    static ErrorCode CheckOrderRequest(RiskRule* rule, const Order& order) {
+      return static_cast<Rule*>(rule)->CheckOrderRequest(order);
+    }
+    static ErrorCode CheckCancelReq(RiskRule* rule, const Order& order) {
+      return static_cast<Rule*>(rule)->CheckCancelReq(order);
+    }
+    static void OnOrderSent(RiskRule* rule, const Order& order) {
+      static_cast<Rule*>(rule)->OnOrderSent(order);
+    }
+    static void OnCancelReqSent(RiskRule* rule, const Order& order) {
+      static_cast<Rule*>(rule)->OnCancelReqSent(order);
+    }
+    static void OnOrderAccepted(RiskRule* rule, const Order& order) {
+      static_cast<Rule*>(rule)->OnOrderAccepted(order);
+    }
+    static void OnOrderTraded(RiskRule* rule, const Order& order, const OrderTradedRsp& trade) {
+      static_cast<Rule*>(rule)->OnOrderTraded(order, trade);
+    }
+    static void OnOrderCanceled(RiskRule* rule, const Order& order, int canceled) {
+      static_cast<Rule*>(rule)->OnOrderCanceled(order, canceled);
+    }
+    static void OnOrderCompleted(RiskRule* rule, const Order& order) {
+      static_cast<Rule*>(rule)->OnOrderCompleted(order);
+    }
+    static void OnOrderRejected(RiskRule* rule, const Order& order, ErrorCode error_code) {
+      static_cast<Rule*>(rule)->OnOrderRejected(order, error_code);
+    }
+  };
+
+  template <class Rule>
+  void AddAs(RiskRule* rule) {
+    static_assert(std::is_same_v<Rule, RiskRule> || std::is_final_v<Rule>,
+                  "built-in risk rules must be final");
+    uint32_t hooks = rule->GetHooks();
+    if (hooks & kRiskCheckOrderRequest) {
+      check_order_.push_back({rule, &Call<Rule>::CheckOrderRequest});
+    }
+    if (hooks & kRiskCheckCancelReq) {
+      check_cancel_.push_back({rule, &Call<Rule>::CheckCancelReq});
+    }
+    if (hooks & kRiskOnOrderSent) {
+      order_sent_.push_back({rule, &Call<Rule>::OnOrderSent});
+    }
+    if (hooks & kRiskOnCancelReqSent) {
+      cancel_sent_.push_back({rule, &Call<Rule>::OnCancelReqSent});
+    }
+    if (hooks & kRiskOnOrderAccepted) {
+      order_accepted_.push_back({rule, &Call<Rule>::OnOrderAccepted});
+    }
+    if (hooks & kRiskOnOrderTraded) {
+      order_traded_.push_back({rule, &Call<Rule>::OnOrderTraded});
+    }
+    if (hooks & kRiskOnOrderCanceled) {
+      order_canceled_.push_back({rule, &Call<Rule>::OnOrderCanceled});
+    }
+    if (hooks & kRiskOnOrderCompleted) {
+      order_completed_.push_back({rule, &Call<Rule>::OnOrderCompleted});
+    }
+    if (hooks & kRiskOnOrderRejected) {
+      order_rejected_.push_back({rule, &Call<Rule>::OnOrderRejected});
+    }
+  }
+
+ private:
+  std::vector<Entry<CheckFn>> check_order_;
+  std::vector<Entry<CheckFn>> check_cancel_;
+  std::vector<Entry<OrderFn>> order_sent_;
+  std::vector<Entry<OrderFn>> cancel_sent_;
+  std::vector<Entry<OrderFn>> order_accepted_;
+  std::vector<Entry<TradedFn>> order_traded_;
+  std::vector<Entry<CanceledFn>> order_canceled_;
+  std::vector<Entry<OrderFn>> order_completed_;
+  std::vector<Entry<RejectedFn>> order_rejected_;
+};
+
+}  // namespace ft
+
+#endif  // FT_SRC_TRADER_RISK_RISK_CHAIN_H_
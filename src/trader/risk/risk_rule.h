@@ -6,7 +6,6 @@
 #include <map>
 #include <memory>
 #include <string>
-#include <unordered_map>
 
 #include "ft/base/config.h"
 #include "ft/base/error_code.h"
@@ -14,16 +13,37 @@
 #include "ft/component/position/manager.h"
 #include "ft/utils/protocol_utils.h"
 #include "trader/order.h"
+#include "trader/order_map.h"
+#include "trader/strategy_table.h"
 
 namespace ft {
 
-using OrderMap = std::unordered_map<uint64_t, Order>;
-
 struct RiskRuleParams {
   const RmsConfig* config;
   Account* account;
   PositionManager* pos_manager;
   OrderMap* order_map;
+  const StrategyTable* strategy_table;
+  std::string investor_id;
+  // 回测(backtest gateway或进程内回测)时为true，规则不应读写跨进程或跨次运行的状态
+  bool backtest;
+  // 进程内回测时指向最新行情的本地时间(微秒)，需要按时间切换状态的规则以此代替系统时间
+  // 其他情况为nullptr
+  const uint64_t* md_time_us;
+};
+
+// 风控规则的回调，规则通过GetHooks声明自己实现了哪些回调，RMS不会调用未声明的回调
+enum RiskHook : uint32_t {
+  kRiskCheckOrderRequest = 1 << 0,
+  kRiskCheckCancelReq = 1 << 1,
+  kRiskOnOrderSent = 1 << 2,
+  kRiskOnCancelReqSent = 1 << 3,
+  kRiskOnOrderAccepted = 1 << 4,
+  kRiskOnOrderTraded = 1 << 5,
+  kRiskOnOrderCanceled = 1 << 6,
+  kRiskOnOrderCompleted = 1 << 7,
+  kRiskOnOrderRejected = 1 << 8,
+  kRiskAllHooks = (1 << 9) - 1,
 };
 
 class RiskRule {
@@ -32,6 +52,9 @@ class RiskRule {
 
   virtual bool Init(RiskRuleParams* params) { return true; }
 
+  // 在Init之后调用，默认所有回调都会被调用
+  virtual uint32_t GetHooks() const { return kRiskAllHooks; }
+
   virtual ErrorCode CheckOrderRequest(const Order& order) { return ErrorCode::kNoError; }
 
   virtual ErrorCode CheckCancelReq(const Order& order) { return ErrorCode::kNoError; }
@@ -11,6 +11,10 @@ bool RiskManagementSystem::Init(RiskRuleParams* params) {
     if (!rule->Init(params)) return false;
   }
 
+  chain_.Clear();
+  for (auto& rule : rules_) {
+    chain_.Add(rule.get());
+  }
   return true;
 }
 
@@ -24,72 +28,4 @@ bool RiskManagementSystem::AddRule(const std::string& risk_rule_name) {
   return true;
 }
 
-ErrorCode RiskManagementSystem::CheckOrderRequest(const Order& order) {
-  ErrorCode error_code;
-
-  for (auto& rule : rules_) {
-    error_code = rule->CheckOrderRequest(order);
-    if (error_code != ErrorCode::kNoError) {
-      return error_code;
-    }
-  }
-
-  return ErrorCode::kNoError;
-}
-
-ErrorCode RiskManagementSystem::CheckCancelReq(const Order& order) {
-  ErrorCode error_code;
-
-  for (auto& rule : rules_) {
-    error_code = rule->CheckCancelReq(order);
-    if (error_code != ErrorCode::kNoError) {
-      return error_code;
-    }
-  }
-
-  return ErrorCode::kNoError;
-}
-
-void RiskManagementSystem::OnOrderSent(const Order& order) {
-  for (auto& rule : rules_) {
-    rule->OnOrderSent(order);
-  }
-}
-
-void RiskManagementSystem::OnCancelReqSent(const Order& order) {
-  for (auto& rule : rules_) {
-    rule->OnCancelReqSent(order);
-  }
-}
-
-void RiskManagementSystem::OnOrderAccepted(const Order& order) {
-  for (auto& rule : rules_) {
-    rule->OnOrderAccepted(order);
-  }
-}
-
-void RiskManagementSystem::OnOrderTraded(const Order& order, const OrderTradedRsp& trade) {
-  for (auto& rule : rules_) {
-    rule->OnOrderTraded(order, trade);
-  }
-}
-
-void RiskManagementSystem::OnOrderCanceled(const Order& order, int canceled) {
-  for (auto& rule : rules_) {
-    rule->OnOrderCanceled(order, canceled);
-  }
-}
-
-void RiskManagementSystem::OnOrderRejected(const Order& order, ErrorCode error_code) {
-  for (auto& rule : rules_) {
-    rule->OnOrderRejected(order, error_code);
-  }
-}
-
-void RiskManagementSystem::OnOrderCompleted(const Order& order) {
-  for (auto& rule : rules_) {
-    rule->OnOrderCompleted(order);
-  }
-}
-
 }  // namespace ft
@@ -3,47 +3,64 @@
 #ifndef FT_SRC_TRADER_RISK_RMS_H_
 #define FT_SRC_TRADER_RISK_RMS_H_
 
-#include <list>
-#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "ft/base/trade_msg.h"
 #include "trader/order.h"
+#include "trader/risk/common/cancel_ratio_risk.h"
+#include "trader/risk/common/fund_risk.h"
+#include "trader/risk/common/position_risk.h"
+#include "trader/risk/common/self_trade_risk.h"
+#include "trader/risk/common/throttle_rate_risk.h"
+#include "trader/risk/risk_chain.h"
 #include "trader/risk/risk_rule.h"
 
 namespace ft {
 
+// 内置规则按具体类型调用，新增的内置规则需加入这里
+using BuiltinRiskChain =
+    RiskChain<FundRisk, PositionRisk, SelfTradeRisk, ThrottleRateRisk, CancelRatioRisk>;
+
 class RiskManagementSystem {
  public:
   RiskManagementSystem();
 
+  // 初始化所有规则并构建规则链，之后不能再添加规则
   bool Init(RiskRuleParams* params);
 
   bool AddRule(const std::string& risk_rule_name);
 
-  ErrorCode CheckOrderRequest(const Order& order);
+  ErrorCode CheckOrderRequest(const Order& order) { return chain_.CheckOrderRequest(order); }
 
-  ErrorCode CheckCancelReq(const Order& order);
+  ErrorCode CheckCancelReq(const Order& order) { return chain_.CheckCancelReq(order); }
 
-  void OnOrderSent(const Order& order);
+  void OnOrderSent(const Order& order) { chain_.OnOrderSent(order); }
 
-  void OnCancelReqSent(const Order& order);
+  void OnCancelReqSent(const Order& order) { chain_.OnCancelReqSent(order); }
 
-  void OnOrderAccepted(const Order& order);
+  void OnOrderAccepted(const Order& order) { chain_.OnOrderAccepted(order); }
 
-  void OnOrderTraded(const Order& order, const OrderTradedRsp& trade);
+  void OnOrderTraded(const Order& order, const OrderTradedRsp& trade) {
+    chain_.OnOrderTraded(order, trade);
+  }
 
-  void OnOrderCanceled(const Order& order, int canceled);
+  void OnOrderCanceled(const Order& order, int canceled) {
+    chain_.OnOrderCanceled(order, canceled);
+  }
 
-  void OnOrderRejected(const Order& order, ErrorCode error_code);
+  void OnOrderRejected(const Order& order, ErrorCode error_code) {
+    chain_.OnOrderRejected(order, error_code);
+  }
 
-  void OnOrderCompleted(const Order& order);
+  void OnOrderCompleted(const Order& order) { chain_.OnOrderCompleted(order); }
 
  private:
-  std::list<std::shared_ptr<RiskRule>> rules_;
+  std::vector<std::shared_ptr<RiskRule>> rules_;
+  BuiltinRiskChain chain_;
 };
 
 }  // namespace ft
 
-#endif  // FT_SRC_TRADER_RISK_RMS_H_
\ No newline at end of file
+#endif  // FT_SRC_TRADER_RISK_RMS_H_
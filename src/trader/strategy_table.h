@@ -0,0 +1,52 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#ifndef FT_SRC_TRADER_STRATEGY_TABLE_H_
+#define FT_SRC_TRADER_STRATEGY_TABLE_H_
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ft/base/trade_msg.h"
+
+namespace ft {
+
+// 将策略名映射为从0开始的连续整数，订单中只保存该整数，避免每个订单都拷贝std::string
+// 策略数量很少，线性查找即可。策略只在初始化时通过Intern注册，下单路径上只能通过Find查找，
+// 不会申请内存，GetName返回的引用在运行期间也一直有效
+class StrategyTable {
+ public:
+  // 只能在初始化时调用
+  uint32_t Intern(const char* strategy_name) {
+    uint32_t strategy_id;
+    if (Find(strategy_name, &strategy_id)) {
+      return strategy_id;
+    }
+    names_.emplace_back(strategy_name, strnlen(strategy_name, sizeof(StrategyIdType)));
+    return static_cast<uint32_t>(names_.size() - 1);
+  }
+
+  uint32_t Intern(const std::string& strategy_name) { return Intern(strategy_name.c_str()); }
+
+  // 未注册的策略返回false
+  bool Find(const char* strategy_name, uint32_t* strategy_id) const {
+    for (std::size_t i = 0; i < names_.size(); ++i) {
+      if (strncmp(names_[i].c_str(), strategy_name, sizeof(StrategyIdType)) == 0) {
+        *strategy_id = static_cast<uint32_t>(i);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const std::string& GetName(uint32_t strategy_id) const { return names_[strategy_id]; }
+
+  std::size_t size() const { return names_.size(); }
+
+ private:
+  std::vector<std::string> names_;
+};
+
+}  // namespace ft
+
+#endif  // FT_SRC_TRADER_STRATEGY_TABLE_H_
@@ -0,0 +1,25 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "ft/utils/ipc_config.h"
+
+namespace ft {
+
+std::string GetOmsNotifierName(const std::string& investor_id) { return "oms." + investor_id; }
+
+std::string GetStrategyNotifierName(const std::string& strategy_name) {
+  return "strategy." + strategy_name;
+}
+
+std::string GetTickSnapshotName(const std::string& investor_id) { return investor_id; }
+
+std::string GetPositionCacheName(const std::string& investor_id) { return investor_id; }
+
+std::string GetLatencyStatsName(const std::string& investor_id) { return investor_id; }
+
+std::string GetCancelRatioName(const std::string& investor_id) { return investor_id; }
+
+std::string GetConflatedMdChannelName(const std::string& strategy_name) {
+  return strategy_name;
+}
+
+}  // namespace ft
@@ -0,0 +1,184 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include "ft/utils/wait_strategy.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace ft {
+
+namespace {
+
+uint64_t CurrentThreadOwner() {
+  static thread_local uint64_t owner = 0;
+  if (owner == 0) {
+    owner = (static_cast<uint64_t>(getpid()) << 32) | static_cast<uint32_t>(syscall(SYS_gettid));
+  }
+  return owner;
+}
+
+bool IsThreadAlive(uint64_t owner) {
+  auto pid = static_cast<pid_t>(owner >> 32);
+  auto tid = static_cast<pid_t>(owner & 0xffffffff);
+  return syscall(SYS_tgkill, pid, tid, 0) == 0 || errno == EPERM;
+}
+
+}  // namespace
+
+bool ParseWaitStrategyType(const std::string& name, WaitStrategyType* type) {
+  if (name == "busy_spin") {
+    *type = WaitStrategyType::kBusySpin;
+  } else if (name == "spin_yield") {
+    *type = WaitStrategyType::kSpinYield;
+  } else if (name == "futex") {
+    *type = WaitStrategyType::kSpinFutex;
+  } else if (name == "eventfd") {
+    *type = WaitStrategyType::kSpinEventFd;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+Notifier::~Notifier() {
+  if (state_ != &local_state_) {
+    munmap(state_, sizeof(State));
+  }
+  if (efd_ >= 0) {
+    close(efd_);
+  }
+}
+
+bool Notifier::OpenShared(const std::string& name) {
+  if (state_ != &local_state_ || efd_ >= 0) {
+    return false;
+  }
+
+  std::string path = "./ft_notifier." + name;
+  int fd = open(path.c_str(), O_RDWR | O_CREAT, 0666);
+  if (fd < 0) {
+    return false;
+  }
+  // 新建的文件内容全为0，即seq=0，waiters=0，所有slot空闲
+  if (ftruncate(fd, sizeof(State)) != 0) {
+    close(fd);
+    return false;
+  }
+  void* addr = mmap(nullptr, sizeof(State), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+  state_ = reinterpret_cast<State*>(addr);
+  return true;
+}
+
+bool Notifier::EnableEventFd() {
+  if (state_ != &local_state_) {
+    return false;
+  }
+  if (efd_ < 0) {
+    efd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  }
+  return efd_ >= 0;
+}
+
+void Notifier::Wake() {
+  if (efd_ >= 0) {
+    uint64_t val = 1;
+    ssize_t res = write(efd_, &val, sizeof(val));
+    (void)res;
+  }
+  long woken = syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state_->seq), FUTEX_WAKE,
+                       INT32_MAX, nullptr, nullptr, 0);
+  // eventfd的读端不在futex上等待，唤醒数量为0是正常的
+  if (woken == 0 && efd_ < 0) {
+    ReapWaiters();
+  }
+}
+
+void Notifier::ReapWaiters() {
+  uint32_t waiters = state_->waiters.load(std::memory_order_acquire);
+  while (waiters != 0) {
+    int slot = __builtin_ctz(waiters);
+    waiters &= waiters - 1;
+    // 刚登记还未进入futex的读端所在线程一定存在，不会被清除
+    if (!IsThreadAlive(state_->owners[slot].load(std::memory_order_acquire))) {
+      state_->waiters.fetch_and(~(1U << slot), std::memory_order_seq_cst);
+    }
+  }
+}
+
+int Notifier::AcquireSlot() {
+  uint64_t self = CurrentThreadOwner();
+  for (uint32_t i = 0; i < kMaxWaiters; ++i) {
+    if (state_->owners[i].load(std::memory_order_acquire) == self) {
+      return static_cast<int>(i);
+    }
+  }
+  // slot在线程退出后不会主动释放，由之后分配slot的线程回收
+  for (uint32_t i = 0; i < kMaxWaiters; ++i) {
+    uint64_t owner = state_->owners[i].load(std::memory_order_acquire);
+    if ((owner == 0 || !IsThreadAlive(owner)) &&
+        state_->owners[i].compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+      state_->waiters.fetch_and(~(1U << i), std::memory_order_seq_cst);
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void Waiter::WaitSlow() {
+  if (strategy_.type == WaitStrategyType::kSpinYield || !notifier_) {
+    sched_yield();
+    return;
+  }
+
+  auto* state = notifier_->state_;
+  // 上次检查消息源之后已经有新消息写入
+  uint32_t seq = state->seq.load(std::memory_order_acquire);
+  if (seq != seq_) {
+    seq_ = seq;
+    return;
+  }
+
+  if (slot_ < 0) {
+    slot_ = notifier_->AcquireSlot();
+    if (slot_ < 0) {
+      // 阻塞的读端过多，退化为sched_yield
+      sched_yield();
+      seq_ = state->seq.load(std::memory_order_acquire);
+      return;
+    }
+  }
+
+  // 先登记waiter再检查序号，与Notify中的先加序号再检查waiter相对应，保证不会丢失唤醒
+  uint32_t bit = 1U << slot_;
+  state->waiters.fetch_or(bit, std::memory_order_seq_cst);
+  if (strategy_.type == WaitStrategyType::kSpinEventFd && notifier_->efd_ >= 0) {
+    if (state->seq.load(std::memory_order_seq_cst) == seq_) {
+      pollfd pfd{notifier_->efd_, POLLIN, 0};
+      poll(&pfd, 1, static_cast<int>((strategy_.timeout_us + 999) / 1000));
+    }
+    uint64_t val;
+    ssize_t res = read(notifier_->efd_, &val, sizeof(val));
+    (void)res;
+  } else {
+    timespec timeout{strategy_.timeout_us / 1000000, (strategy_.timeout_us % 1000000) * 1000L};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state->seq), FUTEX_WAIT, seq_, &timeout,
+            nullptr, 0);
+  }
+  state->waiters.fetch_and(~bit, std::memory_order_seq_cst);
+
+  seq_ = state->seq.load(std::memory_order_acquire);
+}
+
+}  // namespace ft
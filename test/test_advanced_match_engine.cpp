@@ -93,6 +93,7 @@ TEST(AdvancedMatchEngine, Match) {
   ASSERT_TRUE(rsp_queue.empty());
 
   OrderRequest order;
+  uint64_t handle;
   order.contract = contract;
   order.direction = Direction::kBuy;
   order.offset = Offset::kOpen;
@@ -100,7 +101,7 @@ TEST(AdvancedMatchEngine, Match) {
   order.type = OrderType::kLimit;
   order.price = 99;
   order.volume = 1;
-  engine.InsertOrder(order);
+  engine.InsertOrder(order, &handle);
   ASSERT_EQ(rsp_queue.size(), 1);
   auto rsp = rsp_queue.front();
   rsp_queue.pop();
@@ -113,7 +114,7 @@ TEST(AdvancedMatchEngine, Match) {
   order.order_id = 1;
   order.price = 101;
   order.volume = 1;
-  engine.InsertOrder(order);
+  engine.InsertOrder(order, &handle);
   ASSERT_EQ(rsp_queue.size(), 1);
   rsp = rsp_queue.front();
   rsp_queue.pop();
@@ -159,17 +160,17 @@ TEST(AdvancedMatchEngine, Match) {
   order.order_id = 2;
   order.price = 101;
   order.volume = 3;
-  engine.InsertOrder(order);
+  engine.InsertOrder(order, &handle);
 
   order.order_id = 3;
   order.price = 102;
   order.volume = 2;
-  engine.InsertOrder(order);
+  engine.InsertOrder(order, &handle);
 
   order.order_id = 4;
   order.price = 103;
   order.volume = 1;
-  engine.InsertOrder(order);
+  engine.InsertOrder(order, &handle);
 
   // ask成交量为50，只有前面两个订单能够成交
   tick.volume += 50;
@@ -196,3 +197,129 @@ TEST(AdvancedMatchEngine, Match) {
   ASSERT_EQ(rsp.volume, 2);
   ASSERT_DOUBLE_EQ(rsp.price, 102);
 }
+
+static TickData MakeTick(double bid, double ask, uint64_t volume = 0, double turnover = 0) {
+  TickData tick{};
+  tick.ticker_id = 1;
+  tick.volume = volume;
+  tick.turnover = turnover;
+  tick.ask[0] = ask;
+  tick.ask_volume[0] = 10;
+  tick.bid[0] = bid;
+  tick.bid_volume[0] = 10;
+  return tick;
+}
+
+TEST(AdvancedMatchEngine, Cancel) {
+  auto* contract = ContractTable::get_by_index(1);
+  ASSERT_TRUE(contract != nullptr);
+
+  AdvancedMatchEngine engine;
+  TestListener listener;
+  auto& rsp_queue = listener.GetRspQueue();
+  engine.RegisterListener(&listener);
+  ASSERT_TRUE(engine.Init());
+  engine.OnNewTick(MakeTick(99, 101));
+
+  OrderRequest order{};
+  order.contract = contract;
+  order.direction = Direction::kBuy;
+  order.offset = Offset::kOpen;
+  order.type = OrderType::kLimit;
+  order.volume = 1;
+  std::vector<uint64_t> handles(3);
+  for (int i = 0; i < 3; ++i) {
+    order.order_id = i + 1;
+    order.price = 99;
+    engine.InsertOrder(order, &handles[i]);
+  }
+  ASSERT_EQ(rsp_queue.size(), 3);
+  while (!rsp_queue.empty()) {
+    ASSERT_EQ(rsp_queue.front().type, ACCEPTED);
+    rsp_queue.pop();
+  }
+
+  // 撤掉队列中间的订单
+  engine.CancelOrder(2, handles[1]);
+  ASSERT_EQ(rsp_queue.size(), 1);
+  ASSERT_EQ(rsp_queue.front().type, CANCELED);
+  rsp_queue.pop();
+
+  // 重复撤单及order_id与handle不匹配时拒绝撤单
+  engine.CancelOrder(2, handles[1]);
+  engine.CancelOrder(3, handles[0]);
+  engine.CancelOrder(4, 12345);
+  ASSERT_EQ(rsp_queue.size(), 3);
+  while (!rsp_queue.empty()) {
+    ASSERT_EQ(rsp_queue.front().type, CANCEL_REJECTED);
+    rsp_queue.pop();
+  }
+
+  // 节点被复用后，旧的handle不能撤掉新订单
+  order.order_id = 5;
+  uint64_t handle;
+  engine.InsertOrder(order, &handle);
+  ASSERT_EQ(handle, handles[1]);
+  rsp_queue.pop();
+  engine.CancelOrder(2, handle);
+  ASSERT_EQ(rsp_queue.front().type, CANCEL_REJECTED);
+  rsp_queue.pop();
+
+  engine.CancelOrder(1, handles[0]);
+  engine.CancelOrder(3, handles[2]);
+  engine.CancelOrder(5, handle);
+  ASSERT_EQ(rsp_queue.size(), 3);
+  while (!rsp_queue.empty()) {
+    ASSERT_EQ(rsp_queue.front().type, CANCELED);
+    rsp_queue.pop();
+  }
+}
+
+TEST(AdvancedMatchEngine, CrossLevels) {
+  auto* contract = ContractTable::get_by_index(1);
+  ASSERT_TRUE(contract != nullptr);
+
+  AdvancedMatchEngine engine;
+  TestListener listener;
+  auto& rsp_queue = listener.GetRspQueue();
+  engine.RegisterListener(&listener);
+  ASSERT_TRUE(engine.Init());
+  engine.OnNewTick(MakeTick(99, 101));
+
+  // 价格跨度超出初始价位数，需要扩容
+  OrderRequest order{};
+  order.contract = contract;
+  order.direction = Direction::kBuy;
+  order.offset = Offset::kOpen;
+  order.type = OrderType::kLimit;
+  order.volume = 1;
+  uint64_t handle;
+  for (int i = 0; i < 10; ++i) {
+    order.order_id = i + 1;
+    order.price = 90 + i;
+    engine.InsertOrder(order, &handle);
+  }
+  ASSERT_EQ(rsp_queue.size(), 10);
+  while (!rsp_queue.empty()) {
+    rsp_queue.pop();
+  }
+
+  // 卖一价跌到95，不低于95的买单按价格从高到低成交
+  engine.OnNewTick(MakeTick(94, 95, 10, 10 * 95));
+  ASSERT_EQ(rsp_queue.size(), 5);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(rsp_queue.front().type, TRADED);
+    ASSERT_DOUBLE_EQ(rsp_queue.front().price, 99 - i);
+    rsp_queue.pop();
+  }
+
+  engine.OnNewTick(MakeTick(80, 90, 20, 10 * 95 + 10 * 90));
+  ASSERT_EQ(rsp_queue.size(), 5);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_DOUBLE_EQ(rsp_queue.front().price, 94 - i);
+    rsp_queue.pop();
+  }
+
+  engine.CancelOrder(10, handle);
+  ASSERT_EQ(rsp_queue.front().type, CANCEL_REJECTED);
+}
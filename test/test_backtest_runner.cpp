@@ -0,0 +1,152 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "backtest/backtest_runner.h"
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "ft/strategy/strategy.h"
+#include "trader/gateway/backtest/data_feed/tick_file.h"
+
+using ft::OrderResponse;
+using ft::TickData;
+
+static constexpr int kTickNum = 10;
+static const char* kContractFile = "test_backtest_runner.csv";
+static const char* kTickFile = "test_backtest_runner.ftick";
+
+// 把收到的行情及回报按顺序记录下来
+// 第2个tick以对手价买入2手，第4个tick挂一个不会成交的卖单，收到挂单回报后立即撤单
+class RecordStrategy : public ft::Strategy {
+ public:
+  void OnTick(const TickData& tick) override {
+    ++tick_count_;
+    events.emplace_back("tick " + std::to_string(tick_count_));
+    if (tick_count_ == 2) {
+      BuyOpen("rb2110", 2, tick.ask[0], ft::OrderType::kLimit, 1);
+    } else if (tick_count_ == 4) {
+      SellClose("rb2110", 1, tick.ask[0] + 10, ft::OrderType::kLimit, 2);
+    }
+  }
+
+  void OnOrder(const OrderResponse& rsp) override {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "order %u traded:%d/%d completed:%d", rsp.client_order_id,
+             rsp.traded_volume, rsp.original_volume, rsp.completed);
+    events.emplace_back(buf);
+    if (rsp.client_order_id == 2 && !rsp.completed) {
+      CancelOrder(rsp.order_id);
+    }
+  }
+
+  void OnTrade(const OrderResponse& rsp) override {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "trade %u %u@%.0f", rsp.client_order_id, rsp.this_traded,
+             rsp.this_traded_price);
+    events.emplace_back(buf);
+  }
+
+  void OnExit() override {
+    auto pos = GetPosition("rb2110");
+    events.emplace_back("exit " + std::to_string(pos.long_pos.holdings));
+  }
+
+  std::vector<std::string> events;
+
+ private:
+  int tick_count_ = 0;
+};
+
+class BacktestRunnerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    FILE* fp = fopen(kContractFile, "w");
+    ASSERT_TRUE(fp);
+    fprintf(fp,
+            "ticker,exchange,name,product_type,size,price_tick,long_margin_rate,"
+            "short_margin_rate,max_market_order_volume,min_market_order_volume,"
+            "max_limit_order_volume,min_limit_order_volume,delivery_year,delivery_month\n"
+            "rb2110,SHFE,rb2110,Futures,10,1.0,0.1,0.1,30,1,500,1,2021,10\n");
+    fclose(fp);
+    ASSERT_TRUE(ft::ContractTable::Init(kContractFile));
+
+    // 价格从100开始每个tick上涨1
+    ft::TickFileWriter writer;
+    ASSERT_TRUE(writer.Open(kTickFile));
+    for (int i = 0; i < kTickNum; ++i) {
+      TickData tick{};
+      tick.ticker_id = 1;
+      tick.local_timestamp_us = 1619571600000000UL + i * 500000UL;
+      tick.exchange_timestamp_us = tick.local_timestamp_us;
+      tick.last_price = 100.0 + i;
+      for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+        tick.ask[level] = tick.last_price + level + 1;
+        tick.bid[level] = tick.last_price - level - 1;
+        tick.ask_volume[level] = 100;
+        tick.bid_volume[level] = 100;
+      }
+      ASSERT_TRUE(writer.Write(tick));
+    }
+    ASSERT_TRUE(writer.Close());
+
+    config_.global_config.contract_file = kContractFile;
+    // 进程内回测不连接redis，地址无效也能初始化
+    config_.global_config.trader_db_address = "127.0.0.1:1";
+    config_.gateway_config.api = "backtest";
+    config_.gateway_config.investor_id = "1001";
+    config_.gateway_config.extended_args["match_engine"] = "ft.match_engine.simple";
+    config_.gateway_config.extended_args["data_feed"] = "ft.data_feed.tick_file";
+    config_.gateway_config.extended_args["data_file"] = kTickFile;
+    // 策略的仓位由ft.risk.position维护
+    config_.rms_config.risk_conf_list.push_back({"ft.risk.fund", {}});
+    config_.rms_config.risk_conf_list.push_back({"ft.risk.position", {}});
+
+    ft::StrategyConfig strategy_conf{};
+    strategy_conf.strategy_name = "record";
+    strategy_conf.subscription_list = {"rb2110"};
+    config_.strategy_config_list.emplace_back(strategy_conf);
+  }
+
+  void TearDown() override {
+    remove(kContractFile);
+    remove(kTickFile);
+  }
+
+  ft::FlareTraderConfig config_{};
+};
+
+TEST_F(BacktestRunnerTest, OrderSequence) {
+  LOG_SET_LEVEL("error");
+  ft::BacktestRunner runner;
+  RecordStrategy strategy;
+  ASSERT_TRUE(runner.Init(config_));
+  ASSERT_TRUE(runner.AddStrategy("record", &strategy));
+  runner.Run();
+
+  // 回报在下一个tick之前处理完，撤单回报紧跟在挂单回报之后
+  std::vector<std::string> expected{
+      "tick 1",
+      "tick 2",
+      "order 1 traded:0/2 completed:0",
+      "order 1 traded:2/2 completed:1",
+      "trade 1 2@102",
+      "tick 3",
+      "tick 4",
+      "order 2 traded:0/1 completed:0",
+      "order 2 traded:0/1 completed:1",
+      "tick 5",
+      "tick 6",
+      "tick 7",
+      "tick 8",
+      "tick 9",
+      "tick 10",
+      "exit 2",
+  };
+  ASSERT_EQ(strategy.events, expected);
+  ASSERT_EQ(runner.tick_num(), kTickNum);
+  ASSERT_EQ(runner.rsp_num(), 4);
+}
@@ -0,0 +1,174 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ft/base/contract_table.h"
+#include "trader/risk/common/cancel_ratio_risk.h"
+
+static const char* kInvestorId = "test_cancel_ratio_risk";
+
+class CancelRatioRiskTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!ft::ContractTable::is_inited()) {
+      std::vector<ft::Contract> contracts(2);
+      contracts[0].ticker = "IF2103";
+      contracts[0].exchange = "CFFEX";
+      contracts[1].ticker = "rb2105";
+      contracts[1].exchange = "SHFE";
+      ASSERT_TRUE(ft::ContractTable::Init(std::move(contracts)));
+    }
+    unlink((std::string("./ft_cancel_ratio.") + kInvestorId).c_str());
+  }
+
+  void TearDown() override { unlink((std::string("./ft_cancel_ratio.") + kInvestorId).c_str()); }
+
+  // 模拟OMS重启，重新创建规则
+  // md_time_us不为空时模拟进程内回测
+  bool Init(const std::map<std::string, std::string>& options,
+            const uint64_t* md_time_us = nullptr) {
+    config_.risk_conf_list.clear();
+    config_.risk_conf_list.emplace_back(ft::RiskConfig{"ft.risk.cancel_ratio", options});
+    ft::RiskRuleParams params{};
+    params.config = &config_;
+    params.investor_id = kInvestorId;
+    params.backtest = md_time_us != nullptr;
+    params.md_time_us = md_time_us;
+    rule_ = std::make_unique<ft::CancelRatioRisk>();
+    return rule_->Init(&params);
+  }
+
+  ft::Order MakeOrder(const char* ticker) {
+    ft::Order order{};
+    order.req.contract = ft::ContractTable::get_by_ticker(ticker);
+    return order;
+  }
+
+  void Send(const char* ticker, int n = 1) {
+    auto order = MakeOrder(ticker);
+    for (int i = 0; i < n; ++i) {
+      rule_->OnOrderSent(order);
+    }
+  }
+
+  void Trade(const char* ticker) { rule_->OnOrderTraded(MakeOrder(ticker), ft::OrderTradedRsp{}); }
+
+  // 检查通过后模拟发出撤单
+  ft::ErrorCode Cancel(const char* ticker) {
+    auto order = MakeOrder(ticker);
+    auto error_code = rule_->CheckCancelReq(order);
+    if (error_code == ft::ErrorCode::kNoError) {
+      rule_->OnCancelReqSent(order);
+    }
+    return error_code;
+  }
+
+  ft::RmsConfig config_;
+  std::unique_ptr<ft::CancelRatioRisk> rule_;
+};
+
+TEST_F(CancelRatioRiskTest, CancelLimit) {
+  ASSERT_TRUE(Init({{"exchanges", "CFFEX,DCE"}, {"cancel_limit", "3"}}));
+  Send("IF2103", 10);
+  Send("rb2105", 10);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+  }
+  ASSERT_EQ(ft::ErrorCode::kExceedCancelLimit, Cancel("IF2103"));
+  // SHFE不受限制
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("rb2105"));
+  }
+
+  // 重启后恢复当日的计数
+  ASSERT_TRUE(Init({{"exchanges", "CFFEX,DCE"}, {"cancel_limit", "4"}}));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+  ASSERT_EQ(ft::ErrorCode::kExceedCancelLimit, Cancel("IF2103"));
+
+  // 不持久化时从0开始
+  ASSERT_TRUE(Init({{"cancel_limit", "4"}, {"persistent", "false"}}));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+}
+
+TEST_F(CancelRatioRiskTest, OrderTradeRatio) {
+  ASSERT_TRUE(Init({{"order_trade_ratio", "3"}, {"ratio_min_count", "4"}}));
+  Send("IF2103", 2);
+  // 3笔未达到ratio_min_count
+  ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+  // (2 + 2) / 1 > 3
+  ASSERT_EQ(ft::ErrorCode::kExceedOrderTradeRatio, Cancel("IF2103"));
+
+  Trade("IF2103");
+  Trade("IF2103");
+  // (2 + 2) / 2 <= 3, (2 + 3) / 2 <= 3, (2 + 4) / 2 <= 3
+  ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+  ASSERT_EQ(ft::ErrorCode::kExceedOrderTradeRatio, Cancel("IF2103"));
+}
+
+TEST_F(CancelRatioRiskTest, TradingDayRollover) {
+  ASSERT_TRUE(Init({{"cancel_limit", "1"}}));
+  Send("IF2103", 2);
+  ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+  ASSERT_EQ(ft::ErrorCode::kExceedCancelLimit, Cancel("IF2103"));
+
+  // 运行期间跨过交易日，计数清零
+  auto next_week = time(nullptr) + 7 * 86400;
+  rule_->UpdateTradingDay(next_week);
+  ASSERT_EQ(ft::CancelRatioRisk::GetTradingDay(next_week), rule_->trading_day());
+  ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+  ASSERT_EQ(ft::ErrorCode::kExceedCancelLimit, Cancel("IF2103"));
+
+  // 重启时共享内存中的交易日与当前不同，之前的计数作废
+  ASSERT_TRUE(Init({{"cancel_limit", "1"}}));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+}
+
+TEST_F(CancelRatioRiskTest, InProcessBacktest) {
+  struct tm tm {};
+  tm.tm_year = 2021 - 1900;
+  tm.tm_mon = 2;
+  tm.tm_mday = 5;
+  tm.tm_hour = 9;
+  tm.tm_isdst = -1;
+  uint64_t md_time_us = static_cast<uint64_t>(mktime(&tm)) * 1000000;
+
+  // 回测时不写共享内存，交易日取自行情时间
+  ASSERT_TRUE(Init({{"cancel_limit", "1"}}, &md_time_us));
+  ASSERT_NE(0, access((std::string("./ft_cancel_ratio.") + kInvestorId).c_str(), F_OK));
+  Send("IF2103", 2);
+  ASSERT_EQ(20210305U, rule_->trading_day());
+  ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+  ASSERT_EQ(ft::ErrorCode::kExceedCancelLimit, Cancel("IF2103"));
+
+  // 行情跨过周五夜盘开盘，计数清零
+  md_time_us += 12 * 3600 * 1000000UL;
+  ASSERT_EQ(ft::ErrorCode::kNoError, Cancel("IF2103"));
+  ASSERT_EQ(20210308U, rule_->trading_day());
+  ASSERT_EQ(ft::ErrorCode::kExceedCancelLimit, Cancel("IF2103"));
+}
+
+TEST_F(CancelRatioRiskTest, TradingDay) {
+  struct tm tm {};
+  tm.tm_year = 2021 - 1900;
+  tm.tm_mon = 2;
+  tm.tm_isdst = -1;
+  auto make_time = [&](int mday, int hour) {
+    tm.tm_mday = mday;
+    tm.tm_hour = hour;
+    return mktime(&tm);
+  };
+  // 2021-03-05是周五
+  ASSERT_EQ(20210305U, ft::CancelRatioRisk::GetTradingDay(make_time(5, 9)));
+  ASSERT_EQ(20210308U, ft::CancelRatioRisk::GetTradingDay(make_time(5, 21)));
+  ASSERT_EQ(20210308U, ft::CancelRatioRisk::GetTradingDay(make_time(6, 1)));
+  ASSERT_EQ(20210309U, ft::CancelRatioRisk::GetTradingDay(make_time(8, 22)));
+  ASSERT_EQ(20210401U, ft::CancelRatioRisk::GetTradingDay(make_time(31, 20)));
+}
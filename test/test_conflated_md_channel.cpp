@@ -0,0 +1,133 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "ft/component/conflated_md_channel.h"
+
+static ft::TickData MakeTick(uint32_t ticker_id, uint64_t volume) {
+  ft::TickData tick{};
+  tick.ticker_id = ticker_id;
+  tick.volume = volume;
+  return tick;
+}
+
+TEST(ConflatedMdChannel, Basic) {
+  ft::ConflatedMdChannel writer;
+  ASSERT_TRUE(writer.Create("test_conflated_md", 4));
+  ft::ConflatedMdChannel reader;
+  ASSERT_TRUE(reader.Open("test_conflated_md"));
+  ASSERT_EQ(reader.ticker_num(), 4U);
+
+  ft::TickData tick{};
+  ASSERT_FALSE(reader.Poll(&tick));
+  ASSERT_FALSE(writer.Publish(MakeTick(0, 1)));
+  ASSERT_FALSE(writer.Publish(MakeTick(5, 1)));
+
+  // 读端取走之前同一合约的tick被合并，只能读到最新的
+  ASSERT_TRUE(writer.Publish(MakeTick(2, 1)));
+  ASSERT_TRUE(writer.Publish(MakeTick(2, 2)));
+  ASSERT_TRUE(writer.Publish(MakeTick(2, 3)));
+  ASSERT_TRUE(reader.Poll(&tick));
+  ASSERT_EQ(tick.ticker_id, 2U);
+  ASSERT_EQ(tick.volume, 3U);
+  ASSERT_FALSE(reader.Poll(&tick));
+  ASSERT_EQ(reader.published(), 3U);
+  ASSERT_EQ(reader.conflated(), 2U);
+
+  // 取走之后的更新重新排队
+  ASSERT_TRUE(writer.Publish(MakeTick(2, 4)));
+  ASSERT_TRUE(reader.Poll(&tick));
+  ASSERT_EQ(tick.volume, 4U);
+  ASSERT_FALSE(reader.Poll(&tick));
+
+  int ret = system("rm -f ft_conflated_md.test_conflated_md");
+  (void)ret;
+}
+
+TEST(ConflatedMdChannel, Order) {
+  ft::ConflatedMdChannel writer;
+  ASSERT_TRUE(writer.Create("test_conflated_md_order", 4));
+  ft::ConflatedMdChannel reader;
+  ASSERT_TRUE(reader.Open("test_conflated_md_order"));
+
+  // 按合约第一次更新的顺序读取，每个合约读到的都是最新的行情
+  ASSERT_TRUE(writer.Publish(MakeTick(3, 1)));
+  ASSERT_TRUE(writer.Publish(MakeTick(1, 1)));
+  ASSERT_TRUE(writer.Publish(MakeTick(3, 2)));
+  ASSERT_TRUE(writer.Publish(MakeTick(4, 1)));
+  ASSERT_TRUE(writer.Publish(MakeTick(1, 2)));
+
+  ft::TickData tick{};
+  ASSERT_TRUE(reader.Poll(&tick));
+  ASSERT_EQ(tick.ticker_id, 3U);
+  ASSERT_EQ(tick.volume, 2U);
+  ASSERT_TRUE(reader.Poll(&tick));
+  ASSERT_EQ(tick.ticker_id, 1U);
+  ASSERT_EQ(tick.volume, 2U);
+  ASSERT_TRUE(reader.Poll(&tick));
+  ASSERT_EQ(tick.ticker_id, 4U);
+  ASSERT_EQ(tick.volume, 1U);
+  ASSERT_FALSE(reader.Poll(&tick));
+
+  // 重新创建时清空通道
+  ASSERT_TRUE(writer.Publish(MakeTick(2, 1)));
+  ASSERT_TRUE(writer.Create("test_conflated_md_order", 4));
+  ASSERT_TRUE(reader.Open("test_conflated_md_order"));
+  ASSERT_FALSE(reader.Poll(&tick));
+  ASSERT_EQ(reader.published(), 0U);
+
+  int ret = system("rm -f ft_conflated_md.test_conflated_md_order");
+  (void)ret;
+}
+
+TEST(ConflatedMdChannel, Concurrent) {
+  constexpr uint32_t kTickerNum = 8;
+  constexpr uint64_t kRounds = 200000;
+
+  ft::ConflatedMdChannel writer;
+  ASSERT_TRUE(writer.Create("test_conflated_md_mt", kTickerNum));
+  ft::ConflatedMdChannel reader;
+  ASSERT_TRUE(reader.Open("test_conflated_md_mt"));
+
+  // 每个合约的volume单调递增，读端读到的必须递增且最终读到最后一个tick
+  std::atomic<bool> done = false;
+  std::thread writer_thread([&] {
+    for (uint64_t i = 1; i <= kRounds; ++i) {
+      for (uint32_t ticker_id = 1; ticker_id <= kTickerNum; ++ticker_id) {
+        auto tick = MakeTick(ticker_id, i);
+        tick.turnover = static_cast<double>(i);
+        writer.Publish(tick);
+      }
+    }
+    done = true;
+  });
+
+  uint64_t last_volume[kTickerNum + 1]{};
+  uint64_t delivered = 0;
+  ft::TickData tick{};
+  for (;;) {
+    bool finished = done;
+    while (reader.Poll(&tick)) {
+      ASSERT_GT(tick.volume, last_volume[tick.ticker_id]);
+      ASSERT_DOUBLE_EQ(tick.turnover, static_cast<double>(tick.volume));
+      last_volume[tick.ticker_id] = tick.volume;
+      ++delivered;
+    }
+    if (finished) {
+      break;
+    }
+  }
+  writer_thread.join();
+
+  for (uint32_t ticker_id = 1; ticker_id <= kTickerNum; ++ticker_id) {
+    ASSERT_EQ(last_volume[ticker_id], kRounds);
+  }
+  ASSERT_EQ(reader.published(), kRounds * kTickerNum);
+  ASSERT_LE(delivered, reader.published() - reader.conflated());
+
+  int ret = system("rm -f ft_conflated_md.test_conflated_md_mt");
+  (void)ret;
+}
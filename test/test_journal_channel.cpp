@@ -0,0 +1,92 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <type_traits>
+
+#include "ft/component/journal_channel.h"
+#include "ft/component/yijinjing/journal/Timer.h"
+
+TEST(JournalChannel, TypedDispatch) {
+  auto writer = yijinjing::JournalWriter::create(".", "test_journal_channel", "writer");
+  auto start_time = yijinjing::getNanoTime();
+  writer->seekEnd();
+
+  for (uint32_t i = 0; i < 100; ++i) {
+    ft::TickData tick{};
+    tick.ticker_id = i;
+    ft::WriteMsg(writer.get(), tick);
+
+    ft::OrderResponse rsp{};
+    rsp.order_id = i;
+    ft::WriteMsg(writer.get(), rsp);
+
+    ft::TraderCommand cmd{};
+    cmd.magic = i;
+    ft::WriteMsg(writer.get(), cmd);
+
+    // 未标注类型的数据
+    writer->write_data(i, 0, 0);
+  }
+
+  ft::TypedJournalReader<ft::TickData, ft::OrderResponse> reader(
+      yijinjing::JournalReader::create(".", "test_journal_channel", start_time, "reader"));
+
+  uint32_t tick_count = 0;
+  uint32_t rsp_count = 0;
+  auto handler = [&](const auto& msg) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(msg)>, ft::TickData>) {
+      ASSERT_EQ(msg.ticker_id, tick_count);
+      ASSERT_EQ(tick_count, rsp_count);
+      ++tick_count;
+    } else {
+      ASSERT_EQ(msg.order_id, rsp_count);
+      ++rsp_count;
+    }
+  };
+  uint32_t cmd_count = 0;
+  uint32_t untyped_count = 0;
+  auto on_unknown = [&](const yijinjing::Frame& frame) {
+    if (frame.getMsgType() == ft::kMsgTypeOf<ft::TraderCommand>) {
+      ASSERT_EQ(frame.getDataLength(), sizeof(ft::TraderCommand));
+      ++cmd_count;
+    } else {
+      ASSERT_EQ(frame.getMsgType(), 0);
+      ASSERT_EQ(frame.getDataLength(), sizeof(uint32_t));
+      ++untyped_count;
+    }
+  };
+  while (reader.Poll(handler, on_unknown)) {
+  }
+
+  ASSERT_EQ(tick_count, 100);
+  ASSERT_EQ(rsp_count, 100);
+  ASSERT_EQ(cmd_count, 100);
+  ASSERT_EQ(untyped_count, 100);
+  ASSERT_EQ(reader.unknown_count(), 200);
+
+  int res = system("rm -f yjj.test_journal_channel.*");
+  (void)res;
+}
+
+TEST(JournalChannel, SizeMismatch) {
+  auto writer = yijinjing::JournalWriter::create(".", "test_journal_channel_size", "writer");
+  auto start_time = yijinjing::getNanoTime();
+  writer->seekEnd();
+
+  // msg_type正确但长度不一致的数据不会被分发
+  uint64_t data = 0;
+  writer->write_data(data, ft::kMsgTypeOf<ft::TickData>, 0);
+
+  auto reader = yijinjing::JournalReader::create(".", "test_journal_channel_size", start_time,
+                                                 "reader");
+  yijinjing::Frame frame(nullptr);
+  ASSERT_TRUE(reader->getNextFrame(&frame));
+  bool called = false;
+  ASSERT_FALSE(ft::MsgDispatcher<ft::TickData>::Dispatch(
+      frame, [&](const ft::TickData&) { called = true; }));
+  ASSERT_FALSE(called);
+
+  int res = system("rm -f yjj.test_journal_channel_size.*");
+  (void)res;
+}
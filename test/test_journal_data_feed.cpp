@@ -0,0 +1,118 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "ft/component/journal_channel.h"
+#include "ft/component/yijinjing/journal/Timer.h"
+#include "trader/gateway/backtest/data_feed/data_feed.h"
+
+class TickCollector : public ft::MarketDataListener {
+ public:
+  void OnDataFeed(const ft::TickData* tick) override { volumes.emplace_back(tick->volume); }
+
+  std::vector<uint64_t> volumes;
+};
+
+static void WriteTick(yijinjing::JournalWriter* writer, uint64_t volume) {
+  ft::TickData tick{};
+  tick.ticker_id = 1;
+  tick.volume = volume;
+  ft::WriteMsg(writer, tick);
+}
+
+static std::vector<uint64_t> Replay(const std::map<std::string, std::string>& args) {
+  auto data_feed = ft::CreateDataFeed("ft.data_feed.journal");
+  TickCollector collector;
+  data_feed->RegisterListener(&collector);
+  if (!data_feed->Init(args)) {
+    return {};
+  }
+  while (data_feed->Feed()) {
+  }
+  return collector.volumes;
+}
+
+TEST(JournalDataFeed, Replay) {
+  int ret = system(
+      "rm -rf test_journal_feed_d0 test_journal_feed_d1 && "
+      "mkdir test_journal_feed_d0 test_journal_feed_d1");
+  ASSERT_EQ(ret, 0);
+
+  // 第一个目录中的两个journal交替写入，第二个目录只有一个journal
+  std::vector<int64_t> times;
+  {
+    auto writer_a = yijinjing::JournalWriter::create("test_journal_feed_d0", "md_a", "writer");
+    auto writer_b = yijinjing::JournalWriter::create("test_journal_feed_d0", "md_b", "writer");
+    for (uint64_t i = 0; i < 100; ++i) {
+      times.emplace_back(yijinjing::getNanoTime());
+      WriteTick(i % 2 == 0 ? writer_a.get() : writer_b.get(), i);
+      // 非行情消息会被跳过
+      ft::OrderResponse rsp{};
+      ft::WriteMsg(writer_a.get(), rsp);
+    }
+  }
+  {
+    auto writer_a = yijinjing::JournalWriter::create("test_journal_feed_d1", "md_a", "writer");
+    for (uint64_t i = 100; i < 200; ++i) {
+      times.emplace_back(yijinjing::getNanoTime());
+      WriteTick(writer_a.get(), i);
+    }
+  }
+
+  auto volumes = Replay({{"journal_dir", "test_journal_feed_d0,test_journal_feed_d1"},
+                         {"journal", "md_a,md_b"}});
+  ASSERT_EQ(volumes.size(), 200U);
+  for (uint64_t i = 0; i < volumes.size(); ++i) {
+    ASSERT_EQ(volumes[i], i);
+  }
+
+  // 只回放[50, 150)
+  volumes = Replay({{"journal_dir", "test_journal_feed_d0,test_journal_feed_d1"},
+                    {"journal", "md_a,md_b"},
+                    {"start_time", std::to_string(times[50])},
+                    {"end_time", std::to_string(times[150] - 1)}});
+  ASSERT_EQ(volumes.size(), 100U);
+  for (uint64_t i = 0; i < volumes.size(); ++i) {
+    ASSERT_EQ(volumes[i], i + 50);
+  }
+
+  ASSERT_TRUE(Replay({{"journal", "md_a"}}).empty());
+  ASSERT_TRUE(Replay({{"journal_dir", "test_journal_feed_d0"},
+                      {"journal", "md_a"},
+                      {"start_time", "2021-06-01"}})
+                  .empty());
+
+  ret = system("rm -rf test_journal_feed_d0 test_journal_feed_d1");
+  (void)ret;
+}
+
+TEST(JournalDataFeed, LegacyTicks) {
+  int ret = system("rm -rf test_journal_feed_d2 && mkdir test_journal_feed_d2");
+  ASSERT_EQ(ret, 0);
+
+  // 模拟引入消息类型之前记录的行情，msg_type都为0
+  // 长度与TickData一致的照常回放，TickData定义变化之前记录的会被丢弃
+  struct OldTickData {
+    char data[sizeof(ft::TickData) - 16];
+  };
+  {
+    auto writer = yijinjing::JournalWriter::create("test_journal_feed_d2", "md_a", "writer");
+    WriteTick(writer.get(), 0);
+    writer->write_data(OldTickData{}, 0, 0);
+    writer->write_data(OldTickData{}, 0, 0);
+    ft::TickData legacy_tick{};
+    legacy_tick.ticker_id = 1;
+    legacy_tick.volume = 1;
+    writer->write_data(legacy_tick, 0, 0);
+    WriteTick(writer.get(), 2);
+  }
+
+  auto volumes = Replay({{"journal_dir", "test_journal_feed_d2"}, {"journal", "md_a"}});
+  ASSERT_EQ(volumes, (std::vector<uint64_t>{0, 1, 2}));
+
+  ret = system("rm -rf test_journal_feed_d2");
+  (void)ret;
+}
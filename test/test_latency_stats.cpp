@@ -0,0 +1,149 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "ft/component/latency_stats.h"
+
+using ft::LatencyHistogram;
+using ft::LatencyHistograms;
+
+TEST(LatencyHistogram, Bucket) {
+  // 桶的范围连续且单调，每个值都落在所在桶的范围内
+  uint64_t prev = 0;
+  for (std::size_t i = 1; i < LatencyHistogram::kBucketNum; ++i) {
+    auto value = LatencyHistogram::BucketValue(i);
+    ASSERT_GT(value, prev);
+    ASSERT_EQ(i, LatencyHistogram::BucketIndex(value));
+    ASSERT_EQ(i, LatencyHistogram::BucketIndex(prev + 1));
+    prev = value;
+  }
+  ASSERT_EQ(LatencyHistogram::kBucketNum - 1, LatencyHistogram::BucketIndex(1UL << 40));
+
+  for (uint64_t value = 1; value < (1UL << 32); value = value * 3 / 2 + 1) {
+    auto upper = LatencyHistogram::BucketValue(LatencyHistogram::BucketIndex(value));
+    ASSERT_GE(upper, value);
+    ASSERT_LE(upper - value, value / LatencyHistogram::kSubBucketNum);
+  }
+}
+
+TEST(LatencyHistogram, Percentile) {
+  auto hist = std::make_unique<LatencyHistogram>();
+  *hist = LatencyHistogram{};
+  ASSERT_EQ(0UL, hist->Percentile(0.5));
+
+  std::vector<uint64_t> values;
+  std::mt19937_64 rng(42);
+  for (int i = 0; i < 100000; ++i) {
+    values.emplace_back(rng() % 1000000);
+    hist->Record(values.back());
+  }
+  std::sort(values.begin(), values.end());
+  ASSERT_EQ(values.size(), hist->count);
+  ASSERT_EQ(values.back(), hist->max);
+  ASSERT_EQ(values.back(), hist->Percentile(1.0));
+  for (double p : {0.5, 0.9, 0.99, 0.999}) {
+    auto expected = values[static_cast<std::size_t>(p * values.size()) - 1];
+    auto res = hist->Percentile(p);
+    ASSERT_GE(res, expected);
+    ASSERT_LE(res - expected, expected / LatencyHistogram::kSubBucketNum);
+  }
+}
+
+TEST(LatencyStats, Slot) {
+  ft::LatencyStats writer;
+  ASSERT_TRUE(writer.Create("test_latency_stats"));
+  ASSERT_GT(writer.tsc_per_ns(), 0.0);
+
+  ft::LatencyStats strategy;
+  ASSERT_TRUE(strategy.Open("test_latency_stats", true));
+  ft::LatencyStats reader;
+  ASSERT_TRUE(reader.Open("test_latency_stats", false));
+  ASSERT_DOUBLE_EQ(writer.tsc_per_ns(), reader.tsc_per_ns());
+
+  uint32_t oms_slot;
+  uint32_t strategy_slot;
+  uint32_t slot;
+  ASSERT_TRUE(writer.AcquireSlot("oms", &oms_slot));
+  ASSERT_TRUE(strategy.AcquireSlot("strategy.s1", &strategy_slot));
+  ASSERT_NE(oms_slot, strategy_slot);
+  ASSERT_TRUE(strategy.AcquireSlot("strategy.s1", &slot));
+  ASSERT_EQ(strategy_slot, slot);
+  ASSERT_FALSE(reader.AcquireSlot("reader", &slot));
+  ASSERT_FALSE(strategy.AcquireSlot(std::string(40, 'x'), &slot));
+
+  auto histograms = std::make_unique<LatencyHistograms>();
+  std::string thread_name;
+  ASSERT_FALSE(reader.Load(oms_slot, &thread_name, histograms.get()));
+
+  *histograms = LatencyHistograms{};
+  histograms->stages[ft::kLatencyRmsCheck].Record(100);
+  strategy.Store(strategy_slot, *histograms);
+  *histograms = LatencyHistograms{};
+  ASSERT_TRUE(reader.Load(strategy_slot, &thread_name, histograms.get()));
+  ASSERT_EQ("strategy.s1", thread_name);
+  ASSERT_EQ(1UL, histograms->stages[ft::kLatencyRmsCheck].count);
+  ASSERT_EQ(100UL, histograms->stages[ft::kLatencyRmsCheck].max);
+
+  // 重新创建时替换为新的统计页，仍映射着旧统计页的策略及读端不受影响
+  ASSERT_TRUE(writer.Create("test_latency_stats"));
+  ASSERT_TRUE(reader.Load(strategy_slot, &thread_name, histograms.get()));
+  strategy.Store(strategy_slot, *histograms);
+  // 重新打开后读到的是清空后的统计
+  ASSERT_TRUE(reader.Open("test_latency_stats", false));
+  ASSERT_FALSE(reader.Load(strategy_slot, &thread_name, histograms.get()));
+
+  int ret = system("rm -f ft_latency_stats.test_latency_stats");
+  (void)ret;
+}
+
+TEST(LatencyStats, Recorder) {
+  ft::LatencyStats stats;
+  ASSERT_TRUE(stats.Create("test_latency_recorder"));
+
+  // 未注册recorder的线程不统计
+  ft::RecordLatency(ft::kLatencyTickRing, 1, 2);
+  ft::FlushLatencyStats();
+
+  std::thread t([&] {
+    ASSERT_TRUE(ft::RegisterLatencyRecorder(&stats, "worker", 0));
+    for (uint64_t i = 1; i <= 1000; ++i) {
+      ft::RecordLatency(ft::kLatencyTickRing, 1000, 1000 + i);
+    }
+    // 上游没有打点
+    ft::RecordLatency(ft::kLatencyTickToTrade, 0, 1000);
+    // end早于start时记为0
+    ft::RecordLatency(ft::kLatencyCmdRead, 1000, 999);
+    ft::FlushLatencyStats();
+  });
+  t.join();
+
+  ft::LatencyStats reader;
+  ASSERT_TRUE(reader.Open("test_latency_recorder", false));
+  auto histograms = std::make_unique<LatencyHistograms>();
+  std::string thread_name;
+  uint32_t found = 0;
+  for (uint32_t i = 0; i < reader.slot_num(); ++i) {
+    if (reader.Load(i, &thread_name, histograms.get())) {
+      ++found;
+      ASSERT_EQ("worker", thread_name);
+      auto& tick_ring = histograms->stages[ft::kLatencyTickRing];
+      ASSERT_EQ(1000UL, tick_ring.count);
+      ASSERT_EQ(1000UL, tick_ring.max);
+      ASSERT_GE(tick_ring.Percentile(0.5), 500UL);
+      ASSERT_LE(tick_ring.Percentile(0.5), 500UL + 500 / LatencyHistogram::kSubBucketNum);
+      ASSERT_EQ(0UL, histograms->stages[ft::kLatencyTickToTrade].count);
+      ASSERT_EQ(1UL, histograms->stages[ft::kLatencyCmdRead].count);
+      ASSERT_EQ(0UL, histograms->stages[ft::kLatencyCmdRead].max);
+    }
+  }
+  ASSERT_EQ(1U, found);
+
+  int ret = system("rm -f ft_latency_stats.test_latency_recorder");
+  (void)ret;
+}
@@ -0,0 +1,292 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ft/base/config.h"
+#include "ft/base/log.h"
+#include "ft/base/log_file.h"
+#include "spdlog/sinks/ostream_sink.h"
+
+using ft::log_detail::LogRing;
+
+template <class... Args>
+static std::string Format(std::string_view fmt, const Args&... args) {
+  std::string buf;
+  auto normalized = std::make_tuple(ft::log_detail::Normalize(args)...);
+  std::apply(
+      [&](const auto&... v) {
+        std::size_t size = 0;
+        ((size += ft::log_detail::EncodedSize(v)), ...);
+        buf.resize(size);
+        [[maybe_unused]] char* p = buf.data();
+        ((p = ft::log_detail::Encode(p, v)), ...);
+      },
+      normalized);
+
+  std::string out;
+  if (!ft::log_detail::FormatLogArgs(fmt, buf.data(), buf.size(), &out)) {
+    return "<error>";
+  }
+  return out;
+}
+
+enum TestEnum { kTestEnumA = 3 };
+
+TEST(Log, FormatLogArgs) {
+  char ticker[16] = "rb2105";
+  std::string exchange = "SHFE";
+  const char* direction = "buy";
+  ASSERT_EQ("rb2105.SHFE buy 10@4123.50 -1 3 true x",
+            Format("{}.{} {} {}@{:.2f} {} {} {} {}", ticker, exchange, direction, 10U, 4123.5, -1,
+                   kTestEnumA, true, 'x'));
+  ASSERT_EQ("{0} 0002 |  ab| 1.5", Format("{{0}} {:04d} |{:>4}| {}", 2, "ab", 1.5F));
+  ASSERT_EQ("b a b", Format("{1} {0} {1}", "a", "b"));
+  ASSERT_EQ(fmt::format("{}", static_cast<const void*>(ticker)),
+            Format("{}", static_cast<const void*>(ticker)));
+  ASSERT_EQ(std::string(ft::log_detail::kMaxLogStringLen, 'x'),
+            Format("{}", std::string(ft::log_detail::kMaxLogStringLen + 10, 'x')));
+
+  // 没有参数时原样输出
+  ASSERT_EQ("{} {{", Format("{} {{"));
+
+  // 参数不足或格式说明不合法
+  ASSERT_EQ("<error>", Format("{} {}", 1));
+  ASSERT_EQ("<error>", Format("{:d}", "str"));
+  ASSERT_EQ("<error>", Format("{:{}}", 1, 2));
+}
+
+TEST(Log, LogRing) {
+  auto ring = std::make_unique<LogRing>();
+  ASSERT_TRUE(ring->Empty());
+
+  // 记录不跨越队列末尾，剩余空间不足时写入填充记录，填充对消费者不可见
+  constexpr std::size_t kRecordSize = 40000;
+  uint32_t site_id = 100;
+  uint64_t pushed = 0;
+  uint64_t popped = 0;
+  for (int round = 0; round < 100; ++round) {
+    char* p;
+    while ((p = ring->Reserve(kRecordSize)) != nullptr) {
+      auto* header = reinterpret_cast<ft::log_detail::LogRecordHeader*>(p);
+      header->size = kRecordSize;
+      header->site_id = site_id++;
+      ring->Commit(kRecordSize);
+      ++pushed;
+    }
+    ASSERT_GE(pushed - popped, LogRing::kCapacity / kRecordSize - 1);
+
+    for (int i = 0; i < 7; ++i) {
+      auto* header = ring->Front();
+      ASSERT_NE(nullptr, header);
+      ASSERT_EQ(100 + popped, header->site_id);
+      ring->Pop(header->size);
+      ++popped;
+    }
+  }
+  while (auto* header = ring->Front()) {
+    ASSERT_EQ(100 + popped, header->site_id);
+    ring->Pop(header->size);
+    ++popped;
+  }
+  ASSERT_EQ(pushed, popped);
+  ASSERT_TRUE(ring->Empty());
+}
+
+TEST(Log, Sync) {
+  auto& logger = ft::Logger::Instance();
+  std::ostringstream oss;
+  auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+  sink->set_pattern("%l %v");
+  auto old_sinks = logger.GetLogger()->sinks();
+  logger.GetLogger()->sinks() = {sink};
+  int errors = 0;
+  logger.GetLogger()->set_error_handler([&](const std::string&) { ++errors; });
+  LOG_SET_LEVEL("info");
+  ASSERT_FALSE(logger.async());
+
+  char buf[32];
+  snprintf(buf, sizeof(buf), "buf {}");
+  LOG_INFO("sync {} {:.1f}", 1, 0.5);
+  LOG_WARN(std::string("str {}"), 2);
+  LOG_ERROR(buf, 3);
+  LOG_ERROR("raw {}");
+  // 格式串不合法时交给spdlog的错误处理函数，不输出格式串本身
+  LOG_ERROR(std::string("bad {} {}"), 4);
+  ASSERT_EQ("info sync 1 0.5\nwarning str 2\nerror buf 3\nerror raw {}\n", oss.str());
+  ASSERT_EQ(errors, 1);
+
+  logger.GetLogger()->set_error_handler(nullptr);
+  logger.GetLogger()->sinks() = old_sinks;
+}
+
+TEST(Log, Async) {
+  auto& logger = ft::Logger::Instance();
+  std::ostringstream oss;
+  auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+  sink->set_pattern("%l %v");
+  auto old_sinks = logger.GetLogger()->sinks();
+  logger.GetLogger()->sinks() = {sink};
+  LOG_SET_LEVEL("debug");
+
+  ASSERT_TRUE(logger.StartAsync());
+  ASSERT_TRUE(logger.async());
+
+  // 线程退出后队列被其他线程复用
+  for (int t = 0; t < 4; ++t) {
+    std::thread([t] {
+      for (int i = 0; i < 100; ++i) {
+        LOG_INFO("thread:{} seq:{} price:{:.1f}", t, i, i * 0.5);
+      }
+    }).join();
+  }
+  LOG_TRACE("filtered {}", 1);
+  LOG_WARN(std::string("preformatted {}"), 42);
+  LOG_ERROR("raw {}");
+  logger.StopAsync();
+  ASSERT_FALSE(logger.async());
+
+  std::vector<std::string> lines;
+  std::istringstream iss(oss.str());
+  for (std::string line; std::getline(iss, line);) {
+    lines.emplace_back(line);
+  }
+  ASSERT_EQ(402UL, lines.size());
+  // 同一线程的日志保持顺序
+  for (int t = 0; t < 4; ++t) {
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_EQ(fmt::format("info thread:{} seq:{} price:{:.1f}", t, i, i * 0.5),
+                lines[t * 100 + i]);
+    }
+  }
+  ASSERT_EQ("warning preformatted 42", lines[400]);
+  ASSERT_EQ("error raw {}", lines[401]);
+
+  logger.GetLogger()->sinks() = old_sinks;
+}
+
+TEST(Log, NonLiteralFormatAndFatal) {
+  auto& logger = ft::Logger::Instance();
+  std::ostringstream oss;
+  auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+  sink->set_pattern("%l %v");
+  auto old_sinks = logger.GetLogger()->sinks();
+  logger.GetLogger()->sinks() = {sink};
+  LOG_SET_LEVEL("info");
+
+  ASSERT_TRUE(logger.StartAsync());
+  // char数组缓冲区作为格式串时每次都按当前内容格式化
+  char buf[32];
+  for (int i = 0; i < 2; ++i) {
+    snprintf(buf, sizeof(buf), "msg%d {}", i);
+    LOG_ERROR(buf, i);
+  }
+  // LOG_FATAL返回时之前的日志都已输出
+  LOG_FATAL("fatal {}", 2);
+  ASSERT_EQ("error msg0 0\nerror msg1 1\ncritical fatal 2\n", oss.str());
+  logger.StopAsync();
+
+  logger.GetLogger()->sinks() = old_sinks;
+}
+
+TEST(Log, TerminateSignal) {
+  // 子进程被SIGTERM终止前输出队列中的日志
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    ft::GlobalConfig config{};
+    config.log_mode = "binary";
+    LOG_SET_LEVEL("info");
+    if (!ft::InitLogMode(config, "test_log_signal")) {
+      _exit(1);
+    }
+    for (int i = 0; i < 1000; ++i) {
+      LOG_INFO("signal seq:{}", i);
+    }
+    raise(SIGTERM);
+    _exit(2);
+  }
+
+  int status = 0;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFSIGNALED(status));
+  ASSERT_EQ(SIGTERM, WTERMSIG(status));
+
+  auto file = fmt::format("./ft_log.test_log_signal.{}.bin", pid);
+  FILE* fp = fopen(file.c_str(), "rb");
+  ASSERT_NE(nullptr, fp);
+  ft::LogFileHeader header;
+  ASSERT_EQ(1UL, fread(&header, sizeof(header), 1, fp));
+  int records = 0;
+  std::vector<char> block;
+  uint32_t type_and_size[2];
+  while (fread(type_and_size, sizeof(type_and_size), 1, fp) == 1) {
+    block.resize(type_and_size[1] - sizeof(type_and_size));
+    ASSERT_EQ(block.size(), fread(block.data(), 1, block.size(), fp));
+    records += type_and_size[0] == ft::kLogFileRecordBlock;
+  }
+  fclose(fp);
+  remove(file.c_str());
+  ASSERT_EQ(1000, records);
+}
+
+TEST(Log, Binary) {
+  auto& logger = ft::Logger::Instance();
+  LOG_SET_LEVEL("info");
+  const char* file = "./ft_log.test_log.bin";
+  ASSERT_TRUE(logger.StartAsync(file));
+  for (int i = 0; i < 10; ++i) {
+    LOG_INFO("binary seq:{} {}", i, "abc");
+  }
+  logger.StopAsync();
+
+  FILE* fp = fopen(file, "rb");
+  ASSERT_NE(nullptr, fp);
+  ft::LogFileHeader header;
+  ASSERT_EQ(1UL, fread(&header, sizeof(header), 1, fp));
+  ASSERT_EQ(ft::kLogFileMagic, header.magic);
+
+  std::string site_fmt;
+  std::vector<std::string> msgs;
+  std::vector<char> block;
+  uint32_t type_and_size[2];
+  while (fread(type_and_size, sizeof(type_and_size), 1, fp) == 1) {
+    block.resize(type_and_size[1]);
+    memcpy(block.data(), type_and_size, sizeof(type_and_size));
+    std::size_t remain = type_and_size[1] - sizeof(type_and_size);
+    ASSERT_EQ(remain, fread(block.data() + sizeof(type_and_size), 1, remain, fp));
+    if (type_and_size[0] == ft::kLogFileSiteBlock) {
+      ft::LogFileSite site;
+      memcpy(&site, block.data(), sizeof(site));
+      ASSERT_EQ(spdlog::level::info, static_cast<int>(site.level));
+      ASSERT_EQ(std::string(__FILE__), std::string(block.data() + sizeof(site), site.file_len));
+      site_fmt.assign(block.data() + sizeof(site) + site.file_len,
+                      type_and_size[1] - sizeof(site) - site.file_len);
+    } else {
+      ASSERT_EQ(ft::kLogFileRecordBlock, type_and_size[0]);
+      std::string msg;
+      ASSERT_TRUE(ft::log_detail::FormatLogArgs(site_fmt, block.data() + sizeof(ft::LogFileRecord),
+                                                type_and_size[1] - sizeof(ft::LogFileRecord),
+                                                &msg));
+      msgs.emplace_back(msg);
+    }
+  }
+  fclose(fp);
+
+  ASSERT_EQ("binary seq:{} {}", site_fmt);
+  ASSERT_EQ(10UL, msgs.size());
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(fmt::format("binary seq:{} abc", i), msgs[i]);
+  }
+
+  int ret = system("rm -f ft_log.test_log.bin");
+  (void)ret;
+}
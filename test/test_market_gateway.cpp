@@ -0,0 +1,199 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "ft/component/journal_channel.h"
+#include "ft/component/md_relay.h"
+#include "trader/gateway/gateway.h"
+#include "trader/oms.h"
+
+using ft::TickData;
+
+static const char* kContractFile = "test_market_gateway.csv";
+static const char* kJournalDir = "test_market_gateway";
+
+static TickData MakeTick(const char* ticker, uint64_t volume) {
+  TickData tick{};
+  tick.ticker_id = ft::ContractTable::get_by_ticker(ticker)->ticker_id;
+  tick.volume = volume;
+  return tick;
+}
+
+// 等待直到收到n个tick或超时
+template <class PollFn>
+static std::vector<uint64_t> Collect(std::size_t n, PollFn&& poll) {
+  std::vector<uint64_t> volumes;
+  TickData tick;
+  auto start = std::chrono::steady_clock::now();
+  while (volumes.size() < n &&
+         std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    if (poll(&tick)) {
+      volumes.emplace_back(tick.volume);
+    }
+  }
+  // 多等一会，确认没有多余的tick
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  while (poll(&tick)) {
+    volumes.emplace_back(tick.volume);
+  }
+  return volumes;
+}
+
+class MarketGatewayTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    FILE* fp = fopen(kContractFile, "w");
+    ASSERT_TRUE(fp);
+    fprintf(fp,
+            "ticker,exchange,name,product_type,size,price_tick,long_margin_rate,"
+            "short_margin_rate,max_market_order_volume,min_market_order_volume,"
+            "max_limit_order_volume,min_limit_order_volume,delivery_year,delivery_month\n"
+            "rb2110,SHFE,rb2110,Futures,10,1.0,0.1,0.1,30,1,500,1,2021,10\n"
+            "ag2106,SHFE,ag2106,Futures,15,1.0,0.1,0.1,30,1,500,1,2021,6\n"
+            "IF2106,CFFEX,IF2106,Futures,300,0.2,0.1,0.1,30,1,500,1,2021,6\n");
+    fclose(fp);
+    ASSERT_TRUE(ft::ContractTable::Init(kContractFile));
+    auto cmd = std::string("rm -rf ") + kJournalDir + " && mkdir " + kJournalDir;
+    ASSERT_EQ(0, system(cmd.c_str()));
+
+    // 与ft_market一样按交易所写入行情
+    shfe_writer_ = yijinjing::JournalWriter::create(kJournalDir, "md.SHFE", "market_server");
+    cffex_writer_ = yijinjing::JournalWriter::create(kJournalDir, "md.CFFEX", "market_server");
+    // 订阅之前写入的行情不会被读取
+    ft::WriteMsg(shfe_writer_.get(), MakeTick("rb2110", 100));
+  }
+
+  void TearDown() override {
+    shfe_writer_.reset();
+    cffex_writer_.reset();
+    remove(kContractFile);
+    ASSERT_EQ(0, system((std::string("rm -rf ") + kJournalDir).c_str()));
+  }
+
+  void WriteTicks() {
+    ft::WriteMsg(shfe_writer_.get(), MakeTick("rb2110", 1));
+    // 未订阅
+    ft::WriteMsg(shfe_writer_.get(), MakeTick("ag2106", 2));
+    // 非行情消息
+    ft::WriteMsg(shfe_writer_.get(), ft::OrderResponse{});
+    ft::WriteMsg(cffex_writer_.get(), MakeTick("IF2106", 3));
+  }
+
+  ft::GatewayConfig JournalConfig() {
+    ft::GatewayConfig config{};
+    config.api = "market";
+    config.extended_args["md_journal_dir"] = kJournalDir;
+    config.extended_args["md_journal_prefix"] = "md";
+    return config;
+  }
+
+  yijinjing::JournalWriterPtr shfe_writer_;
+  yijinjing::JournalWriterPtr cffex_writer_;
+};
+
+TEST_F(MarketGatewayTest, Journal) {
+  auto gateway = ft::CreateGateway("market");
+  ASSERT_TRUE(gateway);
+  ASSERT_TRUE(gateway->Init(JournalConfig()));
+  ASSERT_TRUE(gateway->Subscribe({"rb2110", "IF2106"}));
+  WriteTicks();
+
+  auto volumes = Collect(2, [&](TickData* tick) { return gateway->GetTickRB()->Get(tick); });
+  ASSERT_EQ(volumes, (std::vector<uint64_t>{1, 3}));
+  gateway->Logout();
+}
+
+TEST_F(MarketGatewayTest, JournalNotFound) {
+  auto config = JournalConfig();
+  config.extended_args["md_journal_prefix"] = "not_exist";
+  auto gateway = ft::CreateGateway("market");
+  ASSERT_TRUE(gateway->Init(config));
+  ASSERT_FALSE(gateway->Subscribe({"rb2110"}));
+}
+
+TEST_F(MarketGatewayTest, Udp) {
+  ft::GatewayConfig config{};
+  config.api = "market";
+  config.extended_args["md_source"] = "udp";
+  config.extended_args["md_address"] = "127.0.0.1";
+  config.extended_args["md_port"] = "18860";
+  auto gateway = ft::CreateGateway("market");
+  ASSERT_TRUE(gateway->Init(config));
+  ASSERT_TRUE(gateway->Subscribe({"rb2110"}));
+
+  ft::UdpMdPublisher publisher;
+  ASSERT_TRUE(publisher.Init("127.0.0.1", 18860));
+  publisher.Publish(MakeTick("rb2110", 1));
+  publisher.Publish(MakeTick("ag2106", 2));
+  publisher.Publish(MakeTick("rb2110", 3));
+  publisher.Flush();
+
+  auto volumes = Collect(2, [&](TickData* tick) { return gateway->GetTickRB()->Get(tick); });
+  ASSERT_EQ(volumes, (std::vector<uint64_t>{1, 3}));
+  gateway->Logout();
+}
+
+TEST_F(MarketGatewayTest, InvalidPort) {
+  ft::GatewayConfig config{};
+  config.api = "market";
+  config.extended_args["md_source"] = "udp";
+  config.extended_args["md_address"] = "127.0.0.1";
+  for (auto* port : {"abc", "18860x", "0", "70000", "99999999999"}) {
+    config.extended_args["md_port"] = port;
+    auto gateway = ft::CreateGateway("market");
+    ASSERT_FALSE(gateway->Init(config));
+  }
+}
+
+class TickRecorder : public ft::OmsInProcessListener {
+ public:
+  void OnTick(uint32_t strategy_idx, const TickData& tick) override {
+    ticks.emplace_back(tick);
+  }
+
+  void OnOrderResponse(uint32_t strategy_idx, const ft::OrderResponse& rsp) override {}
+
+  std::vector<TickData> ticks;
+};
+
+// 交易走stub gateway，行情由market gateway从ft_market的journal读取后交给OMS分发
+TEST_F(MarketGatewayTest, Oms) {
+  LOG_SET_LEVEL("error");
+  ft::FlareTraderConfig config{};
+  config.global_config.contract_file = kContractFile;
+  config.gateway_config = JournalConfig();
+  config.gateway_config.api = "stub";
+  config.gateway_config.md_api = "market";
+  config.gateway_config.investor_id = "1002";
+  ft::StrategyConfig strategy_conf{};
+  strategy_conf.strategy_name = "md";
+  strategy_conf.subscription_list = {"rb2110", "IF2106"};
+  config.strategy_config_list.emplace_back(strategy_conf);
+
+  TickRecorder recorder;
+  ft::OrderManagementSystem oms;
+  ASSERT_TRUE(oms.Init(config, &recorder));
+  WriteTicks();
+
+  std::size_t idx = 0;
+  auto volumes = Collect(2, [&](TickData* tick) {
+    if (idx == recorder.ticks.size()) {
+      oms.PollTicks();
+    }
+    if (idx == recorder.ticks.size()) {
+      return false;
+    }
+    *tick = recorder.ticks[idx++];
+    return true;
+  });
+  ASSERT_EQ(volumes, (std::vector<uint64_t>{1, 3}));
+}
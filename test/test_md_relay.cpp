@@ -0,0 +1,175 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ft/base/contract_table.h"
+#include "ft/component/md_relay.h"
+
+using ft::Contract;
+using ft::ContractTable;
+using ft::MdRelayDecoder;
+using ft::MdRelayHeader;
+using ft::TickData;
+
+bool is_contractable_inited = [] {
+  std::vector<Contract> contracts;
+  contracts.resize(3);
+  contracts[0].ticker = "rb2105";
+  contracts[1].ticker = "rb2110";
+  contracts[2].ticker = "ag2106";
+  return ContractTable::Init(std::move(contracts));
+}();
+
+// 把发出的包保存下来，用于模拟丢包、重复及乱序
+class CapturePublisher : public ft::MdRelayPublisher {
+ public:
+  std::vector<std::string> packets;
+
+ protected:
+  bool SendPacket(const char* data, std::size_t size) override {
+    packets.emplace_back(data, size);
+    return true;
+  }
+};
+
+static TickData MakeTick(uint64_t volume) {
+  TickData tick{};
+  tick.ticker_id = volume % 3 + 1;
+  tick.volume = volume;
+  return tick;
+}
+
+TEST(MdRelay, Decode) {
+  ASSERT_TRUE(is_contractable_inited);
+
+  CapturePublisher publisher;
+  for (uint64_t i = 1; i <= 20; ++i) {
+    publisher.Publish(MakeTick(i));
+  }
+  publisher.Flush();
+  publisher.Flush();  // 空包不会发送
+  ASSERT_EQ(publisher.packets.size(), (20 + ft::kMaxTicksPerMdRelayPacket - 1) /
+                                          ft::kMaxTicksPerMdRelayPacket);
+  ASSERT_EQ(publisher.next_seq(), 21UL);
+
+  MdRelayDecoder decoder;
+  std::vector<uint64_t> volumes;
+  auto handler = [&](const TickData& tick) { volumes.emplace_back(tick.volume); };
+  for (auto& packet : publisher.packets) {
+    ASSERT_TRUE(decoder.Decode(packet.data(), packet.size(), handler));
+  }
+  ASSERT_EQ(volumes.size(), 20UL);
+  for (uint64_t i = 0; i < volumes.size(); ++i) {
+    ASSERT_EQ(volumes[i], i + 1);
+  }
+  ASSERT_EQ(decoder.gap_count(), 0UL);
+  ASSERT_EQ(decoder.next_seq(), 21UL);
+
+  // 非法包
+  auto packet = publisher.packets[0];
+  ASSERT_FALSE(decoder.Decode(packet.data(), packet.size() - 1, handler));
+  reinterpret_cast<MdRelayHeader*>(packet.data())->contract_hash += 1;
+  ASSERT_FALSE(decoder.Decode(packet.data(), packet.size(), handler));
+}
+
+TEST(MdRelay, GapAndDuplicate) {
+  CapturePublisher publisher;
+  for (uint64_t i = 1; i <= ft::kMaxTicksPerMdRelayPacket * 4; ++i) {
+    publisher.Publish(MakeTick(i));
+  }
+  auto& packets = publisher.packets;
+  ASSERT_EQ(packets.size(), 4UL);
+
+  MdRelayDecoder decoder;
+  std::vector<uint64_t> volumes;
+  auto handler = [&](const TickData& tick) { volumes.emplace_back(tick.volume); };
+
+  // 丢失第2个包
+  ASSERT_TRUE(decoder.Decode(packets[0].data(), packets[0].size(), handler));
+  ASSERT_TRUE(decoder.Decode(packets[2].data(), packets[2].size(), handler));
+  ASSERT_EQ(decoder.gap_count(), 1UL);
+  ASSERT_EQ(decoder.lost_ticks(), ft::kMaxTicksPerMdRelayPacket);
+  ASSERT_EQ(volumes.size(), ft::kMaxTicksPerMdRelayPacket * 2);
+
+  // 迟到的第2个包及重复的第3个包都被丢弃
+  ASSERT_TRUE(decoder.Decode(packets[1].data(), packets[1].size(), handler));
+  ASSERT_TRUE(decoder.Decode(packets[2].data(), packets[2].size(), handler));
+  ASSERT_EQ(decoder.dup_ticks(), ft::kMaxTicksPerMdRelayPacket * 2);
+  ASSERT_EQ(volumes.size(), ft::kMaxTicksPerMdRelayPacket * 2);
+
+  ASSERT_TRUE(decoder.Decode(packets[3].data(), packets[3].size(), handler));
+  ASSERT_EQ(volumes.size(), ft::kMaxTicksPerMdRelayPacket * 3);
+  ASSERT_EQ(volumes.back(), ft::kMaxTicksPerMdRelayPacket * 4);
+  ASSERT_EQ(decoder.gap_count(), 1UL);
+
+  // 发布端重启后重新开始计数，不算作丢包
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  CapturePublisher restarted;
+  restarted.Publish(MakeTick(1000));
+  restarted.Flush();
+  ASSERT_TRUE(decoder.Decode(restarted.packets[0].data(), restarted.packets[0].size(), handler));
+  ASSERT_EQ(volumes.back(), 1000UL);
+  ASSERT_EQ(decoder.gap_count(), 1UL);
+}
+
+template <class Publisher, class Receiver>
+static void SendAndReceive(Publisher* publisher, Receiver* receiver, int tick_num) {
+  for (int i = 1; i <= tick_num; ++i) {
+    publisher->Publish(MakeTick(i));
+    if (i % 7 == 0) {
+      publisher->Flush();
+    }
+  }
+  publisher->Flush();
+
+  std::vector<uint64_t> volumes;
+  TickData tick;
+  auto start = std::chrono::steady_clock::now();
+  while (static_cast<int>(volumes.size()) < tick_num &&
+         std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    if (receiver->Poll(&tick)) {
+      volumes.emplace_back(tick.volume);
+    }
+  }
+  ASSERT_EQ(static_cast<int>(volumes.size()), tick_num);
+  for (int i = 0; i < tick_num; ++i) {
+    ASSERT_EQ(volumes[i], static_cast<uint64_t>(i + 1));
+  }
+}
+
+TEST(MdRelay, Udp) {
+  ft::UdpMdReceiver receiver;
+  ASSERT_TRUE(receiver.Init("127.0.0.1", 18850));
+  ft::UdpMdPublisher publisher;
+  ASSERT_TRUE(publisher.Init("127.0.0.1", 18850));
+
+  SendAndReceive(&publisher, &receiver, 1000);
+  ASSERT_EQ(receiver.decoder().gap_count(), 0UL);
+}
+
+TEST(MdRelay, Tcp) {
+  ft::TcpMdPublisher publisher;
+  ASSERT_TRUE(publisher.Init("127.0.0.1", 18851));
+  ft::TcpMdReceiver receiver;
+  ASSERT_TRUE(receiver.Init("127.0.0.1", 18851));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  SendAndReceive(&publisher, &receiver, 1000);
+}
+
+// 发布端晚于接收端启动，接收端在事件循环中定时重连
+TEST(MdRelay, TcpReconnect) {
+  ft::TcpMdReceiver receiver;
+  ASSERT_TRUE(receiver.Init("127.0.0.1", 18852));
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  ft::TcpMdPublisher publisher;
+  ASSERT_TRUE(publisher.Init("127.0.0.1", 18852));
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+
+  SendAndReceive(&publisher, &receiver, 1000);
+}
@@ -1,8 +1,12 @@
 // Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <vector>
 
 #include "ft/base/log.h"
 #include "ft/component/networking.h"
+#include "ft/component/serializable.h"
 #include "gtest/gtest.h"
 
 using ft::NetworkNode;
@@ -133,3 +137,205 @@ TEST(NetworkNode, MultiClients) {
   ASSERT_EQ(kOnRecvMsgCount, 2);
   ASSERT_EQ(kOnDisconnetedCount, 4);
 }
+
+struct BinaryTestMsg {
+  uint64_t seq;
+  uint64_t send_ts;
+  double price[10];
+  int volume[10];
+};
+
+struct SerializedTestMsg : public ft::pubsub::Serializable<SerializedTestMsg> {
+  int value;
+  double price[4];
+
+  SERIALIZABLE_FIELDS(value, price);
+};
+
+static constexpr uint32_t kBinaryTestMsgType = 1;
+static constexpr uint32_t kSerializedTestMsgType = 2;
+static constexpr uint32_t kLargeTestMsgType = 3;
+
+class BinaryTestNode : public NetworkNode {
+ public:
+  void OnConnected(int conn_id) override { ++kOnConnectedCount; }
+  void OnDisconnected(int conn_id) override { ++kOnDisconnetedCount; }
+  void OnRecvMsg(int conn_id, const nlohmann::json& msg) override {
+    ASSERT_EQ(msg["data"], expected_data);
+    ++kOnRecvMsgCount;
+  }
+  void OnRecvMsg(int conn_id, uint32_t msg_type, const char* data, std::size_t size) override {
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(data) % 8, 0UL);
+    if (msg_type == kBinaryTestMsgType) {
+      ASSERT_EQ(size, sizeof(BinaryTestMsg));
+      auto* msg = reinterpret_cast<const BinaryTestMsg*>(data);
+      ASSERT_EQ(msg->seq, static_cast<uint64_t>(kOnRecvMsgCount));
+      ASSERT_DOUBLE_EQ(msg->price[9], 9.0 + msg->seq);
+    } else if (msg_type == kSerializedTestMsgType) {
+      SerializedTestMsg msg;
+      msg.ParseFromString(data, size);
+      ASSERT_EQ(msg.value, kOnRecvMsgCount);
+      ASSERT_DOUBLE_EQ(msg.price[3], 3.0);
+    } else {
+      ASSERT_EQ(msg_type, kLargeTestMsgType);
+      ASSERT_EQ(size, 1UL << 20);
+      ASSERT_EQ(data[size - 1], 'x');
+    }
+    ++kOnRecvMsgCount;
+  }
+};
+
+TEST(NetworkNode, SendBinaryMsg) {
+  kOnConnectedCount = 0;
+  kOnRecvMsgCount = 0;
+  kOnDisconnetedCount = 0;
+
+  int port = 18842;
+
+  BinaryTestNode server;
+  ASSERT_TRUE(server.StartServer(port));
+
+  BinaryTestNode client;
+  int conn_id = client.GenConnId();
+  ASSERT_TRUE(client.StartClient());
+  ASSERT_TRUE(client.Connect(port, conn_id));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  // 二进制消息与json消息可以在同一个连接上混合发送
+  BinaryTestMsg msg{};
+  for (uint64_t i = 0; i < 1000; ++i) {
+    msg.seq = i;
+    msg.price[9] = 9.0 + i;
+    ASSERT_TRUE(client.SendPodMsg(conn_id, kBinaryTestMsgType, msg));
+  }
+  SerializedTestMsg serialized_msg{};
+  serialized_msg.value = 1000;
+  serialized_msg.price[3] = 3.0;
+  ASSERT_TRUE(client.SendSerializedMsg(conn_id, kSerializedTestMsgType, serialized_msg));
+  nlohmann::json json_msg;
+  expected_data = "json";
+  json_msg["data"] = expected_data;
+  ASSERT_TRUE(client.SendMsg(conn_id, json_msg));
+  ASSERT_FALSE(client.SendMsg(conn_id, NetworkNode::kJsonMsgType, &msg, sizeof(msg)));
+
+  // 超过初始接收缓冲区大小的消息
+  std::vector<char> large_msg(1 << 20, 'x');
+  ASSERT_TRUE(client.SendMsg(conn_id, kLargeTestMsgType, large_msg.data(), large_msg.size()));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  client.Disconnect(conn_id);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_EQ(kOnConnectedCount, 2);
+  ASSERT_EQ(kOnRecvMsgCount, 1003);
+  ASSERT_EQ(kOnDisconnetedCount, 2);
+}
+
+static uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static nlohmann::json ToJson(const BinaryTestMsg& msg) {
+  nlohmann::json res;
+  res["seq"] = msg.seq;
+  res["send_ts"] = msg.send_ts;
+  res["price"] = msg.price;
+  res["volume"] = msg.volume;
+  return res;
+}
+
+// 服务端原样回发，客户端统计收到的消息数
+class EchoNode : public NetworkNode {
+ public:
+  explicit EchoNode(bool echo) : echo_(echo) {}
+
+  void OnRecvMsg(int conn_id, const nlohmann::json& msg) override {
+    BinaryTestMsg res{};
+    res.seq = msg["seq"];
+    res.send_ts = msg["send_ts"];
+    for (int i = 0; i < 10; ++i) {
+      res.price[i] = msg["price"][i];
+      res.volume[i] = msg["volume"][i];
+    }
+    if (echo_) {
+      SendMsg(conn_id, ToJson(res));
+    }
+    ++recv_count;
+  }
+
+  void OnRecvMsg(int conn_id, uint32_t msg_type, const char* data, std::size_t size) override {
+    if (echo_) {
+      SendMsg(conn_id, msg_type, data, size);
+    }
+    ++recv_count;
+  }
+
+  std::atomic<int> recv_count{0};
+
+ private:
+  bool echo_;
+};
+
+static void CompareMode(bool binary, int port) {
+  constexpr int kThroughputMsgs = 20000;
+  constexpr int kPingPongMsgs = 2000;
+
+  EchoNode sink(false);
+  ASSERT_TRUE(sink.StartServer(port));
+  EchoNode echo(true);
+  ASSERT_TRUE(echo.StartServer(port + 1));
+  EchoNode client(false);
+  ASSERT_TRUE(client.StartClient());
+  int sink_conn = client.GenConnId();
+  int echo_conn = client.GenConnId();
+  ASSERT_TRUE(client.Connect(port, sink_conn));
+  ASSERT_TRUE(client.Connect(port + 1, echo_conn));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  auto send = [&](int conn_id, const BinaryTestMsg& msg) {
+    if (binary) {
+      return client.SendPodMsg(conn_id, kBinaryTestMsgType, msg);
+    } else {
+      return client.SendMsg(conn_id, ToJson(msg));
+    }
+  };
+
+  // 单向吞吐: 客户端连续发送，服务端收齐所有消息的耗时
+  BinaryTestMsg msg{};
+  auto start = NowNs();
+  for (int i = 0; i < kThroughputMsgs; ++i) {
+    msg.seq = i;
+    ASSERT_TRUE(send(sink_conn, msg));
+  }
+  while (sink.recv_count < kThroughputMsgs && NowNs() - start < 10000000000UL) {
+    std::this_thread::yield();
+  }
+  auto elapsed = NowNs() - start;
+  ASSERT_EQ(sink.recv_count, kThroughputMsgs);
+
+  // 往返延迟: 每次只有一条消息在途
+  std::vector<uint64_t> rtt;
+  rtt.reserve(kPingPongMsgs);
+  for (int i = 0; i < kPingPongMsgs; ++i) {
+    msg.seq = i;
+    msg.send_ts = NowNs();
+    ASSERT_TRUE(send(echo_conn, msg));
+    while (client.recv_count <= i && NowNs() - msg.send_ts < 1000000000UL) {
+      std::this_thread::yield();
+    }
+    ASSERT_GT(client.recv_count, i);
+    rtt.emplace_back(NowNs() - msg.send_ts);
+  }
+  std::sort(rtt.begin(), rtt.end());
+
+  printf("%s mode. throughput: %.0f msgs/s, rtt 50th: %lu ns, 99th: %lu ns\n",
+         binary ? "binary" : "json", kThroughputMsgs * 1e9 / elapsed, rtt[rtt.size() / 2],
+         rtt[rtt.size() * 99 / 100]);
+}
+
+TEST(NetworkNode, CompareJsonAndBinaryMode) {
+  CompareMode(false, 18843);
+  CompareMode(true, 18845);
+}
@@ -2,20 +2,190 @@
 
 #include <gtest/gtest.h>
 
+#include <functional>
+#include <map>
+#include <random>
+#include <vector>
+
 #include "ft/component/order_book/order_book.h"
 
+using ft::TickData;
 using ft::orderbook::LimitOrder;
 using ft::orderbook::OrderBook;
 
 TEST(OrderBook, Case_0) {
   OrderBook order_book(1);
 
-  LimitOrder order_0(0, true, 10, 1.00);
+  LimitOrder order_0(1, true, 10, 1.00);
   order_book.AddOrder(&order_0);
   ASSERT_EQ(nullptr, order_book.best_ask());
   ASSERT_EQ(10, order_book.best_bid()->total_volume());
 
-  LimitOrder order_1(0, false, 13, 1.01);
+  LimitOrder order_1(2, false, 13, 1.01);
   order_book.AddOrder(&order_1);
   ASSERT_EQ(13, order_book.best_ask()->total_volume());
 }
+
+TEST(OrderBook, CancelModifyExecute) {
+  OrderBook order_book(1);
+
+  LimitOrder order(1, true, 10, 10.00);
+  ASSERT_TRUE(order_book.AddOrder(&order));
+  ASSERT_FALSE(order_book.AddOrder(&order));
+  order.set_id(2);
+  order.set_volume(5);
+  ASSERT_TRUE(order_book.AddOrder(&order));
+  order.set_id(3);
+  order.set_price(9.99);
+  ASSERT_TRUE(order_book.AddOrder(&order));
+  ASSERT_EQ(3, order_book.size());
+  ASSERT_DOUBLE_EQ(10.00, order_book.best_bid()->price());
+  ASSERT_EQ(15, order_book.best_bid()->total_volume());
+
+  // 只改数量时保持队列位置
+  order.set_id(1);
+  order.set_volume(4);
+  order.set_price(10.00);
+  ASSERT_TRUE(order_book.ModifyOrder(&order));
+  std::vector<uint64_t> ids;
+  order_book.ForEachOrder(*order_book.best_bid(), [&](auto& o) { ids.emplace_back(o.id()); });
+  ASSERT_EQ(ids, std::vector<uint64_t>({1, 2}));
+  ASSERT_EQ(9, order_book.best_bid()->total_volume());
+
+  // 改价后排到新价位的队尾
+  order.set_id(2);
+  order.set_volume(5);
+  order.set_price(9.99);
+  ASSERT_TRUE(order_book.ModifyOrder(&order));
+  ASSERT_EQ(4, order_book.best_bid()->total_volume());
+
+  ASSERT_TRUE(order_book.ExecuteOrder(1, 3));
+  ASSERT_EQ(1, order_book.FindOrder(1)->volume());
+  ASSERT_EQ(1, order_book.best_bid()->total_volume());
+  ASSERT_TRUE(order_book.ExecuteOrder(1, 1));
+  ASSERT_EQ(nullptr, order_book.FindOrder(1));
+  ASSERT_DOUBLE_EQ(9.99, order_book.best_bid()->price());
+  ASSERT_EQ(10, order_book.best_bid()->total_volume());
+  ids.clear();
+  order_book.ForEachOrder(*order_book.best_bid(), [&](auto& o) { ids.emplace_back(o.id()); });
+  ASSERT_EQ(ids, std::vector<uint64_t>({3, 2}));
+
+  ASSERT_TRUE(order_book.CancelOrder(3));
+  ASSERT_FALSE(order_book.CancelOrder(3));
+  ASSERT_FALSE(order_book.ExecuteOrder(3, 1));
+  ASSERT_TRUE(order_book.RemoveOrder(&order));
+  ASSERT_EQ(0, order_book.size());
+  ASSERT_EQ(nullptr, order_book.best_bid());
+}
+
+TEST(OrderBook, ToTick) {
+  OrderBook order_book(7, 0.01);
+  uint64_t id = 0;
+  for (int i = 0; i < 8; ++i) {
+    LimitOrder bid(++id, true, i + 1, 10.00 - i * 0.02);
+    LimitOrder ask(++id, false, i + 1, 10.01 + i * 0.01);
+    ASSERT_TRUE(order_book.AddOrder(&bid));
+    ASSERT_TRUE(order_book.AddOrder(&ask));
+  }
+
+  TickData tick{};
+  order_book.to_tick(&tick);
+  ASSERT_EQ(7, tick.ticker_id);
+  for (int i = 0; i < ft::kMaxMarketLevel; ++i) {
+    ASSERT_DOUBLE_EQ(10.00 - i * 0.02, tick.bid[i]);
+    ASSERT_EQ(i + 1, tick.bid_volume[i]);
+    ASSERT_DOUBLE_EQ(10.01 + i * 0.01, tick.ask[i]);
+    ASSERT_EQ(i + 1, tick.ask_volume[i]);
+  }
+
+  // 撤掉买一后档位上移，第6档补入
+  ASSERT_TRUE(order_book.CancelOrder(1));
+  order_book.to_tick(&tick);
+  ASSERT_DOUBLE_EQ(9.98, tick.bid[0]);
+  ASSERT_DOUBLE_EQ(9.90, tick.bid[4]);
+  ASSERT_EQ(6, tick.bid_volume[4]);
+
+  // 在档位中间插入新价位
+  LimitOrder bid(++id, true, 100, 9.97);
+  ASSERT_TRUE(order_book.AddOrder(&bid));
+  order_book.to_tick(&tick);
+  ASSERT_DOUBLE_EQ(9.97, tick.bid[1]);
+  ASSERT_EQ(100, tick.bid_volume[1]);
+  ASSERT_DOUBLE_EQ(9.92, tick.bid[4]);
+}
+
+// 与按std::map逐档汇总的结果对比
+TEST(OrderBook, RandomFlow) {
+  OrderBook order_book(1, 0.01, 64);
+  std::map<uint64_t, LimitOrder> orders;
+  std::mt19937_64 rng(42);
+  uint64_t next_id = 0;
+
+  for (int n = 0; n < 50000; ++n) {
+    auto op = rng() % 10;
+    if (op < 5 || orders.empty()) {
+      bool is_buy = rng() % 2;
+      int offset = static_cast<int>(rng() % 400);
+      double price = is_buy ? 20.00 - offset * 0.01 : 20.01 + offset * 0.01;
+      LimitOrder order(++next_id, is_buy, static_cast<int>(rng() % 100) + 1, price);
+      ASSERT_TRUE(order_book.AddOrder(&order));
+      orders.emplace(order.id(), order);
+    } else {
+      auto it = orders.lower_bound(rng() % next_id + 1);
+      if (it == orders.end()) {
+        it = orders.begin();
+      }
+      if (op < 8) {
+        ASSERT_TRUE(order_book.CancelOrder(it->first));
+        orders.erase(it);
+      } else if (op < 9) {
+        int volume = static_cast<int>(rng() % 100) + 1;
+        ASSERT_TRUE(order_book.ExecuteOrder(it->first, volume));
+        if (volume >= it->second.volume()) {
+          orders.erase(it);
+        } else {
+          it->second.set_volume(it->second.volume() - volume);
+        }
+      } else {
+        it->second.set_price(it->second.price() + (it->second.is_buy() ? -0.01 : 0.01));
+        it->second.set_volume(static_cast<int>(rng() % 100) + 1);
+        ASSERT_TRUE(order_book.ModifyOrder(&it->second));
+      }
+    }
+
+    if (n % 97 != 0) {
+      continue;
+    }
+    std::map<int64_t, int, std::greater<int64_t>> bids;
+    std::map<int64_t, int> asks;
+    for (auto& [id, order] : orders) {
+      auto p = std::llround(order.price() * 100);
+      if (order.is_buy()) {
+        bids[p] += order.volume();
+      } else {
+        asks[p] += order.volume();
+      }
+    }
+    TickData tick{};
+    order_book.to_tick(&tick);
+    ASSERT_EQ(orders.size(), order_book.size());
+    auto bid_it = bids.begin();
+    auto ask_it = asks.begin();
+    for (int i = 0; i < ft::kMaxMarketLevel; ++i) {
+      if (bid_it != bids.end()) {
+        ASSERT_EQ(bid_it->first, std::llround(tick.bid[i] * 100));
+        ASSERT_EQ(bid_it->second, tick.bid_volume[i]);
+        ++bid_it;
+      } else {
+        ASSERT_EQ(0, tick.bid_volume[i]);
+      }
+      if (ask_it != asks.end()) {
+        ASSERT_EQ(ask_it->first, std::llround(tick.ask[i] * 100));
+        ASSERT_EQ(ask_it->second, tick.ask_volume[i]);
+        ++ask_it;
+      } else {
+        ASSERT_EQ(0, tick.ask_volume[i]);
+      }
+    }
+  }
+}
@@ -0,0 +1,158 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+
+#include "trader/order_map.h"
+
+static ft::Contract contracts[4]{};
+
+static ft::Order GenOrder(uint64_t order_id) {
+  ft::Order order{};
+  order.req.order_id = order_id;
+  order.req.contract = &contracts[order_id % 4];
+  order.req.direction = order_id % 2 == 0 ? ft::Direction::kBuy : ft::Direction::kSell;
+  order.req.type = ft::OrderType::kLimit;
+  order.req.price = 100.0 + static_cast<double>(order_id % 7);
+  order.req.volume = static_cast<int>(order_id % 100);
+  return order;
+}
+
+static ft::Order GenOrder(uint64_t order_id, uint32_t ticker_id, ft::Direction direction,
+                          ft::OrderType type, double price) {
+  ft::Order order{};
+  order.req.order_id = order_id;
+  contracts[ticker_id].ticker_id = ticker_id;
+  order.req.contract = &contracts[ticker_id];
+  order.req.direction = direction;
+  order.req.type = type;
+  order.req.price = price;
+  return order;
+}
+
+TEST(OrderMap, Basic) {
+  ft::OrderMap order_map(4);
+  ASSERT_EQ(order_map.capacity(), 4UL);
+  ASSERT_TRUE(order_map.empty());
+
+  for (uint64_t i = 1; i <= 4; ++i) {
+    auto* order = order_map.emplace(GenOrder(i));
+    ASSERT_NE(order, nullptr);
+    ASSERT_EQ(order->req.order_id, i);
+  }
+  ASSERT_TRUE(order_map.full());
+  ASSERT_EQ(order_map.emplace(GenOrder(5)), nullptr);
+
+  ASSERT_TRUE(order_map.erase(2));
+  ASSERT_FALSE(order_map.erase(2));
+  ASSERT_EQ(order_map.find(2), nullptr);
+  ASSERT_EQ(order_map.emplace(GenOrder(3)), nullptr);
+
+  auto* order = order_map.emplace(GenOrder(5));
+  ASSERT_NE(order, nullptr);
+  ASSERT_EQ(order_map.find(5), order);
+
+  order_map.erase(order_map.find(1));
+  ASSERT_EQ(order_map.size(), 3UL);
+
+  uint64_t sum = 0;
+  for (auto& o : order_map) {
+    sum += o.req.order_id;
+  }
+  ASSERT_EQ(sum, 3UL + 4UL + 5UL);
+}
+
+TEST(OrderMap, PendingSide) {
+  using ft::Direction;
+  using ft::OrderType;
+
+  // 挂单索引预先分配，pending_side返回的引用在插入订单后仍然有效
+  ft::OrderMap order_map(ft::OrderMap::kDefaultCapacity, 3);
+  ASSERT_EQ(order_map.pending_side(1, Direction::kBuy).count, 0U);
+
+  order_map.emplace(GenOrder(1, 1, Direction::kBuy, OrderType::kLimit, 100.0));
+  order_map.emplace(GenOrder(2, 1, Direction::kBuy, OrderType::kLimit, 101.0));
+  order_map.emplace(GenOrder(3, 1, Direction::kBuy, OrderType::kLimit, 99.0));
+  order_map.emplace(GenOrder(4, 1, Direction::kSell, OrderType::kLimit, 103.0));
+  order_map.emplace(GenOrder(5, 1, Direction::kSell, OrderType::kLimit, 102.0));
+  order_map.emplace(GenOrder(6, 2, Direction::kSell, OrderType::kLimit, 90.0));
+
+  auto& buy = order_map.pending_side(1, Direction::kBuy);
+  auto& sell = order_map.pending_side(1, Direction::kSell);
+  ASSERT_EQ(buy.count, 3U);
+  ASSERT_DOUBLE_EQ(buy.best_price, 101.0);
+  ASSERT_EQ(sell.count, 2U);
+  ASSERT_DOUBLE_EQ(sell.best_price, 102.0);
+
+  order_map.erase(2);
+  ASSERT_EQ(buy.count, 2U);
+  ASSERT_DOUBLE_EQ(buy.best_price, 100.0);
+  order_map.erase(5);
+  ASSERT_DOUBLE_EQ(sell.best_price, 103.0);
+
+  order_map.emplace(GenOrder(7, 1, Direction::kBuy, OrderType::kMarket, 0.0));
+  ASSERT_EQ(buy.count, 3U);
+  ASSERT_EQ(buy.market_count, 1U);
+  ASSERT_DOUBLE_EQ(buy.best_price, 100.0);
+  order_map.erase(7);
+  ASSERT_EQ(buy.market_count, 0U);
+
+  uint64_t sum = 0;
+  order_map.for_each_pending(1, [&](const ft::Order& order) { sum += order.req.order_id; });
+  ASSERT_EQ(sum, 1UL + 3UL + 4UL);
+
+  order_map.erase(1);
+  order_map.erase(3);
+  order_map.erase(4);
+  ASSERT_EQ(buy.count, 0U);
+  ASSERT_EQ(sell.count, 0U);
+  ASSERT_EQ(order_map.pending_side(2, Direction::kSell).count, 1U);
+}
+
+TEST(OrderMap, MaxTickerId) {
+  using ft::Direction;
+  using ft::OrderType;
+
+  ft::OrderMap order_map(16, 2);
+  ASSERT_NE(order_map.emplace(GenOrder(1, 2, Direction::kBuy, OrderType::kLimit, 100.0)), nullptr);
+  ASSERT_EQ(order_map.emplace(GenOrder(2, 3, Direction::kBuy, OrderType::kLimit, 100.0)), nullptr);
+  ASSERT_EQ(order_map.pending_side(3, Direction::kBuy).count, 0U);
+  ASSERT_EQ(order_map.size(), 1UL);
+
+  ASSERT_FALSE(order_map.init_tickers(3));
+  order_map.erase(1);
+  ASSERT_TRUE(order_map.init_tickers(3));
+  ASSERT_NE(order_map.emplace(GenOrder(2, 3, Direction::kBuy, OrderType::kLimit, 100.0)), nullptr);
+  ASSERT_EQ(order_map.pending_side(3, Direction::kBuy).count, 1U);
+}
+
+TEST(OrderMap, Random) {
+  ft::OrderMap order_map(1024);
+  std::map<uint64_t, int> expected;
+  std::mt19937 rng(0);
+  uint64_t next_id = 1;
+
+  for (int i = 0; i < 200000; ++i) {
+    if (!order_map.full() && (expected.empty() || rng() % 2 == 0)) {
+      auto order = GenOrder(next_id++);
+      ASSERT_NE(order_map.emplace(order), nullptr);
+      expected.emplace(order.req.order_id, order.req.volume);
+    } else {
+      auto it = expected.begin();
+      std::advance(it, rng() % expected.size());
+      ASSERT_TRUE(order_map.erase(it->first));
+      expected.erase(it);
+    }
+
+    if (i % 1000 == 0) {
+      ASSERT_EQ(order_map.size(), expected.size());
+      for (auto& [order_id, volume] : expected) {
+        auto* order = order_map.find(order_id);
+        ASSERT_NE(order, nullptr);
+        ASSERT_EQ(order->req.volume, volume);
+      }
+    }
+  }
+}
@@ -0,0 +1,127 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ft/base/contract_table.h"
+#include "ft/component/position_cache.h"
+
+using ft::Contract;
+using ft::ContractTable;
+using ft::Position;
+using ft::PositionCache;
+
+bool is_contractable_inited = [] {
+  std::vector<Contract> contracts;
+  contracts.resize(3);
+  contracts[0].ticker = "rb2105";
+  contracts[1].ticker = "rb2110";
+  contracts[2].ticker = "ag2106";
+  return ContractTable::Init(std::move(contracts));
+}();
+
+TEST(PositionCache, Basic) {
+  ASSERT_TRUE(is_contractable_inited);
+
+  PositionCache writer;
+  ASSERT_TRUE(writer.Create("test_position_cache", {"common", "s1", "s2"}, 3));
+  PositionCache reader;
+  ASSERT_TRUE(reader.Open("test_position_cache"));
+  ASSERT_EQ(reader.strategy_num(), 3U);
+  ASSERT_EQ(reader.ticker_num(), 3U);
+
+  // 还没有写入的持仓为空
+  Position pos{};
+  ASSERT_TRUE(reader.GetPosition("s1", "rb2110", &pos));
+  ASSERT_EQ(pos.ticker_id, 2U);
+  ASSERT_EQ(pos.long_pos.holdings, 0);
+  ASSERT_FALSE(reader.GetPosition("s3", "rb2110", &pos));
+  ASSERT_FALSE(reader.GetPosition("s1", "unknown", &pos));
+
+  pos = Position{};
+  pos.ticker_id = 2;
+  pos.long_pos.holdings = 10;
+  pos.short_pos.yd_holdings = 3;
+  ASSERT_TRUE(writer.SetPosition("s1", pos));
+  ASSERT_FALSE(writer.SetPosition("s3", pos));
+  ASSERT_FALSE(reader.SetPosition("s1", pos));
+  pos.ticker_id = 4;
+  ASSERT_FALSE(writer.SetPosition("s1", pos));
+
+  Position res{};
+  ASSERT_TRUE(reader.GetPosition("s1", "rb2110", &res));
+  ASSERT_EQ(res.ticker_id, 2U);
+  ASSERT_EQ(res.long_pos.holdings, 10);
+  ASSERT_EQ(res.short_pos.yd_holdings, 3);
+  ASSERT_TRUE(reader.GetPosition("s2", "rb2110", &res));
+  ASSERT_EQ(res.long_pos.holdings, 0);
+
+  uint32_t strategy_idx;
+  ASSERT_TRUE(reader.FindStrategy("s1", &strategy_idx));
+  ASSERT_EQ(strategy_idx, 1U);
+  ASSERT_TRUE(reader.GetPosition(strategy_idx, 2, &res));
+  ASSERT_EQ(res.long_pos.holdings, 10);
+
+  std::vector<Position> all;
+  ASSERT_TRUE(reader.GetAllPositions("s1", &all));
+  ASSERT_EQ(all.size(), 1UL);
+  ASSERT_EQ(all[0].ticker_id, 2U);
+  all.clear();
+  ASSERT_TRUE(reader.GetAllPositions("s2", &all));
+  ASSERT_TRUE(all.empty());
+
+  ft::Account account{};
+  ASSERT_FALSE(reader.GetAccount(&account));
+  account.account_id = 1234;
+  account.cash = 1e6;
+  ASSERT_TRUE(writer.SetAccount(account));
+  ft::Account account_res{};
+  ASSERT_TRUE(reader.GetAccount(&account_res));
+  ASSERT_EQ(account_res.account_id, 1234UL);
+  ASSERT_DOUBLE_EQ(account_res.cash, 1e6);
+
+  int ret = system("rm -f ft_position_cache.test_position_cache");
+  (void)ret;
+}
+
+TEST(PositionCache, Consistency) {
+  PositionCache writer;
+  ASSERT_TRUE(writer.Create("test_position_cache_mt", {"s1"}, 1));
+  PositionCache reader;
+  ASSERT_TRUE(reader.Open("test_position_cache_mt"));
+
+  // 写端每次写入的各字段都相同，读端读到的持仓各字段必须一致
+  std::atomic<bool> running = true;
+  std::thread writer_thread([&] {
+    Position pos{};
+    pos.ticker_id = 1;
+    for (int i = 1; i <= 200000; ++i) {
+      pos.long_pos.holdings = pos.long_pos.frozen = pos.short_pos.holdings = i;
+      pos.long_pos.cost_price = pos.short_pos.cost_price = i;
+      writer.SetPosition(0, pos);
+    }
+    running = false;
+  });
+
+  int last_holdings = 0;
+  Position pos{};
+  while (running) {
+    ASSERT_TRUE(reader.GetPosition(0, 1, &pos));
+    ASSERT_EQ(pos.long_pos.frozen, pos.long_pos.holdings);
+    ASSERT_EQ(pos.short_pos.holdings, pos.long_pos.holdings);
+    ASSERT_DOUBLE_EQ(pos.long_pos.cost_price, pos.long_pos.holdings);
+    ASSERT_DOUBLE_EQ(pos.short_pos.cost_price, pos.long_pos.holdings);
+    ASSERT_GE(pos.long_pos.holdings, last_holdings);
+    last_holdings = pos.long_pos.holdings;
+  }
+  writer_thread.join();
+  ASSERT_TRUE(reader.GetPosition(0, 1, &pos));
+  ASSERT_EQ(pos.long_pos.holdings, 200000);
+
+  int ret = system("rm -f ft_position_cache.test_position_cache_mt");
+  (void)ret;
+}
@@ -0,0 +1,97 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "trader/risk/risk_chain.h"
+
+static std::vector<std::string> calls;
+
+class CheckOnlyRule final : public ft::RiskRule {
+ public:
+  explicit CheckOnlyRule(ft::ErrorCode error_code = ft::ErrorCode::kNoError)
+      : error_code_(error_code) {}
+
+  uint32_t GetHooks() const override { return ft::kRiskCheckOrderRequest; }
+
+  ft::ErrorCode CheckOrderRequest(const ft::Order& order) override {
+    calls.emplace_back("check_only.check");
+    return error_code_;
+  }
+
+  // 未声明，不会被调用
+  void OnOrderSent(const ft::Order& order) override { calls.emplace_back("check_only.sent"); }
+
+ private:
+  ft::ErrorCode error_code_;
+};
+
+class SentOnlyRule final : public ft::RiskRule {
+ public:
+  uint32_t GetHooks() const override { return ft::kRiskOnOrderSent; }
+
+  void OnOrderSent(const ft::Order& order) override { calls.emplace_back("sent_only.sent"); }
+};
+
+// 插件规则，通过虚函数调用
+class PluginRule : public ft::RiskRule {
+ public:
+  ft::ErrorCode CheckOrderRequest(const ft::Order& order) override {
+    calls.emplace_back("plugin.check");
+    return ft::ErrorCode::kNoError;
+  }
+
+  ft::ErrorCode CheckCancelReq(const ft::Order& order) override {
+    calls.emplace_back("plugin.cancel");
+    return ft::ErrorCode::kExceedThrottleRateRisk;
+  }
+
+  void OnOrderSent(const ft::Order& order) override { calls.emplace_back("plugin.sent"); }
+};
+
+using TestChain = ft::RiskChain<CheckOnlyRule, SentOnlyRule>;
+
+TEST(RiskChain, Hooks) {
+  CheckOnlyRule check_only;
+  SentOnlyRule sent_only;
+  PluginRule plugin;
+
+  TestChain chain;
+  chain.Add(&plugin);
+  chain.Add(&check_only);
+  chain.Add(&sent_only);
+  ASSERT_EQ(2UL, chain.size(ft::kRiskCheckOrderRequest));
+  ASSERT_EQ(2UL, chain.size(ft::kRiskOnOrderSent));
+  ASSERT_EQ(1UL, chain.size(ft::kRiskOnOrderCompleted));
+
+  ft::Order order{};
+  calls.clear();
+  ASSERT_EQ(ft::ErrorCode::kNoError, chain.CheckOrderRequest(order));
+  chain.OnOrderSent(order);
+  chain.OnOrderCompleted(order);
+  ASSERT_EQ(ft::ErrorCode::kExceedThrottleRateRisk, chain.CheckCancelReq(order));
+  std::vector<std::string> expected{"plugin.check", "check_only.check", "plugin.sent",
+                                    "sent_only.sent", "plugin.cancel"};
+  ASSERT_EQ(expected, calls);
+}
+
+TEST(RiskChain, StopOnError) {
+  CheckOnlyRule reject(ft::ErrorCode::kSelfTrade);
+  PluginRule plugin;
+
+  TestChain chain;
+  chain.Add(&reject);
+  chain.Add(&plugin);
+
+  ft::Order order{};
+  calls.clear();
+  ASSERT_EQ(ft::ErrorCode::kSelfTrade, chain.CheckOrderRequest(order));
+  ASSERT_EQ(std::vector<std::string>{"check_only.check"}, calls);
+
+  chain.Clear();
+  calls.clear();
+  ASSERT_EQ(ft::ErrorCode::kNoError, chain.CheckOrderRequest(order));
+  ASSERT_TRUE(calls.empty());
+}
@@ -37,7 +37,7 @@ TEST(RMS, NoSelfTrade) {
   rule.Init(&params);
 
   GenLO(&order, ft::Direction::kBuy, ft::Offset::kOpen, 100.1);
-  order_map.emplace(static_cast<uint64_t>(order.req.order_id), order);
+  order_map.emplace(order);
 
   GenLO(&order, ft::Direction::kBuy, ft::Offset::kOpen, 100.1);
   ASSERT_EQ(ft::ErrorCode::kNoError, rule.CheckOrderRequest(order));
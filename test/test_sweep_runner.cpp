@@ -0,0 +1,269 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "backtest/sweep_runner.h"
+#include "ft/base/contract_table.h"
+#include "ft/strategy/algo_order/target_pos_engine.h"
+#include "trader/gateway/backtest/data_feed/tick_file.h"
+
+using ft::Contract;
+using ft::ContractTable;
+using ft::TickData;
+
+static constexpr int kTickNum = 100;
+static constexpr int kContractSize = 10;
+
+bool is_contractable_inited = [] {
+  std::vector<Contract> contracts;
+  contracts.resize(2);
+  contracts[0].ticker = "rb2110";
+  contracts[0].size = kContractSize;
+  contracts[1].ticker = "ag2106";
+  contracts[1].size = kContractSize;
+  return ContractTable::Init(std::move(contracts));
+}();
+
+static std::atomic<int> position_mismatches = 0;
+
+// 在第buy_at个rb2110的tick以对手价买入volume手，之后一直持有
+class BuyAndHoldStrategy : public ft::Strategy {
+ public:
+  void OnInit() override {
+    buy_at_ = std::stoi(GetParam("buy_at", "0"));
+    volume_ = std::stoi(GetParam("volume", "1"));
+  }
+
+  void OnTick(const TickData& tick) override {
+    if (tick.ticker_id != 1) {
+      return;
+    }
+    if (tick_count_++ == buy_at_) {
+      BuyOpen("rb2110", volume_, tick.ask[0]);
+    }
+  }
+
+  void OnExit() override {
+    if (GetPosition("rb2110").long_pos.holdings != volume_) {
+      ++position_mismatches;
+    }
+  }
+
+ private:
+  int buy_at_ = 0;
+  int volume_ = 0;
+  int tick_count_ = 0;
+};
+
+static ft::StrategyRunner* CreateBuyAndHold() { return new BuyAndHoldStrategy; }
+
+// 先直接买入2手，成交后再注册TargetPosEngine把仓位调整到target
+// TargetPosEngine初始化时需读到已有的2手，否则会再买入target手
+class TargetPosStrategy : public ft::Strategy {
+ public:
+  void OnInit() override { target_ = std::stoi(GetParam("target", "3")); }
+
+  void OnTick(const TickData& tick) override {
+    if (tick.ticker_id != 1) {
+      return;
+    }
+    ++tick_count_;
+    if (tick_count_ == 1) {
+      BuyOpen("rb2110", 2, tick.ask[0]);
+    } else if (tick_count_ == 10) {
+      engine_ = std::make_unique<ft::TargetPosEngine>(1);
+      RegisterAlgoOrderEngine(engine_.get());
+      engine_->SetTargetPos(target_);
+    }
+  }
+
+  void OnExit() override {
+    auto pos = GetPosition("rb2110");
+    if (pos.long_pos.holdings - pos.short_pos.holdings != target_) {
+      ++position_mismatches;
+    }
+  }
+
+ private:
+  int target_ = 0;
+  int tick_count_ = 0;
+  std::unique_ptr<ft::TargetPosEngine> engine_;
+};
+
+static ft::StrategyRunner* CreateTargetPos() { return new TargetPosStrategy; }
+
+// rb2110的价格从100开始每个tick上涨1，ag2106的tick穿插其中
+static std::string GenerateTickFile() {
+  std::string file = "test_sweep_runner.ftick";
+  ft::TickFileWriter writer;
+  EXPECT_TRUE(writer.Open(file, 16));
+  for (int i = 0; i < kTickNum; ++i) {
+    for (uint32_t ticker_id : {1U, 2U}) {
+      TickData tick{};
+      tick.ticker_id = ticker_id;
+      tick.local_timestamp_us = 1000000 + i;
+      tick.exchange_timestamp_us = 1000000 + i;
+      tick.last_price = ticker_id == 1 ? 100.0 + i : 5000.0 - i;
+      for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+        tick.ask[level] = tick.last_price + level + 1;
+        tick.bid[level] = tick.last_price - level - 1;
+        tick.ask_volume[level] = 100;
+        tick.bid_volume[level] = 100;
+      }
+      EXPECT_TRUE(writer.Write(tick));
+    }
+  }
+  EXPECT_TRUE(writer.Close());
+  return file;
+}
+
+static ft::FlareTraderConfig MakeConfig(const std::string& tick_file) {
+  ft::FlareTraderConfig config{};
+  config.gateway_config.api = "backtest";
+  config.gateway_config.extended_args["data_feed"] = "ft.data_feed.tick_file";
+  config.gateway_config.extended_args["data_file"] = tick_file;
+
+  ft::StrategyConfig strategy_conf{};
+  strategy_conf.strategy_name = "buy_and_hold";
+  strategy_conf.subscription_list = {"rb2110"};
+  strategy_conf.params["volume"] = "5";
+  config.strategy_config_list.emplace_back(strategy_conf);
+  // 策略的仓位由ft.risk.position维护
+  config.rms_config.risk_conf_list.push_back({"ft.risk.fund", {}});
+  config.rms_config.risk_conf_list.push_back({"ft.risk.position", {}});
+  return config;
+}
+
+TEST(SweepRunner, ParamGrid) {
+  auto tick_file = GenerateTickFile();
+  ft::SweepRunner runner;
+  ASSERT_TRUE(runner.Init(MakeConfig(tick_file), "buy_and_hold", CreateBuyAndHold));
+  ASSERT_EQ(runner.ticks().size(), kTickNum * 2);
+
+  ft::ParamGrid grid{{"buy_at", {"10", "50", "90"}}, {"volume", {"1", "2"}}};
+  ASSERT_EQ(runner.SetParamGrid(grid), 6);
+  runner.Run(2);
+
+  auto& results = runner.results();
+  ASSERT_EQ(results.size(), 6);
+  for (auto& result : results) {
+    ASSERT_TRUE(result.ok);
+    int buy_at = std::stoi(result.params.at("buy_at"));
+    int volume = std::stoi(result.params.at("volume"));
+    // 以100+buy_at+1买入，最后按100+kTickNum-1盯市，买入时按最新价盯市先亏1个点
+    ASSERT_DOUBLE_EQ(result.pnl, volume * kContractSize * (kTickNum - 2 - buy_at));
+    ASSERT_DOUBLE_EQ(result.max_drawdown, volume * kContractSize);
+    ASSERT_EQ(result.orders, 1);
+    ASSERT_EQ(result.trades, 1);
+    ASSERT_EQ(result.traded_volume, volume);
+    ASSERT_EQ(result.ticks, kTickNum * 2);
+  }
+  ASSERT_EQ(results[0].params.at("buy_at"), "10");
+  ASSERT_EQ(results[0].params.at("volume"), "1");
+  ASSERT_EQ(results[5].params.at("buy_at"), "90");
+  ASSERT_EQ(results[5].params.at("volume"), "2");
+  ASSERT_EQ(position_mismatches, 0);
+
+  remove(tick_file.c_str());
+}
+
+TEST(SweepRunner, DefaultParams) {
+  auto tick_file = GenerateTickFile();
+  ft::SweepRunner runner;
+  ASSERT_TRUE(runner.Init(MakeConfig(tick_file), "buy_and_hold", CreateBuyAndHold));
+
+  // 不在网格中的参数使用配置中的params
+  ASSERT_EQ(runner.SetParamGrid({{"buy_at", {"0"}}}), 1);
+  runner.Run(0);
+  ASSERT_TRUE(runner.results()[0].ok);
+  ASSERT_EQ(runner.results()[0].traded_volume, 5);
+  ASSERT_DOUBLE_EQ(runner.results()[0].pnl, 5 * kContractSize * (kTickNum - 2));
+
+  remove(tick_file.c_str());
+}
+
+TEST(SweepRunner, Commission) {
+  auto tick_file = GenerateTickFile();
+  auto config = MakeConfig(tick_file);
+  config.gateway_config.extended_args["commission_rate"] = "0.001";
+  ft::SweepRunner runner;
+  ASSERT_TRUE(runner.Init(config, "buy_and_hold", CreateBuyAndHold));
+
+  ASSERT_EQ(runner.SetParamGrid({{"buy_at", {"0"}}}), 1);
+  runner.Run(1);
+  ASSERT_TRUE(runner.results()[0].ok);
+  // 以101买入5手，手续费按成交金额计算
+  double commission = 5 * kContractSize * 101.0 * 0.001;
+  // 盈亏由1亿的资金相减得到，有舍入误差
+  ASSERT_NEAR(runner.results()[0].pnl, 5 * kContractSize * (kTickNum - 2) - commission, 1e-6);
+  ASSERT_NEAR(runner.results()[0].max_drawdown, 5 * kContractSize + commission, 1e-6);
+
+  remove(tick_file.c_str());
+}
+
+TEST(SweepRunner, TargetPosEngine) {
+  auto tick_file = GenerateTickFile();
+  auto config = MakeConfig(tick_file);
+  config.strategy_config_list[0].strategy_name = "target_pos";
+  ft::SweepRunner runner;
+  ASSERT_TRUE(runner.Init(config, "target_pos", CreateTargetPos));
+
+  position_mismatches = 0;
+  ASSERT_EQ(runner.SetParamGrid({{"target", {"3", "1", "-1"}}}), 3);
+  runner.Run(0);
+
+  // 3: 再买1手; 1: 平1手; -1: 平2手再开空1手
+  auto& results = runner.results();
+  ASSERT_EQ(results.size(), 3);
+  for (auto& result : results) {
+    ASSERT_TRUE(result.ok);
+  }
+  ASSERT_EQ(results[0].traded_volume, 3);
+  ASSERT_EQ(results[1].traded_volume, 3);
+  ASSERT_EQ(results[2].traded_volume, 5);
+  ASSERT_EQ(position_mismatches, 0);
+
+  remove(tick_file.c_str());
+}
+
+TEST(SweepRunner, LoadConfig) {
+  std::string file = "test_sweep_runner.yml";
+  FILE* fp = fopen(file.c_str(), "w");
+  ASSERT_TRUE(fp);
+  fprintf(fp,
+          "config: ft_config.yml\n"
+          "strategy: ./libbuy_and_hold.so\n"
+          "name: buy_and_hold\n"
+          "threads: 4\n"
+          "params:\n"
+          "  volume: [1, 2]\n"
+          "  buy_at: {from: 10, to: 30, step: 10}\n"
+          "  threshold: {from: 0.5, to: 1.0, step: 0.25}\n"
+          "  mode: fast\n");
+  fclose(fp);
+
+  ft::SweepConfig config;
+  ASSERT_TRUE(config.Load(file));
+  ASSERT_EQ(config.config_file, "ft_config.yml");
+  ASSERT_EQ(config.strategy_file, "./libbuy_and_hold.so");
+  ASSERT_EQ(config.strategy_name, "buy_and_hold");
+  ASSERT_EQ(config.threads, 4);
+  ASSERT_TRUE(config.output.empty());
+  ASSERT_EQ(config.param_grid.size(), 4);
+  ASSERT_EQ(config.param_grid[0].first, "volume");
+  ASSERT_EQ(config.param_grid[0].second, (std::vector<std::string>{"1", "2"}));
+  ASSERT_EQ(config.param_grid[1].first, "buy_at");
+  ASSERT_EQ(config.param_grid[1].second, (std::vector<std::string>{"10", "20", "30"}));
+  ASSERT_EQ(config.param_grid[2].first, "threshold");
+  ASSERT_EQ(config.param_grid[2].second, (std::vector<std::string>{"0.5", "0.75", "1"}));
+  ASSERT_EQ(config.param_grid[3].first, "mode");
+  ASSERT_EQ(config.param_grid[3].second, (std::vector<std::string>{"fast"}));
+
+  remove(file.c_str());
+}
@@ -0,0 +1,140 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "ft/base/contract_table.h"
+#include "trader/risk/common/throttle_rate_risk.h"
+
+class ThrottleRateRiskTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!ft::ContractTable::is_inited()) {
+      std::vector<ft::Contract> contracts(3);
+      contracts[0].ticker = "rb2105";
+      contracts[0].exchange = "SHFE";
+      contracts[1].ticker = "ag2106";
+      contracts[1].exchange = "SHFE";
+      contracts[2].ticker = "IF2103";
+      contracts[2].exchange = "CFFEX";
+      ASSERT_TRUE(ft::ContractTable::Init(std::move(contracts)));
+    }
+    strategy_table_.Intern("s0");
+    strategy_table_.Intern("s1");
+  }
+
+  bool Init(const std::map<std::string, std::string>& options,
+            const uint64_t* md_time_us = nullptr) {
+    config_.risk_conf_list.emplace_back(ft::RiskConfig{"ft.risk.throttle_rate", options});
+    ft::RiskRuleParams params{};
+    params.config = &config_;
+    params.strategy_table = &strategy_table_;
+    params.md_time_us = md_time_us;
+    return rule_.Init(&params);
+  }
+
+  // 检查通过后模拟发出
+  ft::ErrorCode Send(const char* ticker, uint32_t strategy_id = 0) {
+    ft::Order order{};
+    order.req.contract = ft::ContractTable::get_by_ticker(ticker);
+    order.strategy_id = strategy_id;
+    auto error_code = rule_.CheckOrderRequest(order);
+    if (error_code == ft::ErrorCode::kNoError) {
+      rule_.OnOrderSent(order);
+    }
+    return error_code;
+  }
+
+  ft::RmsConfig config_;
+  ft::StrategyTable strategy_table_;
+  ft::ThrottleRateRisk rule_;
+};
+
+TEST_F(ThrottleRateRiskTest, Account) {
+  ASSERT_TRUE(Init({{"order_limit", "3"}, {"period_ms", "200"}}));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("rb2105"));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("ag2106"));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("IF2103", 1));
+  ASSERT_EQ(ft::ErrorCode::kExceedThrottleRateRisk, Send("rb2105"));
+  ASSERT_EQ(ft::ErrorCode::kExceedThrottleRateRisk, Send("IF2103", 1));
+
+  // 窗口滑过后恢复
+  std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("rb2105"));
+}
+
+TEST_F(ThrottleRateRiskTest, Scopes) {
+  ASSERT_TRUE(Init({{"ticker_order_limit", "2"},
+                    {"ticker_period_ms", "60000"},
+                    {"exchange_order_limit", "3"},
+                    {"exchange_period_ms", "60000"},
+                    {"strategy_order_limit", "4"},
+                    {"strategy_period_ms", "60000"}}));
+
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("rb2105"));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("rb2105"));
+  // 合约限制
+  ASSERT_EQ(ft::ErrorCode::kExceedThrottleRateRisk, Send("rb2105"));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("ag2106"));
+  // 交易所限制，SHFE已有3笔
+  ASSERT_EQ(ft::ErrorCode::kExceedThrottleRateRisk, Send("ag2106"));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("IF2103"));
+  // 策略限制，s0已有4笔
+  ASSERT_EQ(ft::ErrorCode::kExceedThrottleRateRisk, Send("IF2103"));
+  // 其他策略不受影响，但IF2103已有2笔
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("IF2103", 1));
+  ASSERT_EQ(ft::ErrorCode::kExceedThrottleRateRisk, Send("IF2103", 1));
+}
+
+TEST_F(ThrottleRateRiskTest, WithoutCheck) {
+  ASSERT_TRUE(Init({{"order_limit", "2"}, {"period_ms", "60000"}}));
+  // 绕过风控的订单不经过检查，但同样占用流控额度
+  ft::Order order{};
+  order.req.contract = ft::ContractTable::get_by_ticker("rb2105");
+  rule_.OnOrderSent(order);
+  rule_.OnOrderSent(order);
+  ASSERT_EQ(ft::ErrorCode::kExceedThrottleRateRisk, Send("rb2105"));
+}
+
+TEST_F(ThrottleRateRiskTest, RejectedAfterCheck) {
+  ASSERT_TRUE(Init({{"order_limit", "1"}, {"period_ms", "100"}}));
+  // 检查通过后被其他规则或Gateway拒绝，没有发出
+  ft::Order order{};
+  order.req.contract = ft::ContractTable::get_by_ticker("rb2105");
+  ASSERT_EQ(ft::ErrorCode::kNoError, rule_.CheckOrderRequest(order));
+
+  // 之后发出的订单以发出的时间计入，不能沿用上次检查的时间而提前滑出窗口
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  rule_.OnOrderSent(order);
+  ASSERT_EQ(ft::ErrorCode::kExceedThrottleRateRisk, Send("rb2105"));
+}
+
+TEST_F(ThrottleRateRiskTest, MdTime) {
+  // 进程内回测时按行情时间计算窗口，与回放的快慢无关
+  uint64_t md_time_us = 1000000;
+  ASSERT_TRUE(Init({{"order_limit", "2"}, {"period_ms", "100"}}, &md_time_us));
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("rb2105"));
+  md_time_us += 50000;
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("rb2105"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  ASSERT_EQ(ft::ErrorCode::kExceedThrottleRateRisk, Send("rb2105"));
+
+  // 第一笔滑出窗口
+  md_time_us += 50000;
+  ASSERT_EQ(ft::ErrorCode::kNoError, Send("rb2105"));
+  ASSERT_EQ(ft::ErrorCode::kExceedThrottleRateRisk, Send("rb2105"));
+}
+
+TEST_F(ThrottleRateRiskTest, Options) {
+  ASSERT_FALSE(Init({{"ticker_order_limt", "2"}}));
+
+  // 只配置了一半的不限制
+  config_.risk_conf_list.clear();
+  ASSERT_TRUE(Init({{"order_limit", "1"}}));
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(ft::ErrorCode::kNoError, Send("rb2105"));
+  }
+}
@@ -0,0 +1,231 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ft/base/contract_table.h"
+#include "trader/gateway/backtest/data_feed/data_feed.h"
+#include "trader/gateway/backtest/data_feed/tick_file.h"
+
+using ft::Contract;
+using ft::ContractTable;
+using ft::TickData;
+
+bool is_contractable_inited = [] {
+  std::vector<Contract> contracts;
+  contracts.resize(3);
+  contracts[0].ticker = "rb2105";
+  contracts[1].ticker = "rb2110";
+  contracts[2].ticker = "ag2106";
+  return ContractTable::Init(std::move(contracts));
+}();
+
+static TickData MakeTick(uint64_t i) {
+  TickData tick{};
+  tick.source = ft::MarketDataSource::kCTP;
+  tick.ticker_id = static_cast<uint32_t>(i % 3) + 1;
+  tick.local_timestamp_us = 1000000 + i;
+  tick.exchange_timestamp_us = 2000000 + i;
+  tick.last_price = 100.0 + i * 0.5;
+  tick.open_price = 1.0;
+  tick.highest_price = 2.0;
+  // 不能以整数精确表示的价格，所在block的该列按double原样存放
+  tick.lowest_price = i % 100 == 7 ? 1.0 / 3 : 3.0;
+  tick.pre_close_price = 4.0;
+  tick.upper_limit_price = 5.0;
+  tick.lower_limit_price = 6.0;
+  tick.volume = i;
+  tick.turnover = i * 10;
+  tick.open_interest = i * 100;
+  for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+    tick.ask[level] = tick.last_price + level + 1;
+    tick.bid[level] = tick.last_price - level - 1;
+    tick.ask_volume[level] = static_cast<int>(i + level);
+    tick.bid_volume[level] = static_cast<int>(i * 2 + level);
+  }
+  return tick;
+}
+
+static void ExpectTickEq(const TickData& a, const TickData& b) {
+  ASSERT_EQ(a.source, b.source);
+  ASSERT_EQ(a.ticker_id, b.ticker_id);
+  ASSERT_EQ(a.local_timestamp_us, b.local_timestamp_us);
+  ASSERT_EQ(a.exchange_timestamp_us, b.exchange_timestamp_us);
+  ASSERT_DOUBLE_EQ(a.last_price, b.last_price);
+  ASSERT_DOUBLE_EQ(a.open_price, b.open_price);
+  ASSERT_DOUBLE_EQ(a.highest_price, b.highest_price);
+  ASSERT_DOUBLE_EQ(a.lowest_price, b.lowest_price);
+  ASSERT_DOUBLE_EQ(a.pre_close_price, b.pre_close_price);
+  ASSERT_DOUBLE_EQ(a.upper_limit_price, b.upper_limit_price);
+  ASSERT_DOUBLE_EQ(a.lower_limit_price, b.lower_limit_price);
+  ASSERT_EQ(a.volume, b.volume);
+  ASSERT_EQ(a.turnover, b.turnover);
+  ASSERT_EQ(a.open_interest, b.open_interest);
+  for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+    ASSERT_DOUBLE_EQ(a.ask[level], b.ask[level]);
+    ASSERT_DOUBLE_EQ(a.bid[level], b.bid[level]);
+    ASSERT_EQ(a.ask_volume[level], b.ask_volume[level]);
+    ASSERT_EQ(a.bid_volume[level], b.bid_volume[level]);
+  }
+}
+
+TEST(TickFile, WriteAndRead) {
+  ASSERT_TRUE(is_contractable_inited);
+
+  // 最后一个block不满
+  constexpr uint64_t kTickNum = 1000;
+  ft::TickFileWriter writer;
+  ASSERT_TRUE(writer.Open("test_tick_file.ftick", 64));
+  ASSERT_FALSE(writer.Open("test_tick_file.ftick", 64));
+  for (uint64_t i = 0; i < kTickNum; ++i) {
+    ASSERT_TRUE(writer.Write(MakeTick(i)));
+  }
+  auto invalid_tick = MakeTick(0);
+  invalid_tick.ticker_id = 4;
+  ASSERT_FALSE(writer.Write(invalid_tick));
+  ASSERT_TRUE(writer.Close());
+  ASSERT_EQ(writer.tick_num(), kTickNum);
+
+  ft::TickFileReader reader;
+  ASSERT_TRUE(reader.Open("test_tick_file.ftick"));
+  ASSERT_EQ(reader.tick_num(), kTickNum);
+  TickData tick;
+  for (uint64_t i = 0; i < kTickNum; ++i) {
+    ASSERT_TRUE(reader.Next(&tick));
+    ExpectTickEq(tick, MakeTick(i));
+  }
+  ASSERT_FALSE(reader.Next(&tick));
+  ASSERT_FALSE(reader.failed());
+
+  // 价格、成交量及时间戳都按差分编码，文件远小于TickData本身
+  struct stat st;
+  ASSERT_EQ(stat("test_tick_file.ftick", &st), 0);
+  ASSERT_LT(static_cast<uint64_t>(st.st_size), kTickNum * sizeof(TickData) / 4);
+
+  // 重新打开后从头读取
+  ASSERT_TRUE(reader.Open("test_tick_file.ftick"));
+  ASSERT_TRUE(reader.Next(&tick));
+  ExpectTickEq(tick, MakeTick(0));
+
+  remove("test_tick_file.ftick");
+}
+
+TEST(TickFile, Empty) {
+  ft::TickFileWriter writer;
+  ASSERT_TRUE(writer.Open("test_tick_file_empty.ftick"));
+  ASSERT_TRUE(writer.Close());
+
+  ft::TickFileReader reader;
+  ASSERT_TRUE(reader.Open("test_tick_file_empty.ftick"));
+  TickData tick;
+  ASSERT_FALSE(reader.Next(&tick));
+
+  remove("test_tick_file_empty.ftick");
+}
+
+TEST(TickFile, InvalidFile) {
+  ft::TickFileReader reader;
+  ASSERT_FALSE(reader.Open("test_tick_file_not_exist.ftick"));
+
+  // 未正常关闭的文件不能被读取
+  {
+    ft::TickFileWriter writer;
+    ASSERT_TRUE(writer.Open("test_tick_file_invalid.ftick", 16));
+    for (uint64_t i = 0; i < 100; ++i) {
+      ASSERT_TRUE(writer.Write(MakeTick(i)));
+    }
+    ASSERT_FALSE(reader.Open("test_tick_file_invalid.ftick"));
+  }
+
+  remove("test_tick_file_invalid.ftick");
+}
+
+class TickCollector : public ft::MarketDataListener {
+ public:
+  void OnDataFeed(const TickData* tick) override { ticks.emplace_back(*tick); }
+
+  std::vector<TickData> ticks;
+};
+
+TEST(TickFile, DataFeed) {
+  ASSERT_TRUE(is_contractable_inited);
+
+  // 多个文件按顺序回放
+  for (int f = 0; f < 2; ++f) {
+    ft::TickFileWriter writer;
+    ASSERT_TRUE(writer.Open("test_tick_file_feed" + std::to_string(f) + ".ftick", 32));
+    for (uint64_t i = 0; i < 100; ++i) {
+      ASSERT_TRUE(writer.Write(MakeTick(f * 100 + i)));
+    }
+    ASSERT_TRUE(writer.Close());
+  }
+
+  auto data_feed = ft::CreateDataFeed("ft.data_feed.tick_file");
+  ASSERT_TRUE(data_feed);
+  TickCollector collector;
+  data_feed->RegisterListener(&collector);
+  ASSERT_FALSE(data_feed->Init({}));
+  ASSERT_TRUE(data_feed->Init(
+      {{"data_file", "test_tick_file_feed0.ftick,test_tick_file_feed1.ftick"}}));
+  while (data_feed->Feed()) {
+  }
+  ASSERT_EQ(collector.ticks.size(), 200U);
+  for (uint64_t i = 0; i < collector.ticks.size(); ++i) {
+    ExpectTickEq(collector.ticks[i], MakeTick(i));
+  }
+
+  remove("test_tick_file_feed0.ftick");
+  remove("test_tick_file_feed1.ftick");
+}
+
+// 合约表下标越界时报错，而不是当作读完
+TEST(TickFile, InvalidTickerIndex) {
+  ASSERT_TRUE(is_contractable_inited);
+
+  for (int f = 0; f < 2; ++f) {
+    ft::TickFileWriter writer;
+    ASSERT_TRUE(writer.Open("test_tick_file_bad" + std::to_string(f) + ".ftick", 16));
+    for (uint64_t i = 0; i < 100; ++i) {
+      ASSERT_TRUE(writer.Write(MakeTick(i)));
+    }
+    ASSERT_TRUE(writer.Close());
+  }
+
+  // 去掉合约表中的最后一个合约，该合约的tick在读取时下标越界
+  auto* fp = fopen("test_tick_file_bad0.ftick", "r+b");
+  ASSERT_TRUE(fp);
+  uint32_t ticker_num = 2;
+  ASSERT_EQ(fseek(fp, offsetof(ft::TickFileHeader, ticker_num), SEEK_SET), 0);
+  ASSERT_EQ(fwrite(&ticker_num, sizeof(ticker_num), 1, fp), 1U);
+  fclose(fp);
+
+  ft::TickFileReader reader;
+  ASSERT_TRUE(reader.Open("test_tick_file_bad0.ftick"));
+  TickData tick;
+  ASSERT_TRUE(reader.Next(&tick));
+  ASSERT_TRUE(reader.Next(&tick));
+  ASSERT_FALSE(reader.Next(&tick));
+  ASSERT_TRUE(reader.failed());
+  ASSERT_FALSE(reader.Next(&tick));
+
+  // data feed在出错的文件处停止，不继续回放下一个文件
+  auto data_feed = ft::CreateDataFeed("ft.data_feed.tick_file");
+  ASSERT_TRUE(data_feed);
+  TickCollector collector;
+  data_feed->RegisterListener(&collector);
+  ASSERT_TRUE(data_feed->Init(
+      {{"data_file", "test_tick_file_bad0.ftick,test_tick_file_bad1.ftick"}}));
+  while (data_feed->Feed()) {
+  }
+  ASSERT_EQ(collector.ticks.size(), 2U);
+
+  remove("test_tick_file_bad0.ftick");
+  remove("test_tick_file_bad1.ftick");
+}
@@ -0,0 +1,114 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "ft/component/tick_snapshot.h"
+
+TEST(TickSnapshot, Basic) {
+  ft::TickSnapshotTable writer;
+  ASSERT_TRUE(writer.Create("test_tick_snapshot", 4));
+
+  ft::TickSnapshotTable reader;
+  ASSERT_TRUE(reader.Open("test_tick_snapshot"));
+  ASSERT_EQ(reader.ticker_num(), 4U);
+
+  ft::TickData tick{};
+  ASSERT_FALSE(reader.Get(1, &tick));
+  ASSERT_FALSE(reader.Get(0, &tick));
+  ASSERT_FALSE(reader.Get(5, &tick));
+
+  tick.ticker_id = 2;
+  tick.last_price = 100.0;
+  ASSERT_TRUE(writer.Update(tick));
+  tick.ticker_id = 5;
+  ASSERT_FALSE(writer.Update(tick));
+  ASSERT_FALSE(reader.Update(tick));
+
+  ft::TickData res{};
+  ASSERT_TRUE(reader.Get(2, &res));
+  ASSERT_EQ(res.ticker_id, 2U);
+  ASSERT_DOUBLE_EQ(res.last_price, 100.0);
+  ASSERT_EQ(reader.version(2), 1U);
+  ASSERT_FALSE(reader.Get(1, &res));
+
+  // 重新创建时清空上次的快照
+  ASSERT_TRUE(writer.Create("test_tick_snapshot", 4));
+  ASSERT_FALSE(writer.Get(2, &res));
+
+  int ret = system("rm -f ft_tick_snapshot.test_tick_snapshot");
+  (void)ret;
+}
+
+TEST(TickSnapshot, RecreateKeepsReaders) {
+  ft::TickSnapshotTable writer;
+  ASSERT_TRUE(writer.Create("test_tick_snapshot_re", 4));
+  ft::TickData tick{};
+  tick.ticker_id = 4;
+  tick.last_price = 100.0;
+  ASSERT_TRUE(writer.Update(tick));
+
+  ft::TickSnapshotTable reader;
+  ASSERT_TRUE(reader.Open("test_tick_snapshot_re"));
+
+  // OMS重启后以更少的合约重新创建，原有的读端继续读旧表，不会因文件被截断而SIGBUS
+  ft::TickSnapshotTable new_writer;
+  ASSERT_TRUE(new_writer.Create("test_tick_snapshot_re", 1));
+  ft::TickData res{};
+  ASSERT_TRUE(reader.Get(4, &res));
+  ASSERT_DOUBLE_EQ(res.last_price, 100.0);
+
+  // 重新打开后读到新表
+  ASSERT_TRUE(reader.Open("test_tick_snapshot_re"));
+  ASSERT_EQ(reader.ticker_num(), 1U);
+  ASSERT_FALSE(reader.Get(1, &res));
+
+  int ret = system("rm -f ft_tick_snapshot.test_tick_snapshot_re");
+  (void)ret;
+}
+
+TEST(TickSnapshot, Consistency) {
+  ft::TickSnapshotTable writer;
+  ASSERT_TRUE(writer.Create("test_tick_snapshot_mt", 1));
+  ft::TickSnapshotTable reader;
+  ASSERT_TRUE(reader.Open("test_tick_snapshot_mt"));
+
+  // 写端每次写入的各字段都相同，读端读到的快照各字段必须一致
+  std::atomic<bool> running = true;
+  std::thread writer_thread([&] {
+    ft::TickData tick{};
+    tick.ticker_id = 1;
+    for (uint64_t i = 1; i <= 200000; ++i) {
+      tick.volume = tick.turnover = tick.open_interest = i;
+      for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+        tick.ask[level] = tick.bid[level] = static_cast<double>(i);
+      }
+      writer.Update(tick);
+    }
+    running = false;
+  });
+
+  uint64_t last_volume = 0;
+  ft::TickData tick{};
+  while (running) {
+    if (!reader.Get(1, &tick)) {
+      continue;
+    }
+    ASSERT_EQ(tick.turnover, tick.volume);
+    ASSERT_EQ(tick.open_interest, tick.volume);
+    for (int level = 0; level < ft::kMaxMarketLevel; ++level) {
+      ASSERT_DOUBLE_EQ(tick.ask[level], static_cast<double>(tick.volume));
+      ASSERT_DOUBLE_EQ(tick.bid[level], static_cast<double>(tick.volume));
+    }
+    ASSERT_GE(tick.volume, last_volume);
+    last_volume = tick.volume;
+  }
+  writer_thread.join();
+  ASSERT_TRUE(reader.Get(1, &tick));
+  ASSERT_EQ(tick.volume, 200000UL);
+
+  int ret = system("rm -f ft_tick_snapshot.test_tick_snapshot_mt");
+  (void)ret;
+}
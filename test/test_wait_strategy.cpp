@@ -0,0 +1,137 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "ft/utils/wait_strategy.h"
+
+static void TestWakeup(ft::WaitStrategyType type, ft::Notifier* reader_notifier,
+                       ft::Notifier* writer_notifier) {
+  ft::WaitStrategy strategy{};
+  strategy.type = type;
+  strategy.spin_count = 10;
+  strategy.timeout_us = 10000000;  // 超时足够长，只能被写端唤醒
+
+  std::atomic<int> data{0};
+  std::thread reader([&] {
+    ft::Waiter waiter(strategy, reader_notifier);
+    int expected = 1;
+    while (expected <= 100) {
+      if (data.load() >= expected) {
+        ++expected;
+        waiter.Reset();
+      } else {
+        waiter.Wait();
+      }
+    }
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 1; i <= 100; ++i) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    data.store(i);
+    writer_notifier->Notify();
+  }
+  reader.join();
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST(WaitStrategy, Parse) {
+  ft::WaitStrategyType type;
+  ASSERT_TRUE(ft::ParseWaitStrategyType("busy_spin", &type));
+  ASSERT_EQ(type, ft::WaitStrategyType::kBusySpin);
+  ASSERT_TRUE(ft::ParseWaitStrategyType("spin_yield", &type));
+  ASSERT_EQ(type, ft::WaitStrategyType::kSpinYield);
+  ASSERT_TRUE(ft::ParseWaitStrategyType("futex", &type));
+  ASSERT_EQ(type, ft::WaitStrategyType::kSpinFutex);
+  ASSERT_TRUE(ft::ParseWaitStrategyType("eventfd", &type));
+  ASSERT_EQ(type, ft::WaitStrategyType::kSpinEventFd);
+  ASSERT_FALSE(ft::ParseWaitStrategyType("sleep", &type));
+}
+
+TEST(WaitStrategy, FutexWakeup) {
+  ft::Notifier notifier;
+  TestWakeup(ft::WaitStrategyType::kSpinFutex, &notifier, &notifier);
+}
+
+TEST(WaitStrategy, EventFdWakeup) {
+  ft::Notifier notifier;
+  ASSERT_TRUE(notifier.EnableEventFd());
+  TestWakeup(ft::WaitStrategyType::kSpinEventFd, &notifier, &notifier);
+}
+
+TEST(WaitStrategy, SharedNotifier) {
+  // 两个notifier映射同一个文件，模拟跨进程的读写端
+  ft::Notifier reader_notifier;
+  ft::Notifier writer_notifier;
+  ASSERT_TRUE(reader_notifier.OpenShared("test_wait_strategy"));
+  ASSERT_TRUE(writer_notifier.OpenShared("test_wait_strategy"));
+  ASSERT_FALSE(reader_notifier.EnableEventFd());
+  TestWakeup(ft::WaitStrategyType::kSpinFutex, &reader_notifier, &writer_notifier);
+
+  int res = system("rm -f ft_notifier.test_wait_strategy");
+  (void)res;
+}
+
+TEST(WaitStrategy, ReapKilledWaiter) {
+  ft::Notifier writer_notifier;
+  ASSERT_TRUE(writer_notifier.OpenShared("test_wait_strategy_reap"));
+
+  // 读端进程阻塞在futex上时被杀掉，留下的waiter在下一次Notify时被清除
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    ft::Notifier reader_notifier;
+    if (!reader_notifier.OpenShared("test_wait_strategy_reap")) {
+      _exit(1);
+    }
+    ft::WaitStrategy strategy{};
+    strategy.type = ft::WaitStrategyType::kSpinFutex;
+    strategy.spin_count = 0;
+    strategy.timeout_us = 10000000;
+    ft::Waiter waiter(strategy, &reader_notifier);
+    for (;;) {
+      waiter.Wait();
+    }
+  }
+
+  for (int i = 0; i < 1000 && !writer_notifier.has_waiters(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  ASSERT_TRUE(writer_notifier.has_waiters());
+  kill(pid, SIGKILL);
+  waitpid(pid, nullptr, 0);
+  ASSERT_TRUE(writer_notifier.has_waiters());
+
+  writer_notifier.Notify();
+  ASSERT_FALSE(writer_notifier.has_waiters());
+
+  // 同一个notifier上之后的读端回收已退出线程的slot，可以正常阻塞及唤醒
+  ft::WaitStrategy strategy{};
+  strategy.type = ft::WaitStrategyType::kSpinFutex;
+  strategy.spin_count = 0;
+  strategy.timeout_us = 10000000;
+  std::atomic<bool> done{false};
+  std::thread reader([&] {
+    ft::Waiter waiter(strategy, &writer_notifier);
+    while (!done.load()) {
+      waiter.Wait();
+    }
+  });
+  while (!writer_notifier.has_waiters()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  done.store(true);
+  writer_notifier.Notify();
+  reader.join();
+  ASSERT_FALSE(writer_notifier.has_waiters());
+
+  int res = system("rm -f ft_notifier.test_wait_strategy_reap");
+  (void)res;
+}
@@ -1,8 +1,14 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "ft/component/yijinjing/journal/JournalReader.h"
 #include "ft/component/yijinjing/journal/JournalWriter.h"
 #include "ft/component/yijinjing/journal/PageProvider.h"
+#include "ft/component/yijinjing/journal/PageUtil.h"
+#include "ft/component/yijinjing/journal/Timer.h"
 
 TEST(YIJINJING, JOURNAL) {
   auto writer = yijinjing::JournalWriter::create(".", "test_yijinjing_writer", "writer");
@@ -22,3 +28,163 @@ TEST(YIJINJING, JOURNAL) {
   data[frame->getDataLength()] = 0;
   ASSERT_STREQ(data, "aaa");
 }
+
+TEST(YIJINJING, JOURNAL_FRAME_VIEW) {
+  auto writer = yijinjing::JournalWriter::create(".", "test_yijinjing_frame_view", "writer");
+  auto start_time = yijinjing::getNanoTime();
+
+  writer->seekEnd();
+  for (int i = 0; i < 100; ++i) {
+    writer->write_data(i, 1, 0);
+  }
+
+  auto reader = yijinjing::JournalReader::create(".", "test_yijinjing_frame_view", start_time,
+                                                 "reader");
+
+  yijinjing::Frame frame(nullptr);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(reader->getNextFrame(&frame));
+    ASSERT_EQ(frame.getDataLength(), sizeof(int));
+    ASSERT_EQ(frame.getMsgType(), 1);
+    ASSERT_EQ(*reinterpret_cast<int*>(frame.getData()), i);
+  }
+  ASSERT_FALSE(reader->getNextFrame(&frame));
+
+  int res = system("rm -f yjj.test_yijinjing_frame_view.*");
+  (void)res;
+}
+
+TEST(YIJINJING, JOURNAL_PAGE_CONFIG) {
+  yijinjing::PageUtil::RemoveJournal(".", "test_yijinjing_page_config");
+
+  yijinjing::PageConfig page_config;
+  page_config.pageSize = yijinjing::JOURNAL_MIN_PAGE_SIZE;
+  page_config.preallocate = true;
+  auto writer = yijinjing::JournalWriter::create(".", "test_yijinjing_page_config", "writer",
+                                                 page_config);
+  auto start_time = yijinjing::getNanoTime();
+
+  // 每帧约1KB，写满3页以上
+  char data[1000]{};
+  int n = 4 * yijinjing::JOURNAL_MIN_PAGE_SIZE / sizeof(data);
+  for (int i = 0; i < n; ++i) {
+    *reinterpret_cast<int*>(data) = i;
+    writer->write_data(data, 1, 0);
+  }
+  ASSERT_GE(writer->getPageNum(), 4);
+
+  auto reader = yijinjing::JournalReader::create(".", "test_yijinjing_page_config", start_time,
+                                                 "reader");
+  yijinjing::Frame frame(nullptr);
+  for (int i = 0; i < n; ++i) {
+    ASSERT_TRUE(reader->getNextFrame(&frame));
+    ASSERT_EQ(frame.getDataLength(), sizeof(data));
+    ASSERT_EQ(*reinterpret_cast<int*>(frame.getData()), i);
+  }
+  ASSERT_FALSE(reader->getNextFrame(&frame));
+
+  auto page_nums = yijinjing::PageUtil::GetPageNums(".", "test_yijinjing_page_config");
+  for (auto page_num : page_nums) {
+    auto path = yijinjing::PageUtil::GenPageFullPath(".", "test_yijinjing_page_config", page_num);
+    ASSERT_EQ(yijinjing::PageUtil::GetFileSize(path), yijinjing::JOURNAL_MIN_PAGE_SIZE);
+  }
+  yijinjing::PageUtil::RemoveJournal(".", "test_yijinjing_page_config");
+}
+
+TEST(YIJINJING, JOURNAL_HEAP_MERGE) {
+  const int journal_num = 5;
+  std::vector<std::string> dirs;
+  std::vector<std::string> jnames;
+  std::vector<yijinjing::JournalWriterPtr> writers;
+  yijinjing::PageConfig page_config;
+  page_config.pageSize = yijinjing::JOURNAL_MIN_PAGE_SIZE;
+  for (int i = 0; i < journal_num; ++i) {
+    dirs.emplace_back(".");
+    jnames.emplace_back("test_yijinjing_merge_" + std::to_string(i));
+    yijinjing::PageUtil::RemoveJournal(".", jnames.back());
+    writers.emplace_back(
+        yijinjing::JournalWriter::create(".", jnames.back(), "writer", page_config));
+  }
+  auto start_time = yijinjing::getNanoTime();
+
+  auto linear_reader = yijinjing::JournalReader::create(dirs, jnames, start_time, "linear");
+  auto heap_reader = yijinjing::JournalReader::create(dirs, jnames, start_time, "heap");
+  heap_reader->enableHeapMerge();
+
+  // 不均匀地写入各journal，部分journal在中途才开始有数据
+  auto write_batch = [&](int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+      int idx = (i * 7 + i / 3) % journal_num;
+      if (i < 1000 && idx == journal_num - 1) idx = 0;
+      writers[idx]->write_data(i, 1, 0);
+    }
+  };
+  auto read_all = [](yijinjing::JournalReaderPtr& reader, std::vector<int>* res) {
+    yijinjing::Frame frame(nullptr);
+    while (reader->getNextFrame(&frame)) {
+      res->emplace_back(*reinterpret_cast<int*>(frame.getData()));
+    }
+  };
+
+  std::vector<int> linear_res;
+  std::vector<int> heap_res;
+  for (int batch = 0; batch < 4; ++batch) {
+    write_batch(batch * 1000, batch * 1000 + 1000);
+    read_all(linear_reader, &linear_res);
+    read_all(heap_reader, &heap_res);
+    ASSERT_EQ(heap_res, linear_res);
+  }
+  ASSERT_EQ(heap_res.size(), 4000UL);
+
+  // 空闲的journal延迟检查，所有帧仍需被读到
+  auto lazy_reader = yijinjing::JournalReader::create(dirs, jnames, start_time, "lazy");
+  lazy_reader->enableHeapMerge(16);
+  std::vector<int> lazy_res;
+  read_all(lazy_reader, &lazy_res);
+  std::sort(lazy_res.begin(), lazy_res.end());
+  std::sort(heap_res.begin(), heap_res.end());
+  ASSERT_EQ(lazy_res, heap_res);
+
+  for (auto& jname : jnames) {
+    yijinjing::PageUtil::RemoveJournal(".", jname);
+  }
+}
+
+TEST(YIJINJING, JOURNAL_WRITE_MULTI) {
+  const int journal_num = 3;
+  std::vector<yijinjing::JournalWriterPtr> writers;
+  std::vector<yijinjing::JournalWriter*> raw_writers;
+  std::vector<yijinjing::JournalReaderPtr> readers;
+  auto start_time = yijinjing::getNanoTime();
+  for (int i = 0; i < journal_num; ++i) {
+    auto jname = "test_yijinjing_multi_" + std::to_string(i);
+    yijinjing::PageUtil::RemoveJournal(".", jname);
+    writers.emplace_back(yijinjing::JournalWriter::create(".", jname, "writer"));
+    raw_writers.emplace_back(writers.back().get());
+    readers.emplace_back(yijinjing::JournalReader::create(".", jname, start_time, "reader"));
+  }
+
+  std::vector<int64_t> nanos;
+  for (int i = 0; i < 100; ++i) {
+    nanos.emplace_back(yijinjing::JournalWriter::write_data_multi(
+        raw_writers.data(), raw_writers.size(), i, 3, 0));
+  }
+
+  yijinjing::Frame frame(nullptr);
+  for (auto& reader : readers) {
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_TRUE(reader->getNextFrame(&frame));
+      ASSERT_EQ(frame.getMsgType(), 3);
+      ASSERT_EQ(frame.getNano(), nanos[i]);
+      ASSERT_EQ(frame.getDataLength(), sizeof(int));
+      ASSERT_EQ(*reinterpret_cast<int*>(frame.getData()), i);
+    }
+    ASSERT_FALSE(reader->getNextFrame(&frame));
+  }
+
+  readers.clear();
+  writers.clear();
+  for (int i = 0; i < journal_num; ++i) {
+    yijinjing::PageUtil::RemoveJournal(".", "test_yijinjing_multi_" + std::to_string(i));
+  }
+}
@@ -0,0 +1,105 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 读取OMS及策略导出的延迟统计页，按线程打印各阶段的p50/p99/p999
+// 指定--interval时每隔interval秒打印一次该时间段内的分布
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ft/component/latency_stats.h"
+#include "ft/utils/getopt.hpp"
+#include "ft/utils/ipc_config.h"
+
+static void Usage() {
+  printf("Usage:\n");
+  printf("    --name              统计页名称，即investor_id\n");
+  printf("    --interval          打印间隔(秒)，为0时打印累计值后退出，默认0\n");
+  printf("    -h, -?, --help      帮助\n");
+}
+
+// 从cur中减去prev，max为最后一个非空桶的上界
+static void Subtract(const ft::LatencyHistogram& prev, ft::LatencyHistogram* cur) {
+  cur->count -= prev.count;
+  cur->max = 0;
+  for (std::size_t i = 0; i < ft::LatencyHistogram::kBucketNum; ++i) {
+    cur->buckets[i] -= prev.buckets[i];
+    if (cur->buckets[i] > 0) {
+      cur->max = ft::LatencyHistogram::BucketValue(i);
+    }
+  }
+}
+
+static void Print(const std::string& thread_name, const ft::LatencyHistograms& histograms,
+                  double tsc_per_ns) {
+  auto ns = [=](uint64_t tsc) { return static_cast<double>(tsc) / tsc_per_ns; };
+  for (uint32_t stage = 0; stage < ft::kLatencyStageNum; ++stage) {
+    auto& hist = histograms.stages[stage];
+    if (hist.count == 0) {
+      continue;
+    }
+    printf("%-24s %-14s %12lu %10.0f %10.0f %10.0f %12.0f\n", thread_name.c_str(),
+           ft::LatencyStageStr(static_cast<ft::LatencyStage>(stage)), hist.count,
+           ns(hist.Percentile(0.5)), ns(hist.Percentile(0.99)), ns(hist.Percentile(0.999)),
+           ns(hist.max));
+  }
+}
+
+int main() {
+  std::string name = getarg("", "--name");
+  int interval = getarg(0, "--interval");
+  bool help = getarg(false, "-h", "--help", "-?");
+
+  if (help || name.empty()) {
+    Usage();
+    exit(help ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  ft::LatencyStats stats;
+  if (!stats.Open(ft::GetLatencyStatsName(name), false)) {
+    printf("cannot open latency stats: %s\n", name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  // 直方图较大，放在堆上
+  auto cur = std::make_unique<ft::LatencyHistograms>();
+  std::vector<ft::LatencyHistograms> prev(stats.slot_num());
+  std::vector<bool> has_prev(stats.slot_num(), false);
+  std::string thread_name;
+  for (;;) {
+    printf("%-24s %-14s %12s %10s %10s %10s %12s\n", "thread", "stage", "count", "p50(ns)",
+           "p99(ns)", "p999(ns)", "max(ns)");
+    for (uint32_t i = 0; i < stats.slot_num(); ++i) {
+      if (!stats.Load(i, &thread_name, cur.get())) {
+        continue;
+      }
+      if (interval <= 0) {
+        Print(thread_name, *cur, stats.tsc_per_ns());
+        continue;
+      }
+
+      // slot被复用后重新统计，计数变小时不做差
+      auto delta = *cur;
+      if (has_prev[i]) {
+        bool restarted = false;
+        for (uint32_t stage = 0; stage < ft::kLatencyStageNum; ++stage) {
+          restarted |= delta.stages[stage].count < prev[i].stages[stage].count;
+        }
+        for (uint32_t stage = 0; stage < ft::kLatencyStageNum && !restarted; ++stage) {
+          Subtract(prev[i].stages[stage], &delta.stages[stage]);
+        }
+      }
+      Print(thread_name, delta, stats.tsc_per_ns());
+      prev[i] = *cur;
+      has_prev[i] = true;
+    }
+
+    if (interval <= 0) {
+      break;
+    }
+    printf("\n");
+    std::this_thread::sleep_for(std::chrono::seconds(interval));
+  }
+  return 0;
+}
@@ -0,0 +1,146 @@
+// Copyright [2020-2021] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 解码log_mode为binary时写入的二进制日志(./ft_log.<name>.<pid>.bin)，按写入顺序输出文本日志
+// 格式为: [时间] [级别] [线程id] 内容
+
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ft/base/log.h"
+#include "ft/base/log_file.h"
+#include "ft/utils/getopt.hpp"
+
+static void Usage() {
+  printf("Usage:\n");
+  printf("    --file              二进制日志文件\n");
+  printf("    --loglevel          只输出不低于该等级的日志(trace, debug, info, warn, error)，默认trace\n");
+  printf("    -h, -?, --help      帮助\n");
+}
+
+struct Site {
+  spdlog::level::level_enum level;
+  std::string file;
+  uint32_t line;
+  std::string fmt;
+};
+
+static void PrintTime(int64_t timestamp_ns) {
+  time_t sec = timestamp_ns / 1000000000;
+  struct tm tm;
+  localtime_r(&sec, &tm);
+  char buf[32];
+  strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+  printf("[%s.%06ld] ", buf, static_cast<long>(timestamp_ns % 1000000000 / 1000));
+}
+
+int main() {
+  std::string file = getarg("", "--file");
+  std::string log_level = getarg("trace", "--loglevel");
+  bool help = getarg(false, "-h", "--help", "-?");
+
+  if (help || file.empty()) {
+    Usage();
+    exit(help ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  FILE* fp = fopen(file.c_str(), "rb");
+  if (!fp) {
+    printf("cannot open %s\n", file.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  ft::LogFileHeader header;
+  if (fread(&header, sizeof(header), 1, fp) != 1 || header.magic != ft::kLogFileMagic ||
+      header.version != ft::kLogFileVersion) {
+    printf("invalid log file: %s\n", file.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  auto min_level = spdlog::level::from_str(log_level);
+  std::map<uint32_t, Site> sites;
+  std::vector<char> block;
+  std::string msg;
+  uint64_t lines = 0;
+  for (;;) {
+    uint32_t type_and_size[2];
+    if (fread(type_and_size, sizeof(type_and_size), 1, fp) != 1) {
+      break;
+    }
+    // 进程异常退出时最后一个块可能不完整
+    uint32_t size = type_and_size[1];
+    if (size < sizeof(type_and_size)) {
+      printf("corrupted block at offset %ld\n", ftell(fp));
+      break;
+    }
+    block.resize(size);
+    memcpy(block.data(), type_and_size, sizeof(type_and_size));
+    std::size_t remain = size - sizeof(type_and_size);
+    if (fread(block.data() + sizeof(type_and_size), 1, remain, fp) != remain) {
+      break;
+    }
+
+    if (type_and_size[0] == ft::kLogFileSiteBlock) {
+      ft::LogFileSite site_block;
+      if (size < sizeof(site_block)) {
+        break;
+      }
+      memcpy(&site_block, block.data(), sizeof(site_block));
+      const char* p = block.data() + sizeof(site_block);
+      if (site_block.file_len > size - sizeof(site_block)) {
+        break;
+      }
+      auto& site = sites[site_block.site_id];
+      site.level = static_cast<spdlog::level::level_enum>(site_block.level);
+      site.file.assign(p, site_block.file_len);
+      site.line = site_block.line;
+      site.fmt.assign(p + site_block.file_len, size - sizeof(site_block) - site_block.file_len);
+    } else if (type_and_size[0] == ft::kLogFileRecordBlock) {
+      ft::LogFileRecord record;
+      if (size < sizeof(record)) {
+        break;
+      }
+      memcpy(&record, block.data(), sizeof(record));
+      const char* args = block.data() + sizeof(record);
+      std::size_t args_size = size - sizeof(record);
+
+      spdlog::level::level_enum level;
+      std::string_view fmt;
+      if (record.site_id >= ft::log_detail::kFirstSiteId) {
+        auto it = sites.find(record.site_id);
+        if (it == sites.end()) {
+          printf("unknown site id %u\n", record.site_id);
+          continue;
+        }
+        level = it->second.level;
+        fmt = it->second.fmt;
+      } else {
+        level = static_cast<spdlog::level::level_enum>(record.site_id -
+                                                       ft::log_detail::kPreformattedSiteId);
+        fmt = "{}";
+      }
+      if (level < min_level) {
+        continue;
+      }
+
+      msg.clear();
+      if (!ft::log_detail::FormatLogArgs(fmt, args, args_size, &msg)) {
+        msg.assign(fmt.data(), fmt.size());
+      }
+      PrintTime(record.timestamp_ns);
+      auto level_str = spdlog::level::to_string_view(level);
+      printf("[%.*s] [%lu] %s\n", static_cast<int>(level_str.size()), level_str.data(),
+             record.thread_id, msg.c_str());
+      ++lines;
+    } else {
+      printf("unknown block type %u\n", type_and_size[0]);
+      break;
+    }
+  }
+
+  fclose(fp);
+  fprintf(stderr, "%lu lines decoded\n", lines);
+  return 0;
+}
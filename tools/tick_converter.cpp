@@ -0,0 +1,110 @@
+// Copyright [2020-present] <Copyright Kevin, kevin.lau.gd@gmail.com>
+
+// 将csv行情文件或yijinjing中记录的行情转换为列式tick文件，用于ft.data_feed.tick_file
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ft/base/contract_table.h"
+#include "ft/base/log.h"
+#include "ft/base/msg_type.h"
+#include "ft/component/yijinjing/journal/JournalReader.h"
+#include "ft/utils/getopt.hpp"
+#include "ft/utils/string_utils.h"
+#include "trader/gateway/backtest/data_feed/csv_data_feed.h"
+#include "trader/gateway/backtest/data_feed/tick_file.h"
+
+static void Usage() {
+  printf("Usage:\n");
+  printf("    --contracts         合约列表文件，需与记录行情时使用的一致\n");
+  printf("    --csv               csv行情文件\n");
+  printf("    --journal           journal名，多个journal以逗号分隔，按时间顺序合并\n");
+  printf("    --journal_dir       journal所在目录，默认为当前目录\n");
+  printf("    --start_time        只转换该时间(ns)之后的行情，默认从头开始\n");
+  printf("    --output            输出文件\n");
+  printf("    -h, -?, --help      帮助\n");
+}
+
+class TickFileListener : public ft::MarketDataListener {
+ public:
+  explicit TickFileListener(ft::TickFileWriter* writer) : writer_(writer) {}
+
+  void OnDataFeed(const ft::TickData* tick) override { ok_ = writer_->Write(*tick) && ok_; }
+
+  bool ok() const { return ok_; }
+
+ private:
+  ft::TickFileWriter* writer_;
+  bool ok_ = true;
+};
+
+static bool ConvertCsv(const std::string& file, ft::TickFileWriter* writer) {
+  ft::CsvDataFeed data_feed;
+  TickFileListener listener(writer);
+  data_feed.RegisterListener(&listener);
+  if (!data_feed.Init({{"data_file", file}})) {
+    return false;
+  }
+  while (data_feed.Feed()) {
+  }
+  return listener.ok();
+}
+
+static bool ConvertJournal(const std::string& dir, const std::string& journals, int64_t start_time,
+                           ft::TickFileWriter* writer) {
+  std::vector<std::string> jnames;
+  ft::StringSplit(journals, ",", &jnames, true);
+  std::vector<std::string> dirs(jnames.size(), dir);
+  auto reader = yijinjing::JournalReader::create(dirs, jnames, start_time, "tick_converter");
+  if (!reader) {
+    return false;
+  }
+
+  yijinjing::Frame frame(nullptr);
+  while (reader->getNextFrame(&frame)) {
+    if (frame.getMsgType() != ft::kMsgTypeOf<ft::TickData> ||
+        frame.getDataLength() != sizeof(ft::TickData)) {
+      continue;
+    }
+    if (!writer->Write(*reinterpret_cast<const ft::TickData*>(frame.getData()))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  std::string contracts_file = getarg("../config/contracts.csv", "--contracts");
+  std::string csv_file = getarg("", "--csv");
+  std::string journals = getarg("", "--journal");
+  std::string journal_dir = getarg(".", "--journal_dir");
+  int64_t start_time = getarg(0L, "--start_time");
+  std::string output = getarg("", "--output");
+  bool help = getarg(false, "-h", "--help", "-?");
+
+  if (help || output.empty() || csv_file.empty() == journals.empty()) {
+    Usage();
+    exit(help ? 0 : -1);
+  }
+
+  if (!ft::ContractTable::Init(contracts_file)) {
+    printf("ContractTable Init failed\n");
+    exit(-1);
+  }
+
+  ft::TickFileWriter writer;
+  if (!writer.Open(output)) {
+    printf("failed to open %s\n", output.c_str());
+    exit(-1);
+  }
+
+  bool res = csv_file.empty() ? ConvertJournal(journal_dir, journals, start_time, &writer)
+                              : ConvertCsv(csv_file, &writer);
+  if (!writer.Close() || !res) {
+    printf("convert failed\n");
+    exit(-1);
+  }
+  printf("%lu ticks written to %s\n", writer.tick_num(), output.c_str());
+  return 0;
+}